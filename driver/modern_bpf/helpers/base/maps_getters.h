@@ -90,6 +90,11 @@ static __always_inline uint8_t maps__64bit_sampling_tracepoint_table(uint32_t ev
 	return g_64bit_sampling_tracepoint_table[event_id < PPM_EVENT_MAX ? event_id : PPM_EVENT_MAX-1];
 }
 
+static __always_inline uint32_t maps__64bit_adaptive_sampling_ratio(uint32_t syscall_id)
+{
+	return g_64bit_adaptive_sampling_ratio_table[syscall_id & (SYSCALL_TABLE_SIZE - 1)];
+}
+
 /*=============================== SAMPLING TABLES ===========================*/
 
 /*=============================== SYSCALL-64 INTERESTING TABLE ===========================*/
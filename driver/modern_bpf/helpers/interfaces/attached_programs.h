@@ -23,11 +23,24 @@ enum intrumentation_type
  */
 static __always_inline bool sampling_logic(void* ctx, uint32_t id, enum intrumentation_type type)
 {
-	/* If dropping mode is not enabled we don't perform any sampling
+	/* Per-syscall ratios are pushed by the userspace adaptive sampler when the
+	 * ring buffers are under pressure. They are applied even if the global
+	 * dropping mode is disabled.
+	 */
+	uint32_t adaptive_ratio = 1;
+	if(type == MODERN_BPF_SYSCALL)
+	{
+		adaptive_ratio = maps__64bit_adaptive_sampling_ratio(id);
+	}
+
+	bool dropping_mode = maps__get_dropping_mode();
+
+	/* If dropping mode is not enabled and the syscall is not sampled on its
+	 * own we don't perform any sampling
 	 * false: means don't drop the syscall
 	 * true: means drop the syscall
 	 */
-	if(!maps__get_dropping_mode())
+	if(!dropping_mode && adaptive_ratio <= 1)
 	{
 		return false;
 	}
@@ -51,36 +64,46 @@ static __always_inline bool sampling_logic(void* ctx, uint32_t id, enum intrumen
 		return false;
 	}
 
-	if(sampling_flag == UF_ALWAYS_DROP)
-	{
-		return true;
-	}
+	uint64_t phase = bpf_ktime_get_boot_ns() % SECOND_TO_NS;
 
-	if((bpf_ktime_get_boot_ns() % SECOND_TO_NS) >= (SECOND_TO_NS / maps__get_sampling_ratio()))
+	if(dropping_mode)
 	{
-		/* If we are starting the dropping phase we need to notify the userspace, otherwise, we
-		 * simply drop our event.
-		 * PLEASE NOTE: this logic is not per-CPU so it is best effort!
-		 */
-		if(!maps__get_is_dropping())
+		if(sampling_flag == UF_ALWAYS_DROP)
 		{
-			/* Here we are not sure we can send the drop_e event to userspace
-			 * if the buffer is full, but this is not essential even if we lose
-			 * an iteration we will synchronize again the next time the logic is enabled.
+			return true;
+		}
+
+		if(phase >= (SECOND_TO_NS / maps__get_sampling_ratio()))
+		{
+			/* If we are starting the dropping phase we need to notify the userspace, otherwise, we
+			 * simply drop our event.
+			 * PLEASE NOTE: this logic is not per-CPU so it is best effort!
 			 */
-			maps__set_is_dropping(true);
-			bpf_tail_call(ctx, &extra_event_prog_tail_table, T1_DROP_E);
-			bpf_printk("unable to tail call into 'drop_e' prog");
+			if(!maps__get_is_dropping())
+			{
+				/* Here we are not sure we can send the drop_e event to userspace
+				 * if the buffer is full, but this is not essential even if we lose
+				 * an iteration we will synchronize again the next time the logic is enabled.
+				 */
+				maps__set_is_dropping(true);
+				bpf_tail_call(ctx, &extra_event_prog_tail_table, T1_DROP_E);
+				bpf_printk("unable to tail call into 'drop_e' prog");
+			}
+			return true;
 		}
-		return true;
-	}
 
-	if(maps__get_is_dropping())
-	{
-		maps__set_is_dropping(false);
-		bpf_tail_call(ctx, &extra_event_prog_tail_table, T1_DROP_X);
-		bpf_printk("unable to tail call into 'drop_x' prog");
+		if(maps__get_is_dropping())
+		{
+			maps__set_is_dropping(false);
+			bpf_tail_call(ctx, &extra_event_prog_tail_table, T1_DROP_X);
+			bpf_printk("unable to tail call into 'drop_x' prog");
+		}
 	}
 
-	return false;
+	/* The `drop_e`/`drop_x` events only track the global dropping phase and
+	 * carry its ratio. Adaptive drops are silent: they would flip the
+	 * dropping state on almost every event, and userspace already knows
+	 * which ratios it pushed.
+	 */
+	return adaptive_ratio > 1 && phase >= (SECOND_TO_NS / adaptive_ratio);
 }
@@ -74,6 +74,16 @@ __weak uint8_t g_64bit_sampling_syscall_table[SYSCALL_TABLE_SIZE];
 /// TOOD: we need to change the dimension! we need to create a dedicated enum for tracepoints!
 __weak uint8_t g_64bit_sampling_tracepoint_table[PPM_EVENT_MAX];
 
+/**
+ * @brief Given the syscall id on 64-bit-architectures returns the
+ * sampling ratio pushed by the userspace adaptive sampler:
+ * - `0` or `1` if the syscall is not sampled on its own.
+ * - a power of 2 (<= 128) if only `1/ratio` of the syscalls must be kept.
+ * These ratios are applied even if the global dropping mode is disabled
+ * but never to syscalls marked as `UF_NEVER_DROP`.
+ */
+__weak uint32_t g_64bit_adaptive_sampling_ratio_table[SYSCALL_TABLE_SIZE];
+
 /**
  * @brief Given the syscall id on 32-bit x86 arch returns
  * its x64 value. Used to support ia32 syscall emulation.
@@ -3,6 +3,7 @@
 #include <libscap/scap.h>
 #include <errno.h>
 #include <fcntl.h>
+#include <vector>
 
 /* We are supposing that if we overcome this threshold, all buffers are full.
  * Probably this threshold is too low, but it depends on the machine's workload.
@@ -96,7 +97,7 @@ void check_event_is_not_overwritten(scap_t *h)
 
 #if defined(__NR_close) && defined(__NR_openat) && defined(__NR_listen) && defined(__NR_accept4) && defined(__NR_getegid) && defined(__NR_getgid) && defined(__NR_geteuid) && defined(__NR_getuid) && defined(__NR_bind) && defined(__NR_connect) && defined(__NR_sendto) && defined(__NR_getsockopt) && defined(__NR_recvmsg) && defined(__NR_recvfrom) && defined(__NR_socket) && defined(__NR_socketpair)
 
-void check_event_order(scap_t *h)
+void check_event_order(scap_t *h, uint32_t batch_size)
 {
 	uint32_t events_to_assert[EVENTS_TO_ASSERT] = {PPME_SYSCALL_CLOSE_E, PPME_SYSCALL_CLOSE_X, PPME_SYSCALL_OPENAT_2_E, PPME_SYSCALL_OPENAT_2_X, PPME_SOCKET_LISTEN_E, PPME_SOCKET_LISTEN_X, PPME_SOCKET_ACCEPT4_6_E, PPME_SOCKET_ACCEPT4_6_X, PPME_SYSCALL_GETEGID_E, PPME_SYSCALL_GETEGID_X, PPME_SYSCALL_GETGID_E, PPME_SYSCALL_GETGID_X, PPME_SYSCALL_GETEUID_E, PPME_SYSCALL_GETEUID_X, PPME_SYSCALL_GETUID_E, PPME_SYSCALL_GETUID_X, PPME_SOCKET_BIND_E, PPME_SOCKET_BIND_X, PPME_SOCKET_CONNECT_E, PPME_SOCKET_CONNECT_X, PPME_SOCKET_SENDTO_E, PPME_SOCKET_SENDTO_X, PPME_SOCKET_GETSOCKOPT_E, PPME_SOCKET_GETSOCKOPT_X, PPME_SOCKET_RECVMSG_E, PPME_SOCKET_RECVMSG_X, PPME_SOCKET_RECVFROM_E, PPME_SOCKET_RECVFROM_X, PPME_SOCKET_SOCKET_E, PPME_SOCKET_SOCKET_X, PPME_SOCKET_SOCKETPAIR_E, PPME_SOCKET_SOCKETPAIR_X};
 
@@ -162,11 +163,48 @@ void check_event_order(scap_t *h)
 	/* if we hit 5 consecutive timeouts it means that all buffers are empty (approximation) */
 	uint16_t timeouts = 0;
 
+	/* Events of the current batch not yet checked */
+	std::vector<scap_batch_evt> batch(batch_size);
+	uint32_t batch_nevts = 0;
+	uint32_t batch_pos = 0;
+	uint64_t batch_prev_ts = 0;
+
 	for(int i = 0; i < EVENTS_TO_ASSERT; i++)
 	{
 		while(true)
 		{
-			ret = scap_next(h, &evt, &buffer_id, &flags);
+			if(batch_size == 0)
+			{
+				ret = scap_next(h, &evt, &buffer_id, &flags);
+			}
+			else
+			{
+				if(batch_pos == batch_nevts)
+				{
+					batch_pos = 0;
+					batch_prev_ts = 0;
+					ret = scap_next_batch(h, batch.data(), batch_size, &batch_nevts);
+					if(ret != SCAP_SUCCESS)
+					{
+						batch_nevts = 0;
+					}
+					else
+					{
+						ASSERT_GT(batch_nevts, 0);
+						ASSERT_LE(batch_nevts, batch_size);
+					}
+				}
+
+				if(batch_pos < batch_nevts)
+				{
+					/* The events of a batch are merged by timestamp */
+					evt = batch[batch_pos++].evt;
+					ASSERT_GE(evt->ts, batch_prev_ts);
+					batch_prev_ts = evt->ts;
+					ret = SCAP_SUCCESS;
+				}
+			}
+
 			if(ret == SCAP_SUCCESS)
 			{
 				timeouts = 0;
@@ -190,7 +228,7 @@ void check_event_order(scap_t *h)
 
 #else
 
-void check_event_order(scap_t *h)
+void check_event_order(scap_t *h, uint32_t batch_size)
 {
 	GTEST_SKIP() << "Some syscalls required by the test are not defined" << std::endl;
 }
@@ -2,6 +2,7 @@
 
 void check_event_is_not_overwritten(scap_t* h);
 
-void check_event_order(scap_t* h);
+/* With `batch_size > 0` the events are read with `scap_next_batch` */
+void check_event_order(scap_t* h, uint32_t batch_size = 0);
 
 int num_possible_cpus(void);
@@ -91,6 +91,17 @@ TEST(bpf, read_in_order)
 	scap_close(h);
 }
 
+TEST(bpf, read_in_order_batch)
+{
+	char error_buffer[SCAP_LASTERR_SIZE] = {0};
+	int ret = 0;
+	scap_t* h = open_bpf_engine(error_buffer, &ret, 1 * 1024 * 1024, LIBSCAP_TEST_BPF_PROBE_PATH);
+	ASSERT_FALSE(!h || ret != SCAP_SUCCESS) << "unable to open bpf engine: " << error_buffer << std::endl;
+
+	check_event_order(h, 16);
+	scap_close(h);
+}
+
 TEST(bpf, scap_stats_check)
 {
 	char error_buffer[FILENAME_MAX] = {0};
@@ -146,6 +146,18 @@ TEST(kmod, read_in_order)
 	scap_close(h);
 }
 
+TEST(kmod, read_in_order_batch)
+{
+	char error_buffer[SCAP_LASTERR_SIZE] = {0};
+	int ret = 0;
+	/* We use buffers of 1 MB to be sure that we don't have drops */
+	scap_t* h = open_kmod_engine(error_buffer, &ret, 1 * 1024 * 1024, LIBSCAP_TEST_KERNEL_MODULE_PATH);
+	ASSERT_FALSE(!h || ret != SCAP_SUCCESS) << "unable to open kmod engine: " << error_buffer << std::endl;
+
+	check_event_order(h, 16);
+	scap_close(h);
+}
+
 TEST(kmod, scap_stats_check)
 {
 	char error_buffer[FILENAME_MAX] = {0};
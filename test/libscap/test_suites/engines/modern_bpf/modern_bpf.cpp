@@ -173,6 +173,57 @@ TEST(modern_bpf, one_buffer_shared_between_all_online_CPUs_with_explicit_CPUs_nu
 	scap_close(h);
 }
 
+TEST(modern_bpf, one_buffer_per_numa_node_with_custom_sizes)
+{
+	char error_buffer[FILENAME_MAX] = {0};
+	int ret = 0;
+
+	struct scap_open_args oargs {};
+	for(int i = 0; i < PPM_SC_MAX; i++)
+	{
+		oargs.ppm_sc_of_interest.ppm_sc[i] = 1;
+	}
+
+	/* The first ring buffer is twice the default one */
+	unsigned long buffers_bytes_dim[] = {8 * 4096};
+	struct scap_modern_bpf_engine_params modern_bpf_params = {
+		.cpus_for_each_buffer = 1,
+		.allocate_online_only = true,
+		.buffer_bytes_dim = 4 * 4096,
+		.buffers_topology = MODERN_BPF_BUFFERS_TOPOLOGY_NUMA,
+		.buffers_bytes_dim = buffers_bytes_dim,
+		.n_buffers_bytes_dim = 1,
+	};
+	oargs.engine_params = &modern_bpf_params;
+	oargs.log_fn = test_open_log_fn;
+
+	scap_t* h = scap_open(&oargs, &scap_modern_bpf_engine, error_buffer, &ret);
+	ASSERT_FALSE(!h || ret != SCAP_SUCCESS) << "unable to open modern bpf engine with a ring buffer per NUMA node: " << error_buffer << std::endl;
+
+	/* We have at least one NUMA node and never more buffers than online CPUs */
+	uint32_t num_rings = scap_get_ndevs(h);
+	ASSERT_GE(num_rings, 1);
+	ASSERT_LE(num_rings, sysconf(_SC_NPROCESSORS_ONLN));
+
+	uint32_t nstats;
+	int32_t rc;
+	const scap_stats_v2* stats_v2 = scap_get_stats_v2(h, PPM_SCAP_STATS_KERNEL_COUNTERS, &nstats, &rc);
+	ASSERT_EQ(rc, SCAP_SUCCESS);
+	bool found = false;
+	for(uint32_t i = 0; i < nstats; i++)
+	{
+		if(strcmp(stats_v2[i].name, "ring_buffers_bytes_dim_max") == 0)
+		{
+			ASSERT_EQ(stats_v2[i].value.u64, 8 * 4096);
+			found = true;
+		}
+	}
+	ASSERT_TRUE(found);
+
+	check_event_is_not_overwritten(h);
+	scap_close(h);
+}
+
 TEST(modern_bpf, read_in_order_one_buffer_per_online_CPU)
 {
 	char error_buffer[FILENAME_MAX] = {0};
@@ -0,0 +1,263 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libscap/scap.h>
+#include <libscap/scap-int.h>
+#include <libscap/ringbuffer/ringbuffer.h>
+
+#include "synthetic_devset.h"
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+
+static uint64_t staged_events(struct scap_device_set* devset)
+{
+	scap_stats_v2 stats[NUMA_CONSUMER_MAX_STATS];
+	uint32_t nstats = numa_consumer_get_stats(devset, stats, NUMA_CONSUMER_MAX_STATS);
+	uint64_t total = 0;
+	for(uint32_t i = 0; i < nstats; i++)
+	{
+		if(strstr(stats[i].name, ".n_evts") != NULL)
+		{
+			total += stats[i].value.u64;
+		}
+	}
+	return total;
+}
+
+TEST(numa_consumer, ordered_merge)
+{
+	char lasterr[SCAP_LASTERR_SIZE];
+	struct scap_device_set devset;
+	const uint32_t ndevs = 4;
+	const uint64_t evts_per_dev = 1000;
+	init_synthetic_devset(&devset, ndevs, lasterr);
+
+	/* Interleave the timestamps across the devices */
+	for(uint64_t i = 0; i < evts_per_dev * ndevs; i++)
+	{
+		ASSERT_TRUE(produce_event(&devset.m_devs[(i * 7) % ndevs], i + 1));
+	}
+
+	ASSERT_EQ(numa_consumer_start(&devset, ringbuffer_stage_device, ringbuffer_flush_device, NUMA_CONSUMER_QUEUE_BYTES_DIM), SCAP_SUCCESS) << lasterr;
+	ASSERT_NE(devset.m_numa_consumer, nullptr);
+
+	/* Wait for the readers to stage everything so that the merge sees all the events */
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while(staged_events(&devset) < evts_per_dev * ndevs && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+
+	scap_stats_v2 stats[NUMA_CONSUMER_MAX_STATS];
+	uint32_t nstats = numa_consumer_get_stats(&devset, stats, NUMA_CONSUMER_MAX_STATS);
+	ASSERT_GE(nstats, NUMA_CONSUMER_STATS_PER_NODE);
+	ASSERT_EQ(nstats % NUMA_CONSUMER_STATS_PER_NODE, 0);
+	ASSERT_NE(strstr(stats[0].name, "numa_consumer.node"), nullptr);
+	ASSERT_EQ(staged_events(&devset), evts_per_dev * ndevs);
+
+	scap_evt* evt = NULL;
+	uint16_t devid = 0;
+	uint32_t flags = 0;
+	for(uint64_t i = 0; i < evts_per_dev * ndevs; i++)
+	{
+		ASSERT_EQ(ringbuffer_next(&devset, &evt, &devid, &flags), SCAP_SUCCESS);
+		ASSERT_EQ(evt->ts, i + 1);
+		ASSERT_EQ(devid, (i * 7) % ndevs);
+	}
+
+	/* The last event is released by the next call */
+	ASSERT_EQ(ringbuffer_next(&devset, &evt, &devid, &flags), SCAP_TIMEOUT);
+	ASSERT_EQ(staged_events(&devset), 0);
+
+	devset_free(&devset);
+	ASSERT_EQ(devset.m_numa_consumer, nullptr);
+}
+
+/* The reader of `s_late_dev` doesn't stage anything until `s_late_dev_ready` is set */
+static std::atomic<scap_device*> s_late_dev{nullptr};
+static std::atomic<bool> s_late_dev_ready{false};
+
+static uint32_t late_stage_device(scap_device* dev, scap_staging_queue* queue)
+{
+	if(dev == s_late_dev.load() && !s_late_dev_ready.load())
+	{
+		return 0;
+	}
+	return ringbuffer_stage_device(dev, queue);
+}
+
+TEST(numa_consumer, late_reader)
+{
+	char lasterr[SCAP_LASTERR_SIZE];
+	struct scap_device_set devset;
+	const uint32_t ndevs = 2;
+	const uint64_t evts_per_dev = 100;
+	init_synthetic_devset(&devset, ndevs, lasterr);
+
+	/* Odd timestamps in the second buffer, even ones in the first */
+	for(uint64_t i = 0; i < evts_per_dev * ndevs; i++)
+	{
+		ASSERT_TRUE(produce_event(&devset.m_devs[(i + 1) % ndevs], i + 1));
+	}
+
+	s_late_dev = &devset.m_devs[1];
+	s_late_dev_ready = false;
+	ASSERT_EQ(numa_consumer_start(&devset, late_stage_device, ringbuffer_flush_device, NUMA_CONSUMER_QUEUE_BYTES_DIM), SCAP_SUCCESS) << lasterr;
+
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while(staged_events(&devset) < evts_per_dev && std::chrono::steady_clock::now() < deadline)
+	{
+		std::this_thread::yield();
+	}
+	ASSERT_EQ(staged_events(&devset), evts_per_dev);
+
+	/* The events of the first buffer are staged but the second buffer could
+	 * hold older ones: nothing can be returned yet.
+	 */
+	scap_evt* evt = NULL;
+	uint16_t devid = 0;
+	uint32_t flags = 0;
+	ASSERT_EQ(ringbuffer_next(&devset, &evt, &devid, &flags), SCAP_TIMEOUT);
+	ASSERT_EQ(ringbuffer_next(&devset, &evt, &devid, &flags), SCAP_TIMEOUT);
+
+	s_late_dev_ready = true;
+	for(uint64_t i = 0; i < evts_per_dev * ndevs;)
+	{
+		int32_t res = ringbuffer_next(&devset, &evt, &devid, &flags);
+		if(res == SCAP_TIMEOUT)
+		{
+			ASSERT_LT(std::chrono::steady_clock::now(), deadline);
+			continue;
+		}
+		ASSERT_EQ(res, SCAP_SUCCESS);
+		ASSERT_EQ(evt->ts, i + 1);
+		i++;
+	}
+
+	devset_free(&devset);
+	s_late_dev = nullptr;
+}
+
+TEST(numa_consumer, flush)
+{
+	char lasterr[SCAP_LASTERR_SIZE];
+	struct scap_device_set devset;
+	const uint32_t ndevs = 2;
+	init_synthetic_devset(&devset, ndevs, lasterr);
+
+	for(uint64_t i = 0; i < 10; i++)
+	{
+		ASSERT_TRUE(produce_event(&devset.m_devs[i % ndevs], i + 1));
+	}
+
+	ASSERT_EQ(numa_consumer_start(&devset, ringbuffer_stage_device, ringbuffer_flush_device, NUMA_CONSUMER_QUEUE_BYTES_DIM), SCAP_SUCCESS) << lasterr;
+
+	scap_evt* evt = NULL;
+	uint16_t devid = 0;
+	uint32_t flags = 0;
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	int32_t res;
+	while((res = ringbuffer_next(&devset, &evt, &devid, &flags)) == SCAP_TIMEOUT && std::chrono::steady_clock::now() < deadline)
+	{
+	}
+	ASSERT_EQ(res, SCAP_SUCCESS);
+	ASSERT_EQ(evt->ts, 1);
+
+	/* Both what is staged and what is still in the buffers is discarded */
+	ASSERT_TRUE(produce_event(&devset.m_devs[0], 11));
+	ASSERT_EQ(numa_consumer_flush(&devset), SCAP_SUCCESS);
+	ASSERT_EQ(ringbuffer_next(&devset, &evt, &devid, &flags), SCAP_TIMEOUT);
+	ASSERT_EQ(staged_events(&devset), 0);
+
+	/* New events are still captured */
+	ASSERT_TRUE(produce_event(&devset.m_devs[1], 12));
+	while((res = ringbuffer_next(&devset, &evt, &devid, &flags)) == SCAP_TIMEOUT && std::chrono::steady_clock::now() < deadline)
+	{
+	}
+	ASSERT_EQ(res, SCAP_SUCCESS);
+	ASSERT_EQ(evt->ts, 12);
+
+	devset_free(&devset);
+}
+
+/* Benchmark, run it with `--gtest_also_run_disabled_tests` */
+TEST(numa_consumer, DISABLED_throughput)
+{
+	char lasterr[SCAP_LASTERR_SIZE];
+	struct scap_device_set devset;
+	const uint32_t ndevs = 8;
+	const uint64_t evts_per_dev = 200000;
+	std::atomic<uint64_t> ts{1};
+	init_synthetic_devset(&devset, ndevs, lasterr);
+
+	ASSERT_EQ(numa_consumer_start(&devset, ringbuffer_stage_device, ringbuffer_flush_device, NUMA_CONSUMER_QUEUE_BYTES_DIM), SCAP_SUCCESS) << lasterr;
+
+	std::vector<std::thread> producers;
+	for(uint32_t j = 0; j < ndevs; j++)
+	{
+		producers.emplace_back([&, j]() {
+			for(uint64_t i = 0; i < evts_per_dev;)
+			{
+				if(produce_event(&devset.m_devs[j], ts.fetch_add(1)))
+				{
+					i++;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<uint64_t> last_ts(ndevs, 0);
+	uint64_t consumed = 0;
+	scap_evt* evt = NULL;
+	uint16_t devid = 0;
+	uint32_t flags = 0;
+	auto start = std::chrono::steady_clock::now();
+	while(consumed < evts_per_dev * ndevs)
+	{
+		int32_t res = ringbuffer_next(&devset, &evt, &devid, &flags);
+		if(res == SCAP_TIMEOUT)
+		{
+			continue;
+		}
+		ASSERT_EQ(res, SCAP_SUCCESS);
+		ASSERT_LT(devid, ndevs);
+		/* Events of the same buffer keep their order */
+		ASSERT_GT(evt->ts, last_ts[devid]);
+		last_ts[devid] = evt->ts;
+		consumed++;
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	for(auto& p : producers)
+	{
+		p.join();
+	}
+
+	printf("[ INFO     ] %" PRIu64 " events from %u buffers in %" PRId64 " us (%.2f Mevt/s)\n",
+	       consumed, ndevs, (int64_t)elapsed, elapsed > 0 ? (double)consumed / elapsed : 0);
+
+	devset_free(&devset);
+}
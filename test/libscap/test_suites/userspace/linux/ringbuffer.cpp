@@ -0,0 +1,126 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libscap/scap.h>
+#include <libscap/scap-int.h>
+#include <libscap/ringbuffer/ringbuffer.h>
+
+#include "synthetic_devset.h"
+
+#include <vector>
+
+TEST(ringbuffer, next_batch_ordered_merge)
+{
+	char lasterr[SCAP_LASTERR_SIZE];
+	struct scap_device_set devset;
+	const uint32_t ndevs = 3;
+	const uint64_t nevts = 100;
+	const uint32_t max_evts = 7;
+	init_synthetic_devset(&devset, ndevs, lasterr);
+
+	/* Interleave the timestamps across the devices */
+	for(uint64_t i = 0; i < nevts; i++)
+	{
+		ASSERT_TRUE(produce_event(&devset.m_devs[(i * 5) % ndevs], i + 1));
+	}
+
+	scap_batch_evt evts[max_evts];
+	uint32_t n = 0;
+	uint64_t next_ts = 1;
+	uint32_t refills = 0;
+	while(next_ts <= nevts)
+	{
+		int32_t res = ringbuffer_next_batch(&devset, evts, max_evts, &n);
+		if(res == SCAP_TIMEOUT)
+		{
+			/* A new block has been read from every buffer */
+			ASSERT_EQ(n, 0);
+			ASSERT_LT(++refills, 2);
+			continue;
+		}
+		ASSERT_EQ(res, SCAP_SUCCESS);
+		ASSERT_GT(n, 0);
+		ASSERT_LE(n, max_evts);
+		for(uint32_t k = 0; k < n; k++)
+		{
+			ASSERT_EQ(evts[k].evt->ts, next_ts);
+			ASSERT_EQ(evts[k].devid, ((next_ts - 1) * 5) % ndevs);
+			next_ts++;
+		}
+
+		/* The whole batch is still valid after the events are read */
+		for(uint32_t k = 0; k < n; k++)
+		{
+			ASSERT_EQ(evts[k].evt->ts, next_ts - n + k);
+		}
+	}
+
+	ASSERT_EQ(ringbuffer_next_batch(&devset, evts, max_evts, &n), SCAP_TIMEOUT);
+	ASSERT_EQ(n, 0);
+
+	devset_free(&devset);
+}
+
+TEST(ringbuffer, next_batch_same_as_next)
+{
+	char lasterr[SCAP_LASTERR_SIZE];
+	struct scap_device_set batch_devset;
+	struct scap_device_set devset;
+	const uint32_t ndevs = 4;
+	const uint64_t nevts = 1000;
+	init_synthetic_devset(&batch_devset, ndevs, lasterr);
+	init_synthetic_devset(&devset, ndevs, lasterr);
+
+	for(uint64_t i = 0; i < nevts; i++)
+	{
+		ASSERT_TRUE(produce_event(&batch_devset.m_devs[(i * i) % ndevs], i + 1));
+		ASSERT_TRUE(produce_event(&devset.m_devs[(i * i) % ndevs], i + 1));
+	}
+
+	std::vector<std::pair<uint64_t, uint16_t>> expected;
+	scap_evt* evt = NULL;
+	uint16_t devid = 0;
+	uint32_t flags = 0;
+	int32_t res = SCAP_TIMEOUT;
+	for(uint32_t refills = 0; refills < 2; refills += res == SCAP_TIMEOUT)
+	{
+		res = ringbuffer_next(&devset, &evt, &devid, &flags);
+		if(res == SCAP_SUCCESS)
+		{
+			expected.emplace_back(evt->ts, devid);
+		}
+	}
+	ASSERT_EQ(expected.size(), nevts);
+
+	std::vector<std::pair<uint64_t, uint16_t>> batched;
+	scap_batch_evt evts[64];
+	uint32_t n = 0;
+	for(uint32_t refills = 0; refills < 2; refills += res == SCAP_TIMEOUT)
+	{
+		res = ringbuffer_next_batch(&batch_devset, evts, 64, &n);
+		for(uint32_t k = 0; k < n; k++)
+		{
+			batched.emplace_back(evts[k].evt->ts, evts[k].devid);
+		}
+	}
+	ASSERT_EQ(batched, expected);
+
+	devset_free(&batch_devset);
+	devset_free(&devset);
+}
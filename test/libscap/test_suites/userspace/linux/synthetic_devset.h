@@ -0,0 +1,81 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <gtest/gtest.h>
+#include <libscap/scap.h>
+#include <libscap/ringbuffer/devset.h>
+#include <driver/ppm_ringbuffer.h>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+/* Synthetic devset: every device is an anonymous mapping laid out like a kmod
+ * ring buffer (the data area is mirrored to emulate the double mapping).
+ */
+#define SYNTH_BUFFER_SIZE (1024 * 1024)
+#define SYNTH_EVT_LEN 64
+
+static inline void init_synthetic_devset(struct scap_device_set* devset, uint32_t ndevs, char* lasterr)
+{
+	ASSERT_EQ(devset_init(devset, ndevs, lasterr), SCAP_SUCCESS);
+	long ncpus = sysconf(_SC_NPROCESSORS_ONLN);
+	for(uint32_t j = 0; j < ndevs; j++)
+	{
+		scap_device* dev = &devset->m_devs[j];
+		dev->m_buffer_size = SYNTH_BUFFER_SIZE;
+		dev->m_mmap_size = 2 * SYNTH_BUFFER_SIZE;
+		dev->m_buffer = (char*)mmap(NULL, dev->m_mmap_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		ASSERT_NE(dev->m_buffer, MAP_FAILED);
+		dev->m_bufinfo_size = sizeof(struct ppm_ring_buffer_info);
+		dev->m_bufinfo = (struct ppm_ring_buffer_info*)mmap(NULL, dev->m_bufinfo_size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+		ASSERT_NE((void*)dev->m_bufinfo, MAP_FAILED);
+		dev->m_cpu = ncpus > 0 ? j % ncpus : -1;
+	}
+}
+
+/* Write an event in the buffer of `dev`, returns false if the buffer is full. */
+static inline bool produce_event(scap_device* dev, uint64_t ts)
+{
+	struct ppm_ring_buffer_info* info = dev->m_bufinfo;
+	uint32_t head = info->head;
+	uint32_t tail = __atomic_load_n(&info->tail, __ATOMIC_ACQUIRE);
+	uint32_t used = head >= tail ? head - tail : dev->m_buffer_size - tail + head;
+	if(dev->m_buffer_size - used <= SYNTH_EVT_LEN)
+	{
+		return false;
+	}
+
+	char evt_buf[SYNTH_EVT_LEN] = {};
+	scap_evt* evt = (scap_evt*)evt_buf;
+	evt->ts = ts;
+	evt->tid = 1;
+	evt->len = SYNTH_EVT_LEN;
+	evt->type = PPME_SYSCALL_GETUID_X;
+	evt->nparams = 0;
+
+	for(uint32_t i = 0; i < SYNTH_EVT_LEN; i++)
+	{
+		uint32_t pos = (head + i) % dev->m_buffer_size;
+		dev->m_buffer[pos] = evt_buf[i];
+		dev->m_buffer[pos + dev->m_buffer_size] = evt_buf[i];
+	}
+	__atomic_store_n(&info->head, (head + SYNTH_EVT_LEN) % dev->m_buffer_size, __ATOMIC_RELEASE);
+	return true;
+}
@@ -245,6 +245,68 @@ extern "C"
 	// MANAGE RINGBUFFERS
 	/////////////////////////////
 
+	/**
+	 * @brief How CPUs are grouped into ring buffers.
+	 */
+	enum pman_buffers_topology
+	{
+		PMAN_BUFFERS_TOPOLOGY_CPUS = 0, ///< a ring buffer every `cpus_for_each_buffer` CPUs.
+		PMAN_BUFFERS_TOPOLOGY_NUMA,	///< a ring buffer for every NUMA node.
+		PMAN_BUFFERS_TOPOLOGY_CACHE,	///< a ring buffer for every group of CPUs sharing the last level cache.
+	};
+
+	/**
+	 * @brief Per-CPU state of a previous capture, used to auto-tune
+	 * the ring buffers of the next one. It is owned by the caller.
+	 */
+	struct pman_buffer_history
+	{
+		uint64_t n_drops_buffer; ///< drops due to a full ring buffer seen by this CPU.
+		unsigned long bytes_dim; ///< dimension of the ring buffer associated with this CPU.
+	};
+
+	/**
+	 * @brief Compute the association between CPUs and ring buffers and
+	 * the dimension of every ring buffer. This must be called after
+	 * `pman_init_state` and before `pman_prepare_ringbuf_array_before_loading`,
+	 * the number of required buffers is updated according to the chosen topology.
+	 *
+	 * @param topology how CPUs are grouped into ring buffers.
+	 * @param buffers_bytes_dim optional array with the dimension of every ring buffer,
+	 * indexed by ring buffer id. Missing or `0` entries fallback to the dimension
+	 * passed to `pman_init_state`. Can be `NULL`. Ring buffers of different
+	 * sizes require kernel 5.10 or newer.
+	 * @param n_buffers_bytes_dim number of entries in `buffers_bytes_dim`.
+	 * @param history optional per-CPU history of the previous capture, filled by
+	 * `pman_save_buffers_drops_history`. Ring buffers that dropped events are doubled
+	 * in size. Can be `NULL`.
+	 * @param history_len number of entries in `history`, it is ignored unless it
+	 * matches the number of possible CPUs.
+	 * @return `0` on success, `errno` in case of error.
+	 */
+	int pman_init_buffers_layout(enum pman_buffers_topology topology, const unsigned long* buffers_bytes_dim,
+				     uint16_t n_buffers_bytes_dim, const struct pman_buffer_history* history,
+				     uint16_t history_len);
+
+	/**
+	 * @brief Store the per-CPU `n_drops_buffer` counters together with the
+	 * current ring buffer dimensions into `history`, so that it can be passed
+	 * to `pman_init_buffers_layout` to auto-tune the next capture.
+	 *
+	 * @param history array with an entry for every possible CPU.
+	 * @param history_len number of entries in `history`.
+	 * @return `0` on success, `errno` in case of error.
+	 */
+	int pman_save_buffers_drops_history(struct pman_buffer_history* history, uint16_t history_len);
+
+	/**
+	 * @brief Return the dimension in bytes of a single ring buffer.
+	 *
+	 * @param buffer_id ring buffer id.
+	 * @return dimension in bytes, `0` if the buffer doesn't exist.
+	 */
+	unsigned long pman_get_buffer_bytes_dim(uint16_t buffer_id);
+
 	/**
 	 * @brief Performs all necessary operations on ringbuf array before the
 	 * loading phase:
@@ -276,6 +338,15 @@ extern "C"
 	 */
 	void pman_consume_first_event(void** event_ptr, int16_t* buffer_id);
 
+	/**
+	 * @brief Return the maximum number of bytes currently used
+	 * in one of the ring buffers, i.e. the distance between the
+	 * producer and the consumer positions of the most loaded buffer.
+	 *
+	 * @return max number of bytes used among all the ring buffers.
+	 */
+	uint64_t pman_get_max_buf_used(void);
+
 	/////////////////////////////
 	// CAPTURE (EXCHANGE VALUES WITH BPF SIDE)
 	/////////////////////////////
@@ -343,6 +414,18 @@ extern "C"
 
 	void pman_set_sampling_ratio(uint32_t value);
 
+	/**
+	 * @brief Set the adaptive sampling ratio of a single syscall.
+	 * Only `1/ratio` of the events generated by this syscall will
+	 * be sent to userspace, regardless of the global dropping mode.
+	 * Syscalls marked as `UF_NEVER_DROP` are never sampled.
+	 *
+	 * @param syscall_id syscall system id.
+	 * @param ratio power of 2 (<= 128), `1` disables the sampling.
+	 * @return `0` on success, `EINVAL` if the syscall cannot be sampled.
+	 */
+	int pman_set_64bit_syscall_sampling_ratio(int syscall_id, uint32_t ratio);
+
 	/**
 	 * @brief Ask driver to drop failed syscalls.
 	 * It only applied to syscall exit events.
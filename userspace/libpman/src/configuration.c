@@ -68,6 +68,9 @@ void pman_clear_state()
 	g_state.prod_pos = NULL;
 	g_state.inner_ringbuf_map_fd = 0;
 	g_state.buffer_bytes_dim = 0;
+	g_state.buffers_topology = 0;
+	g_state.cpu_to_buffer = NULL;
+	g_state.buffers_bytes_dim = NULL;
 	g_state.last_ring_read = -1;
 	g_state.last_event_size = 0;
 	g_state.n_attached_progs = 0;
@@ -90,6 +90,16 @@ void pman_close_probe()
 		free(g_state.prod_pos);
 	}
 
+	if(g_state.cpu_to_buffer)
+	{
+		free(g_state.cpu_to_buffer);
+	}
+
+	if(g_state.buffers_bytes_dim)
+	{
+		free(g_state.buffers_bytes_dim);
+	}
+
 	if(g_state.skel)
 	{
 		bpf_probe__detach(g_state.skel);
@@ -84,6 +84,22 @@ void pman_set_sampling_ratio(uint32_t value)
 	g_state.skel->bss->g_settings.sampling_ratio = value;
 }
 
+int pman_set_64bit_syscall_sampling_ratio(int syscall_id, uint32_t ratio)
+{
+	if(syscall_id < 0 || syscall_id >= SYSCALL_TABLE_SIZE)
+	{
+		return EINVAL;
+	}
+
+	/* `UF_NEVER_DROP` syscalls are fundamental for the userspace state, we never sample them. */
+	if(g_state.skel->bss->g_64bit_sampling_syscall_table[syscall_id] == UF_NEVER_DROP)
+	{
+		return EINVAL;
+	}
+	g_state.skel->bss->g_64bit_adaptive_sampling_ratio_table[syscall_id] = ratio;
+	return 0;
+}
+
 void pman_set_drop_failed(bool drop_failed)
 {
 	g_state.skel->bss->g_settings.drop_failed = drop_failed;
@@ -22,7 +22,9 @@ limitations under the License.
 #include <stdint.h>
 #include <stdbool.h>
 #include <sys/mman.h>
+#include <dirent.h>
 #include <driver/ppm_events_public.h>
+#include <libpman.h>
 
 #include "ringbuffer_definitions.h"
 
@@ -85,8 +87,13 @@ static int allocate_consumer_producer_positions()
 /* Before loading */
 int pman_prepare_ringbuf_array_before_loading()
 {
-	int err;
-	err = ringbuf_array_set_inner_map();
+	int err = 0;
+	/* If the layout was not explicitly configured we keep the `cpus_for_each_buffer` one. */
+	if(g_state.cpu_to_buffer == NULL)
+	{
+		err = pman_init_buffers_layout(PMAN_BUFFERS_TOPOLOGY_CPUS, NULL, 0, NULL, 0);
+	}
+	err = err ?: ringbuf_array_set_inner_map();
 	err = err ?: ringbuf_array_set_max_entries();
 	/* Allocate consumer positions and producer positions for the ringbuffer. */
 	err = err ?: allocate_consumer_producer_positions();
@@ -131,6 +138,241 @@ static bool is_cpu_online(uint16_t cpu_id)
 	return online == 1;
 }
 
+/* Auto-tuned ring buffers cannot grow more than this factor
+ * with respect to the requested dimension.
+ */
+#define AUTO_TUNE_MAX_GROWTH_FACTOR 8
+
+/* Return the NUMA node of the CPU or `0` if NUMA information is not available. */
+static int32_t get_cpu_numa_node(uint16_t cpu_id)
+{
+	char dirname[FILENAME_MAX];
+	int32_t node = 0;
+	snprintf(dirname, sizeof(dirname), "/sys/devices/system/cpu/cpu%d", cpu_id);
+	DIR *dir = opendir(dirname);
+	if(dir == NULL)
+	{
+		return 0;
+	}
+
+	/* Every CPU has a `nodeN` symlink pointing to its NUMA node */
+	struct dirent *entry;
+	while((entry = readdir(dir)) != NULL)
+	{
+		if(sscanf(entry->d_name, "node%d", &node) == 1)
+		{
+			break;
+		}
+	}
+	closedir(dir);
+	return node;
+}
+
+/* Return an id shared by all the CPUs that use the same last level cache, or `0` if
+ * cache information is not available.
+ */
+static int32_t get_cpu_cache_id(uint16_t cpu_id)
+{
+	char filename[FILENAME_MAX];
+	int32_t cache_id = 0;
+
+	/* Try from the highest cache level, usually `index3` is the L3 unified cache */
+	for(int index = 3; index >= 0; index--)
+	{
+		snprintf(filename, sizeof(filename), "/sys/devices/system/cpu/cpu%d/cache/index%d/id", cpu_id, index);
+		FILE *fp = fopen(filename, "r");
+		if(fp == NULL)
+		{
+			continue;
+		}
+
+		int ret = fscanf(fp, "%d", &cache_id);
+		fclose(fp);
+		if(ret == 1)
+		{
+			return cache_id;
+		}
+		cache_id = 0;
+	}
+	return cache_id;
+}
+
+static unsigned long auto_tune_buffer_bytes_dim(const struct pman_buffer_history *history, uint16_t buffer_id, unsigned long bytes_dim)
+{
+	uint64_t n_drops = 0;
+	unsigned long prev_bytes_dim = 0;
+	for(int cpu = 0; cpu < g_state.n_possible_cpus; cpu++)
+	{
+		if(g_state.cpu_to_buffer[cpu] != buffer_id)
+		{
+			continue;
+		}
+		n_drops += history[cpu].n_drops_buffer;
+		if(history[cpu].bytes_dim > prev_bytes_dim)
+		{
+			prev_bytes_dim = history[cpu].bytes_dim;
+		}
+	}
+
+	/* We never shrink a buffer below what we used in the previous capture,
+	 * otherwise we would oscillate between drops and no drops.
+	 */
+	unsigned long new_bytes_dim = prev_bytes_dim > bytes_dim ? prev_bytes_dim : bytes_dim;
+	if(n_drops > 0 && new_bytes_dim < bytes_dim * AUTO_TUNE_MAX_GROWTH_FACTOR)
+	{
+		new_bytes_dim *= 2;
+	}
+	return new_bytes_dim;
+}
+
+int pman_init_buffers_layout(enum pman_buffers_topology topology, const unsigned long *buffers_bytes_dim,
+			     uint16_t n_buffers_bytes_dim, const struct pman_buffer_history *history,
+			     uint16_t history_len)
+{
+	int err = 0;
+
+	g_state.buffers_topology = topology;
+	g_state.cpu_to_buffer = (int16_t *)calloc(g_state.n_possible_cpus, sizeof(int16_t));
+	/* Distinct NUMA nodes or caches ids, the position in the array is the ring buffer id. */
+	int32_t *group_ids = (int32_t *)calloc(g_state.n_possible_cpus, sizeof(int32_t));
+	if(g_state.cpu_to_buffer == NULL || group_ids == NULL)
+	{
+		pman_print_error("failed to alloc memory for the ring buffers layout");
+		err = errno;
+		goto cleanup;
+	}
+
+	uint16_t n_buffers = 0;
+	uint16_t reached = 0;
+	for(int i = 0; i < g_state.n_possible_cpus; i++)
+	{
+		/* If we want to allocate only buffers for online CPUs and the CPU is offline
+		 * it won't have an associated ring buffer.
+		 */
+		if(g_state.allocate_online_only && !is_cpu_online(i))
+		{
+			g_state.cpu_to_buffer[i] = -1;
+			continue;
+		}
+
+		if(topology == PMAN_BUFFERS_TOPOLOGY_CPUS)
+		{
+			g_state.cpu_to_buffer[i] = n_buffers;
+			if(++reached == g_state.cpus_for_each_buffer)
+			{
+				/* we need to switch to the next buffer */
+				reached = 0;
+				n_buffers++;
+			}
+			continue;
+		}
+
+		int32_t group_id = topology == PMAN_BUFFERS_TOPOLOGY_NUMA ? get_cpu_numa_node(i) : get_cpu_cache_id(i);
+		int16_t buffer_id = 0;
+		while(buffer_id < n_buffers && group_ids[buffer_id] != group_id)
+		{
+			buffer_id++;
+		}
+		if(buffer_id == n_buffers)
+		{
+			group_ids[n_buffers++] = group_id;
+		}
+		g_state.cpu_to_buffer[i] = buffer_id;
+	}
+
+	/* The last buffer could be partially filled */
+	if(topology == PMAN_BUFFERS_TOPOLOGY_CPUS && reached != 0)
+	{
+		n_buffers++;
+	}
+
+	if(n_buffers == 0)
+	{
+		pman_print_error("no CPUs available to associate with ring buffers");
+		err = -1;
+		goto cleanup;
+	}
+	g_state.n_required_buffers = n_buffers;
+
+	g_state.buffers_bytes_dim = (unsigned long *)calloc(n_buffers, sizeof(unsigned long));
+	if(g_state.buffers_bytes_dim == NULL)
+	{
+		pman_print_error("failed to alloc memory for the ring buffers dimensions");
+		err = errno;
+		goto cleanup;
+	}
+
+	/* We can use the history only if the CPUs didn't change between the two captures */
+	if(history_len != g_state.n_possible_cpus)
+	{
+		history = NULL;
+	}
+
+	for(uint16_t b = 0; b < n_buffers; b++)
+	{
+		unsigned long bytes_dim = g_state.buffer_bytes_dim;
+		if(buffers_bytes_dim != NULL && b < n_buffers_bytes_dim && buffers_bytes_dim[b] != 0)
+		{
+			bytes_dim = buffers_bytes_dim[b];
+		}
+
+		if(history != NULL)
+		{
+			bytes_dim = auto_tune_buffer_bytes_dim(history, b, bytes_dim);
+		}
+		g_state.buffers_bytes_dim[b] = bytes_dim;
+	}
+
+cleanup:
+	free(group_ids);
+	return err;
+}
+
+int pman_save_buffers_drops_history(struct pman_buffer_history *history, uint16_t history_len)
+{
+	char error_message[MAX_ERROR_MESSAGE_LEN];
+	struct counter_map cnt_map;
+
+	if(g_state.skel == NULL || g_state.cpu_to_buffer == NULL || history == NULL || history_len != g_state.n_possible_cpus)
+	{
+		return EINVAL;
+	}
+
+	int counter_maps_fd = bpf_map__fd(g_state.skel->maps.counter_maps);
+	if(counter_maps_fd <= 0)
+	{
+		pman_print_error("unable to get counter maps");
+		return errno;
+	}
+
+	for(int index = 0; index < g_state.n_possible_cpus; index++)
+	{
+		if(bpf_map_lookup_elem(counter_maps_fd, &index, &cnt_map) < 0)
+		{
+			snprintf(error_message, MAX_ERROR_MESSAGE_LEN, "unable to get the counter map for CPU %d", index);
+			pman_print_error((const char *)error_message);
+			return errno;
+		}
+		history[index].n_drops_buffer = cnt_map.n_drops_buffer;
+		history[index].bytes_dim = 0;
+		if(g_state.cpu_to_buffer[index] >= 0)
+		{
+			history[index].bytes_dim = g_state.buffers_bytes_dim[g_state.cpu_to_buffer[index]];
+		}
+	}
+	return 0;
+}
+
+unsigned long pman_get_buffer_bytes_dim(uint16_t buffer_id)
+{
+	if(g_state.buffers_bytes_dim == NULL || buffer_id >= g_state.n_required_buffers)
+	{
+		return 0;
+	}
+	return g_state.buffers_bytes_dim[buffer_id];
+}
+
+
 /* After loading */
 int pman_finalize_ringbuf_array_after_loading()
 {
@@ -150,7 +392,11 @@ int pman_finalize_ringbuf_array_after_loading()
 	/* Create ring buffer maps. */
 	for(int i = 0; i < g_state.n_required_buffers; i++)
 	{
-		ringbufs_fds[i] = bpf_map_create(BPF_MAP_TYPE_RINGBUF, NULL, 0, 0, g_state.buffer_bytes_dim, NULL);
+		/* Since kernel 5.10 ring buffers inside the array can have different
+		 * sizes, the verifier only checks the inner map type against the dummy
+		 * one. Older kernels require all of them to match `buffer_bytes_dim`.
+		 */
+		ringbufs_fds[i] = bpf_map_create(BPF_MAP_TYPE_RINGBUF, NULL, 0, 0, g_state.buffers_bytes_dim[i], NULL);
 		if(ringbufs_fds[i] <= 0)
 		{
 			snprintf(error_message, MAX_ERROR_MESSAGE_LEN, "failed to create the ringbuf map for CPU '%d'. (If you get memory allocation errors try to reduce the buffer dimension)", i);
@@ -190,41 +436,21 @@ int pman_finalize_ringbuf_array_after_loading()
 	}
 
 	/* We need to associate every CPU to the right ring buffer */
-	int ringbuf_id = 0;
-	int reached = 0;
 	for(int i = 0; i < g_state.n_possible_cpus; i++)
 	{
-		/* If we want to allocate only buffers for online CPUs and the CPU is online, fill its
-		 * ring buffer array entry, otherwise we can go on with the next online CPU
-		 */
-		if(g_state.allocate_online_only && !is_cpu_online(i))
+		/* CPUs without an associated ring buffer are skipped, see `pman_init_buffers_layout` */
+		int ringbuf_id = g_state.cpu_to_buffer[i];
+		if(ringbuf_id < 0)
 		{
 			continue;
 		}
 
-		if(ringbuf_id >= g_state.n_required_buffers)
-		{
-			/* If we arrive here it means that we have too many CPUs for our allocated ring buffers
-			 * so probably we faced a CPU hotplug.
-			 */
-			snprintf(error_message, MAX_ERROR_MESSAGE_LEN, "the actual system configuration requires more than '%d' ring buffers", g_state.n_required_buffers);
-			pman_print_error((const char *)error_message);
-			goto clean_percpu_ring_buffers;
-		}
-
 		if(bpf_map_update_elem(ringubuf_array_fd, &i, &ringbufs_fds[ringbuf_id], BPF_ANY))
 		{
 			snprintf(error_message, MAX_ERROR_MESSAGE_LEN, "failed to add the ringbuf map for CPU '%d' to ringbuf '%d'", i, ringbuf_id);
 			pman_print_error((const char *)error_message);
 			goto clean_percpu_ring_buffers;
 		}
-
-		if(++reached == g_state.cpus_for_each_buffer)
-		{
-			/* we need to switch to the next buffer */
-			reached = 0;
-			ringbuf_id++;
-		}
 	}
 	success = true;
 
@@ -332,3 +558,23 @@ void pman_consume_first_event(void **event_ptr, int16_t *buffer_id)
 {
 	ringbuf__consume_first_event(g_state.rb_manager, (struct ppm_evt_hdr **)event_ptr, buffer_id);
 }
+
+uint64_t pman_get_max_buf_used()
+{
+	uint64_t max = 0;
+	struct ring_buffer *rb = g_state.rb_manager;
+	if(rb == NULL)
+	{
+		return 0;
+	}
+
+	for(uint16_t pos = 0; pos < rb->ring_cnt; pos++)
+	{
+		struct ring *r = rb->rings[pos];
+		unsigned long prod = smp_load_acquire(r->producer_pos);
+		unsigned long cons = smp_load_acquire(r->consumer_pos);
+		uint64_t used = prod - cons;
+		max = used > max ? used : max;
+	}
+	return max;
+}
@@ -48,7 +48,10 @@ struct internal_state
 	unsigned long* cons_pos;	/* every ringbuf has a consumer position. */
 	unsigned long* prod_pos;	/* every ringbuf has a producer position. */
 	int32_t inner_ringbuf_map_fd;	/* inner map used to configure the ringbuf array before loading phase. */
-	unsigned long buffer_bytes_dim; /* dimension of a single per-CPU ringbuffer in bytes. */
+	unsigned long buffer_bytes_dim; /* default dimension of a single per-CPU ringbuffer in bytes. */
+	uint16_t buffers_topology;	/* how CPUs are grouped into ring buffers, see `enum pman_buffers_topology`. */
+	int16_t* cpu_to_buffer;		/* ring buffer associated with every possible CPU, `-1` if the CPU has no buffer. */
+	unsigned long* buffers_bytes_dim; /* dimension in bytes of every ring buffer. */
 	int last_ring_read; /* Last ring from which we have correctly read an event. Could be `-1` if there were no
 			       successful reads. */
 	unsigned long last_event_size; /* Last event correctly read. Could be `0` if there were no successful reads. */
@@ -40,6 +40,10 @@ typedef enum modern_bpf_kernel_counters_stats
 	MODERN_BPF_N_DROPS_BUFFER_PROC_EXIT,
 	MODERN_BPF_N_DROPS_SCRATCH_MAP,
 	MODERN_BPF_N_DROPS,
+	MODERN_BPF_N_RING_BUFFERS,
+	MODERN_BPF_RING_BUFFERS_TOPOLOGY,
+	MODERN_BPF_RING_BUFFERS_BYTES_DIM_TOTAL,
+	MODERN_BPF_RING_BUFFERS_BYTES_DIM_MAX,
 	MODERN_BPF_MAX_KERNEL_COUNTERS_STATS
 } modern_bpf_kernel_counters_stats;
 
@@ -70,6 +74,10 @@ const char *const modern_bpf_kernel_counters_stats_names[] = {
 	[MODERN_BPF_N_DROPS_BUFFER_PROC_EXIT] = "n_drops_buffer_proc_exit",
 	[MODERN_BPF_N_DROPS_SCRATCH_MAP] = "n_drops_scratch_map",
 	[MODERN_BPF_N_DROPS] = "n_drops",
+	[MODERN_BPF_N_RING_BUFFERS] = "n_ring_buffers",
+	[MODERN_BPF_RING_BUFFERS_TOPOLOGY] = "ring_buffers_topology",
+	[MODERN_BPF_RING_BUFFERS_BYTES_DIM_TOTAL] = "ring_buffers_bytes_dim_total",
+	[MODERN_BPF_RING_BUFFERS_BYTES_DIM_MAX] = "ring_buffers_bytes_dim_max",
 };
 
 const char *const modern_bpf_libbpf_stats_names[] = {
@@ -210,6 +218,18 @@ struct scap_stats_v2 *pman_get_scap_stats_v2(uint32_t flags, uint32_t *nstats, i
 			g_state.stats[MODERN_BPF_N_DROPS_SCRATCH_MAP].value.u64 += cnt_map.n_drops_max_event_size;
 			g_state.stats[MODERN_BPF_N_DROPS].value.u64 += (cnt_map.n_drops_buffer + cnt_map.n_drops_max_event_size);
 		}
+
+		/* Ring buffers layout chosen at init time, see `pman_init_buffers_layout` */
+		g_state.stats[MODERN_BPF_N_RING_BUFFERS].value.u64 = g_state.n_required_buffers;
+		g_state.stats[MODERN_BPF_RING_BUFFERS_TOPOLOGY].value.u64 = g_state.buffers_topology;
+		for(uint32_t b = 0; b < g_state.n_required_buffers && g_state.buffers_bytes_dim != NULL; b++)
+		{
+			g_state.stats[MODERN_BPF_RING_BUFFERS_BYTES_DIM_TOTAL].value.u64 += g_state.buffers_bytes_dim[b];
+			if(g_state.buffers_bytes_dim[b] > g_state.stats[MODERN_BPF_RING_BUFFERS_BYTES_DIM_MAX].value.u64)
+			{
+				g_state.stats[MODERN_BPF_RING_BUFFERS_BYTES_DIM_MAX].value.u64 = g_state.buffers_bytes_dim[b];
+			}
+		}
 		offset = MODERN_BPF_MAX_KERNEL_COUNTERS_STATS;
 	}
 
@@ -14,6 +14,7 @@ limitations under the License.
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #define BPF_ENGINE "bpf"
@@ -27,6 +28,7 @@ extern "C"
 	{
 		unsigned long buffer_bytes_dim; ///< Dimension of a single per-CPU buffer in bytes. Please note: this buffer will be mapped twice in the process virtual memory, so pay attention to its size.
 		const char* bpf_probe;	    ///<  The path to the BPF probe object file.
+		bool numa_consumers;	    ///< Drain the buffers with one reader thread for every NUMA node instead of reading them from the capture thread.
 	};
 
 #ifdef __cplusplus
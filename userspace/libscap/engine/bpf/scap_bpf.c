@@ -861,7 +861,7 @@ static int allocate_scap_stats_v2(struct bpf_engine *handle)
 			nprogs_attached++;
 		}
 	}
-	handle->m_nstats = (BPF_MAX_KERNEL_COUNTERS_STATS + (nprogs_attached * BPF_MAX_LIBBPF_STATS));
+	handle->m_nstats = (BPF_MAX_KERNEL_COUNTERS_STATS + NUMA_CONSUMER_MAX_STATS + (nprogs_attached * BPF_MAX_LIBBPF_STATS));
 	handle->m_stats = (scap_stats_v2 *)malloc(handle->m_nstats * sizeof(scap_stats_v2));
 
 	if(!handle->m_stats)
@@ -1627,6 +1627,7 @@ int32_t scap_bpf_load(
 		{
 			return scap_errprintf(handle->m_lasterr, errno, "unable to mmap the perf-buffer for cpu '%d'", cpu_idx);
 		}
+		dev->m_cpu = cpu_idx;
 		online_idx++;
 	}
 
@@ -1763,6 +1764,9 @@ const struct scap_stats_v2* scap_bpf_get_stats_v2(struct scap_engine_handle engi
 				v.n_drops_bug;
 		}
 		offset = BPF_MAX_KERNEL_COUNTERS_STATS;
+
+		/* Depth of the staging queues of the NUMA reader threads, if any */
+		offset += numa_consumer_get_stats(&handle->m_dev_set, &stats[offset], NUMA_CONSUMER_MAX_STATS);
 	}
 
 	/* LIBBPF STATS */
@@ -1870,6 +1874,11 @@ static int32_t next(struct scap_engine_handle engine, OUT scap_evt **pevent, OUT
 	return ringbuffer_next(&engine.m_handle->m_dev_set, pevent, pdevid, pflags);
 }
 
+static int32_t next_batch(struct scap_engine_handle engine, OUT scap_batch_evt* evts, uint32_t max_evts, OUT uint32_t* nevts)
+{
+	return ringbuffer_next_batch(&engine.m_handle->m_dev_set, evts, max_evts, nevts);
+}
+
 static int32_t unsupported_config(struct scap_engine_handle engine, const char* msg)
 {
 	struct bpf_engine* handle = engine.m_handle;
@@ -2013,6 +2022,11 @@ static int32_t init(scap_t* handle, scap_open_args *oargs)
 		engine.m_handle->m_flags |= ENGINE_FLAG_BPF_STATS_ENABLED;
 	}
 
+	if(params->numa_consumers)
+	{
+		return numa_consumer_start(&engine.m_handle->m_dev_set, ringbuffer_stage_device, ringbuffer_flush_device, NUMA_CONSUMER_QUEUE_BYTES_DIM);
+	}
+
 	return SCAP_SUCCESS;
 }
 
@@ -2061,6 +2075,7 @@ const struct scap_vtable scap_bpf_engine = {
 	.free_handle = free_handle,
 	.close = scap_bpf_close,
 	.next = next,
+	.next_batch = next_batch,
 	.start_capture = scap_bpf_start_capture,
 	.stop_capture = scap_bpf_stop_capture,
 	.configure = configure,
@@ -14,6 +14,7 @@ limitations under the License.
 
 #pragma once
 
+#include <stdbool.h>
 #include <stdint.h>
 
 #define KMOD_ENGINE "kmod"
@@ -27,6 +28,7 @@ extern "C"
 	struct scap_kmod_engine_params
 	{
 		unsigned long buffer_bytes_dim; ///< Dimension of a single per-CPU buffer in bytes. Please note: this buffer will be mapped twice in the process virtual memory, so pay attention to its size.
+		bool numa_consumers; ///< Drain the buffers with one reader thread for every NUMA node instead of reading them from the capture thread.
 	};
 
 	extern const struct scap_linux_vtable scap_kmod_linux_vtable;
@@ -490,6 +490,7 @@ int32_t scap_kmod_init(scap_t *handle, scap_open_args *oargs)
 			return scap_errprintf(handle->m_lasterr, err, "error mapping the ring buffer info for device %s. (If you get memory allocation errors try to reduce the buffer dimension)", filename);
 		}
 		dev->m_bufinfo_size = sizeof(struct ppm_ring_buffer_info);
+		dev->m_cpu = cpu_idx;
 
 		++online_idx;
 	}
@@ -514,6 +515,11 @@ int32_t scap_kmod_init(scap_t *handle, scap_open_args *oargs)
 	/* Store interesting sc codes */
 	memcpy(&engine.m_handle->curr_sc_set, &oargs->ppm_sc_of_interest, sizeof(interesting_ppm_sc_set));
 
+	if(params->numa_consumers)
+	{
+		return numa_consumer_start(devset, ringbuffer_stage_device, ringbuffer_flush_device, NUMA_CONSUMER_QUEUE_BYTES_DIM);
+	}
+
 	return SCAP_SUCCESS;
 }
 
@@ -532,6 +538,11 @@ int32_t scap_kmod_next(struct scap_engine_handle engine, OUT scap_evt **pevent,
 	return ringbuffer_next(&engine.m_handle->m_dev_set, pevent, pdevid, pflags);
 }
 
+int32_t scap_kmod_next_batch(struct scap_engine_handle engine, OUT scap_batch_evt* evts, uint32_t max_evts, OUT uint32_t* nevts)
+{
+	return ringbuffer_next_batch(&engine.m_handle->m_dev_set, evts, max_evts, nevts);
+}
+
 uint32_t scap_kmod_get_n_devs(struct scap_engine_handle engine)
 {
 	return engine.m_handle->m_dev_set.m_ndevs;
@@ -628,6 +639,9 @@ const struct scap_stats_v2* scap_kmod_get_stats_v2(struct scap_engine_handle eng
 			stats[KMOD_N_PREEMPTIONS].value.u64 += dev->m_bufinfo->n_preemptions;
 		}
 		*nstats = KMOD_MAX_KERNEL_COUNTERS_STATS;
+
+		/* Depth of the staging queues of the NUMA reader threads, if any */
+		*nstats += numa_consumer_get_stats(devset, &stats[*nstats], NUMA_CONSUMER_MAX_STATS);
 	}
 
 	*rc = SCAP_SUCCESS;
@@ -725,8 +739,14 @@ int32_t scap_kmod_set_snaplen(struct scap_engine_handle engine, uint32_t snaplen
 	uint32_t j;
 
 	//
-	// Force a flush of the read buffers, so we don't capture events with the old snaplen
+	// Force a flush of the read buffers, so we don't capture events with the old snaplen.
+	// When the NUMA reader threads own the buffers they flush them for us.
 	//
+	if(devset->m_numa_consumer != NULL)
+	{
+		return numa_consumer_flush(devset);
+	}
+
 	for(j = 0; j < devset->m_ndevs; j++)
 	{
 		ringbuffer_readbuf(&devset->m_devs[j],
@@ -790,8 +810,14 @@ int32_t scap_kmod_set_fullcapture_port_range(struct scap_engine_handle engine, u
 	uint32_t j;
 
 	//
-	// Force a flush of the read buffers, so we don't capture events with the old snaplen
+	// Force a flush of the read buffers, so we don't capture events with the old snaplen.
+	// When the NUMA reader threads own the buffers they flush them for us.
 	//
+	if(devset->m_numa_consumer != NULL)
+	{
+		return numa_consumer_flush(devset);
+	}
+
 	for(j = 0; j < devset->m_ndevs; j++)
 	{
 		ringbuffer_readbuf(&devset->m_devs[j],
@@ -822,6 +848,11 @@ int32_t scap_kmod_set_statsd_port(struct scap_engine_handle engine, const uint16
 	// Force a flush of the read buffers, so we don't
 	// capture events with the old snaplen
 	//
+	if(devset->m_numa_consumer != NULL)
+	{
+		return numa_consumer_flush(devset);
+	}
+
 	for(j = 0; j < devset->m_ndevs; j++)
 	{
 		ringbuffer_readbuf(&devset->m_devs[j],
@@ -975,6 +1006,7 @@ struct scap_vtable scap_kmod_engine = {
 	.free_handle = free_handle,
 	.close = scap_kmod_close,
 	.next = scap_kmod_next,
+	.next_batch = scap_kmod_next_batch,
 	.start_capture = scap_kmod_start_capture,
 	.stop_capture = scap_kmod_stop_capture,
 	.configure = configure,
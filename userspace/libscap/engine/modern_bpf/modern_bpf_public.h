@@ -24,11 +24,31 @@ extern "C"
 {
 #endif
 
+	/* How CPUs are grouped into ring buffers. */
+	enum modern_bpf_buffers_topology
+	{
+		MODERN_BPF_BUFFERS_TOPOLOGY_CPUS = 0, ///< A ring buffer every `cpus_for_each_buffer` CPUs.
+		MODERN_BPF_BUFFERS_TOPOLOGY_NUMA,     ///< A ring buffer for every NUMA node.
+		MODERN_BPF_BUFFERS_TOPOLOGY_CACHE,    ///< A ring buffer for every group of CPUs sharing the last level cache.
+	};
+
+	/* Per-CPU state of a previous capture, used to auto-tune the ring buffers of the next one. */
+	struct scap_modern_bpf_buffer_history
+	{
+		uint64_t n_drops_buffer; ///< Drops due to a full ring buffer seen by this CPU.
+		unsigned long bytes_dim; ///< Dimension of the ring buffer associated with this CPU.
+	};
+
 	struct scap_modern_bpf_engine_params
 	{
 		uint16_t cpus_for_each_buffer;	///< [EXPERIMENTAL] We will allocate a ring buffer every `cpus_for_each_buffer` CPUs. `0` is a special value and means a single ring buffer shared between all the CPUs.
 		bool allocate_online_only; ///< [EXPERIMENTAL] Allocate ring buffers only for online CPUs. The number of ring buffers allocated changes according to the `cpus_for_each_buffer` param. Please note: this buffer will be mapped twice both kernel and userspace-side, so pay attention to its size.
 		unsigned long buffer_bytes_dim; ///< Dimension of a ring buffer in bytes. The number of ring buffers allocated changes according to the `cpus_for_each_buffer` param. Please note: this buffer will be mapped twice both kernel and userspace-side, so pay attention to its size.
+		uint16_t buffers_topology; ///< [EXPERIMENTAL] One of `modern_bpf_buffers_topology`. With `MODERN_BPF_BUFFERS_TOPOLOGY_CPUS` (the default) the layout is driven by `cpus_for_each_buffer`, otherwise `cpus_for_each_buffer` is ignored.
+		const unsigned long* buffers_bytes_dim; ///< [EXPERIMENTAL] Optional dimension of every ring buffer in bytes, indexed by ring buffer id. `NULL` or `0` entries fallback to `buffer_bytes_dim`.
+		uint16_t n_buffers_bytes_dim; ///< [EXPERIMENTAL] Number of entries in `buffers_bytes_dim`.
+		struct scap_modern_bpf_buffer_history* buffers_history; ///< [EXPERIMENTAL] Optional history owned by the caller, with an entry for every possible CPU. Ring buffers that dropped events during the capture recorded here are doubled in size, and the history is updated when the engine is closed. `NULL` disables the auto-tuning.
+		uint16_t n_buffers_history; ///< [EXPERIMENTAL] Number of entries in `buffers_history`.
 	};
 
 #ifdef __cplusplus
@@ -95,6 +95,25 @@ static int32_t scap_modern_bpf_handle_sc(struct scap_engine_handle engine, uint3
 	return SCAP_SUCCESS;
 }
 
+static int32_t scap_modern_bpf_handle_sc_sampling_ratio(struct scap_engine_handle engine, uint32_t sc, uint32_t sampling_ratio)
+{
+	struct modern_bpf_engine* handle = engine.m_handle;
+	int syscall_id = scap_ppm_sc_to_native_id(sc);
+	/* if `syscall_id` is -1 this is not a syscall */
+	if(syscall_id == -1)
+	{
+		snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "%s(%u) is not a syscall", __FUNCTION__, sc);
+		return SCAP_FAILURE;
+	}
+
+	if(pman_set_64bit_syscall_sampling_ratio(syscall_id, sampling_ratio))
+	{
+		snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "%s(%u) the syscall cannot be sampled", __FUNCTION__, sc);
+		return SCAP_FAILURE;
+	}
+	return SCAP_SUCCESS;
+}
+
 static int32_t scap_modern_bpf__configure(struct scap_engine_handle engine, enum scap_setting setting, unsigned long arg1, unsigned long arg2)
 {
 	switch(setting)
@@ -125,6 +144,8 @@ static int32_t scap_modern_bpf__configure(struct scap_engine_handle engine, enum
 	case SCAP_STATSD_PORT:
 		pman_set_statsd_port(arg1);
 		break;
+	case SCAP_SC_SAMPLING_RATIO:
+		return scap_modern_bpf_handle_sc_sampling_ratio(engine, arg1, arg2);
 	default:
 	{
 		char msg[SCAP_LASTERR_SIZE];
@@ -181,6 +202,14 @@ int32_t scap_modern_bpf__init(scap_t* handle, scap_open_args* oargs)
 		return ENOTSUP;
 	}
 
+	for(uint16_t i = 0; params->buffers_bytes_dim != NULL && i < params->n_buffers_bytes_dim; i++)
+	{
+		if(params->buffers_bytes_dim[i] != 0 && check_buffer_bytes_dim(handle->m_lasterr, params->buffers_bytes_dim[i]) != SCAP_SUCCESS)
+		{
+			return ENOTSUP;
+		}
+	}
+
 	if(!pman_check_support())
 	{
 		return ENOTSUP;
@@ -196,6 +225,49 @@ int32_t scap_modern_bpf__init(scap_t* handle, scap_open_args* oargs)
 		return SCAP_FAILURE;
 	}
 
+	enum pman_buffers_topology topology;
+	switch(params->buffers_topology)
+	{
+	case MODERN_BPF_BUFFERS_TOPOLOGY_CPUS:
+		topology = PMAN_BUFFERS_TOPOLOGY_CPUS;
+		break;
+	case MODERN_BPF_BUFFERS_TOPOLOGY_NUMA:
+		topology = PMAN_BUFFERS_TOPOLOGY_NUMA;
+		break;
+	case MODERN_BPF_BUFFERS_TOPOLOGY_CACHE:
+		topology = PMAN_BUFFERS_TOPOLOGY_CACHE;
+		break;
+	default:
+		snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "unknown ring buffers topology (%d).", params->buffers_topology);
+		return SCAP_FAILURE;
+	}
+
+	struct pman_buffer_history* history = NULL;
+	if(params->buffers_history != NULL && params->n_buffers_history > 0)
+	{
+		history = (struct pman_buffer_history*)calloc(params->n_buffers_history, sizeof(struct pman_buffer_history));
+		if(history == NULL)
+		{
+			snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "unable to allocate the ring buffers history.");
+			return SCAP_FAILURE;
+		}
+		for(uint16_t i = 0; i < params->n_buffers_history; i++)
+		{
+			history[i].n_drops_buffer = params->buffers_history[i].n_drops_buffer;
+			history[i].bytes_dim = params->buffers_history[i].bytes_dim;
+		}
+	}
+
+	ret = pman_init_buffers_layout(topology, params->buffers_bytes_dim, params->n_buffers_bytes_dim, history, params->n_buffers_history);
+	free(history);
+	if(ret != 0)
+	{
+		snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "unable to configure the ring buffers layout.");
+		return SCAP_FAILURE;
+	}
+	engine.m_handle->m_buffers_history = params->buffers_history;
+	engine.m_handle->m_n_buffers_history = params->n_buffers_history;
+
 	/* Set an initial sleep time in case of timeouts. */
 	engine.m_handle->m_retry_us = BUFFER_EMPTY_WAIT_TIME_US_START;
 
@@ -241,10 +313,30 @@ static uint64_t scap_modern_bpf__get_flags(struct scap_engine_handle engine)
 
 int32_t scap_modern_bpf__close(struct scap_engine_handle engine)
 {
+	struct modern_bpf_engine* handle = engine.m_handle;
+	if(handle->m_buffers_history != NULL && handle->m_n_buffers_history > 0)
+	{
+		/* Not fatal, at worst the next capture is not auto-tuned */
+		struct pman_buffer_history* history = (struct pman_buffer_history*)calloc(handle->m_n_buffers_history, sizeof(struct pman_buffer_history));
+		if(history != NULL && pman_save_buffers_drops_history(history, handle->m_n_buffers_history) == 0)
+		{
+			for(uint16_t i = 0; i < handle->m_n_buffers_history; i++)
+			{
+				handle->m_buffers_history[i].n_drops_buffer = history[i].n_drops_buffer;
+				handle->m_buffers_history[i].bytes_dim = history[i].bytes_dim;
+			}
+		}
+		free(history);
+	}
 	pman_close_probe();
 	return SCAP_SUCCESS;
 }
 
+static uint64_t scap_modern_bpf__get_max_buf_used(struct scap_engine_handle engine)
+{
+	return pman_get_max_buf_used();
+}
+
 static uint32_t scap_modern_bpf__get_n_devs(struct scap_engine_handle engine)
 {
 	return pman_get_required_buffers();
@@ -306,7 +398,7 @@ struct scap_vtable scap_modern_bpf_engine = {
 	.get_stats_v2 = scap_modern_bpf__get_stats_v2,
 	.get_n_tracepoint_hit = scap_modern_bpf__get_n_tracepoint_hit,
 	.get_n_devs = scap_modern_bpf__get_n_devs,
-	.get_max_buf_used = noop_get_max_buf_used,
+	.get_max_buf_used = scap_modern_bpf__get_max_buf_used,
 	.get_api_version = scap_modern_bpf__get_api_version,
 	.get_schema_version = scap_modern_bpf__get_schema_version,
 };
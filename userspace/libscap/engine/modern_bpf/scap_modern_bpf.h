@@ -35,4 +35,6 @@ struct modern_bpf_engine
 	uint64_t m_schema_version;
 	bool capturing;
 	uint64_t m_flags;
+	struct scap_modern_bpf_buffer_history* m_buffers_history; /* Caller owned, updated on close to auto-tune the next capture */
+	uint16_t m_n_buffers_history;
 };
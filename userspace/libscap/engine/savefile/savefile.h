@@ -25,6 +25,7 @@ limitations under the License.
 #include <libscap/scap_savefile.h>
 
 #define READER_BUF_SIZE (1 << 16) // UINT16_MAX + 1, ie: 65536
+#define SAVEFILE_BATCH_BUF_SIZE (16 * READER_BUF_SIZE)
 
 #define CHECK_READ_SIZE_ERR(read_size, expected_size, error) if(read_size != expected_size) \
 	{\
@@ -105,6 +106,7 @@ struct savefile_engine
 	bool m_use_last_block_header;
 	char* m_reader_evt_buf;
 	size_t m_reader_evt_buf_size;
+	char* m_batch_buf; // holds the events returned by a single next_batch()
 	uint32_t m_last_evt_dump_flags;
 	struct scap_platform* m_platform;
 };
@@ -1839,11 +1839,13 @@ static int32_t scap_read_init(struct savefile_engine *handle, scap_reader_t* r,
 }
 
 //
-// Read an event from disk
+// Read an event from disk into `buf`. The reader buffer is enlarged for large
+// events, any other buffer is not: if the event doesn't fit, its block is left
+// for the next read and SCAP_TIMEOUT is returned.
 //
-static int32_t next(struct scap_engine_handle engine, scap_evt **pevent, uint16_t *pdevid, uint32_t *pflags)
+static int32_t read_event(struct savefile_engine* handle, char* buf, size_t buf_size, OUT uint32_t* plen,
+			  scap_evt **pevent, uint16_t *pdevid, uint32_t *pflags)
 {
-	struct savefile_engine* handle = engine.m_handle;
 	block_header bh;
 	size_t readsize;
 	uint32_t readlen;
@@ -1930,7 +1932,11 @@ static int32_t next(struct scap_engine_handle engine, scap_evt **pevent, uint16_
 					 READER_BUF_SIZE);
 				return SCAP_FAILURE;
 			}
-		} else if (readlen > handle->m_reader_evt_buf_size) {
+		} else if (readlen > buf_size) {
+			if(buf != handle->m_reader_evt_buf) {
+				handle->m_use_last_block_header = true;
+				return SCAP_TIMEOUT;
+			}
 			// Try to allocate a buffer large enough
 			char *tmp = realloc(handle->m_reader_evt_buf, readlen);
 			if (!tmp) {
@@ -1943,25 +1949,26 @@ static int32_t next(struct scap_engine_handle engine, scap_evt **pevent, uint16_
 			}
 			handle->m_reader_evt_buf = tmp;
 			handle->m_reader_evt_buf_size = readlen;
+			buf = tmp;
 		}
 
-		readsize = r->read(r, handle->m_reader_evt_buf, readlen);
+		readsize = r->read(r, buf, readlen);
 		CHECK_READ_SIZE(readsize, readlen);
 
 		//
 		// EVF_BLOCK_TYPE has 32 bits of flags
 		//
-		*pdevid = *(uint16_t *)handle->m_reader_evt_buf;
+		*pdevid = *(uint16_t *)buf;
 
 		if(bh.block_type == EVF_BLOCK_TYPE || bh.block_type == EVF_BLOCK_TYPE_V2 || bh.block_type == EVF_BLOCK_TYPE_V2_LARGE)
 		{
-			memcpy(pflags, handle->m_reader_evt_buf + sizeof(uint16_t), sizeof(uint32_t));
-			*pevent = (struct ppm_evt_hdr *)(handle->m_reader_evt_buf + sizeof(uint16_t) + sizeof(uint32_t));
+			memcpy(pflags, buf + sizeof(uint16_t), sizeof(uint32_t));
+			*pevent = (struct ppm_evt_hdr *)(buf + sizeof(uint16_t) + sizeof(uint32_t));
 		}
 		else
 		{
 			*pflags = 0;
-			*pevent = (struct ppm_evt_hdr *)(handle->m_reader_evt_buf + sizeof(uint16_t));
+			*pevent = (struct ppm_evt_hdr *)(buf + sizeof(uint16_t));
 		}
 
 		if((*pevent)->type >= PPM_EVENT_MAX)
@@ -1992,7 +1999,7 @@ static int32_t next(struct scap_engine_handle engine, scap_evt **pevent, uint16_
 
 			memmove((char *)*pevent + sizeof(struct ppm_evt_hdr),
 				(char *)*pevent + sizeof(struct ppm_evt_hdr) - sizeof(uint32_t),
-				readlen - ((char *)*pevent - handle->m_reader_evt_buf) - (sizeof(struct ppm_evt_hdr) - sizeof(uint32_t)));
+				readlen - ((char *)*pevent - buf) - (sizeof(struct ppm_evt_hdr) - sizeof(uint32_t)));
 			(*pevent)->len += sizeof(uint32_t);
 
 			// In old captures, the length of PPME_NOTIFICATION_E and PPME_INFRASTRUCTURE_EVENT_E
@@ -2043,12 +2050,81 @@ static int32_t next(struct scap_engine_handle engine, scap_evt **pevent, uint16_
 			(*pevent)->nparams = nparams;
 		}
 
+		*plen = readlen;
 		break;
 	}
 
 	return SCAP_SUCCESS;
 }
 
+static int32_t next(struct scap_engine_handle engine, scap_evt **pevent, uint16_t *pdevid, uint32_t *pflags)
+{
+	struct savefile_engine* handle = engine.m_handle;
+	uint32_t len;
+
+	return read_event(handle, handle->m_reader_evt_buf, handle->m_reader_evt_buf_size, &len, pevent, pdevid, pflags);
+}
+
+//
+// Read consecutive events in the batch buffer, so that all of them stay valid
+// until the next call. We stop when the space left could not fit any non-large event.
+//
+static int32_t next_batch(struct scap_engine_handle engine, scap_batch_evt* evts, uint32_t max_evts, uint32_t* nevts)
+{
+	struct savefile_engine* handle = engine.m_handle;
+	int32_t res = SCAP_SUCCESS;
+	size_t offset = 0;
+	uint32_t len;
+	uint32_t n = 0;
+
+	*nevts = 0;
+
+	if(handle->m_batch_buf == NULL)
+	{
+		handle->m_batch_buf = (char*)malloc(SAVEFILE_BATCH_BUF_SIZE);
+		if(handle->m_batch_buf == NULL)
+		{
+			snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "error allocating the batch read buffer");
+			return SCAP_FAILURE;
+		}
+	}
+
+	while(n < max_evts && SAVEFILE_BATCH_BUF_SIZE - offset >= READER_BUF_SIZE)
+	{
+		res = read_event(handle, handle->m_batch_buf + offset, SAVEFILE_BATCH_BUF_SIZE - offset, &len,
+				 &evts[n].evt, &evts[n].devid, &evts[n].flags);
+		if(res != SCAP_SUCCESS)
+		{
+			break;
+		}
+		offset += (len + 7) & ~(size_t)7;
+		n++;
+	}
+
+	if(res == SCAP_TIMEOUT && n == 0)
+	{
+		/* A large event that doesn't fit the batch buffer, serve it alone */
+		res = next(engine, &evts[0].evt, &evts[0].devid, &evts[0].flags);
+		n = res == SCAP_SUCCESS ? 1 : 0;
+	}
+
+	/* The read position is unknown after a failure, while the other results
+	 * (EOF, unexpected block, event too large) will be returned again by the next call.
+	 */
+	if(res == SCAP_FAILURE)
+	{
+		return SCAP_FAILURE;
+	}
+
+	if(n == 0)
+	{
+		return res;
+	}
+
+	*nevts = n;
+	return SCAP_SUCCESS;
+}
+
 uint64_t scap_savefile_ftell(struct scap_engine_handle engine)
 {
 	scap_reader_t* reader = engine.m_handle->m_reader;
@@ -2239,6 +2315,12 @@ static int32_t scap_savefile_close(struct scap_engine_handle engine)
 		handle->m_reader_evt_buf = NULL;
 	}
 
+	if(handle->m_batch_buf)
+	{
+		free(handle->m_batch_buf);
+		handle->m_batch_buf = NULL;
+	}
+
 	return SCAP_SUCCESS;
 }
 
@@ -2288,6 +2370,7 @@ struct scap_vtable scap_savefile_engine = {
 	.free_handle = free_handle,
 	.close = scap_savefile_close,
 	.next = next,
+	.next_batch = next_batch,
 	.start_capture = noop_start_capture,
 	.stop_capture = noop_stop_capture,
 	.configure = noop_configure,
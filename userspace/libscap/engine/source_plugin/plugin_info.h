@@ -35,4 +35,5 @@ typedef struct
 	void (*close)(ss_plugin_t* s, ss_instance_t* h);
 	ss_plugin_rc (*next_batch)(ss_plugin_t* s, ss_instance_t* h, uint32_t *nevts, ss_plugin_event ***evts);
 	const char *(*get_last_error)(ss_plugin_t *s);
+	uint32_t (*get_max_concurrent_instances)(ss_plugin_t *s); // optional, can be NULL
 } scap_source_plugin;
@@ -31,6 +31,10 @@ limitations under the License.
 #include <libscap/strl.h>
 #include <libscap/scap_gettimeofday.h>
 
+#ifdef SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+#include <unistd.h>
+#endif
+
 static const char * const source_plugin_counters_stats_names[] = {
 	[N_EVTS] = "n_evts",
 };
@@ -111,6 +115,372 @@ static struct source_plugin_engine* alloc_handle(scap_t* main_handle, char* last
 	return engine;
 }
 
+static void free_handle(struct scap_engine_handle engine)
+{
+	struct source_plugin_engine *handle = engine.m_handle;
+	free(handle->m_stats);
+	free(handle);
+}
+
+// Checks the consistency of an event produced by the plugin and fixes
+// the fields that the plugin is allowed to leave unset.
+static int32_t check_event(struct source_plugin_engine *handle, scap_evt* evt)
+{
+	char *lasterr = handle->m_lasterr;
+
+	// Sanity checks in case a plugin implements a non-syscall event source.
+	// If a plugin has event sourcing capability and has a specific ID, then
+	// it is allowed to produce only plugin events of its own event source.
+	uint32_t* pplugin_id = (uint32_t*)((uint8_t*) evt + sizeof(scap_evt) + 4 + 4);
+	uint32_t plugin_id;
+	memcpy(&plugin_id, pplugin_id, sizeof(plugin_id));
+
+	if (handle->m_input_plugin->id != 0)
+	{
+		/*
+		* | scap_evt | len_id (4B) | len_pl (4B) | id | payload |
+		* Note: we need to use 4B for len_id too because the
+		* PPME_PLUGINEVENT_E has EF_LARGE_PAYLOAD flag!
+		*/
+		if (evt->type != PPME_PLUGINEVENT_E || evt->nparams != 2)
+		{
+			snprintf(lasterr, SCAP_LASTERR_SIZE, "malformed plugin event produced by plugin: '%s'", handle->m_input_plugin->name);
+			return SCAP_FAILURE;
+		}
+
+		// forcely setting plugin ID with the one of the open plugin
+		if (plugin_id == 0)
+		{
+			plugin_id = handle->m_input_plugin->id;
+			memcpy(pplugin_id, &plugin_id, sizeof(plugin_id));
+		}
+		else if (plugin_id != handle->m_input_plugin->id)
+		{
+			snprintf(lasterr, SCAP_LASTERR_SIZE, "unexpected plugin ID in plugin event: plugin='%s', expected_id=%d, actual_id=%d", handle->m_input_plugin->name, handle->m_input_plugin->id, plugin_id);
+			return SCAP_FAILURE;
+		}
+	}
+
+	if (evt->type == PPME_PLUGINEVENT_E)
+	{
+		// a zero plugin ID is not allowed for PPME_PLUGINEVENT_E
+		if (plugin_id == 0)
+		{
+			snprintf(lasterr, SCAP_LASTERR_SIZE, "malformed plugin event produced by plugin (no ID): '%s'", handle->m_input_plugin->name);
+			return SCAP_FAILURE;
+		}
+
+		// plugin events have no thread associated
+		evt->tid = (uint64_t) -1;
+	}
+
+	// automatically set timestamp if none was specified
+	if(evt->ts == UINT64_MAX)
+	{
+		evt->ts = get_timestamp_ns();
+	}
+
+	return SCAP_SUCCESS;
+}
+
+#ifdef SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+static void* instance_worker(void* arg)
+{
+	struct source_plugin_instance* inst = (struct source_plugin_instance*)arg;
+	struct source_plugin_engine* handle = inst->m_engine;
+	scap_source_plugin* plugin = handle->m_input_plugin;
+	uint64_t wait_time_us = SOURCE_PLUGIN_WAIT_TIME_US_START;
+	int32_t res = SCAP_SUCCESS;
+
+	while(!__atomic_load_n(&handle->m_stop, __ATOMIC_ACQUIRE))
+	{
+		uint32_t nevts = 0;
+		ss_plugin_event** evts = NULL;
+		res = plugin_rc_to_scap_rc(plugin->next_batch(plugin->state, inst->m_handle, &nevts, &evts));
+		__atomic_store_n(&inst->m_idle, res == SCAP_TIMEOUT && nevts == 0, __ATOMIC_RELEASE);
+
+		// The events are valid only until the next call to next_batch, so they
+		// are copied in the queue. We stop reading the plugin while it's full.
+		for(uint32_t i = 0; i < nevts; i++)
+		{
+			scap_evt* evt = (scap_evt*)evts[i];
+
+			// the timestamp is needed now for the merge
+			if(evt->ts == UINT64_MAX)
+			{
+				evt->ts = get_timestamp_ns();
+			}
+
+			if(sizeof(struct staging_record) + evt->len > inst->m_queue.m_size)
+			{
+				snprintf(inst->m_lasterr, SCAP_LASTERR_SIZE, "event of %u bytes produced by plugin '%s' does not fit in the instance queue", evt->len, plugin->name);
+				res = SCAP_FAILURE;
+				break;
+			}
+
+			while(!staging_queue_push(&inst->m_queue, evt))
+			{
+				if(__atomic_load_n(&handle->m_stop, __ATOMIC_ACQUIRE))
+				{
+					return NULL;
+				}
+				__atomic_store_n(&inst->m_n_queue_full, inst->m_n_queue_full + 1, __ATOMIC_RELAXED);
+				usleep(wait_time_us);
+				wait_time_us = MIN(wait_time_us * 2, SOURCE_PLUGIN_WAIT_TIME_US_MAX);
+			}
+			wait_time_us = SOURCE_PLUGIN_WAIT_TIME_US_START;
+		}
+
+		if(res == SCAP_SUCCESS && nevts == 0)
+		{
+			snprintf(inst->m_lasterr, SCAP_LASTERR_SIZE, "unexpected 0 size event returned by plugin %s", plugin->name);
+			res = SCAP_FAILURE;
+		}
+
+		if(res == SCAP_TIMEOUT)
+		{
+			if(nevts == 0)
+			{
+				usleep(wait_time_us);
+				wait_time_us = MIN(wait_time_us * 2, SOURCE_PLUGIN_WAIT_TIME_US_MAX);
+			}
+			continue;
+		}
+
+		if(res != SCAP_SUCCESS)
+		{
+			break;
+		}
+	}
+
+	// get_last_error() is not called here, the other workers could be
+	// calling next_batch at the same time
+	inst->m_res = res;
+	__atomic_store_n(&inst->m_done, true, __ATOMIC_RELEASE);
+	return NULL;
+}
+
+static int32_t open_instances(struct source_plugin_engine *handle, struct scap_source_plugin_engine_params *params, uint32_t ninstances)
+{
+	scap_source_plugin* plugin = handle->m_input_plugin;
+	uint64_t queue_bytes_dim = params->instance_queue_bytes_dim;
+	if(queue_bytes_dim == 0)
+	{
+		queue_bytes_dim = SOURCE_PLUGIN_INSTANCE_QUEUE_BYTES_DIM;
+	}
+
+	if((queue_bytes_dim & (queue_bytes_dim - 1)) != 0)
+	{
+		snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "the instance queue dimension (%lu) must be a power of 2", (unsigned long)queue_bytes_dim);
+		return SCAP_FAILURE;
+	}
+
+	handle->m_instances = (struct source_plugin_instance*)calloc(ninstances, sizeof(struct source_plugin_instance));
+	if(handle->m_instances == NULL)
+	{
+		strlcpy(handle->m_lasterr, "error allocating the source plugin instances", SCAP_LASTERR_SIZE);
+		return SCAP_FAILURE;
+	}
+	handle->m_last_instance = UINT32_MAX;
+	handle->m_wait_time_us = SOURCE_PLUGIN_WAIT_TIME_US_START;
+	handle->m_merge_wait_start_ns = 0;
+
+	for(uint32_t i = 0; i < ninstances; i++)
+	{
+		struct source_plugin_instance* inst = &handle->m_instances[i];
+		const char* iparams = params->instances_params != NULL ? params->instances_params[i] : params->input_plugin_params;
+		ss_plugin_rc plugin_rc = SS_PLUGIN_FAILURE;
+
+		inst->m_engine = handle;
+		inst->m_handle = plugin->open(plugin->state, iparams, &plugin_rc);
+		handle->m_ninstances++;
+		if(plugin_rc_to_scap_rc(plugin_rc) != SCAP_SUCCESS)
+		{
+			const char *errstr = plugin->get_last_error(plugin->state);
+			snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "%s", errstr);
+			return SCAP_FAILURE;
+		}
+
+		inst->m_queue.m_buf = (char*)malloc(queue_bytes_dim);
+		if(inst->m_queue.m_buf == NULL)
+		{
+			snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "error allocating the queue for source plugin instance %u", i);
+			return SCAP_FAILURE;
+		}
+		inst->m_queue.m_size = queue_bytes_dim;
+	}
+
+	for(uint32_t i = 0; i < ninstances; i++)
+	{
+		struct source_plugin_instance* inst = &handle->m_instances[i];
+		if(pthread_create(&inst->m_thread, NULL, instance_worker, inst) != 0)
+		{
+			snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "unable to start the worker thread for source plugin instance %u", i);
+			return SCAP_FAILURE;
+		}
+		inst->m_started = true;
+	}
+
+	return SCAP_SUCCESS;
+}
+
+static void stop_instances(struct source_plugin_engine *handle)
+{
+	__atomic_store_n(&handle->m_stop, true, __ATOMIC_RELEASE);
+	for(uint32_t i = 0; i < handle->m_ninstances; i++)
+	{
+		if(handle->m_instances[i].m_started)
+		{
+			pthread_join(handle->m_instances[i].m_thread, NULL);
+			handle->m_instances[i].m_started = false;
+		}
+	}
+}
+
+static void close_instances(struct source_plugin_engine *handle)
+{
+	scap_source_plugin* plugin = handle->m_input_plugin;
+
+	stop_instances(handle);
+
+	for(uint32_t i = 0; i < handle->m_ninstances; i++)
+	{
+		if(handle->m_instances[i].m_handle != NULL)
+		{
+			plugin->close(plugin->state, handle->m_instances[i].m_handle);
+		}
+		free(handle->m_instances[i].m_queue.m_buf);
+	}
+
+	free(handle->m_instances);
+	handle->m_instances = NULL;
+	handle->m_ninstances = 0;
+}
+
+// Reports the error of an instance whose worker has stopped. The workers
+// are stopped first, so that the plugin's last error can be read without
+// any next_batch running concurrently.
+static int32_t instance_error(struct source_plugin_engine *handle, struct source_plugin_instance* inst)
+{
+	scap_source_plugin* plugin = handle->m_input_plugin;
+
+	stop_instances(handle);
+	if(inst->m_lasterr[0] == '\0')
+	{
+		const char *errstr = plugin->get_last_error(plugin->state);
+		strlcpy(inst->m_lasterr, errstr ? errstr : "unknown error", SCAP_LASTERR_SIZE);
+	}
+	strlcpy(handle->m_lasterr, inst->m_lasterr, SCAP_LASTERR_SIZE);
+	return inst->m_res;
+}
+
+// Returns the queued event with the lowest timestamp among all the instances.
+// An event is returned only once every instance that is not done or idle has
+// one queued, so that the events come out ordered by timestamp even if the
+// instances produce them at different paces. An instance busy in next_batch
+// for longer than SOURCE_PLUGIN_MERGE_WAIT_NS_MAX doesn't hold back the
+// others either: the ordering is best effort in both cases. The event is
+// valid until the next call.
+static int32_t next_instances(struct source_plugin_engine *handle, OUT scap_evt** pevent, OUT uint16_t* pdevid, OUT uint32_t* pflags)
+{
+	uint64_t min_ts = 0;
+	uint32_t min_inst = UINT32_MAX;
+	scap_evt* min_evt = NULL;
+	uint32_t ndone = 0;
+	bool waiting = false;
+
+	// The previous event is not used by the caller anymore, release its space
+	if(handle->m_last_instance != UINT32_MAX)
+	{
+		staging_queue_pop(&handle->m_instances[handle->m_last_instance].m_queue);
+		handle->m_last_instance = UINT32_MAX;
+	}
+
+	for(uint32_t i = 0; i < handle->m_ninstances; i++)
+	{
+		struct source_plugin_instance* inst = &handle->m_instances[i];
+
+		// the flag is read before peeking, so that a done instance with
+		// an empty queue has surely no events left
+		bool done = __atomic_load_n(&inst->m_done, __ATOMIC_ACQUIRE);
+		scap_evt* pe = staging_queue_peek(&inst->m_queue);
+		if(pe == NULL)
+		{
+			if(!done)
+			{
+				// its next event could be older than the queued ones,
+				// unless it has just found nothing to read
+				if(!__atomic_load_n(&inst->m_idle, __ATOMIC_ACQUIRE))
+				{
+					waiting = true;
+				}
+			}
+			else if(inst->m_res != SCAP_EOF)
+			{
+				return instance_error(handle, inst);
+			}
+			else
+			{
+				ndone++;
+			}
+			continue;
+		}
+
+		if(min_inst == UINT32_MAX || pe->ts < min_ts)
+		{
+			min_ts = pe->ts;
+			min_inst = i;
+			min_evt = pe;
+		}
+	}
+
+	// Once the max wait is over, the events are released until the late
+	// instance queues one
+	if(!waiting)
+	{
+		handle->m_merge_wait_start_ns = 0;
+	}
+	else if(min_inst != UINT32_MAX)
+	{
+		uint64_t now = get_timestamp_ns();
+		if(handle->m_merge_wait_start_ns == 0)
+		{
+			handle->m_merge_wait_start_ns = now;
+		}
+		else if(now - handle->m_merge_wait_start_ns >= SOURCE_PLUGIN_MERGE_WAIT_NS_MAX)
+		{
+			waiting = false;
+		}
+	}
+
+	if(min_inst == UINT32_MAX || waiting)
+	{
+		if(ndone == handle->m_ninstances)
+		{
+			return SCAP_EOF;
+		}
+
+		usleep(handle->m_wait_time_us);
+		handle->m_wait_time_us = MIN(handle->m_wait_time_us * 2, SOURCE_PLUGIN_WAIT_TIME_US_MAX);
+		return SCAP_TIMEOUT;
+	}
+
+	handle->m_wait_time_us = SOURCE_PLUGIN_WAIT_TIME_US_START;
+	handle->m_last_instance = min_inst;
+	int32_t res = check_event(handle, min_evt);
+	if(res != SCAP_SUCCESS)
+	{
+		return res;
+	}
+
+	*pevent = min_evt;
+	*pdevid = 0;
+	*pflags = 0;
+	handle->m_nevts++;
+	return SCAP_SUCCESS;
+}
+#endif
+
 static int32_t init(scap_t* main_handle, scap_open_args* oargs)
 {
 	int32_t rc;
@@ -118,6 +488,44 @@ static int32_t init(scap_t* main_handle, scap_open_args* oargs)
 	struct scap_source_plugin_engine_params *params = oargs->engine_params;
 	handle->m_input_plugin = params->input_plugin;
 
+	uint32_t ninstances = params->num_instances == 0 ? 1 : params->num_instances;
+	if(ninstances > 1)
+	{
+		// opening concurrent instances is opt-in for the plugin
+		uint32_t max_instances = 1;
+		if(handle->m_input_plugin->get_max_concurrent_instances != NULL)
+		{
+			max_instances = handle->m_input_plugin->get_max_concurrent_instances(handle->m_input_plugin->state);
+		}
+		if(ninstances > max_instances)
+		{
+			snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "plugin '%s' does not support %u concurrent instances (max: %u)", handle->m_input_plugin->name, ninstances, max_instances);
+			return SCAP_NOT_SUPPORTED;
+		}
+	}
+
+	handle->m_nstats = MAX_SOURCE_PLUGIN_COUNTERS_STATS;
+	if(ninstances > 1)
+	{
+		handle->m_nstats += ninstances * SOURCE_PLUGIN_STATS_PER_INSTANCE;
+	}
+	handle->m_stats = (scap_stats_v2*)calloc(handle->m_nstats, sizeof(scap_stats_v2));
+	if(handle->m_stats == NULL)
+	{
+		strlcpy(handle->m_lasterr, "error allocating the source plugin stats", SCAP_LASTERR_SIZE);
+		return SCAP_FAILURE;
+	}
+
+	if(ninstances > 1)
+	{
+#ifdef SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+		return open_instances(handle, params, ninstances);
+#else
+		strlcpy(handle->m_lasterr, "opening more source plugin instances in parallel is not supported on this platform", SCAP_LASTERR_SIZE);
+		return SCAP_NOT_SUPPORTED;
+#endif
+	}
+
 	// Set the rc to SCAP_FAILURE now, so in the unlikely event
 	// that a plugin doesn't not actually set a rc, that it gets
 	// treated as a failure.
@@ -147,6 +555,14 @@ static int close_engine(struct scap_engine_handle engine)
 {
 	struct source_plugin_engine *handle = engine.m_handle;
 
+#ifdef SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+	if(handle->m_instances != NULL)
+	{
+		close_instances(handle);
+		return SCAP_SUCCESS;
+	}
+#endif
+
 	// We could arrive here without having initialized 'm_input_plugin'.
 	if(handle->m_input_plugin != NULL)
 	{
@@ -161,6 +577,13 @@ static int32_t next(struct scap_engine_handle engine, OUT scap_evt** pevent, OUT
 	struct source_plugin_engine *handle = engine.m_handle;
 	char *lasterr = engine.m_handle->m_lasterr;
 
+#ifdef SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+	if(handle->m_instances != NULL)
+	{
+		return next_instances(handle, pevent, pdevid, pflags);
+	}
+#endif
+
 	/* we have to read a new batch */
 	if(handle->m_input_plugin_batch_idx >= handle->m_input_plugin_batch_nevts)
 	{
@@ -206,57 +629,10 @@ static int32_t next(struct scap_engine_handle engine, OUT scap_evt** pevent, OUT
 
 	uint32_t pos = handle->m_input_plugin_batch_idx;
 	scap_evt* evt = (scap_evt*) handle->m_input_plugin_batch_evts[pos];
-
-	// Sanity checks in case a plugin implements a non-syscall event source.
-	// If a plugin has event sourcing capability and has a specific ID, then
-	// it is allowed to produce only plugin events of its own event source.
-	uint32_t* pplugin_id = (uint32_t*)((uint8_t*) evt + sizeof(scap_evt) + 4 + 4);
-	uint32_t plugin_id;
-	memcpy(&plugin_id, pplugin_id, sizeof(plugin_id));
-
-	if (handle->m_input_plugin->id != 0)
-	{
-		/*
-		* | scap_evt | len_id (4B) | len_pl (4B) | id | payload |
-		* Note: we need to use 4B for len_id too because the
-		* PPME_PLUGINEVENT_E has EF_LARGE_PAYLOAD flag!
-		*/
-		if (evt->type != PPME_PLUGINEVENT_E || evt->nparams != 2)
-		{
-			snprintf(lasterr, SCAP_LASTERR_SIZE, "malformed plugin event produced by plugin: '%s'", handle->m_input_plugin->name);
-			return SCAP_FAILURE;
-		}
-
-		// forcely setting plugin ID with the one of the open plugin
-		if (plugin_id == 0)
-		{
-			plugin_id = handle->m_input_plugin->id;
-			memcpy(pplugin_id, &plugin_id, sizeof(plugin_id));
-		}
-		else if (plugin_id != handle->m_input_plugin->id)
-		{
-			snprintf(lasterr, SCAP_LASTERR_SIZE, "unexpected plugin ID in plugin event: plugin='%s', expected_id=%d, actual_id=%d", handle->m_input_plugin->name, handle->m_input_plugin->id, plugin_id);
-			return SCAP_FAILURE;
-		}
-	}
-
-	if (evt->type == PPME_PLUGINEVENT_E)
-	{
-		// a zero plugin ID is not allowed for PPME_PLUGINEVENT_E
-		if (plugin_id == 0)
-		{
-			snprintf(lasterr, SCAP_LASTERR_SIZE, "malformed plugin event produced by plugin (no ID): '%s'", handle->m_input_plugin->name);
-			return SCAP_FAILURE;
-		}
-
-		// plugin events have no thread associated
-		evt->tid = (uint64_t) -1;
-	}
-	
-	// automatically set timestamp if none was specified
-	if(evt->ts == UINT64_MAX)
+	int32_t res = check_event(handle, evt);
+	if(res != SCAP_SUCCESS)
 	{
-		evt->ts = get_timestamp_ns();
+		return res;
 	}
 
 	*pevent = evt;
@@ -267,6 +643,31 @@ static int32_t next(struct scap_engine_handle engine, OUT scap_evt** pevent, OUT
 	return SCAP_SUCCESS;
 }
 
+static int32_t next_batch(struct scap_engine_handle engine, OUT scap_batch_evt* evts, uint32_t max_evts, OUT uint32_t* nevts)
+{
+	struct source_plugin_engine *handle = engine.m_handle;
+	int32_t res;
+
+	/* The events of a plugin batch stay valid until the plugin's next_batch
+	 * is called again, so we return at most what is left of the current one.
+	 * With parallel instances, the queued events are released at every call,
+	 * so a single event is returned.
+	 */
+	*nevts = 0;
+	do
+	{
+		res = next(engine, &evts[*nevts].evt, &evts[*nevts].devid, &evts[*nevts].flags);
+		if(res != SCAP_SUCCESS)
+		{
+			/* A failing event is not consumed, the error is reported by the following call */
+			return *nevts > 0 ? SCAP_SUCCESS : res;
+		}
+		(*nevts)++;
+	} while(*nevts < max_evts && handle->m_input_plugin_batch_idx < handle->m_input_plugin_batch_nevts);
+
+	return SCAP_SUCCESS;
+}
+
 static int32_t get_stats(struct scap_engine_handle engine, OUT scap_stats* stats)
 {
 	struct source_plugin_engine *handle = engine.m_handle;
@@ -277,7 +678,7 @@ static int32_t get_stats(struct scap_engine_handle engine, OUT scap_stats* stats
 const struct scap_stats_v2* get_source_plugin_stats_v2(struct scap_engine_handle engine, uint32_t flags, OUT uint32_t* nstats, OUT int32_t* rc)
 {
 	struct source_plugin_engine *handle = engine.m_handle;
-	*nstats = MAX_SOURCE_PLUGIN_COUNTERS_STATS;
+	*nstats = handle->m_nstats;
 	scap_stats_v2* stats = handle->m_stats;
 	if (!stats)
 	{
@@ -295,6 +696,34 @@ const struct scap_stats_v2* get_source_plugin_stats_v2(struct scap_engine_handle
 	}
 	stats[N_EVTS].value.u64 = handle->m_nevts;
 
+#ifdef SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+	/* PARALLEL INSTANCES STATS */
+	for(uint32_t i = 0; i < handle->m_ninstances; i++)
+	{
+		struct source_plugin_instance* inst = &handle->m_instances[i];
+		scap_staging_queue* q = &inst->m_queue;
+		uint32_t n = MAX_SOURCE_PLUGIN_COUNTERS_STATS + i * SOURCE_PLUGIN_STATS_PER_INSTANCE;
+		if(n + SOURCE_PLUGIN_STATS_PER_INSTANCE > handle->m_nstats)
+		{
+			break;
+		}
+
+		stats[n].type = STATS_VALUE_TYPE_U64;
+		stats[n].value.u64 = __atomic_load_n(&q->m_n_pushed, __ATOMIC_RELAXED);
+		snprintf(stats[n].name, STATS_NAME_MAX, "instance%u.n_evts", i);
+		n++;
+
+		stats[n].type = STATS_VALUE_TYPE_U64;
+		stats[n].value.u64 = __atomic_load_n(&q->m_head, __ATOMIC_ACQUIRE) - q->m_tail;
+		snprintf(stats[n].name, STATS_NAME_MAX, "instance%u.queue_bytes", i);
+		n++;
+
+		stats[n].type = STATS_VALUE_TYPE_U64;
+		stats[n].value.u64 = __atomic_load_n(&inst->m_n_queue_full, __ATOMIC_RELAXED);
+		snprintf(stats[n].name, STATS_NAME_MAX, "instance%u.n_queue_full", i);
+	}
+#endif
+
 	*rc = SCAP_SUCCESS;
 	return stats;
 }
@@ -305,9 +734,10 @@ const struct scap_vtable scap_source_plugin_engine = {
 
 	.alloc_handle = alloc_handle,
 	.init = init,
-	.free_handle = noop_free_handle,
+	.free_handle = free_handle,
 	.close = close_engine,
 	.next = next,
+	.next_batch = next_batch,
 	.start_capture = noop_start_capture,
 	.stop_capture = noop_stop_capture,
 	.configure = noop_configure,
@@ -22,8 +22,49 @@ limitations under the License.
 #include <libscap/engine/source_plugin/source_plugin_stats.h>
 #include <libscap/scap_stats_v2.h>
 
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+#define SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+#include <pthread.h>
+#include <stdbool.h>
+#include <libscap/ringbuffer/numa_consumer.h>
+#endif
+
 struct scap;
 
+#define SOURCE_PLUGIN_STATS_PER_INSTANCE 3
+#define SOURCE_PLUGIN_WAIT_TIME_US_START 100
+#define SOURCE_PLUGIN_WAIT_TIME_US_MAX (10 * 1000)
+// Max time the merge waits for an instance to queue an event before
+// returning the oldest event queued by the others
+#define SOURCE_PLUGIN_MERGE_WAIT_NS_MAX (100 * 1000 * 1000)
+
+#ifdef SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+// An instance of the source plugin opened in parallel with others.
+// A worker thread calls next_batch on it and copies the events in a queue,
+// waiting when the queue is full. The capture thread merges the queues.
+struct source_plugin_instance
+{
+	struct source_plugin_engine* m_engine;
+	ss_instance_t* m_handle;
+	pthread_t m_thread;
+	bool m_started;
+	scap_staging_queue m_queue;
+
+	// Set by the worker once next_batch returned EOF or an error,
+	// after having written `m_res` and `m_lasterr`
+	bool m_done;
+	int32_t m_res;
+	char m_lasterr[SCAP_LASTERR_SIZE];
+
+	// Set by the worker when its last next_batch returned a timeout
+	// without events: the instance has no older event to merge
+	bool m_idle;
+
+	// Number of times the worker had to wait for the queue to have room
+	uint64_t m_n_queue_full;
+};
+#endif
+
 struct source_plugin_engine
 {
 	char* m_lasterr;
@@ -48,7 +89,19 @@ struct source_plugin_engine
 	// The return value from the last call to next_batch().
 	ss_plugin_rc m_input_plugin_last_batch_res;
 
+#ifdef SOURCE_PLUGIN_HAS_INSTANCE_WORKERS
+	// Instances opened in parallel, used instead of the single
+	// instance of m_input_plugin when more than one is requested.
+	struct source_plugin_instance* m_instances;
+	uint32_t m_ninstances;
+	bool m_stop;
+	uint32_t m_last_instance; // instance of the last event returned, `UINT32_MAX` if none
+	uint64_t m_wait_time_us;
+	uint64_t m_merge_wait_start_ns; // when the merge started waiting for an instance, 0 if not waiting
+#endif
+
 	// Stats v2.
-	scap_stats_v2 m_stats[MAX_SOURCE_PLUGIN_COUNTERS_STATS];
+	scap_stats_v2* m_stats;
+	uint32_t m_nstats;
 
 };
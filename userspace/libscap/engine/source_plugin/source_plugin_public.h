@@ -18,6 +18,9 @@ limitations under the License.
 
 #define SOURCE_PLUGIN_ENGINE "source_plugin"
 
+/* Default dimension of the event queue of every parallel instance, it must be a power of 2. */
+#define SOURCE_PLUGIN_INSTANCE_QUEUE_BYTES_DIM (8 * 1024 * 1024)
+
 #ifdef __cplusplus
 extern "C"
 {
@@ -27,6 +30,9 @@ extern "C"
 	{
 		scap_source_plugin* input_plugin; ///< use this to configure a source plugin that will produce the events for this capture
 		char* input_plugin_params;	  ///< optional parameters string for the source plugin pointed by src_plugin
+		uint32_t num_instances;		  ///< number of plugin instances to open in parallel. With more than one, the plugin must allow them through get_max_concurrent_instances, every instance is read by its own worker thread and the events are merged by timestamp. 0 means 1
+		const char** instances_params;	  ///< parameters strings for each of the num_instances instances. If NULL, all of them are opened with input_plugin_params
+		uint64_t instance_queue_bytes_dim; ///< dimension of the event queue of every parallel instance, it must be a power of 2. 0 means SOURCE_PLUGIN_INSTANCE_QUEUE_BYTES_DIM
 	};
 
 #ifdef __cplusplus
@@ -43,6 +43,10 @@ struct scap_test_input_data {
   size_t thread_count;
 
   struct scap_test_fdinfo_data *fdinfo_data;
+
+  // threads missing from the initial scan, only found by scap_proc_get()
+  struct scap_threadinfo *proc_threads;
+  size_t proc_thread_count;
 };
 
 typedef struct scap_test_input_data scap_test_input_data;
@@ -77,10 +77,28 @@ static bool scap_test_input_is_thread_alive(struct scap_platform* platform, int6
 	return false;
 }
 
+static int32_t scap_test_input_get_proc(struct scap_platform* platform, int64_t tid, struct scap_threadinfo* tinfo, bool scan_sockets)
+{
+	struct scap_test_input_platform* test_input_platform = (struct scap_test_input_platform*)platform;
+	scap_test_input_data *data = test_input_platform->m_data;
+	size_t i;
+
+	for (i = 0; i < data->proc_thread_count; i++)
+	{
+		if(data->proc_threads[i].tid == tid) {
+			*tinfo = data->proc_threads[i];
+			return SCAP_SUCCESS;
+		}
+	}
+
+	return SCAP_FAILURE;
+}
+
 static const struct scap_platform_vtable scap_test_input_platform = {
 	.init_platform = scap_test_input_init_platform,
 	.free_platform = scap_test_input_free_platform,
 	.is_thread_alive = scap_test_input_is_thread_alive,
+	.get_proc = scap_test_input_get_proc,
 };
 
 struct scap_platform* scap_test_input_alloc_platform(proc_entry_callback proc_callback, void* proc_callback_context)
@@ -43,6 +43,7 @@ limitations under the License.
 #define CPUS_FOR_EACH_BUFFER_MODE "--cpus_for_buf"
 #define ALL_AVAILABLE_CPUS_MODE "--available_cpus"
 #define DROP_FAILED "--drop-failed"
+#define NUMA_CONSUMERS_OPTION "--numa_consumers"
 #define VERBOSE_OPTION "--verbose"
 
 /* PRINT */
@@ -544,6 +545,8 @@ void print_help()
 	printf("'%s <cpus_for_each_buffer>': allocate a ring buffer for every `cpus_for_each_buffer` CPUs.\n", CPUS_FOR_EACH_BUFFER_MODE);
 	printf("'%s': allocate ring buffers for all available CPUs. Default: allocate ring buffers for online CPUs only.\n", ALL_AVAILABLE_CPUS_MODE);
 	printf("'%s': instrument drivers to drop failed syscalls (exit) events.\n", DROP_FAILED);
+	printf("[KMOD AND BPF PROBE ONLY]\n");
+	printf("'%s': drain the buffers with one reader thread for every NUMA node.\n", NUMA_CONSUMERS_OPTION);
 	printf("'%s <level>': print all available logs. Default level is WARNING (4)\n", VERBOSE_OPTION);
 	printf("\n------> PRINT OPTIONS\n");
 	printf("'%s': print all supported syscalls with different sources and configurations.\n", PRINT_SYSCALLS_OPTION);
@@ -762,6 +765,13 @@ void parse_CLI_options(int argc, char** argv)
 			drop_failed = true;
 		}
 
+		/* This should be used only with the kernel module and the BPF probe */
+		if(!strcmp(argv[i], NUMA_CONSUMERS_OPTION))
+		{
+			kmod_params.numa_consumers = true;
+			bpf_params.numa_consumers = true;
+		}
+
 		if(!strcmp(argv[i], VERBOSE_OPTION))
 		{
 			if(!(i + 1 < argc))
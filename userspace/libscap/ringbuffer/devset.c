@@ -16,6 +16,7 @@ limitations under the License.
 
 */
 #include <libscap/ringbuffer/devset.h>
+#include <libscap/ringbuffer/numa_consumer.h>
 
 #include <stdlib.h>
 #include <stdint.h>
@@ -45,9 +46,11 @@ int32_t devset_init(struct scap_device_set *devset, size_t num_devs, char *laste
 		devset->m_devs[j].m_bufinfo_fd = INVALID_FD;
 		devset->m_devs[j].m_lastreadsize = 0;
 		devset->m_devs[j].m_sn_len = 0;
+		devset->m_devs[j].m_cpu = -1;
 	}
 	devset->m_buffer_empty_wait_time_us = BUFFER_EMPTY_WAIT_TIME_US_START;
 	devset->m_lasterr = lasterr;
+	devset->m_numa_consumer = NULL;
 
 	return SCAP_SUCCESS;
 }
@@ -67,6 +70,9 @@ void devset_free(struct scap_device_set *devset)
 		return;
 	}
 
+	/* The reader threads must be stopped before unmapping their buffers */
+	numa_consumer_stop(devset);
+
 	uint32_t j;
 	for(j = 0; j < devset->m_ndevs; j++)
 	{
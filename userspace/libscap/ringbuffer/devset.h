@@ -37,6 +37,7 @@ limitations under the License.
 
 struct ppm_ring_buffer_info;
 struct udig_ring_buffer_status;
+struct scap_numa_consumer;
 
 //
 // The device descriptor
@@ -51,6 +52,7 @@ typedef struct scap_device
 	uint32_t m_lastreadsize;
 	char* m_sn_next_event; // Pointer to the next event available for scap_next
 	uint32_t m_sn_len; // Number of bytes available in the buffer pointed by m_sn_next_event
+	int32_t m_cpu; // CPU owning the buffer, -1 if unknown
 	union
 	{
 		// Anonymous struct with ppm stuff
@@ -69,12 +71,22 @@ struct scap_device_set
 	uint32_t m_ndevs;
 	uint64_t m_buffer_empty_wait_time_us;
 	char* m_lasterr;
+	struct scap_numa_consumer* m_numa_consumer; // NULL unless the buffers are read by the NUMA reader threads
 };
 
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
 int32_t devset_init(struct scap_device_set *devset, size_t num_devs, char *lasterr);
 void devset_close_device(struct scap_device *dev);
 void devset_free(struct scap_device_set *devset);
 
+#ifdef __cplusplus
+}
+#endif
+
 static inline void devset_munmap(void* addr, size_t size)
 {
 	if(addr != INVALID_MAPPING)
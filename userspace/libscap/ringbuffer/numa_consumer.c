@@ -0,0 +1,495 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifndef _GNU_SOURCE
+#define _GNU_SOURCE
+#endif
+
+#include <libscap/ringbuffer/numa_consumer.h>
+#include <libscap/ringbuffer/devset.h>
+
+#include <dirent.h>
+#include <sched.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#include <libscap/strl.h>
+#include <libscap/scap-int.h>
+#include <libscap/scap_sleep.h>
+
+/* How many times the merge yields waiting for a late reader before giving up with a timeout */
+#define NUMA_CONSUMER_MAX_WAIT_YIELDS 1000
+
+/* Return the NUMA node of `cpu`, 0 if unknown (e.g. no NUMA support in the kernel). */
+static int32_t get_cpu_numa_node(int32_t cpu)
+{
+	char path[128];
+	struct dirent* entry;
+	int32_t node = 0;
+
+	if(cpu < 0)
+	{
+		return 0;
+	}
+
+	snprintf(path, sizeof(path), "/sys/devices/system/cpu/cpu%d", cpu);
+	DIR* dir = opendir(path);
+	if(dir == NULL)
+	{
+		return 0;
+	}
+
+	while((entry = readdir(dir)) != NULL)
+	{
+		if(sscanf(entry->d_name, "node%d", &node) == 1)
+		{
+			break;
+		}
+	}
+	closedir(dir);
+	return node;
+}
+
+static void pin_reader(struct scap_numa_reader* reader)
+{
+	struct scap_device_set* devset = reader->m_consumer->m_devset;
+	cpu_set_t set;
+	bool any = false;
+
+	CPU_ZERO(&set);
+	for(uint32_t j = 0; j < reader->m_ndevs; j++)
+	{
+		int32_t cpu = devset->m_devs[reader->m_devs[j]].m_cpu;
+		if(cpu >= 0 && cpu < CPU_SETSIZE)
+		{
+			CPU_SET(cpu, &set);
+			any = true;
+		}
+	}
+
+	/* A failure here is not fatal: we only lose the memory locality. */
+	if(any)
+	{
+		pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+	}
+}
+
+static void* reader_loop(void* arg)
+{
+	struct scap_numa_reader* reader = (struct scap_numa_reader*)arg;
+	struct scap_numa_consumer* consumer = reader->m_consumer;
+	struct scap_device_set* devset = consumer->m_devset;
+	uint64_t wait_time_us = BUFFER_EMPTY_WAIT_TIME_US_START;
+	bool failed = false;
+
+	pin_reader(reader);
+
+	/* Allocate and touch the queues after pinning, so that their pages
+	 * are placed on the node of the reader.
+	 */
+	for(uint32_t j = 0; j < reader->m_ndevs; j++)
+	{
+		scap_staging_queue* q = &consumer->m_queues[reader->m_devs[j]];
+		q->m_buf = (char*)malloc(consumer->m_queue_bytes_dim);
+		if(q->m_buf == NULL)
+		{
+			snprintf(consumer->m_lasterr, SCAP_LASTERR_SIZE, "error allocating the staging queue for device %u", reader->m_devs[j]);
+			failed = true;
+			break;
+		}
+		memset(q->m_buf, 0, consumer->m_queue_bytes_dim);
+		q->m_size = consumer->m_queue_bytes_dim;
+	}
+
+	if(failed)
+	{
+		__atomic_store_n(&consumer->m_failed, true, __ATOMIC_RELEASE);
+	}
+	__atomic_add_fetch(&consumer->m_nready, 1, __ATOMIC_RELEASE);
+
+	while(!failed && !__atomic_load_n(&consumer->m_stop, __ATOMIC_ACQUIRE))
+	{
+		uint32_t staged = 0;
+
+		/* The events of the ring buffers are discarded, the capture thread
+		 * discards the staged ones up to `m_flush_head`.
+		 */
+		uint32_t flush_req = __atomic_load_n(&consumer->m_flush_req, __ATOMIC_ACQUIRE);
+		if(flush_req != reader->m_flush_done)
+		{
+			for(uint32_t j = 0; j < reader->m_ndevs; j++)
+			{
+				uint32_t devid = reader->m_devs[j];
+				consumer->m_flush(&devset->m_devs[devid]);
+				consumer->m_queues[devid].m_flush_head = consumer->m_queues[devid].m_head;
+			}
+			__atomic_store_n(&reader->m_flush_done, flush_req, __ATOMIC_RELEASE);
+		}
+
+		for(uint32_t j = 0; j < reader->m_ndevs; j++)
+		{
+			uint32_t devid = reader->m_devs[j];
+			scap_device* dev = &devset->m_devs[devid];
+			uint32_t n = consumer->m_stage(dev, &consumer->m_queues[devid]);
+			if(n == UINT32_MAX)
+			{
+				snprintf(consumer->m_lasterr, SCAP_LASTERR_SIZE, "scap_next buffer corruption");
+				__atomic_store_n(&consumer->m_failed, true, __ATOMIC_RELEASE);
+				failed = true;
+				break;
+			}
+			staged += n;
+		}
+
+		if(staged == 0)
+		{
+			/* Don't back off while the merge is waiting for us */
+			if(__atomic_load_n(&consumer->m_waiting, __ATOMIC_ACQUIRE))
+			{
+				sched_yield();
+				wait_time_us = BUFFER_EMPTY_WAIT_TIME_US_START;
+				continue;
+			}
+			usleep(wait_time_us);
+			wait_time_us = MIN(wait_time_us * 2, BUFFER_EMPTY_WAIT_TIME_US_MAX);
+		}
+		else
+		{
+			wait_time_us = BUFFER_EMPTY_WAIT_TIME_US_START;
+		}
+	}
+
+	return NULL;
+}
+
+static void free_consumer(struct scap_numa_consumer* consumer)
+{
+	for(uint32_t i = 0; i < consumer->m_nreaders; i++)
+	{
+		free(consumer->m_readers[i].m_devs);
+	}
+
+	if(consumer->m_queues != NULL)
+	{
+		for(uint32_t j = 0; j < consumer->m_devset->m_ndevs; j++)
+		{
+			free(consumer->m_queues[j].m_buf);
+		}
+		free(consumer->m_queues);
+	}
+	free(consumer);
+}
+
+int32_t numa_consumer_start(struct scap_device_set* devset, numa_consumer_stage_fn stage, numa_consumer_flush_fn flush, uint64_t queue_bytes_dim)
+{
+	int32_t dev_node[devset->m_ndevs > 0 ? devset->m_ndevs : 1];
+
+	if(devset->m_numa_consumer != NULL)
+	{
+		return SCAP_SUCCESS;
+	}
+
+	if(queue_bytes_dim == 0 || (queue_bytes_dim & (queue_bytes_dim - 1)) != 0)
+	{
+		snprintf(devset->m_lasterr, SCAP_LASTERR_SIZE, "the staging queue dimension (%lu) must be a power of 2", (unsigned long)queue_bytes_dim);
+		return SCAP_FAILURE;
+	}
+
+	struct scap_numa_consumer* consumer = (struct scap_numa_consumer*)calloc(1, sizeof(struct scap_numa_consumer));
+	if(consumer == NULL)
+	{
+		strlcpy(devset->m_lasterr, "error allocating the numa consumer", SCAP_LASTERR_SIZE);
+		return SCAP_FAILURE;
+	}
+	consumer->m_devset = devset;
+	consumer->m_stage = stage;
+	consumer->m_flush = flush;
+	consumer->m_queue_bytes_dim = queue_bytes_dim;
+	consumer->m_last_dev = UINT32_MAX;
+	consumer->m_buffer_empty_wait_time_us = BUFFER_EMPTY_WAIT_TIME_US_START;
+
+	consumer->m_queues = (scap_staging_queue*)calloc(devset->m_ndevs, sizeof(scap_staging_queue));
+	if(consumer->m_queues == NULL)
+	{
+		strlcpy(devset->m_lasterr, "error allocating the staging queues", SCAP_LASTERR_SIZE);
+		free_consumer(consumer);
+		return SCAP_FAILURE;
+	}
+
+	/* Group the devices by node, nodes beyond `NUMA_CONSUMER_MAX_NODES` are folded. */
+	for(uint32_t j = 0; j < devset->m_ndevs; j++)
+	{
+		dev_node[j] = get_cpu_numa_node(devset->m_devs[j].m_cpu) % NUMA_CONSUMER_MAX_NODES;
+	}
+
+	for(int32_t node = 0; node < NUMA_CONSUMER_MAX_NODES; node++)
+	{
+		struct scap_numa_reader* reader = &consumer->m_readers[consumer->m_nreaders];
+		for(uint32_t j = 0; j < devset->m_ndevs; j++)
+		{
+			if(dev_node[j] != node)
+			{
+				continue;
+			}
+
+			if(reader->m_devs == NULL)
+			{
+				reader->m_devs = (uint32_t*)calloc(devset->m_ndevs, sizeof(uint32_t));
+				if(reader->m_devs == NULL)
+				{
+					strlcpy(devset->m_lasterr, "error allocating the numa reader", SCAP_LASTERR_SIZE);
+					free_consumer(consumer);
+					return SCAP_FAILURE;
+				}
+				reader->m_node = node;
+				reader->m_consumer = consumer;
+				consumer->m_nreaders++;
+			}
+			reader->m_devs[reader->m_ndevs++] = j;
+		}
+	}
+
+	devset->m_numa_consumer = consumer;
+
+	for(uint32_t i = 0; i < consumer->m_nreaders; i++)
+	{
+		struct scap_numa_reader* reader = &consumer->m_readers[i];
+		if(pthread_create(&reader->m_thread, NULL, reader_loop, reader) != 0)
+		{
+			snprintf(devset->m_lasterr, SCAP_LASTERR_SIZE, "unable to start the reader thread for numa node %d", reader->m_node);
+			numa_consumer_stop(devset);
+			return SCAP_FAILURE;
+		}
+		reader->m_started = true;
+	}
+
+	/* Wait for all the queues to be allocated */
+	while(__atomic_load_n(&consumer->m_nready, __ATOMIC_ACQUIRE) < consumer->m_nreaders)
+	{
+		usleep(BUFFER_EMPTY_WAIT_TIME_US_START);
+	}
+
+	if(__atomic_load_n(&consumer->m_failed, __ATOMIC_ACQUIRE))
+	{
+		strlcpy(devset->m_lasterr, consumer->m_lasterr, SCAP_LASTERR_SIZE);
+		numa_consumer_stop(devset);
+		return SCAP_FAILURE;
+	}
+
+	return SCAP_SUCCESS;
+}
+
+void numa_consumer_stop(struct scap_device_set* devset)
+{
+	struct scap_numa_consumer* consumer = devset->m_numa_consumer;
+	if(consumer == NULL)
+	{
+		return;
+	}
+
+	__atomic_store_n(&consumer->m_stop, true, __ATOMIC_RELEASE);
+	for(uint32_t i = 0; i < consumer->m_nreaders; i++)
+	{
+		if(consumer->m_readers[i].m_started)
+		{
+			pthread_join(consumer->m_readers[i].m_thread, NULL);
+		}
+	}
+
+	free_consumer(consumer);
+	devset->m_numa_consumer = NULL;
+}
+
+int32_t numa_consumer_flush(struct scap_device_set* devset)
+{
+	struct scap_numa_consumer* consumer = devset->m_numa_consumer;
+
+	uint32_t flush_req = __atomic_add_fetch(&consumer->m_flush_req, 1, __ATOMIC_ACQ_REL);
+	for(uint32_t i = 0; i < consumer->m_nreaders; i++)
+	{
+		while(__atomic_load_n(&consumer->m_readers[i].m_flush_done, __ATOMIC_ACQUIRE) != flush_req)
+		{
+			if(__atomic_load_n(&consumer->m_failed, __ATOMIC_ACQUIRE))
+			{
+				strlcpy(devset->m_lasterr, consumer->m_lasterr, SCAP_LASTERR_SIZE);
+				return SCAP_FAILURE;
+			}
+			usleep(BUFFER_EMPTY_WAIT_TIME_US_START);
+		}
+	}
+
+	/* Drop what was staged before the flush, including the last returned event */
+	if(consumer->m_last_dev != UINT32_MAX)
+	{
+		staging_queue_pop(&consumer->m_queues[consumer->m_last_dev]);
+		consumer->m_last_dev = UINT32_MAX;
+	}
+
+	for(uint32_t j = 0; j < devset->m_ndevs; j++)
+	{
+		scap_staging_queue* q = &consumer->m_queues[j];
+		while(q->m_tail < q->m_flush_head && staging_queue_peek(q) != NULL)
+		{
+			staging_queue_pop(q);
+		}
+	}
+	return SCAP_SUCCESS;
+}
+
+/* True if the ring buffers of all the empty queues were drained after an
+ * event staged at `staged_ns` was written, so they can't hold older events.
+ */
+static bool all_heads_staged(struct scap_device_set* devset, uint64_t staged_ns)
+{
+	struct scap_numa_consumer* consumer = devset->m_numa_consumer;
+
+	for(uint32_t j = 0; j < devset->m_ndevs; j++)
+	{
+		scap_staging_queue* q = &consumer->m_queues[j];
+		if(staging_queue_peek(q) != NULL)
+		{
+			continue;
+		}
+
+		/* Load the drain time before checking the queue again: what was
+		 * staged before the drain is visible and it must have been consumed.
+		 */
+		uint64_t drained_ns = __atomic_load_n(&q->m_drained_ns, __ATOMIC_ACQUIRE);
+		if(drained_ns < staged_ns || staging_queue_peek(q) != NULL)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+int32_t numa_consumer_next(struct scap_device_set* devset, OUT scap_evt** pevent, OUT uint16_t* pdevid, OUT uint32_t* pflags)
+{
+	struct scap_numa_consumer* consumer = devset->m_numa_consumer;
+	uint64_t min_ts;
+	uint32_t min_dev;
+	scap_evt* min_evt;
+
+	/* The previous event is not used by the caller anymore, release its space */
+	if(consumer->m_last_dev != UINT32_MAX)
+	{
+		staging_queue_pop(&consumer->m_queues[consumer->m_last_dev]);
+		consumer->m_last_dev = UINT32_MAX;
+	}
+
+	for(uint32_t yields = 0;; yields++)
+	{
+		min_ts = 0xffffffffffffffffLL;
+		min_dev = UINT32_MAX;
+		min_evt = NULL;
+
+		for(uint32_t j = 0; j < devset->m_ndevs; j++)
+		{
+			scap_evt* pe = staging_queue_peek(&consumer->m_queues[j]);
+			if(pe != NULL && pe->ts < min_ts)
+			{
+				min_ts = pe->ts;
+				min_dev = j;
+				min_evt = pe;
+			}
+		}
+
+		if(min_dev == UINT32_MAX)
+		{
+			break;
+		}
+
+		if(all_heads_staged(devset, staging_queue_staged_ns(min_evt)))
+		{
+			__atomic_store_n(&consumer->m_waiting, false, __ATOMIC_RELEASE);
+			consumer->m_buffer_empty_wait_time_us = BUFFER_EMPTY_WAIT_TIME_US_START;
+			consumer->m_last_dev = min_dev;
+			*pevent = min_evt;
+			*pdevid = (uint16_t)min_dev;
+			// we don't really store the flags in the ringbuffer anywhere
+			*pflags = 0;
+			return SCAP_SUCCESS;
+		}
+
+		/* A reader is late, it could still stage an older event */
+		if(__atomic_load_n(&consumer->m_failed, __ATOMIC_ACQUIRE))
+		{
+			break;
+		}
+
+		if(yields == NUMA_CONSUMER_MAX_WAIT_YIELDS)
+		{
+			return SCAP_TIMEOUT;
+		}
+		__atomic_store_n(&consumer->m_waiting, true, __ATOMIC_RELEASE);
+		sched_yield();
+	}
+
+	__atomic_store_n(&consumer->m_waiting, false, __ATOMIC_RELEASE);
+	if(__atomic_load_n(&consumer->m_failed, __ATOMIC_ACQUIRE))
+	{
+		strlcpy(devset->m_lasterr, consumer->m_lasterr, SCAP_LASTERR_SIZE);
+		ASSERT(false);
+		return SCAP_FAILURE;
+	}
+
+	sleep_ms(consumer->m_buffer_empty_wait_time_us / 1000);
+	consumer->m_buffer_empty_wait_time_us = MIN(consumer->m_buffer_empty_wait_time_us * 2,
+						   BUFFER_EMPTY_WAIT_TIME_US_MAX);
+	return SCAP_TIMEOUT;
+}
+
+uint32_t numa_consumer_get_stats(struct scap_device_set* devset, scap_stats_v2* stats, uint32_t max_stats)
+{
+	struct scap_numa_consumer* consumer = devset->m_numa_consumer;
+	uint32_t n = 0;
+
+	if(consumer == NULL)
+	{
+		return 0;
+	}
+
+	for(uint32_t i = 0; i < consumer->m_nreaders && n + NUMA_CONSUMER_STATS_PER_NODE <= max_stats; i++)
+	{
+		struct scap_numa_reader* reader = &consumer->m_readers[i];
+		uint64_t queue_bytes = 0;
+		uint64_t n_evts = 0;
+
+		for(uint32_t j = 0; j < reader->m_ndevs; j++)
+		{
+			scap_staging_queue* q = &consumer->m_queues[reader->m_devs[j]];
+			queue_bytes += __atomic_load_n(&q->m_head, __ATOMIC_ACQUIRE) - q->m_tail;
+			n_evts += __atomic_load_n(&q->m_n_pushed, __ATOMIC_RELAXED) - q->m_n_popped;
+		}
+
+		stats[n].type = STATS_VALUE_TYPE_U64;
+		stats[n].flags = PPM_SCAP_STATS_KERNEL_COUNTERS;
+		stats[n].value.u64 = queue_bytes;
+		snprintf(stats[n].name, STATS_NAME_MAX, "numa_consumer.node%d.queue_bytes", reader->m_node);
+		n++;
+
+		stats[n].type = STATS_VALUE_TYPE_U64;
+		stats[n].flags = PPM_SCAP_STATS_KERNEL_COUNTERS;
+		stats[n].value.u64 = n_evts;
+		snprintf(stats[n].name, STATS_NAME_MAX, "numa_consumer.node%d.n_evts", reader->m_node);
+		n++;
+	}
+
+	return n;
+}
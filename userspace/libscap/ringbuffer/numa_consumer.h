@@ -0,0 +1,247 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <string.h>
+#include <time.h>
+#include <pthread.h>
+
+#include <libscap/scap.h>
+
+//
+// Multi-consumer mode for the ring buffer engines.
+//
+// One reader thread for every NUMA node is pinned on the CPUs of the node
+// and moves the events of the node-local ring buffers into per-device
+// staging queues allocated (and so first touched) by the reader itself.
+// The capture thread only performs the timestamp merge over the staging
+// queues, so it never reads remote ring buffers.
+//
+// A queue that is empty doesn't mean that its ring buffer is empty: the
+// reader could be late. Before returning an event the merge waits until the
+// ring buffer of every empty queue was found empty by its reader after the
+// event was staged, so that a late reader can't reorder the events.
+//
+
+#define NUMA_CONSUMER_MAX_NODES 16
+#define NUMA_CONSUMER_STATS_PER_NODE 2
+#define NUMA_CONSUMER_MAX_STATS (NUMA_CONSUMER_MAX_NODES * NUMA_CONSUMER_STATS_PER_NODE)
+
+/* Default dimension of a single staging queue, it must be a power of 2. */
+#define NUMA_CONSUMER_QUEUE_BYTES_DIM (8 * 1024 * 1024)
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+struct scap_device;
+struct scap_device_set;
+
+/* Every event in a staging queue is preceded by this header.
+ * A record with `len == 0` means that the producer wrapped around.
+ */
+struct staging_record
+{
+	uint32_t len; /* length of the whole record, header included, 8-byte aligned */
+	uint32_t reserved;
+	uint64_t staged_ns; /* when the block of the event was read, the event was written before */
+};
+
+/* Single producer (reader thread), single consumer (capture thread) byte queue.
+ * `m_head` and `m_tail` never wrap, the offset in the buffer is obtained masking them.
+ */
+typedef struct scap_staging_queue
+{
+	char* m_buf;
+	uint64_t m_size;
+	uint64_t m_head; /* written only by the reader thread */
+	uint64_t m_tail; /* written only by the capture thread */
+	uint64_t m_n_pushed;
+	uint64_t m_n_popped;
+	/* Written only by the reader thread */
+	uint64_t m_block_read_ns; /* before reading the current block of the ring buffer */
+	uint64_t m_block_ns; /* after reading the current block of the ring buffer */
+	uint64_t m_drained_ns; /* all the events written before this were staged */
+	uint64_t m_flush_head; /* `m_head` when the ring buffer was last flushed */
+} scap_staging_queue;
+
+/* Engine specific function that moves the events available in the ring buffer
+ * of a device into its staging queue. Returns the number of staged events.
+ */
+typedef uint32_t (*numa_consumer_stage_fn)(struct scap_device* dev, scap_staging_queue* queue);
+
+/* Engine specific function that discards the events available in the ring buffer of a device. */
+typedef void (*numa_consumer_flush_fn)(struct scap_device* dev);
+
+struct scap_numa_consumer;
+
+struct scap_numa_reader
+{
+	pthread_t m_thread;
+	bool m_started;
+	int32_t m_node;
+	uint32_t* m_devs; /* indexes of the devices read by this reader */
+	uint32_t m_ndevs;
+	struct scap_numa_consumer* m_consumer;
+	uint32_t m_flush_done; /* last flush request served by this reader */
+};
+
+struct scap_numa_consumer
+{
+	struct scap_device_set* m_devset;
+	numa_consumer_stage_fn m_stage;
+	numa_consumer_flush_fn m_flush;
+	scap_staging_queue* m_queues; /* one for every device */
+	uint64_t m_queue_bytes_dim;
+	struct scap_numa_reader m_readers[NUMA_CONSUMER_MAX_NODES];
+	uint32_t m_nreaders;
+	uint32_t m_nready;
+	bool m_failed;
+	char m_lasterr[SCAP_LASTERR_SIZE]; /* written by a reader before setting `m_failed` */
+	bool m_stop;
+	bool m_waiting; /* the merge is waiting for a reader to drain its ring buffers */
+	uint32_t m_flush_req; /* incremented by the capture thread to request a flush */
+	uint32_t m_last_dev; /* device of the last event returned, `UINT32_MAX` if none */
+	uint64_t m_buffer_empty_wait_time_us;
+};
+
+/*!
+  \brief Start one reader thread for every NUMA node owning at least one device of the set.
+  Once started, the devices of the set must not be read by any other thread.
+*/
+int32_t numa_consumer_start(struct scap_device_set* devset, numa_consumer_stage_fn stage, numa_consumer_flush_fn flush, uint64_t queue_bytes_dim);
+
+/*!
+  \brief Stop and join the reader threads, it's safe to call it if the consumer is not running.
+*/
+void numa_consumer_stop(struct scap_device_set* devset);
+
+/*!
+  \brief Discard the events of all the ring buffers and of the staging queues, like
+  the flush done on the devices when the capture settings change. It waits for all
+  the reader threads to flush their devices.
+*/
+int32_t numa_consumer_flush(struct scap_device_set* devset);
+
+/*!
+  \brief Return the staged event with the lowest timestamp. The event is valid until the next call.
+  `SCAP_TIMEOUT` is returned also when the merge can't rule out that a late reader
+  still has to stage an older event.
+*/
+int32_t numa_consumer_next(struct scap_device_set* devset, OUT scap_evt** pevent, OUT uint16_t* pdevid, OUT uint32_t* pflags);
+
+/*!
+  \brief Fill `stats` with the per-node queue depth, returns the number of stats written.
+*/
+uint32_t numa_consumer_get_stats(struct scap_device_set* devset, scap_stats_v2* stats, uint32_t max_stats);
+
+static inline uint64_t staging_queue_now_ns(void)
+{
+	struct timespec ts;
+	clock_gettime(CLOCK_MONOTONIC, &ts);
+	return (uint64_t)ts.tv_sec * 1000000000ULL + (uint64_t)ts.tv_nsec;
+}
+
+/* Called by the reader around the read of a new block of the ring buffer */
+static inline void staging_queue_begin_block(scap_staging_queue* q, uint64_t read_ns)
+{
+	q->m_block_read_ns = read_ns;
+	q->m_block_ns = staging_queue_now_ns();
+}
+
+/* Called by the reader once the whole block is staged: nothing written before
+ * the block was read is left in the ring buffer.
+ */
+static inline void staging_queue_set_drained(scap_staging_queue* q)
+{
+	__atomic_store_n(&q->m_drained_ns, q->m_block_read_ns, __ATOMIC_RELEASE);
+}
+
+static inline bool staging_queue_push(scap_staging_queue* q, const scap_evt* evt)
+{
+	uint64_t rec_len = (sizeof(struct staging_record) + evt->len + 7) & ~7ULL;
+	uint64_t head = q->m_head;
+	uint64_t tail = __atomic_load_n(&q->m_tail, __ATOMIC_ACQUIRE);
+	uint64_t off = head & (q->m_size - 1);
+	uint64_t contiguous = q->m_size - off;
+	uint64_t needed = contiguous < rec_len ? contiguous + rec_len : rec_len;
+
+	if(q->m_size - (head - tail) < needed)
+	{
+		return false;
+	}
+
+	if(contiguous < rec_len)
+	{
+		/* Not enough contiguous space, mark the end of the buffer and restart from the beginning */
+		((struct staging_record*)(q->m_buf + off))->len = 0;
+		head += contiguous;
+		off = 0;
+	}
+
+	struct staging_record* rec = (struct staging_record*)(q->m_buf + off);
+	rec->len = (uint32_t)rec_len;
+	rec->staged_ns = q->m_block_ns;
+	memcpy(rec + 1, evt, evt->len);
+
+	__atomic_store_n(&q->m_head, head + rec_len, __ATOMIC_RELEASE);
+	__atomic_store_n(&q->m_n_pushed, q->m_n_pushed + 1, __ATOMIC_RELAXED);
+	return true;
+}
+
+static inline scap_evt* staging_queue_peek(scap_staging_queue* q)
+{
+	uint64_t tail = q->m_tail;
+	uint64_t head = __atomic_load_n(&q->m_head, __ATOMIC_ACQUIRE);
+
+	while(tail != head)
+	{
+		uint64_t off = tail & (q->m_size - 1);
+		struct staging_record* rec = (struct staging_record*)(q->m_buf + off);
+		if(rec->len == 0)
+		{
+			/* Skip the wrap marker */
+			tail += q->m_size - off;
+			__atomic_store_n(&q->m_tail, tail, __ATOMIC_RELEASE);
+			continue;
+		}
+		return (scap_evt*)(rec + 1);
+	}
+	return NULL;
+}
+
+/* Return when the block of an event returned by `staging_queue_peek` was read */
+static inline uint64_t staging_queue_staged_ns(const scap_evt* evt)
+{
+	return ((const struct staging_record*)evt - 1)->staged_ns;
+}
+
+static inline void staging_queue_pop(scap_staging_queue* q)
+{
+	struct staging_record* rec = (struct staging_record*)(q->m_buf + (q->m_tail & (q->m_size - 1)));
+	__atomic_store_n(&q->m_tail, q->m_tail + rec->len, __ATOMIC_RELEASE);
+	__atomic_store_n(&q->m_n_popped, q->m_n_popped + 1, __ATOMIC_RELAXED);
+}
+
+#ifdef __cplusplus
+}
+#endif
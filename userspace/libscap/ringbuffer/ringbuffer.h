@@ -20,6 +20,7 @@ limitations under the License.
 #include <stdint.h>
 
 #include <libscap/ringbuffer/devset.h>
+#include <libscap/ringbuffer/numa_consumer.h>
 #include <driver/ppm_ringbuffer.h>
 #include <libscap/scap_barrier.h>
 #include <libscap/scap_sleep.h>
@@ -219,6 +220,12 @@ static inline int32_t ringbuffer_next(struct scap_device_set* devset, OUT scap_e
 	scap_evt* pe = NULL;
 	uint32_t ndevs = devset->m_ndevs;
 
+	/* The buffers are drained by the NUMA reader threads, we only merge their queues */
+	if(devset->m_numa_consumer != NULL)
+	{
+		return numa_consumer_next(devset, pevent, pdevid, pflags);
+	}
+
 	*pdevid = 65535;
 
 	for(j = 0; j < ndevs; j++)
@@ -303,6 +310,150 @@ static inline int32_t ringbuffer_next(struct scap_device_set* devset, OUT scap_e
 	}
 }
 
+/* Same merge of `ringbuffer_next` but it returns up to `max_evts` events at once.
+ * All the returned events must stay valid until the next call, so the consumer
+ * position of a buffer is moved only at the beginning of the following batch.
+ */
+static inline int32_t ringbuffer_next_batch(struct scap_device_set* devset, OUT scap_batch_evt* evts, uint32_t max_evts,
+					    OUT uint32_t* nevts)
+{
+	uint32_t j;
+	uint32_t n = 0;
+	uint32_t ndevs = devset->m_ndevs;
+
+	*nevts = 0;
+
+	/* The NUMA consumer releases the previous event at every call, one event at a time */
+	if(devset->m_numa_consumer != NULL)
+	{
+		int32_t res = numa_consumer_next(devset, &evts[0].evt, &evts[0].devid, &evts[0].flags);
+		*nevts = res == SCAP_SUCCESS ? 1 : 0;
+		return res;
+	}
+
+	/* Release the blocks fully consumed by the previous batch */
+	for(j = 0; j < ndevs; j++)
+	{
+		scap_device* dev = &(devset->m_devs[j]);
+		if(dev->m_sn_len == 0 && dev->m_lastreadsize > 0)
+		{
+			ADVANCE_TAIL(dev);
+		}
+	}
+
+	while(n < max_evts)
+	{
+		uint64_t min_ts = 0xffffffffffffffffLL;
+		scap_evt* min_evt = NULL;
+		uint32_t min_dev = 0;
+
+		for(j = 0; j < ndevs; j++)
+		{
+			scap_device* dev = &(devset->m_devs[j]);
+			if(dev->m_sn_len == 0)
+			{
+				continue;
+			}
+
+			scap_evt* pe = NEXT_EVENT(dev);
+			if(pe->ts < min_ts)
+			{
+				if(pe->len > dev->m_sn_len)
+				{
+					snprintf(devset->m_lasterr, SCAP_LASTERR_SIZE, "scap_next buffer corruption");
+					ASSERT(false);
+					return SCAP_FAILURE;
+				}
+				min_ts = pe->ts;
+				min_evt = pe;
+				min_dev = j;
+			}
+		}
+
+		if(min_evt == NULL)
+		{
+			break;
+		}
+
+		ADVANCE_TO_EVT(&devset->m_devs[min_dev], min_evt);
+		evts[n].evt = min_evt;
+		evts[n].devid = (uint16_t)min_dev;
+		// we don't really store the flags in the ringbuffer anywhere
+		evts[n].flags = 0;
+		n++;
+	}
+
+	if(n == 0)
+	{
+		/* All the blocks are consumed and their tails already moved */
+		return refill_read_buffers(devset);
+	}
+
+	*nevts = n;
+	return SCAP_SUCCESS;
+}
+
+/* Used by the NUMA reader threads: move the events of the current block into
+ * the staging queue until the block or the queue are exhausted, then read a
+ * new block. Returns the number of staged events or `UINT32_MAX` on corruption.
+ */
+static inline uint32_t ringbuffer_stage_device(scap_device* dev, scap_staging_queue* queue)
+{
+	uint32_t n = 0;
+
+	if(dev->m_sn_len == 0)
+	{
+		if(dev->m_lastreadsize > 0)
+		{
+			ADVANCE_TAIL(dev);
+		}
+
+		/* Every event written before this point ends up in the new block */
+		uint64_t read_ns = staging_queue_now_ns();
+		if(READBUF(dev, &dev->m_sn_next_event, &dev->m_sn_len) != SCAP_SUCCESS)
+		{
+			return UINT32_MAX;
+		}
+		staging_queue_begin_block(queue, read_ns);
+	}
+
+	while(dev->m_sn_len > 0)
+	{
+		scap_evt* pe = NEXT_EVENT(dev);
+		if(pe->len > dev->m_sn_len)
+		{
+			ASSERT(false);
+			return UINT32_MAX;
+		}
+
+		if(!staging_queue_push(queue, pe))
+		{
+			break;
+		}
+		ADVANCE_TO_EVT(dev, pe);
+		n++;
+	}
+
+	if(dev->m_sn_len == 0)
+	{
+		staging_queue_set_drained(queue);
+	}
+
+	return n;
+}
+
+/* Used by the NUMA reader threads: discard everything available in the ring buffer */
+static inline void ringbuffer_flush_device(scap_device* dev)
+{
+	if(dev->m_lastreadsize > 0)
+	{
+		ADVANCE_TAIL(dev);
+	}
+
+	READBUF(dev, &dev->m_sn_next_event, &dev->m_sn_len);
+	dev->m_sn_len = 0;
+}
+
 static inline uint64_t ringbuffer_get_max_buf_used(struct scap_device_set *devset)
 {
 	uint64_t i;
@@ -232,6 +232,38 @@ int32_t scap_next(scap_t* handle, OUT scap_evt** pevent, OUT uint16_t* pdevid, O
 	return res;
 }
 
+int32_t scap_next_batch(scap_t* handle, OUT scap_batch_evt* evts, uint32_t max_evts, OUT uint32_t* nevts)
+{
+	int32_t res = SCAP_FAILURE;
+	*nevts = 0;
+
+	if(max_evts == 0)
+	{
+		return SCAP_SUCCESS;
+	}
+
+	if(handle->m_vtable == NULL)
+	{
+		ASSERT(false);
+		return SCAP_FAILURE;
+	}
+
+	if(handle->m_vtable->next_batch != NULL)
+	{
+		res = handle->m_vtable->next_batch(handle->m_engine, evts, max_evts, nevts);
+	}
+	else
+	{
+		// The event returned by next() is only valid until the next call,
+		// so without native support we can return only one event.
+		res = handle->m_vtable->next(handle->m_engine, &evts[0].evt, &evts[0].devid, &evts[0].flags);
+		*nevts = res == SCAP_SUCCESS ? 1 : 0;
+	}
+
+	handle->m_evtcnt += *nevts;
+	return res;
+}
+
 //
 // Return the number of dropped events for the given handle.
 //
@@ -359,6 +391,44 @@ int32_t scap_start_dropping_mode(scap_t* handle, uint32_t sampling_ratio)
 	return SCAP_FAILURE;
 }
 
+int32_t scap_set_sc_sampling_ratio(scap_t* handle, ppm_sc_code ppm_sc, uint32_t sampling_ratio)
+{
+	if (handle == NULL)
+	{
+		return SCAP_FAILURE;
+	}
+	if (ppm_sc >= PPM_SC_MAX)
+	{
+		snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "%s(%d) wrong param", __FUNCTION__, ppm_sc);
+		ASSERT(false);
+		return SCAP_FAILURE;
+	}
+
+	switch(sampling_ratio)
+	{
+		case 1:
+		case 2:
+		case 4:
+		case 8:
+		case 16:
+		case 32:
+		case 64:
+		case 128:
+			break;
+		default:
+			snprintf(handle->m_lasterr, SCAP_LASTERR_SIZE, "invalid sampling ratio size");
+			return SCAP_FAILURE;
+	}
+
+	if(handle->m_vtable)
+	{
+		return handle->m_vtable->configure(handle->m_engine, SCAP_SC_SAMPLING_RATIO, ppm_sc, sampling_ratio);
+	}
+
+	snprintf(handle->m_lasterr,	SCAP_LASTERR_SIZE, "operation not supported");
+	return SCAP_FAILURE;
+}
+
 int32_t scap_set_snaplen(scap_t* handle, uint32_t snaplen)
 {
 	if(handle->m_vtable)
@@ -457,6 +457,16 @@ struct scap_const_sized_buffer {
 };
 typedef struct scap_const_sized_buffer scap_const_sized_buffer;
 
+/*!
+  \brief An event returned by \ref scap_next_batch.
+*/
+typedef struct scap_batch_evt
+{
+	scap_evt* evt; ///< The event, owned by the engine.
+	uint16_t devid; ///< ID of the device where the event was captured.
+	uint32_t flags; ///< Flags of the event.
+}scap_batch_evt;
+
 /*@}*/
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -578,6 +588,21 @@ uint64_t scap_max_buf_used(scap_t* handle);
 */
 int32_t scap_next(scap_t* handle, OUT scap_evt** pevent, OUT uint16_t* pcpuid, OUT uint32_t* pflags);
 
+/*!
+  \brief Get up to max_evts events from the given capture instance
+
+  \param handle Handle to the capture instance.
+  \param evts User-provided array of at least max_evts entries that will be filled with the events.
+  \param max_evts Maximum number of events to return.
+  \param nevts User-provided pointer that will be initialized with the number of returned events.
+
+  \return SCAP_SUCCESS if at least one event has been returned, otherwise the same
+   codes of \ref scap_next. The events are not copied: they are owned by the engine
+   and stay valid until the next call to scap_next or scap_next_batch.
+   Engines that don't batch natively return one event per call.
+*/
+int32_t scap_next_batch(scap_t* handle, OUT scap_batch_evt* evts, uint32_t max_evts, OUT uint32_t* nevts);
+
 /*!
   \brief Get the length of an event
 
@@ -866,6 +891,19 @@ uint32_t scap_event_get_sentinel_begin(scap_evt* e);
 
 int32_t scap_stop_dropping_mode(scap_t* handle);
 int32_t scap_start_dropping_mode(scap_t* handle, uint32_t sampling_ratio);
+
+/*!
+  \brief Sample a single syscall in the driver, independently of the global dropping mode.
+  Only `1/sampling_ratio` of the events generated by the syscall will be
+  sent to userspace. Syscalls needed by the userspace state are never sampled.
+
+  \param handle Handle to the capture instance.
+  \param ppm_sc id of the syscall to sample.
+  \param sampling_ratio power of 2 (<= 128), 1 disables the sampling.
+  \note This function can only be called for live captures and it is
+  currently supported only by the modern BPF probe.
+*/
+int32_t scap_set_sc_sampling_ratio(scap_t* handle, ppm_sc_code ppm_sc, uint32_t sampling_ratio);
 int32_t scap_enable_dynamic_snaplen(scap_t* handle);
 int32_t scap_disable_dynamic_snaplen(scap_t* handle);
 uint64_t scap_ftell(scap_t *handle);
@@ -31,6 +31,7 @@ struct scap_stats;
 typedef struct scap scap_t;
 struct scap_stats_v2;
 typedef struct ppm_evt_hdr scap_evt;
+typedef struct scap_batch_evt scap_batch_evt;
 struct scap_proclist;
 
 enum scap_ppm_sc_mask_op {
@@ -81,6 +82,12 @@ enum scap_setting {
 	 * arg1: whether to enabled or disable the feature
 	 */
 	SCAP_DROP_FAILED,
+	/**
+	 * @brief per-syscall sampling ratio, applied even when dropping mode is disabled
+	 * arg1: ppm_sc id
+	 * arg2: sampling ratio (power of 2, <= 128), 1 disables the sampling
+	 */
+	SCAP_SC_SAMPLING_RATIO,
 };
 
 struct scap_savefile_vtable {
@@ -180,6 +187,21 @@ struct scap_vtable {
 	 */
 	int32_t (*next)(struct scap_engine_handle engine, scap_evt** pevent, uint16_t* pdevid, uint32_t* pflags);
 
+	/**
+	 * @brief fetch up to max_evts events at once (optional)
+	 * @param engine wraps the pointer to the engine-specific handle
+	 * @param evts [out] array of at least max_evts entries to fill
+	 * @param max_evts maximum number of events to return
+	 * @param nevts [out] number of events returned
+	 * @return SCAP_SUCCESS if at least one event was returned,
+	 *         otherwise the same codes of next()
+	 *
+	 * All the returned events must remain valid at least until the next
+	 * call to next() or next_batch(). Engines that don't implement it
+	 * are served one event at a time through next().
+	 */
+	int32_t (*next_batch)(struct scap_engine_handle engine, scap_batch_evt* evts, uint32_t max_evts, uint32_t* nevts);
+
 	/**
 	 * @brief start a capture
 	 * @param engine
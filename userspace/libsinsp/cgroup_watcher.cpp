@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/cgroup_watcher.h>
+
+#ifdef __linux__
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+libsinsp::cgroup_watcher::cgroup_watcher(uint64_t poll_interval_ns, bool use_inotify):
+	m_inotify_fd(-1),
+	m_poll_interval_ns(poll_interval_ns),
+	m_next_poll_ts(0)
+{
+#ifdef __linux__
+	if(use_inotify)
+	{
+		m_inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+	}
+#endif
+}
+
+libsinsp::cgroup_watcher::~cgroup_watcher()
+{
+#ifdef __linux__
+	if(m_inotify_fd >= 0)
+	{
+		close(m_inotify_fd);
+	}
+#endif
+}
+
+bool libsinsp::cgroup_watcher::watch(const std::string& dir)
+{
+#ifdef __linux__
+	if(m_dirs.find(dir) != m_dirs.end())
+	{
+		return true;
+	}
+
+	int wd = -1;
+	if(m_inotify_fd >= 0)
+	{
+		wd = inotify_add_watch(m_inotify_fd, dir.c_str(), IN_DELETE_SELF | IN_ONLYDIR);
+		if(wd < 0 && errno == ENOENT)
+		{
+			return false;
+		}
+
+		// the same inode reached through another path is polled
+		if(wd >= 0 && m_wds.find(wd) != m_wds.end())
+		{
+			wd = -1;
+		}
+	}
+
+	if(wd < 0)
+	{
+		struct stat st;
+		if(stat(dir.c_str(), &st) != 0 || !S_ISDIR(st.st_mode))
+		{
+			return false;
+		}
+	}
+	else
+	{
+		m_wds[wd] = dir;
+	}
+
+	m_dirs[dir] = wd;
+	return true;
+#else
+	return false;
+#endif
+}
+
+void libsinsp::cgroup_watcher::unwatch(const std::string& dir)
+{
+	auto it = m_dirs.find(dir);
+	if(it == m_dirs.end())
+	{
+		return;
+	}
+
+#ifdef __linux__
+	if(it->second >= 0)
+	{
+		inotify_rm_watch(m_inotify_fd, it->second);
+		m_wds.erase(it->second);
+	}
+#endif
+	m_dirs.erase(it);
+}
+
+bool libsinsp::cgroup_watcher::poll(uint64_t ts, std::vector<std::string>& removed)
+{
+	if(ts < m_next_poll_ts)
+	{
+		return false;
+	}
+	m_next_poll_ts = ts + m_poll_interval_ns;
+
+#ifdef __linux__
+	if(m_inotify_fd >= 0)
+	{
+		alignas(struct inotify_event) char buf[4096];
+		ssize_t len;
+		while((len = read(m_inotify_fd, buf, sizeof(buf))) > 0)
+		{
+			for(char* p = buf; p < buf + len;)
+			{
+				auto ev = reinterpret_cast<const struct inotify_event*>(p);
+				p += sizeof(struct inotify_event) + ev->len;
+
+				// IN_IGNORED also follows our own inotify_rm_watch(),
+				// that descriptor is not in the map anymore
+				if((ev->mask & (IN_DELETE_SELF | IN_IGNORED)) == 0)
+				{
+					continue;
+				}
+
+				auto wd = m_wds.find(ev->wd);
+				if(wd != m_wds.end())
+				{
+					removed.push_back(wd->second);
+					m_dirs.erase(wd->second);
+					m_wds.erase(wd);
+				}
+			}
+		}
+	}
+
+	for(auto it = m_dirs.begin(); it != m_dirs.end();)
+	{
+		struct stat st;
+		if(it->second < 0 && stat(it->first.c_str(), &st) != 0 && errno == ENOENT)
+		{
+			removed.push_back(it->first);
+			it = m_dirs.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+#endif
+	return true;
+}
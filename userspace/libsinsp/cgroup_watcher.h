@@ -0,0 +1,83 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libsinsp
+{
+
+/**
+ * \brief Notices the removal of cgroup directories
+ *
+ * Directories are watched with inotify when possible. When inotify is not
+ * available, e.g. when the watch limit has been reached, directories are
+ * checked for existence every poll interval instead. Not thread safe.
+ */
+class cgroup_watcher
+{
+public:
+	explicit cgroup_watcher(uint64_t poll_interval_ns, bool use_inotify = true);
+	~cgroup_watcher();
+
+	cgroup_watcher(const cgroup_watcher&) = delete;
+	cgroup_watcher& operator=(const cgroup_watcher&) = delete;
+
+	/**
+	 * \brief Start watching a directory, e.g. /sys/fs/cgroup/memory/docker/<id>
+	 * @return false if the directory does not exist
+	 */
+	bool watch(const std::string& dir);
+
+	void unwatch(const std::string& dir);
+
+	/**
+	 * \brief Collect the watched directories removed since the last call
+	 *
+	 * The check happens at most once every poll interval of event time,
+	 * calling this for every event is cheap. Removed directories are
+	 * not watched anymore.
+	 * @return false if no check was due
+	 */
+	bool poll(uint64_t ts, std::vector<std::string>& removed);
+
+	inline size_t get_num_watched() const
+	{
+		return m_dirs.size();
+	}
+
+	inline bool using_inotify() const
+	{
+		return m_inotify_fd >= 0;
+	}
+
+private:
+	int m_inotify_fd;
+	uint64_t m_poll_interval_ns;
+	uint64_t m_next_poll_ts;
+
+	// watch descriptor of each directory, -1 when polled
+	std::unordered_map<std::string, int> m_dirs;
+	std::unordered_map<int, std::string> m_wds;
+};
+
+}
@@ -37,9 +37,151 @@ limitations under the License.
 #include <libsinsp/container.h>
 #include <libsinsp/utils.h>
 #include <libsinsp/sinsp_observer.h>
+#if !defined(_WIN32) && !defined(__APPLE__)
+#include <libsinsp/sinsp_cgroup.h>
+#include <fstream>
+#include <sys/stat.h>
+#endif
 
 using namespace libsinsp;
 
+namespace {
+
+const std::string persisted_container_prefix = "container:";
+const std::string persisted_boot_id_key = "boot_id";
+
+// The directory of the first cgroup of the set that names the container
+std::string container_cgroup_dir(const sinsp_cgroup_set_pool::cgroups_t& cgroups, const std::string& container_id)
+{
+#if !defined(_WIN32) && !defined(__APPLE__)
+	for(const auto& it : cgroups)
+	{
+		if(it.second.find(container_id) == std::string::npos)
+		{
+			continue;
+		}
+
+		int version;
+		auto root = sinsp_cgroup::instance().lookup_cgroup_dir(it.first, version);
+		if(root != nullptr)
+		{
+			return *root + it.second;
+		}
+	}
+#endif
+	return "";
+}
+
+// A cgroup removed and created again under the same path, e.g. when a
+// container is restarted, gets a new inode: cgroupfs allocates them
+// cyclically, and with a generation on recent kernels. Unlike the change
+// time, the inode stays the same when child cgroups are created.
+bool stat_cgroup_dir(const std::string& dir, uint64_t& ino)
+{
+#if !defined(_WIN32) && !defined(__APPLE__)
+	struct stat st;
+	if(stat(dir.c_str(), &st) != 0)
+	{
+		return false;
+	}
+	ino = st.st_ino;
+	return true;
+#else
+	return false;
+#endif
+}
+
+// The cgroup inodes are only unique until the host reboots
+std::string read_boot_id()
+{
+#if !defined(_WIN32) && !defined(__APPLE__)
+	std::ifstream f(std::string(scap_get_host_root()) + "/proc/sys/kernel/random/boot_id");
+	std::string boot_id;
+	std::getline(f, boot_id);
+	return boot_id;
+#else
+	return "";
+#endif
+}
+
+// inode, directory length, directory, container json
+std::string encode_persisted_container(const std::string& dir, uint64_t ino, const std::string& json)
+{
+	uint32_t dir_len = dir.size();
+	std::string value;
+	value.reserve(sizeof(uint64_t) + sizeof(uint32_t) + dir.size() + json.size());
+	value.append((const char*)&ino, sizeof(ino));
+	value.append((const char*)&dir_len, sizeof(dir_len));
+	value.append(dir);
+	value.append(json);
+	return value;
+}
+
+bool decode_persisted_container(const std::string& value, std::string& dir, uint64_t& ino, std::string& json)
+{
+	const size_t header_len = sizeof(uint64_t) + sizeof(uint32_t);
+	uint32_t dir_len;
+	if(value.size() < header_len)
+	{
+		return false;
+	}
+	memcpy(&ino, value.data(), sizeof(ino));
+	memcpy(&dir_len, value.data() + sizeof(uint64_t), sizeof(dir_len));
+	if(value.size() < header_len + dir_len)
+	{
+		return false;
+	}
+	dir = value.substr(header_len, dir_len);
+	json = value.substr(header_len + dir_len);
+	return true;
+}
+
+std::string generate_error_message(const Json::Value& value, const char* field) {
+	std::string val_as_string = value.isConvertibleTo(Json::stringValue) ? value.asString().c_str() : "value not convertible to string";
+	std::string err_msg = "Unable to convert json value '" + val_as_string + "' for the field: '" + field +"'";
+
+	return err_msg;
+}
+
+bool check_int64_json_is_convertible(const Json::Value& value, const char* field) {
+	if(!value.isNull())
+	{
+		// isConvertibleTo doesn't seem to work on large 64 bit numbers
+		if(value.isInt64()) {
+			return true;
+		} else {
+			std::string err_msg = generate_error_message(value, field);
+			SINSP_DEBUG("%s",err_msg.c_str());
+		}
+	}
+	return false;
+}
+
+bool check_json_val_is_convertible(const Json::Value& value, Json::ValueType other, const char* field, bool log_message=false)
+{
+	if(value.isNull()) {
+		return false;
+	}
+
+	if(!value.isConvertibleTo(other)) {
+		std::string err_msg;
+
+		if(log_message) {
+			err_msg = generate_error_message(value, field);
+			SINSP_WARNING("%s",err_msg.c_str());
+		} else {
+			if(libsinsp_logger()->get_severity() >= sinsp_logger::SEV_DEBUG) {
+				err_msg = generate_error_message(value, field);
+				SINSP_DEBUG("%s",err_msg.c_str());
+			}
+		}
+		return false;
+	}
+	return true;
+}
+
+}
+
 sinsp_container_manager::sinsp_container_manager(sinsp* inspector, bool static_container, const std::string static_id, const std::string static_name, const std::string static_image) :
 	m_last_flush_time_ns(0),
 	m_inspector(inspector),
@@ -47,7 +189,9 @@ sinsp_container_manager::sinsp_container_manager(sinsp* inspector, bool static_c
 	m_static_id(static_id),
 	m_static_name(static_name),
 	m_static_image(static_image),
-	m_container_engine_mask(~0ULL)
+	m_container_engine_mask(~0ULL),
+	m_n_cgroup_resolution_hits(0),
+	m_n_restored_containers(0)
 {
 }
 
@@ -106,6 +250,11 @@ bool sinsp_container_manager::remove_inactive_containers()
 				{
 					remove_cb(*container);
 				}
+				if(m_persistent_cache != nullptr)
+				{
+					m_persistent_cache->erase(persisted_container_prefix + it->first);
+				}
+				m_persisted_cgroups.erase(it->first);
 				containers->erase(it++);
 			}
 			else
@@ -148,6 +297,14 @@ bool sinsp_container_manager::resolve_container(sinsp_threadinfo* tinfo, bool qu
 		create_engines();
 	}
 
+	// the observer may want to see every thread
+	bool use_cache = m_cgroup_watcher != nullptr && !m_inspector->get_observer();
+	if(use_cache && lookup_cgroup_resolution(tinfo))
+	{
+		identify_category(tinfo);
+		return !tinfo->m_container_id.empty();
+	}
+
 	for(auto &eng : m_container_engines)
 	{
 		matches = matches || eng->resolve(tinfo, query_os_for_missing_info);
@@ -157,12 +314,303 @@ bool sinsp_container_manager::resolve_container(sinsp_threadinfo* tinfo, bool qu
 		}
 	}
 
+	if(use_cache && query_os_for_missing_info)
+	{
+		store_cgroup_resolution(tinfo, matches);
+	}
+
+	if(m_persistent_cache != nullptr)
+	{
+		track_persisted_container(tinfo);
+	}
+
 	// Also possibly set the category for the threadinfo
 	identify_category(tinfo);
 
 	return matches;
 }
 
+bool sinsp_container_manager::lookup_cgroup_resolution(sinsp_threadinfo* tinfo)
+{
+	const auto& set = tinfo->get_cgroup_set();
+	if(set == nullptr)
+	{
+		return false;
+	}
+
+	auto it = m_cgroup_resolutions.find(set.get());
+	if(it == m_cgroup_resolutions.end())
+	{
+		return false;
+	}
+
+	// the address may have belonged to a set that went away
+	if(it->second.m_set.lock() != set)
+	{
+		erase_cgroup_resolution(it);
+		return false;
+	}
+
+	if(!it->second.m_container_id.empty())
+	{
+		auto container = get_container(it->second.m_container_id);
+		if(container == nullptr || !container->is_successful())
+		{
+			erase_cgroup_resolution(it);
+			return false;
+		}
+	}
+
+	tinfo->m_container_id = it->second.m_container_id;
+	m_n_cgroup_resolution_hits++;
+	return true;
+}
+
+void sinsp_container_manager::store_cgroup_resolution(sinsp_threadinfo* tinfo, bool matches)
+{
+	const auto& set = tinfo->get_cgroup_set();
+	if(set == nullptr || m_static_container)
+	{
+		return;
+	}
+
+	cgroup_resolution res;
+	res.m_set = set;
+	res.m_container_id = tinfo->m_container_id;
+
+	if(res.m_container_id.empty())
+	{
+		// rkt and mesos also look at the root and environment of the
+		// thread, that might be in one of their containers anyway
+		if(matches ||
+		   m_container_engine_by_type.find(CT_RKT) != m_container_engine_by_type.end() ||
+		   m_container_engine_by_type.find(CT_MESOS) != m_container_engine_by_type.end())
+		{
+			return;
+		}
+	}
+	else
+	{
+		// only cache complete metadata, the engines still have work
+		// to do otherwise
+		auto container = get_container(res.m_container_id);
+		if(!matches || container == nullptr || !container->is_successful() ||
+		   container->m_type == CT_RKT || container->m_type == CT_MESOS)
+		{
+			return;
+		}
+
+		std::string dir = container_cgroup_dir(*set, res.m_container_id);
+		if(!dir.empty())
+		{
+			uint32_t& refs = m_cgroup_dir_refs[dir];
+			if(refs > 0 || m_cgroup_watcher->watch(dir))
+			{
+				refs++;
+				res.m_dir = std::move(dir);
+			}
+			else
+			{
+				m_cgroup_dir_refs.erase(dir);
+			}
+		}
+	}
+
+	auto it = m_cgroup_resolutions.find(set.get());
+	if(it != m_cgroup_resolutions.end())
+	{
+		erase_cgroup_resolution(it);
+	}
+	m_cgroup_resolutions.emplace(set.get(), std::move(res));
+}
+
+sinsp_container_manager::cgroup_resolution_map_t::iterator sinsp_container_manager::erase_cgroup_resolution(cgroup_resolution_map_t::iterator it)
+{
+	const std::string& dir = it->second.m_dir;
+	if(!dir.empty())
+	{
+		auto refs = m_cgroup_dir_refs.find(dir);
+		if(refs != m_cgroup_dir_refs.end() && --refs->second == 0)
+		{
+			m_cgroup_watcher->unwatch(dir);
+			m_cgroup_dir_refs.erase(refs);
+		}
+	}
+	return m_cgroup_resolutions.erase(it);
+}
+
+void sinsp_container_manager::purge_cgroup_resolutions(uint64_t ts)
+{
+	std::vector<std::string> removed;
+	if(!m_cgroup_watcher->poll(ts, removed))
+	{
+		return;
+	}
+
+	for(const auto& dir : removed)
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
+				"cgroup directory %s removed, dropping its cached containers",
+				dir.c_str());
+
+		// the watch went away with the directory
+		m_cgroup_dir_refs.erase(dir);
+	}
+
+	for(auto it = m_cgroup_resolutions.begin(); it != m_cgroup_resolutions.end();)
+	{
+		cgroup_resolution& res = it->second;
+		if(!res.m_dir.empty() && m_cgroup_dir_refs.find(res.m_dir) == m_cgroup_dir_refs.end())
+		{
+			it = m_cgroup_resolutions.erase(it);
+		}
+		else if(res.m_set.expired())
+		{
+			it = erase_cgroup_resolution(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void sinsp_container_manager::set_cgroup_watch(bool enable, uint64_t poll_interval_ns)
+{
+	m_cgroup_resolutions.clear();
+	m_cgroup_dir_refs.clear();
+	m_cgroup_watcher.reset();
+	if(enable)
+	{
+		m_cgroup_watcher = std::make_unique<libsinsp::cgroup_watcher>(poll_interval_ns);
+	}
+}
+
+void sinsp_container_manager::set_persistent_cache(const std::shared_ptr<libsinsp::persistent_cache>& cache)
+{
+	m_persistent_cache = cache;
+	m_persisted_cgroups.clear();
+}
+
+void sinsp_container_manager::load_persistent_cache()
+{
+	if(m_persistent_cache == nullptr)
+	{
+		return;
+	}
+
+	// after a reboot none of the saved containers is running anymore
+	std::string boot_id = read_boot_id();
+	std::string saved_boot_id;
+	bool same_boot = !boot_id.empty() &&
+		m_persistent_cache->get(persisted_boot_id_key, saved_boot_id) &&
+		saved_boot_id == boot_id;
+	m_persistent_cache->put(persisted_boot_id_key, boot_id);
+
+	std::vector<std::string> stale;
+	std::vector<sinsp_container_info::ptr_t> restored;
+	m_persistent_cache->foreach_entry(persisted_container_prefix, [&](const std::string& key, const std::string& value)
+	{
+		persisted_cgroup cg;
+		std::string json;
+		uint64_t ino;
+		auto container = std::make_shared<sinsp_container_info>();
+		bool valid = false;
+		try
+		{
+			valid = same_boot &&
+				decode_persisted_container(value, cg.m_dir, cg.m_ino, json) &&
+				stat_cgroup_dir(cg.m_dir, ino) &&
+				ino == cg.m_ino &&
+				container_from_json(json, *container) &&
+				container->is_successful() &&
+				key.compare(persisted_container_prefix.size(), std::string::npos, container->m_id) == 0;
+		}
+		catch(const sinsp_exception& e)
+		{
+			valid = false;
+		}
+
+		if(!valid)
+		{
+			stale.push_back(key);
+			return true;
+		}
+
+		m_persisted_cgroups[container->m_id] = std::move(cg);
+		restored.push_back(std::move(container));
+		return true;
+	});
+
+	for(const auto& key : stale)
+	{
+		m_persistent_cache->erase(key);
+	}
+
+	for(const auto& container : restored)
+	{
+		add_container(container, nullptr);
+	}
+	m_n_restored_containers += restored.size();
+
+	libsinsp_logger()->format(sinsp_logger::SEV_INFO,
+			"Restored %zu containers from %s, dropped %zu stopped or restarted ones",
+			restored.size(), m_persistent_cache->get_path().c_str(), stale.size());
+}
+
+void sinsp_container_manager::track_persisted_container(sinsp_threadinfo* tinfo)
+{
+	const std::string& container_id = tinfo->m_container_id;
+	if(container_id.empty() || m_persisted_cgroups.find(container_id) != m_persisted_cgroups.end())
+	{
+		return;
+	}
+
+	// containers whose directory can't be found are remembered with an
+	// empty one, so it's looked for only once
+	persisted_cgroup cg = {"", 0};
+	const auto& set = tinfo->get_cgroup_set();
+	if(set != nullptr)
+	{
+		cg.m_dir = container_cgroup_dir(*set, container_id);
+		if(!cg.m_dir.empty() && !stat_cgroup_dir(cg.m_dir, cg.m_ino))
+		{
+			cg.m_dir.clear();
+		}
+	}
+	m_persisted_cgroups.emplace(container_id, std::move(cg));
+	persist_container(container_id);
+}
+
+void sinsp_container_manager::persist_container(const std::string& container_id)
+{
+	if(m_persistent_cache == nullptr)
+	{
+		return;
+	}
+
+	auto it = m_persisted_cgroups.find(container_id);
+	if(it == m_persisted_cgroups.end() || it->second.m_dir.empty())
+	{
+		return;
+	}
+
+	auto container = get_container(container_id);
+	if(container == nullptr || !container->is_successful())
+	{
+		return;
+	}
+
+	// the environment can hold secrets, the restored containers go
+	// without it
+	sinsp_container_info persisted = *container;
+	persisted.m_env.clear();
+
+	const persisted_cgroup& cg = it->second;
+	m_persistent_cache->put(persisted_container_prefix + container_id,
+				encode_persisted_container(cg.m_dir, cg.m_ino, container_to_json(persisted)));
+}
+
 std::string sinsp_container_manager::container_to_json(const sinsp_container_info& container_info)
 {
 	Json::Value obj;
@@ -261,6 +709,223 @@ std::string sinsp_container_manager::container_to_json(const sinsp_container_inf
 	return Json::FastWriter().write(obj);
 }
 
+bool sinsp_container_manager::container_from_json(const std::string& json, sinsp_container_info& container_info) const
+{
+	Json::Value root;
+	if(!Json::Reader().parse(json, root))
+	{
+		return false;
+	}
+
+	const Json::Value& container = root["container"];
+	const Json::Value& id = container["id"];
+	if(check_json_val_is_convertible(id, Json::stringValue, "id"))
+	{
+		container_info.m_id = id.asString();
+	}
+	const Json::Value& full_id = container["full_id"];
+	if(check_json_val_is_convertible(full_id, Json::stringValue, "full_id"))
+	{
+		container_info.m_full_id = full_id.asString();
+	}
+	const Json::Value& type = container["type"];
+	if(check_json_val_is_convertible(type, Json::uintValue, "type"))
+	{
+		container_info.m_type = static_cast<sinsp_container_type>(type.asUInt());
+	}
+	const Json::Value& name = container["name"];
+	if(check_json_val_is_convertible(name, Json::stringValue, "name"))
+	{
+		container_info.m_name = name.asString();
+	}
+
+	const Json::Value& is_pod_sandbox = container["is_pod_sandbox"];
+	if(check_json_val_is_convertible(is_pod_sandbox, Json::booleanValue, "is_pod_sandbox"))
+	{
+		container_info.m_is_pod_sandbox = is_pod_sandbox.asBool();
+	}
+
+	const Json::Value& image = container["image"];
+	if(check_json_val_is_convertible(image, Json::stringValue, "image"))
+	{
+		container_info.m_image = image.asString();
+	}
+	const Json::Value& imageid = container["imageid"];
+	if(check_json_val_is_convertible(imageid, Json::stringValue, "imageid"))
+	{
+		container_info.m_imageid = imageid.asString();
+	}
+	const Json::Value& imagerepo = container["imagerepo"];
+	if(check_json_val_is_convertible(imagerepo, Json::stringValue, "imagerepo"))
+	{
+		container_info.m_imagerepo = imagerepo.asString();
+	}
+	const Json::Value& imagetag = container["imagetag"];
+	if(check_json_val_is_convertible(imagetag, Json::stringValue, "imagetag"))
+	{
+		container_info.m_imagetag = imagetag.asString();
+	}
+	const Json::Value& imagedigest = container["imagedigest"];
+	if(check_json_val_is_convertible(imagedigest, Json::stringValue, "imagedigest"))
+	{
+		container_info.m_imagedigest = imagedigest.asString();
+	}
+	const Json::Value& privileged = container["privileged"];
+	if(check_json_val_is_convertible(privileged, Json::booleanValue, "privileged"))
+	{
+		container_info.m_privileged = privileged.asBool();
+	}
+	const Json::Value& lookup_state = container["lookup_state"];
+	if(check_json_val_is_convertible(lookup_state, Json::uintValue, "lookup_state"))
+	{
+		container_info.set_lookup_status(static_cast<sinsp_container_lookup::state>(lookup_state.asUInt()));
+		switch(container_info.get_lookup_status())
+		{
+		case sinsp_container_lookup::state::STARTED:
+		case sinsp_container_lookup::state::SUCCESSFUL:
+		case sinsp_container_lookup::state::FAILED:
+			break;
+		default:
+			container_info.set_lookup_status(sinsp_container_lookup::state::SUCCESSFUL);
+		}
+	}
+
+	const Json::Value& created_time = container["created_time"];
+	if(check_int64_json_is_convertible(created_time, "created_time"))
+	{
+		container_info.m_created_time = created_time.asInt64();
+	}
+
+#if !defined(MINIMAL_BUILD) && !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+	libsinsp::container_engine::docker_async_source::parse_json_mounts(container["Mounts"], container_info.m_mounts);
+#endif
+
+	const Json::Value& user = container["User"];
+	if(check_json_val_is_convertible(user, Json::stringValue, "User"))
+	{
+		container_info.m_container_user = user.asString();
+	}
+
+	sinsp_container_info::container_health_probe::parse_health_probes(container, container_info.m_health_probes);
+
+	const Json::Value& contip = container["ip"];
+	if(check_json_val_is_convertible(contip, Json::stringValue, "ip"))
+	{
+		uint32_t ip;
+
+		if(inet_pton(AF_INET, contip.asString().c_str(), &ip) == -1)
+		{
+			throw sinsp_exception("Invalid 'ip' field while parsing container info: " + json);
+		}
+
+		container_info.m_container_ip = ntohl(ip);
+	}
+
+	const Json::Value& cniresult = container["cni_json"];
+	if(check_json_val_is_convertible(cniresult, Json::stringValue, "cni_json"))
+	{
+		container_info.m_pod_cniresult = cniresult.asString();
+	}
+
+	const Json::Value &port_mappings = container["port_mappings"];
+
+	if(check_json_val_is_convertible(port_mappings, Json::arrayValue, "port_mappings"))
+	{
+		for (Json::Value::ArrayIndex i = 0; i != port_mappings.size(); i++)
+		{
+			sinsp_container_info::container_port_mapping map;
+			const Json::Value &host_ip = port_mappings[i]["HostIp"];
+			// We log message for HostIp conversion failure at Warning level
+			if(check_json_val_is_convertible(host_ip, Json::intValue, "HostIp", true)) {
+				map.m_host_ip = host_ip.asInt();
+			}
+			const Json::Value& host_port = port_mappings[i]["HostPort"];
+			// We log message for HostPort conversion failure at Warning level
+			if(check_json_val_is_convertible(host_port, Json::intValue, "HostPort", true)) {
+				map.m_host_port = (uint16_t) host_port.asInt();
+			}
+			const Json::Value& container_port = port_mappings[i]["ContainerPort"];
+			// We log message for ContainerPort conversion failure at Warning level
+			if(check_json_val_is_convertible(container_port, Json::intValue, "ContainerPort", true)) {
+				map.m_container_port = (uint16_t) container_port.asInt();
+			}
+			container_info.m_port_mappings.push_back(map);
+		}
+	}
+
+	std::vector<std::string> labels = container["labels"].getMemberNames();
+	for(std::vector<std::string>::const_iterator it = labels.begin(); it != labels.end(); ++it)
+	{
+		std::string val = container["labels"][*it].asString();
+		container_info.m_labels[*it] = val;
+	}
+
+	const Json::Value& env_vars = container["env"];
+
+	for(const auto& env_var : env_vars)
+	{
+		if(env_var.isString())
+		{
+			container_info.m_env.emplace_back(env_var.asString());
+		}
+	}
+
+	const Json::Value& memory_limit = container["memory_limit"];
+	if(check_int64_json_is_convertible(memory_limit, "memory_limit"))
+	{
+		container_info.m_memory_limit = memory_limit.asInt64();
+	}
+
+	const Json::Value& swap_limit = container["swap_limit"];
+	if(check_int64_json_is_convertible(swap_limit, "swap_limit"))
+	{
+		container_info.m_swap_limit = swap_limit.asInt64();
+	}
+
+	const Json::Value& cpu_shares = container["cpu_shares"];
+	if(check_int64_json_is_convertible(cpu_shares, "cpu_shares"))
+	{
+		container_info.m_cpu_shares = cpu_shares.asInt64();
+	}
+
+	const Json::Value& cpu_quota = container["cpu_quota"];
+	if(check_int64_json_is_convertible(cpu_quota, "cpu_quota"))
+	{
+		container_info.m_cpu_quota = cpu_quota.asInt64();
+	}
+
+	const Json::Value& cpu_period = container["cpu_period"];
+	if(check_int64_json_is_convertible(cpu_period, "cpu_period"))
+	{
+		container_info.m_cpu_period = cpu_period.asInt64();
+	}
+
+	const Json::Value& cpuset_cpu_count = container["cpuset_cpu_count"];
+	if(check_json_val_is_convertible(cpuset_cpu_count, Json::intValue, "cpuset_cpu_count"))
+	{
+		container_info.m_cpuset_cpu_count = cpuset_cpu_count.asInt();
+	}
+
+	const Json::Value& mesos_task_id = container["mesos_task_id"];
+	if(check_json_val_is_convertible(mesos_task_id, Json::stringValue, "mesos_task_id"))
+	{
+		container_info.m_mesos_task_id = mesos_task_id.asString();
+	}
+
+	const Json::Value& metadata_deadline = container["metadata_deadline"];
+	if(!metadata_deadline.isNull())
+	{
+		// isConvertibleTo doesn't seem to work on large 64 bit numbers
+		if(metadata_deadline.isUInt64()) {
+			container_info.m_metadata_deadline = metadata_deadline.asUInt64();
+		} else {
+			SINSP_DEBUG("Unable to convert json value for field: %s", "metadata_deadline");
+		}
+	}
+
+	return true;
+}
+
 bool sinsp_container_manager::container_to_sinsp_event(const std::string& json, sinsp_evt* evt, std::shared_ptr<sinsp_threadinfo> tinfo)
 {
 	size_t totlen = sizeof(scap_evt) + sizeof(uint32_t) + json.length() + 1;
@@ -311,13 +976,19 @@ void sinsp_container_manager::add_container(const sinsp_container_info::ptr_t& c
 	{
 		new_cb(*container_info, thread);
 	}
+
+	persist_container(container_info->m_id);
 }
 
 void sinsp_container_manager::replace_container(const sinsp_container_info::ptr_t& container_info)
 {
-	auto containers = m_containers.lock();
-	ASSERT(containers->find(container_info->m_id) != containers->end());
-	(*containers)[container_info->m_id] = container_info;
+	{
+		auto containers = m_containers.lock();
+		ASSERT(containers->find(container_info->m_id) != containers->end());
+		(*containers)[container_info->m_id] = container_info;
+	}
+
+	persist_container(container_info->m_id);
 }
 
 void sinsp_container_manager::notify_new_container(const sinsp_container_info& container_info, sinsp_threadinfo *tinfo)
@@ -668,6 +1339,13 @@ void sinsp_container_manager::set_query_docker_image_info(bool query_image_info)
 #endif
 }
 
+void sinsp_container_manager::set_docker_max_in_flight(uint32_t max_in_flight)
+{
+#if !defined(MINIMAL_BUILD) && !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+	libsinsp::container_engine::docker_async_source::set_max_lookups_in_flight(max_in_flight);
+#endif
+}
+
 void sinsp_container_manager::set_cri_extra_queries(bool extra_queries)
 {
 #if !defined(MINIMAL_BUILD) && !defined(__EMSCRIPTEN__)
@@ -696,6 +1374,13 @@ void sinsp_container_manager::set_cri_timeout(int64_t timeout_ms)
 #endif
 }
 
+void sinsp_container_manager::set_cri_max_in_flight(uint32_t max_in_flight)
+{
+#if !defined(MINIMAL_BUILD) && !defined(__EMSCRIPTEN__)
+	libsinsp::container_engine::cri::set_max_in_flight(max_in_flight);
+#endif
+}
+
 void sinsp_container_manager::set_cri_async(bool async)
 {
 #if !defined(MINIMAL_BUILD) && !defined(__EMSCRIPTEN__)
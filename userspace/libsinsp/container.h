@@ -36,7 +36,10 @@ limitations under the License.
 #include <libsinsp/container_engine/container_cache_interface.h>
 #include <libsinsp/container_engine/container_engine_base.h>
 #include <libsinsp/container_engine/sinsp_container_type.h>
+#include <libsinsp/cgroup_watcher.h>
 #include <libsinsp/mutex.h>
+#include <libsinsp/persistent_cache.h>
+#include <libsinsp/sinsp_cgroup_set.h>
 
 class sinsp_dumper;
 
@@ -177,14 +180,84 @@ public:
 
 	void set_docker_socket_path(std::string socket_path);
 	void set_query_docker_image_info(bool query_image_info);
+	void set_docker_max_in_flight(uint32_t max_in_flight);
 	void set_cri_extra_queries(bool extra_queries);
 	void set_cri_socket_path(const std::string& path);
 	void add_cri_socket_path(const std::string &path);
 	void set_cri_timeout(int64_t timeout_ms);
+	void set_cri_max_in_flight(uint32_t max_in_flight);
 	void set_cri_async(bool async);
 	void set_container_labels_max_len(uint32_t max_label_len);
 	sinsp* get_inspector() { return m_inspector; }
 
+	/**
+	 * \brief Resolve containers once per cgroup set
+	 * @param enable whether to enable the resolution cache
+	 * @param poll_interval_ns how often removed cgroup directories are
+	 *        looked for, in event time
+	 *
+	 * When enabled, the container of a thread whose cgroup set has already
+	 * been resolved to a container with complete metadata (or to no
+	 * container at all) is found with a single hash lookup instead of
+	 * going through the container engines. The cgroup directories of the
+	 * cached containers are watched and their entries are dropped when
+	 * they go away, so a container restarted under the same cgroup is
+	 * resolved again.
+	 *
+	 * Containers of the rkt and mesos engines, whose detection depends on
+	 * more than the cgroups of the thread, are never cached, and threads
+	 * out of containers are only cached when those engines are disabled.
+	 */
+	void set_cgroup_watch(bool enable, uint64_t poll_interval_ns);
+
+	/**
+	 * \brief Apply the removals of watched cgroup directories
+	 */
+	inline void process_cgroup_events(uint64_t ts)
+	{
+		if(m_cgroup_watcher != nullptr)
+		{
+			purge_cgroup_resolutions(ts);
+		}
+	}
+
+	inline size_t get_num_cgroup_resolutions() const
+	{
+		return m_cgroup_resolutions.size();
+	}
+
+	inline uint64_t get_n_cgroup_resolution_hits() const
+	{
+		return m_n_cgroup_resolution_hits;
+	}
+
+	/**
+	 * \brief Save the metadata of the running containers in a local cache
+	 * @param cache the cache, nullptr to stop saving
+	 *
+	 * Every container is saved together with the identity of its cgroup
+	 * directory once both its complete metadata and one of its threads
+	 * are known, and removed when the container goes away. Its
+	 * environment is not saved.
+	 */
+	void set_persistent_cache(const std::shared_ptr<libsinsp::persistent_cache>& cache);
+
+	/**
+	 * \brief Add the containers saved in the persistent cache
+	 *
+	 * Only the containers whose cgroup directory is still the one seen
+	 * when they were saved, since the same boot, are added. The others
+	 * either stopped or were restarted and are dropped from the cache. Meant to be called before
+	 * scanning /proc, so the threads of the restored containers don't need
+	 * any lookup.
+	 */
+	void load_persistent_cache();
+
+	inline uint64_t get_n_restored_containers() const
+	{
+		return m_n_restored_containers;
+	}
+
 	/**
 	 * \brief set the status of an async container metadata lookup
 	 * @param container_id the container id we're looking up
@@ -232,12 +305,38 @@ public:
 	}
 	uint64_t m_last_flush_time_ns;
 	std::string container_to_json(const sinsp_container_info& container_info);
+	bool container_from_json(const std::string& json, sinsp_container_info& container_info) const;
 
 
 private:
 	bool container_to_sinsp_event(const std::string& json, sinsp_evt* evt, std::shared_ptr<sinsp_threadinfo> tinfo);
 	std::string get_docker_env(const Json::Value &env_vars, const std::string &mti);
 
+	using cgroup_set_t = libsinsp::sinsp_cgroup_set_pool::cgroups_t;
+
+	struct cgroup_resolution
+	{
+		std::weak_ptr<const cgroup_set_t> m_set;
+		std::string m_container_id;
+		// watched cgroup directory, empty if none
+		std::string m_dir;
+	};
+	using cgroup_resolution_map_t = std::unordered_map<const cgroup_set_t*, cgroup_resolution>;
+
+	bool lookup_cgroup_resolution(sinsp_threadinfo* tinfo);
+	void store_cgroup_resolution(sinsp_threadinfo* tinfo, bool matches);
+	cgroup_resolution_map_t::iterator erase_cgroup_resolution(cgroup_resolution_map_t::iterator it);
+	void purge_cgroup_resolutions(uint64_t ts);
+
+	struct persisted_cgroup
+	{
+		std::string m_dir;
+		uint64_t m_ino;
+	};
+
+	void track_persisted_container(sinsp_threadinfo* tinfo);
+	void persist_container(const std::string& container_id);
+
 	std::list<std::shared_ptr<libsinsp::container_engine::container_engine_base>> m_container_engines;
 	std::map<sinsp_container_type, std::shared_ptr<libsinsp::container_engine::container_engine_base>> m_container_engine_by_type;
 
@@ -255,5 +354,16 @@ private:
 	std::string m_static_name;
 	std::string m_static_image;
 	uint64_t m_container_engine_mask;
+
+	// resolution cache, keyed by the shared cgroup set of the threads
+	std::unique_ptr<libsinsp::cgroup_watcher> m_cgroup_watcher;
+	cgroup_resolution_map_t m_cgroup_resolutions;
+	std::unordered_map<std::string, uint32_t> m_cgroup_dir_refs;
+	uint64_t m_n_cgroup_resolution_hits;
+
+	std::shared_ptr<libsinsp::persistent_cache> m_persistent_cache;
+	// cgroup directory of the containers to persist, by container id
+	std::unordered_map<std::string, persisted_cgroup> m_persisted_cgroups;
+	uint64_t m_n_restored_containers;
 };
 
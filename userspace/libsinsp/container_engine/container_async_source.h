@@ -21,6 +21,12 @@ limitations under the License.
 #include <libsinsp/async/async_key_value_source.h>
 #include <libsinsp/container_info.h>
 #include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
 
 namespace libsinsp
 {
@@ -42,7 +48,7 @@ class container_async_source : public libsinsp::async_key_value_source<key_type,
 
 public:
 	container_async_source(uint64_t max_wait_ms, uint64_t ttl_ms, container_cache_interface* cache);
-	virtual ~container_async_source() {}
+	virtual ~container_async_source();
 
 	// convenience method with default callback
 	bool lookup(const key_type& key, sinsp_container_info& value);
@@ -55,6 +61,22 @@ public:
 
 	void source_callback(const key_type& key, const sinsp_container_info& res);
 
+	/**
+	 * Look up to `max_in_flight` ready requests concurrently (default 1),
+	 * on a pool of as many worker threads. parse() must be thread safe
+	 * when this is more than one. Call it before the first lookup.
+	 */
+	void set_max_in_flight(uint32_t max_in_flight)
+	{
+		m_max_in_flight = max_in_flight > 0 ? max_in_flight : 1;
+	}
+
+	/**
+	 * Stop the async thread and the workers. Derived classes must call
+	 * it in their destructor, since the workers call parse().
+	 */
+	void stop();
+
 protected:
 	virtual const char* name() const = 0;
 
@@ -67,6 +89,20 @@ protected:
 
 private:
 	void run_impl() override;
+	void run_worker();
+	void handle_result(const key_type& key, sinsp_container_info& res);
+
+	uint32_t m_max_in_flight = 1;
+
+	// Requests handed to the workers. The async thread only takes a
+	// request from the queue when a worker is free, so that the others
+	// stay subject to the ttl.
+	std::mutex m_workers_mtx;
+	std::condition_variable m_workers_cv;
+	std::vector<std::thread> m_workers;
+	std::deque<std::pair<key_type, sinsp_container_info>> m_work;
+	size_t m_in_flight = 0;
+	bool m_stopping = false;
 };
 
 } // namespace container_engine
@@ -33,6 +33,38 @@ container_async_source<key_type>::container_async_source(uint64_t max_wait_ms, u
 {
 }
 
+template<typename key_type>
+container_async_source<key_type>::~container_async_source()
+{
+	stop();
+}
+
+template<typename key_type>
+void container_async_source<key_type>::stop()
+{
+	{
+		std::lock_guard<std::mutex> lock(m_workers_mtx);
+		m_stopping = true;
+	}
+	m_workers_cv.notify_all();
+
+	// the async thread is the only one starting workers, and it's not
+	// running anymore after this
+	parent_type::stop();
+	for(auto& worker : m_workers)
+	{
+		worker.join();
+	}
+
+	// requests handed to the workers but not started yet are dropped,
+	// like the ones still in the queue
+	std::lock_guard<std::mutex> lock(m_workers_mtx);
+	m_workers.clear();
+	m_work.clear();
+	m_in_flight = 0;
+	m_stopping = false;
+}
+
 template<typename key_type>
 bool container_async_source<key_type>::lookup(const key_type& key,
 					      sinsp_container_info& value)
@@ -93,49 +125,111 @@ void container_async_source<key_type>::run_impl()
 	key_type key;
 	sinsp_container_info res;
 
-	while(this->dequeue_next_key(key, &res))
+	while(true)
 	{
+		if(m_max_in_flight > 1)
+		{
+			// Wait for a free worker before taking the next request
+			std::unique_lock<std::mutex> lock(m_workers_mtx);
+			while(m_workers.size() < m_max_in_flight)
+			{
+				m_workers.emplace_back(&container_async_source::run_worker, this);
+			}
+			m_workers_cv.wait(lock, [this] { return m_stopping || m_in_flight < m_workers.size(); });
+			if(m_stopping)
+			{
+				break;
+			}
+		}
+
+		if(!this->dequeue_next_key(key, &res))
+		{
+			break;
+		}
+
 		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 				"%s_async (%s): Source dequeued key attempt=%u",
 				name(),
 				container_id(key).c_str(),
 				res.m_lookup.retry_no());
 
-		lookup_sync(key, res);
-
-		if(!res.m_lookup.should_retry())
+		if(m_max_in_flight > 1)
 		{
-			// Either the fetch was successful or the
-			// maximum number of retries have occurred.
-			if(!res.m_lookup.is_successful())
-			{
-				libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
-						"%s_async (%s): Could not look up container info after %u retries",
-						name(),
-						container_id(key).c_str(),
-						res.m_lookup.retry_no());
-			}
-
-			this->store_value(key, res);
+			// Requests that are ready together, e.g. the containers
+			// of a rollout, are looked up concurrently
+			std::lock_guard<std::mutex> lock(m_workers_mtx);
+			m_work.emplace_back(key, res);
+			m_in_flight++;
+			m_workers_cv.notify_all();
 		}
 		else
 		{
-			// Make a new attempt
-			res.m_lookup.attempt_increment();
+			lookup_sync(key, res);
+			handle_result(key, res);
+		}
+
+		// Reset res
+		res.clear();
+	}
+}
+
+template<typename key_type>
+void container_async_source<key_type>::run_worker()
+{
+	std::unique_lock<std::mutex> lock(m_workers_mtx);
+	while(true)
+	{
+		m_workers_cv.wait(lock, [this] { return m_stopping || !m_work.empty(); });
+		if(m_stopping)
+		{
+			return;
+		}
+
+		auto item = std::move(m_work.front());
+		m_work.pop_front();
+		lock.unlock();
+
+		lookup_sync(item.first, item.second);
+		handle_result(item.first, item.second);
+
+		lock.lock();
+		m_in_flight--;
+		m_workers_cv.notify_all();
+	}
+}
 
+template<typename key_type>
+void container_async_source<key_type>::handle_result(const key_type& key, sinsp_container_info& res)
+{
+	if(!res.m_lookup.should_retry())
+	{
+		// Either the fetch was successful or the
+		// maximum number of retries have occurred.
+		if(!res.m_lookup.is_successful())
+		{
 			libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
-					"%s_async (%s): lookup retry no. %d",
+					"%s_async (%s): Could not look up container info after %u retries",
 					name(),
 					container_id(key).c_str(),
 					res.m_lookup.retry_no());
-
-			this->defer_lookup(key,
-					   &res,
-					   std::chrono::milliseconds(res.m_lookup.delay()));
 		}
 
-		// Reset res
-		res.clear();
+		this->store_value(key, res);
+	}
+	else
+	{
+		// Make a new attempt
+		res.m_lookup.attempt_increment();
+
+		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
+				"%s_async (%s): lookup retry no. %d",
+				name(),
+				container_id(key).c_str(),
+				res.m_lookup.retry_no());
+
+		this->defer_lookup(key,
+				   &res,
+				   std::chrono::milliseconds(res.m_lookup.delay()));
 	}
 }
 
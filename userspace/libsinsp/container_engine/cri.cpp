@@ -139,6 +139,11 @@ void cri::set_cri_timeout(int64_t timeout_ms)
 	libsinsp::cri::cri_settings::set_cri_timeout(timeout_ms);
 }
 
+void cri::set_max_in_flight(uint32_t max_in_flight)
+{
+	libsinsp::cri::cri_settings::set_cri_max_in_flight(max_in_flight);
+}
+
 void cri::set_extra_queries(bool extra_queries) {
 	libsinsp::cri::cri_settings::set_cri_extra_queries(extra_queries);
 }
@@ -220,6 +225,7 @@ bool cri::resolve(sinsp_threadinfo *tinfo, bool query_os_for_missing_info)
 			uint64_t max_wait_ms = 20000;
 			auto async_source =
 				new cri_async_source(cache, m_cri_v1alpha2.get(), m_cri_v1.get(), max_wait_ms);
+			async_source->set_max_in_flight(libsinsp::cri::cri_settings::get_cri_max_in_flight());
 			m_async_source = std::unique_ptr<cri_async_source>(async_source);
 		}
 
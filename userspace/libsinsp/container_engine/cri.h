@@ -56,7 +56,7 @@ public:
 	}
 
 	void quiesce() {
-		async_key_value_source::stop();
+		stop();
 	}
 
 	bool parse(const key_type& key, sinsp_container_info& container) override;
@@ -97,6 +97,7 @@ public:
 	static void set_cri_socket_path(const std::string& path);
 	static void add_cri_socket_path(const std::string& path);
 	static void set_cri_timeout(int64_t timeout_ms);
+	static void set_max_in_flight(uint32_t max_in_flight);
 	static void set_extra_queries(bool extra_queries);
 	static void set_async(bool async_limits);
 
@@ -26,12 +26,15 @@ limitations under the License.
 using namespace libsinsp::container_engine;
 
 bool docker_async_source::m_query_image_info = true;
+uint32_t docker_async_source::m_max_lookups_in_flight = 4;
 
 docker_async_source::docker_async_source(uint64_t max_wait_ms,
 					 uint64_t ttl_ms,
 					 container_cache_interface *cache)
 	: container_async_source(max_wait_ms, ttl_ms, cache)
 {
+	set_max_in_flight(m_max_lookups_in_flight);
+	m_connection.set_max_idle(m_max_lookups_in_flight);
 }
 
 docker_async_source::~docker_async_source()
@@ -335,6 +338,15 @@ void docker_async_source::set_query_image_info(bool query_image_info)
 	m_query_image_info = query_image_info;
 }
 
+void docker_async_source::set_max_lookups_in_flight(uint32_t max_in_flight)
+{
+	libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
+			"docker_async: Setting max_lookups_in_flight=%u",
+			max_in_flight);
+
+	m_max_lookups_in_flight = max_in_flight > 0 ? max_in_flight : 1;
+}
+
 void docker_async_source::fetch_image_info(const docker_lookup_request& request, sinsp_container_info& container)
 {
 	Json::Reader reader;
@@ -367,7 +379,7 @@ void docker_async_source::fetch_image_info(const docker_lookup_request& request,
 			img_json.c_str());
 
 	Json::Value img_root;
-	if(!reader.parse(img_json, img_root))
+	if(!reader.parse(img_json.data(), img_json.data() + img_json.size(), img_root, false))
 	{
 		libsinsp_logger()->format(sinsp_logger::SEV_ERROR,
 				"docker_async (%s) image (%s): Could not parse json image info \"%s\"",
@@ -436,7 +448,7 @@ void docker_async_source::fetch_image_info_from_list(const docker_lookup_request
 			img_json.c_str());
 
 	Json::Value img_root;
-	if(!reader.parse(img_json, img_root))
+	if(!reader.parse(img_json.data(), img_json.data() + img_json.size(), img_root, false))
 	{
 		libsinsp_logger()->format(sinsp_logger::SEV_ERROR,
 				"docker_async (%s): Could not parse json image list \"%s\"",
@@ -690,7 +702,8 @@ bool docker_async_source::parse(const docker_lookup_request& request, sinsp_cont
 
 	Json::Value root;
 	Json::Reader reader;
-	bool parsingSuccessful = reader.parse(json, root);
+	// parse in place, the std::string overload copies the whole response
+	bool parsingSuccessful = reader.parse(json.data(), json.data() + json.size(), root, false);
 	if(!parsingSuccessful)
 	{
 		libsinsp_logger()->format(sinsp_logger::SEV_ERROR,
@@ -21,6 +21,9 @@ public:
 
 	static void parse_json_mounts(const Json::Value &mnt_obj, std::vector<sinsp_container_info::container_mount_info> &mounts);
 	static void set_query_image_info(bool query_image_info);
+	// How many containers can be looked up concurrently, each over its
+	// own connection to the API socket
+	static void set_max_lookups_in_flight(uint32_t max_in_flight);
 
 private:
 	bool parse(const docker_lookup_request& key, sinsp_container_info& container) override;
@@ -91,6 +94,7 @@ private:
 
 	docker_connection m_connection;
 	static bool m_query_image_info;
+	static uint32_t m_max_lookups_in_flight;
 };
 
 
@@ -6,13 +6,21 @@
 #include <curl/multi.h>
 #endif
 
+#include <memory>
+#include <mutex>
 #include <string>
+#include <unordered_map>
+#include <vector>
 
 #include <libsinsp/container_engine/docker/lookup_request.h>
 
 namespace libsinsp {
 namespace container_engine {
 
+// Connection to the docker (or podman) API. Requests can be issued from
+// several threads at once: each one borrows a curl handle from a pool kept
+// per socket, and gives it back when done, so the HTTP/1.1 connection it
+// holds stays open for the next request on the same socket.
 class docker_connection {
 public:
 	enum docker_response {
@@ -30,14 +38,38 @@ public:
 
 	void set_api_version(const std::string& api_version)
 	{
+		std::lock_guard<std::mutex> lk(m_mtx);
 		m_api_version = api_version;
 	}
 
+	// How many idle connections are kept open per socket
+	void set_max_idle(uint32_t max_idle)
+	{
+		std::lock_guard<std::mutex> lk(m_mtx);
+		m_max_idle = max_idle;
+	}
+
 private:
+	std::mutex m_mtx;
 	std::string m_api_version;
+	uint32_t m_max_idle = 1;
 
 #if !defined(_WIN32) && !defined(__EMSCRIPTEN__) && !defined(MINIMAL_BUILD)
-	CURLM *m_curlm;
+	// The connections are cached by the multi handle, so it goes
+	// back to the pool together with the easy handle
+	struct handle
+	{
+		handle();
+		~handle();
+
+		CURLM *m_curlm;
+		CURL *m_curl;
+	};
+
+	std::unique_ptr<handle> acquire(const std::string& docker_path);
+	void release(const std::string& docker_path, std::unique_ptr<handle> h);
+
+	std::unordered_map<std::string, std::vector<std::unique_ptr<handle>>> m_idle;
 #endif
 };
 
@@ -34,31 +34,79 @@ size_t docker_curl_write_callback(const char *ptr, size_t size, size_t nmemb, st
 
 using namespace libsinsp::container_engine;
 
-docker_connection::docker_connection():
-	m_api_version("/v1.24"),
-	m_curlm(nullptr)
+docker_connection::handle::handle():
+	m_curlm(curl_multi_init()),
+	m_curl(curl_easy_init())
 {
-	m_curlm = curl_multi_init();
-
 	if(m_curlm)
 	{
 		curl_multi_setopt(m_curlm, CURLMOPT_PIPELINING, CURLPIPE_HTTP1|CURLPIPE_MULTIPLEX);
 	}
 }
 
-docker_connection::~docker_connection()
+docker_connection::handle::~handle()
 {
+	if(m_curlm && m_curl)
+	{
+		curl_multi_remove_handle(m_curlm, m_curl);
+	}
+	if(m_curl)
+	{
+		curl_easy_cleanup(m_curl);
+	}
 	if(m_curlm)
 	{
 		curl_multi_cleanup(m_curlm);
-		m_curlm = NULL;
+	}
+}
+
+docker_connection::docker_connection():
+	m_api_version("/v1.24")
+{
+}
+
+docker_connection::~docker_connection()
+{
+}
+
+std::unique_ptr<docker_connection::handle> docker_connection::acquire(const std::string& docker_path)
+{
+	{
+		std::lock_guard<std::mutex> lk(m_mtx);
+		auto it = m_idle.find(docker_path);
+		if(it != m_idle.end() && !it->second.empty())
+		{
+			std::unique_ptr<handle> h = std::move(it->second.back());
+			it->second.pop_back();
+			// options are cleared, the open connection is kept
+			curl_easy_reset(h->m_curl);
+			return h;
+		}
+	}
+
+	std::unique_ptr<handle> h(new handle());
+	if(!h->m_curlm || !h->m_curl)
+	{
+		return nullptr;
+	}
+	return h;
+}
+
+void docker_connection::release(const std::string& docker_path, std::unique_ptr<handle> h)
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+	auto& idle = m_idle[docker_path];
+	if(idle.size() < m_max_idle)
+	{
+		idle.push_back(std::move(h));
 	}
 }
 
 docker_connection::docker_response docker_connection::get_docker(const docker_lookup_request& request, const std::string& req_url, std::string &json)
 {
-	CURL* curl = curl_easy_init();
-	if(!curl)
+	auto docker_path = scap_get_host_root() + request.docker_socket;
+	std::unique_ptr<handle> h = acquire(docker_path);
+	if(!h)
 	{
 		libsinsp_logger()->format(sinsp_logger::SEV_WARNING,
 				"docker_async (%s): Failed to initialize curl handle",
@@ -66,26 +114,32 @@ docker_connection::docker_response docker_connection::get_docker(const docker_lo
 		return docker_response::RESP_ERROR;
 	}
 
-	auto docker_path = scap_get_host_root() + request.docker_socket;
+	CURL* curl = h->m_curl;
+	CURLM* curlm = h->m_curlm;
 	curl_easy_setopt(curl, CURLOPT_HTTPGET, 1);
 	curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1);
 	curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, docker_curl_write_callback);
 	curl_easy_setopt(curl, CURLOPT_UNIX_SOCKET_PATH, docker_path.c_str());
 	curl_easy_setopt(curl, CURLOPT_TIMEOUT, 5);
 
-	std::string url = "http://localhost" + m_api_version + req_url;
+	std::string url;
+	{
+		std::lock_guard<std::mutex> lk(m_mtx);
+		url = "http://localhost" + m_api_version + req_url;
+	}
 
 	libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 			"docker_async (%s): Fetching url",
 			url.c_str());
 
+	// on errors the handle is dropped instead of going back to the
+	// pool, as its connection may be in any state
 	if(curl_easy_setopt(curl, CURLOPT_URL, url.c_str()) != CURLE_OK)
 	{
 		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 				"docker_async (%s): curl_easy_setopt(CURLOPT_URL) failed",
 				url.c_str());
 
-		curl_easy_cleanup(curl);
 		ASSERT(false);
 		return docker_response::RESP_ERROR;
 	}
@@ -94,17 +148,15 @@ docker_connection::docker_response docker_connection::get_docker(const docker_lo
 		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 				"docker_async (%s): curl_easy_setopt(CURLOPT_WRITEDATA) failed",
 				url.c_str());
-		curl_easy_cleanup(curl);
 		ASSERT(false);
 		return docker_response::RESP_ERROR;
 	}
 
-	if(curl_multi_add_handle(m_curlm, curl) != CURLM_OK)
+	if(curl_multi_add_handle(curlm, curl) != CURLM_OK)
 	{
 		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 				"docker_async (%s): curl_multi_add_handle() failed",
 				url.c_str());
-		curl_easy_cleanup(curl);
 		ASSERT(false);
 		return docker_response::RESP_ERROR;
 	}
@@ -113,15 +165,13 @@ docker_connection::docker_response docker_connection::get_docker(const docker_lo
 	while(true)
 	{
 		int still_running;
-		CURLMcode res = curl_multi_perform(m_curlm, &still_running);
+		CURLMcode res = curl_multi_perform(curlm, &still_running);
 		if(res != CURLM_OK)
 		{
 			libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 					"docker_async (%s): curl_multi_perform() failed",
 					url.c_str());
 
-			curl_multi_remove_handle(m_curlm, curl);
-			curl_easy_cleanup(curl);
 			ASSERT(false);
 			return docker_response::RESP_ERROR;
 		}
@@ -132,15 +182,13 @@ docker_connection::docker_response docker_connection::get_docker(const docker_lo
 		}
 
 		int numfds;
-		res = curl_multi_wait(m_curlm, NULL, 0, 1000, &numfds);
+		res = curl_multi_wait(curlm, NULL, 0, 1000, &numfds);
 		if(res != CURLM_OK)
 		{
 			libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 					"docker_async (%s): curl_multi_wait() failed",
 					url.c_str());
 
-			curl_multi_remove_handle(m_curlm, curl);
-			curl_easy_cleanup(curl);
 			ASSERT(false);
 			return docker_response::RESP_ERROR;
 		}
@@ -161,13 +209,12 @@ docker_connection::docker_response docker_connection::get_docker(const docker_lo
 		}
 	}
 
-	if(curl_multi_remove_handle(m_curlm, curl) != CURLM_OK)
+	if(curl_multi_remove_handle(curlm, curl) != CURLM_OK)
 	{
 		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 				"docker_async (%s): curl_multi_remove_handle() failed",
 				url.c_str());
 
-		curl_easy_cleanup(curl);
 		ASSERT(false);
 		return docker_response::RESP_ERROR;
 	}
@@ -179,12 +226,11 @@ docker_connection::docker_response docker_connection::get_docker(const docker_lo
 				"docker_async (%s): curl_easy_getinfo(CURLINFO_RESPONSE_CODE) failed",
 				url.c_str());
 
-		curl_easy_cleanup(curl);
 		ASSERT(false);
 		return docker_response::RESP_ERROR;
 	}
 
-	curl_easy_cleanup(curl);
+	release(docker_path, std::move(h));
 	libsinsp_logger()->format(sinsp_logger::SEV_DEBUG,
 			"docker_async (%s): http_code=%ld",
 			url.c_str(), http_code);
@@ -214,4 +260,3 @@ docker_connection::docker_response docker_connection::get_docker(const docker_lo
 
 	return docker_response::RESP_OK;
 }
-
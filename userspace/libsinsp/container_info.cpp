@@ -157,6 +157,7 @@ std::shared_ptr<sinsp_threadinfo> sinsp_container_info::get_tinfo(sinsp* inspect
 	tinfo->m_vpid = -2;
 	tinfo->m_comm = "container:" + m_id;
 	tinfo->m_exe = "container:" + m_id;
+	tinfo->update_derived_strings();
 	tinfo->m_container_id = m_id;
 
 	return tinfo;
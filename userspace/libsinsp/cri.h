@@ -18,9 +18,14 @@ limitations under the License.
 
 #pragma once
 
+#include <chrono>
+#include <condition_variable>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <string>
+#include <unordered_map>
 
 #ifndef MINIMAL_BUILD
 #include <libsinsp/cri-v1alpha2.pb.h>
@@ -118,6 +123,16 @@ public:
 		get().m_cri_unix_socket_paths.clear();
 	}
 
+	static const uint32_t& get_cri_max_in_flight()
+	{
+		return get().m_cri_max_in_flight;
+	}
+
+	static void set_cri_max_in_flight(const uint32_t& v)
+	{
+		get().m_cri_max_in_flight = v;
+	}
+
 private:
 	static std::unique_ptr<cri_settings> s_instance;
 
@@ -130,6 +145,143 @@ private:
 	sinsp_container_type m_cri_runtime_type;
 	std::string m_cri_unix_socket_path;
 	bool m_cri_extra_queries;
+	uint32_t m_cri_max_in_flight;
+};
+
+/**
+ * @brief Entries of a CRI list call, e.g. image references to image ids,
+ * shared by the lookups of all the containers. A lookup of a missing entry
+ * fetches the whole list again, at most once per `min_refresh`. The list
+ * call runs without the lock, and the lookups missing an entry while it
+ * runs wait for its result.
+ */
+class cri_list_cache
+{
+public:
+	using map_type = std::unordered_map<std::string, std::string>;
+
+	// fills the map with a list call, returns false if it failed
+	using fetch_type = std::function<bool(map_type &)>;
+
+	explicit cri_list_cache(std::chrono::steady_clock::duration min_refresh):
+		m_min_refresh(min_refresh)
+	{
+	}
+
+	bool get(const std::string &key, std::string &value, const fetch_type &fetch)
+	{
+		std::unique_lock<std::mutex> lock(m_mtx);
+		if(find(key, value))
+		{
+			return true;
+		}
+
+		if(m_refreshing)
+		{
+			m_refreshed_cv.wait(lock, [this] { return !m_refreshing; });
+			return find(key, value);
+		}
+
+		auto now = std::chrono::steady_clock::now();
+		if(m_fetched && now - m_fetch_ts < m_min_refresh)
+		{
+			return false;
+		}
+		m_fetched = true;
+		m_fetch_ts = now;
+		m_refreshing = true;
+		lock.unlock();
+
+		map_type entries;
+		bool ok = fetch(entries);
+
+		lock.lock();
+		if(ok)
+		{
+			m_entries.swap(entries);
+		}
+		m_refreshing = false;
+		m_refreshed_cv.notify_all();
+		return find(key, value);
+	}
+
+private:
+	bool find(const std::string &key, std::string &value) const
+	{
+		auto it = m_entries.find(key);
+		if(it == m_entries.end())
+		{
+			return false;
+		}
+		value = it->second;
+		return true;
+	}
+
+	const std::chrono::steady_clock::duration m_min_refresh;
+	std::mutex m_mtx;
+	std::condition_variable m_refreshed_cv;
+	map_type m_entries;
+	std::chrono::steady_clock::time_point m_fetch_ts;
+	bool m_fetched = false;
+	bool m_refreshing = false;
+};
+
+/**
+ * @brief Responses reused for `ttl` by the lookups of all the containers,
+ * e.g. the pod sandbox status shared by the containers of a pod. When
+ * full, the expired entries are dropped, or all of them if none is.
+ */
+template<typename value_type>
+class cri_ttl_cache
+{
+public:
+	cri_ttl_cache(std::chrono::steady_clock::duration ttl, size_t max_entries):
+		m_ttl(ttl),
+		m_max_entries(max_entries)
+	{
+	}
+
+	bool get(const std::string &key, value_type &value)
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		auto it = m_entries.find(key);
+		if(it == m_entries.end() || std::chrono::steady_clock::now() - it->second.first >= m_ttl)
+		{
+			return false;
+		}
+		value = it->second.second;
+		return true;
+	}
+
+	void put(const std::string &key, const value_type &value)
+	{
+		auto now = std::chrono::steady_clock::now();
+		std::lock_guard<std::mutex> lock(m_mtx);
+		if(m_entries.size() >= m_max_entries)
+		{
+			for(auto it = m_entries.begin(); it != m_entries.end();)
+			{
+				it = now - it->second.first >= m_ttl ? m_entries.erase(it) : std::next(it);
+			}
+			if(m_entries.size() >= m_max_entries)
+			{
+				m_entries.clear();
+			}
+		}
+		m_entries[key] = std::make_pair(now, value);
+	}
+
+	size_t size()
+	{
+		std::lock_guard<std::mutex> lock(m_mtx);
+		return m_entries.size();
+	}
+
+private:
+	const std::chrono::steady_clock::duration m_ttl;
+	const size_t m_max_entries;
+	std::mutex m_mtx;
+	std::unordered_map<std::string, std::pair<std::chrono::steady_clock::time_point, value_type>> m_entries;
 };
 
 class cri_api_v1alpha2
@@ -348,9 +500,20 @@ public:
 private:
 	bool parse_containerd(const typename api::ContainerStatusResponse &status, sinsp_container_info &container);
 
+	// Unfiltered list calls filling the caches below
+	bool list_image_ids(cri_list_cache::map_type &image_ids);
+	bool list_container_pods(cri_list_cache::map_type &container_pods);
+
 	std::unique_ptr<typename api::RuntimeService::Stub> m_cri;
 	std::unique_ptr<typename api::ImageService::Stub> m_cri_image;
 	sinsp_container_type m_cri_runtime_type;
+
+	// Image ids and pod sandboxes are shared by many containers: they
+	// come from a single list call for all of them, and pod sandbox
+	// statuses are reused for a while. Lookups can run concurrently.
+	cri_list_cache m_image_ids;
+	cri_list_cache m_container_pods;
+	cri_ttl_cache<typename api::PodSandboxStatusResponse> m_pod_sandboxes;
 };
 
 using cri_interface_v1alpha2 = cri_interface<cri_api_v1alpha2>;
@@ -35,6 +35,14 @@ template<typename api> bool pod_uses_host_netns(const typename api::PodSandboxSt
 	const auto netns = resp.status().linux().namespaces().options().network();
 	return netns == api::NamespaceMode::NODE;
 }
+
+// a lookup of an unknown image or container fetches the whole list again
+// at most this often, otherwise it falls back to a filtered list call
+constexpr auto CRI_LIST_MIN_REFRESH = std::chrono::seconds(1);
+
+// the containers of a pod are usually created together
+constexpr auto CRI_POD_SANDBOX_TTL = std::chrono::seconds(10);
+constexpr size_t CRI_POD_SANDBOX_MAX = 1024;
 } // namespace
 
 namespace libsinsp
@@ -43,7 +51,10 @@ namespace cri
 {
 
 template<typename api> 
-inline cri_interface<api>::cri_interface(const std::string &cri_path)
+inline cri_interface<api>::cri_interface(const std::string &cri_path):
+	m_image_ids(CRI_LIST_MIN_REFRESH),
+	m_container_pods(CRI_LIST_MIN_REFRESH),
+	m_pod_sandboxes(CRI_POD_SANDBOX_TTL, CRI_POD_SANDBOX_MAX)
 {
 	std::shared_ptr<grpc::Channel> channel = libsinsp::grpc_channel_registry::get_channel("unix://" + cri_path);
 
@@ -536,6 +547,12 @@ template<typename api>
 inline void cri_interface<api>::get_pod_sandbox_resp(const std::string &pod_sandbox_id,
 					      typename api::PodSandboxStatusResponse &resp, grpc::Status &status)
 {
+	if(m_pod_sandboxes.get(pod_sandbox_id, resp))
+	{
+		status = grpc::Status::OK;
+		return;
+	}
+
 	typename api::PodSandboxStatusRequest req;
 	req.set_pod_sandbox_id(pod_sandbox_id);
 	req.set_verbose(true);
@@ -543,6 +560,14 @@ inline void cri_interface<api>::get_pod_sandbox_resp(const std::string &pod_sand
 	auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(cri_settings::get_cri_timeout());
 	context.set_deadline(deadline);
 	status = m_cri->PodSandboxStatus(&context, req, &resp);
+
+	// a sandbox still setting up its network is asked for again
+	if(!status.ok() || (resp.status().network().ip().empty() && !pod_uses_host_netns<api>(resp)))
+	{
+		return;
+	}
+
+	m_pod_sandboxes.put(pod_sandbox_id, resp);
 }
 
 template<typename api> 
@@ -577,45 +602,58 @@ inline void cri_interface<api>::get_container_ip(const std::string &container_id
 {
 	container_ip = 0;
 	cniresult = "";
-	typename api::ListContainersRequest req;
-	typename api::ListContainersResponse resp;
-	auto filter = req.mutable_filter();
-	filter->set_id(container_id);
-	grpc::ClientContext context;
-	auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(cri_settings::get_cri_timeout());
-	context.set_deadline(deadline);
-	grpc::Status lstatus = m_cri->ListContainers(&context, req, &resp);
 
-	switch(resp.containers_size())
-	{
-	case 0:
-		libsinsp_logger()->format(sinsp_logger::SEV_WARNING, "Container id %s not in list from CRI",
-				container_id.c_str());
-		ASSERT(false);
-		break;
-	case 1:
+	std::string pod_sandbox_id;
+	if(!m_container_pods.get(container_id, pod_sandbox_id,
+				 [this](cri_list_cache::map_type &pods) { return list_container_pods(pods); }))
 	{
-		const auto &cri_container = resp.containers(0);
-		typename api::PodSandboxStatusResponse resp_pod;
-		grpc::Status status_pod;
-		get_pod_sandbox_resp(cri_container.pod_sandbox_id(), resp_pod, status_pod);
-		if(status_pod.ok())
+		typename api::ListContainersRequest req;
+		typename api::ListContainersResponse resp;
+		auto filter = req.mutable_filter();
+		filter->set_id(container_id);
+		grpc::ClientContext context;
+		auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(cri_settings::get_cri_timeout());
+		context.set_deadline(deadline);
+		grpc::Status lstatus = m_cri->ListContainers(&context, req, &resp);
+
+		switch(resp.containers_size())
 		{
-			container_ip = ntohl(get_pod_sandbox_ip(resp_pod));
-			get_pod_info_cniresult(resp_pod, cniresult);
+		case 0:
+			libsinsp_logger()->format(sinsp_logger::SEV_WARNING, "Container id %s not in list from CRI",
+					container_id.c_str());
+			ASSERT(false);
+			return;
+		case 1:
+			pod_sandbox_id = resp.containers(0).pod_sandbox_id();
+			break;
+		default:
+			libsinsp_logger()->format(sinsp_logger::SEV_WARNING, "Container id %s matches more than once in list from CRI",
+					container_id.c_str());
+			ASSERT(false);
+			return;
 		}
 	}
-	default:
-		libsinsp_logger()->format(sinsp_logger::SEV_WARNING, "Container id %s matches more than once in list from CRI",
-				container_id.c_str());
-		ASSERT(false);
-		break;
+
+	typename api::PodSandboxStatusResponse resp_pod;
+	grpc::Status status_pod;
+	get_pod_sandbox_resp(pod_sandbox_id, resp_pod, status_pod);
+	if(status_pod.ok())
+	{
+		container_ip = ntohl(get_pod_sandbox_ip(resp_pod));
+		get_pod_info_cniresult(resp_pod, cniresult);
 	}
 }
 
-template<typename api> 
+template<typename api>
 inline std::string cri_interface<api>::get_container_image_id(const std::string &image_ref)
 {
+	std::string image_id;
+	if(m_image_ids.get(image_ref, image_id,
+			   [this](cri_list_cache::map_type &image_ids) { return list_image_ids(image_ids); }))
+	{
+		return image_id;
+	}
+
 	typename api::ListImagesRequest req;
 	typename api::ListImagesResponse resp;
 	auto filter = req.mutable_filter();
@@ -647,6 +685,64 @@ inline std::string cri_interface<api>::get_container_image_id(const std::string
 	return "";
 }
 
+template<typename api>
+inline bool cri_interface<api>::list_image_ids(cri_list_cache::map_type &image_ids)
+{
+	typename api::ListImagesRequest req;
+	typename api::ListImagesResponse resp;
+	grpc::ClientContext context;
+	auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(cri_settings::get_cri_timeout());
+	context.set_deadline(deadline);
+	grpc::Status status = m_cri_image->ListImages(&context, req, &resp);
+	if(!status.ok())
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG, "cri: ListImages failed: %s",
+				status.error_message().c_str());
+		return false;
+	}
+
+	// images can be referred to by id, tag or digest
+	for(const auto &image : resp.images())
+	{
+		image_ids[image.id()] = image.id();
+		for(const auto &tag : image.repo_tags())
+		{
+			image_ids[tag] = image.id();
+		}
+		for(const auto &digest : image.repo_digests())
+		{
+			image_ids[digest] = image.id();
+		}
+	}
+	return true;
+}
+
+template<typename api>
+inline bool cri_interface<api>::list_container_pods(cri_list_cache::map_type &container_pods)
+{
+	typename api::ListContainersRequest req;
+	typename api::ListContainersResponse resp;
+	grpc::ClientContext context;
+	auto deadline = std::chrono::system_clock::now() + std::chrono::milliseconds(cri_settings::get_cri_timeout());
+	context.set_deadline(deadline);
+	grpc::Status status = m_cri->ListContainers(&context, req, &resp);
+	if(!status.ok())
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_DEBUG, "cri: ListContainers failed: %s",
+				status.error_message().c_str());
+		return false;
+	}
+
+	// containers are usually looked up by their reported, truncated id,
+	// that the filtered list call would match as a prefix
+	for(const auto &container : resp.containers())
+	{
+		container_pods[container.id()] = container.pod_sandbox_id();
+		container_pods[container.id().substr(0, 12)] = container.pod_sandbox_id();
+	}
+	return true;
+}
+
 template<typename api>
 inline bool cri_interface<api>::parse_containerd(const typename api::ContainerStatusResponse &status,
 					  sinsp_container_info &container)
@@ -766,7 +862,12 @@ inline bool cri_interface<api>::parse(const libsinsp::cgroup_limits::cgroup_limi
 	if(!parse_containerd(resp, container))
 	{
 		libsinsp::cgroup_limits::cgroup_limits_value limits;
-		libsinsp::cgroup_limits::get_cgroup_resource_limits(key, limits);
+		{
+			// the cgroup mount lookups are not thread safe
+			static std::mutex s_limits_mtx;
+			std::lock_guard<std::mutex> lock(s_limits_mtx);
+			libsinsp::cgroup_limits::get_cgroup_resource_limits(key, limits);
+		}
 
 		container.m_memory_limit = limits.m_memory_limit;
 		container.m_cpu_shares = limits.m_cpu_shares;
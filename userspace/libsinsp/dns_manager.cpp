@@ -199,3 +199,202 @@ void sinsp_dns_manager::cleanup()
 		m_exit_signal = std::promise<void>();
 	}
 }
+
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+static ipv6addr reverse_dns_key(int af, const void* addr)
+{
+	ipv6addr key;
+	if(af == AF_INET)
+	{
+		key.m_b[0] = 0;
+		key.m_b[1] = 0;
+		key.m_b[2] = htonl(0x0000ffff);
+		memcpy(&key.m_b[3], addr, sizeof(uint32_t));
+	}
+	else
+	{
+		memcpy(key.m_b, addr, sizeof(ipv6addr));
+	}
+	return key;
+}
+#endif
+
+std::string sinsp_reverse_dns_manager::resolve(int af, const void* addr)
+{
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+	sockaddr_storage ss = {};
+	socklen_t sslen;
+	if(af == AF_INET)
+	{
+		auto sin = (sockaddr_in*)&ss;
+		sin->sin_family = AF_INET;
+		memcpy(&sin->sin_addr, addr, sizeof(sin->sin_addr));
+		sslen = sizeof(sockaddr_in);
+	}
+	else
+	{
+		auto sin6 = (sockaddr_in6*)&ss;
+		sin6->sin6_family = AF_INET6;
+		memcpy(&sin6->sin6_addr, addr, sizeof(sin6->sin6_addr));
+		sslen = sizeof(sockaddr_in6);
+	}
+
+	char host[NI_MAXHOST];
+	if(getnameinfo((sockaddr*)&ss, sslen, host, sizeof(host), NULL, 0, NI_NAMEREQD) == 0)
+	{
+		return host;
+	}
+#endif
+	return "";
+}
+
+std::string sinsp_reverse_dns_manager::name_of(int af, const void* addr)
+{
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+	if(!m_enabled || (af != AF_INET && af != AF_INET6))
+	{
+		return "";
+	}
+
+	ipv6addr key = reverse_dns_key(af, addr);
+	uint64_t ts = sinsp_utils::get_current_time_ns();
+
+	std::lock_guard<std::mutex> lk(m_mutex);
+	auto it = m_cache.find(key);
+	if(it != m_cache.end())
+	{
+		dns_entry& e = it->second;
+		if(ts >= e.m_expire_ts && !e.m_queued && m_queue.size() < m_max_queued)
+		{
+			// keep returning the old name until the refresh is done
+			e.m_queued = true;
+			m_queue.push_back(key);
+			m_cv.notify_one();
+		}
+		return e.m_name;
+	}
+
+	if(m_queue.size() >= m_max_queued)
+	{
+		return "";
+	}
+
+	if(m_cache.size() >= m_max_entries)
+	{
+		// make room dropping the expired entries, at most once per
+		// second since every miss ends up here while the cache is full
+		if(ts < m_next_eviction_ts)
+		{
+			return "";
+		}
+		m_next_eviction_ts = ts + ONE_SECOND_IN_NS;
+		for(auto eit = m_cache.begin(); eit != m_cache.end();)
+		{
+			eit = (ts >= eit->second.m_expire_ts && !eit->second.m_queued) ? m_cache.erase(eit) : std::next(eit);
+		}
+		if(m_cache.size() >= m_max_entries)
+		{
+			return "";
+		}
+	}
+
+	if(!m_resolver_thread)
+	{
+		m_stop = false;
+		m_resolver_thread = std::make_unique<std::thread>(&sinsp_reverse_dns_manager::run, this);
+	}
+
+	m_cache.emplace(key, dns_entry{"", 0, true});
+	m_queue.push_back(key);
+	m_cv.notify_one();
+#endif
+	return "";
+}
+
+void sinsp_reverse_dns_manager::run()
+{
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+	std::unique_lock<std::mutex> lk(m_mutex);
+	while(true)
+	{
+		m_cv.wait(lk, [this] { return m_stop || !m_queue.empty(); });
+		if(m_stop)
+		{
+			return;
+		}
+
+		ipv6addr key = m_queue.front();
+		m_queue.pop_front();
+		resolver_t resolver = m_resolver;
+		m_resolving = true;
+		lk.unlock();
+
+		// IPv4-mapped addresses are resolved as IPv4 ones
+		std::string name;
+		if(sinsp_utils::is_ipv4_mapped_ipv6((uint8_t*)key.m_b))
+		{
+			name = resolver ? resolver(AF_INET, &key.m_b[3]) : resolve(AF_INET, &key.m_b[3]);
+		}
+		else
+		{
+			name = resolver ? resolver(AF_INET6, key.m_b) : resolve(AF_INET6, key.m_b);
+		}
+		uint64_t ts = sinsp_utils::get_current_time_ns();
+
+		lk.lock();
+		auto it = m_cache.find(key);
+		if(it != m_cache.end())
+		{
+			if(it->second.m_name != name)
+			{
+				it->second.m_name = std::move(name);
+				m_generation.fetch_add(1, std::memory_order_release);
+			}
+			it->second.m_expire_ts = ts + (it->second.m_name.empty() ? m_negative_ttl : m_ttl);
+			it->second.m_queued = false;
+		}
+		m_resolving = false;
+		if(m_queue.empty())
+		{
+			m_idle_cv.notify_all();
+		}
+	}
+#endif
+}
+
+void sinsp_reverse_dns_manager::wait_idle()
+{
+	std::unique_lock<std::mutex> lk(m_mutex);
+	m_idle_cv.wait(lk, [this] { return m_stop || !m_resolver_thread || (m_queue.empty() && !m_resolving); });
+}
+
+void sinsp_reverse_dns_manager::set_resolver(resolver_t resolver)
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_resolver = std::move(resolver);
+}
+
+size_t sinsp_reverse_dns_manager::size() const
+{
+	std::lock_guard<std::mutex> lk(m_mutex);
+	return m_cache.size();
+}
+
+void sinsp_reverse_dns_manager::cleanup()
+{
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_stop = true;
+	}
+	m_cv.notify_all();
+	m_idle_cv.notify_all();
+	if(m_resolver_thread)
+	{
+		m_resolver_thread->join();
+		m_resolver_thread.reset();
+	}
+
+	std::lock_guard<std::mutex> lk(m_mutex);
+	m_cache.clear();
+	m_queue.clear();
+}
@@ -26,9 +26,14 @@ limitations under the License.
 #include <string>
 #include <thread>
 #include <chrono>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
 #include <future>
 #include <mutex>
 #include <memory>
+#include <unordered_map>
 #if !defined(__EMSCRIPTEN__)
 #include "tbb/concurrent_unordered_map.h"
 #endif
@@ -133,3 +138,135 @@ private:
 
 	friend sinsp_dns_resolver;
 };
+
+//
+// Cache of the names of IP addresses. Lookups never block: a miss queues
+// the address for a reverse DNS resolution on a background thread and
+// returns an empty name until it completes. Failed resolutions are cached
+// too, with a shorter TTL, and expired names keep being returned while
+// they are refreshed.
+//
+// It's disabled by default, since reverse lookups send the observed
+// addresses to the configured name servers. The generation counter is
+// bumped every time a name changes, so that names rendered before can be
+// rendered again.
+//
+class sinsp_reverse_dns_manager
+{
+public:
+	// resolves an AF_INET or AF_INET6 address, returns an empty string
+	// if it has no name
+	using resolver_t = std::function<std::string(int af, const void* addr)>;
+
+	static sinsp_reverse_dns_manager& get()
+	{
+		static sinsp_reverse_dns_manager instance;
+		return instance;
+	};
+
+	//
+	// Returns the name of the address, or an empty string if it's not
+	// known (yet) or lookups are disabled. `addr` is an in_addr or
+	// in6_addr depending on `af`.
+	//
+	std::string name_of(int af, const void* addr);
+
+	void cleanup();
+
+	void set_enabled(bool enabled)
+	{
+		m_enabled = enabled;
+	};
+	bool is_enabled() const
+	{
+		return m_enabled;
+	};
+
+	uint64_t generation() const
+	{
+		return m_generation.load(std::memory_order_acquire);
+	};
+
+	void set_ttl(uint64_t ns)
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_ttl = ns;
+	};
+	void set_negative_ttl(uint64_t ns)
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_negative_ttl = ns;
+	};
+	void set_max_entries(size_t n)
+	{
+		std::lock_guard<std::mutex> lk(m_mutex);
+		m_max_entries = n;
+	};
+
+	//
+	// Waits until all the queued lookups are done
+	//
+	void wait_idle();
+
+	//
+	// Replaces getnameinfo() for the lookups queued from now on
+	//
+	void set_resolver(resolver_t resolver);
+
+	size_t size() const;
+
+private:
+
+	sinsp_reverse_dns_manager() :
+		m_ttl(3600 * ONE_SECOND_IN_NS),
+		m_negative_ttl(60 * ONE_SECOND_IN_NS),
+		m_max_entries(16384),
+		m_max_queued(1024)
+	{};
+
+	~sinsp_reverse_dns_manager() {
+		cleanup();
+	}
+
+	sinsp_reverse_dns_manager(sinsp_reverse_dns_manager const&) = delete;
+	void operator=(sinsp_reverse_dns_manager const&) = delete;
+
+	struct dns_entry
+	{
+		std::string m_name;
+		uint64_t m_expire_ts;
+		bool m_queued;
+	};
+
+	// IPv4 addresses are stored as IPv4-mapped IPv6 ones
+	struct addr_hash
+	{
+		size_t operator()(const ipv6addr& a) const
+		{
+			uint64_t h = ((uint64_t)a.m_b[0] << 32 | a.m_b[1]) * 0x9e3779b97f4a7c15ULL;
+			return (size_t)(h ^ (((uint64_t)a.m_b[2] << 32 | a.m_b[3]) * 0xc2b2ae3d27d4eb4fULL));
+		}
+	};
+
+	static std::string resolve(int af, const void* addr);
+	void run();
+
+	std::atomic<bool> m_enabled{false};
+	std::atomic<uint64_t> m_generation{0};
+
+	mutable std::mutex m_mutex;
+	std::condition_variable m_cv;
+	std::condition_variable m_idle_cv;
+	std::unordered_map<ipv6addr, dns_entry, addr_hash> m_cache;
+	std::deque<ipv6addr> m_queue;
+	std::unique_ptr<std::thread> m_resolver_thread;
+	bool m_stop = false;
+	bool m_resolving = false;
+	resolver_t m_resolver;
+	uint64_t m_next_eviction_ts = 0;
+
+	uint64_t m_ttl;
+	uint64_t m_negative_ttl;
+	size_t m_max_entries;
+	size_t m_max_queued;
+};
@@ -0,0 +1,240 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Epoch-based memory reclamation for a single writer and any number
+ * of reader threads. Readers access the shared objects inside a critical
+ * section opened with enter(), the writer retires the objects it unlinked
+ * and periodically calls collect() to free the ones that no reader can
+ * still see.
+ * Entering and leaving a critical section are wait-free once the calling
+ * thread got its reader slot, which happens on its first enter() and is
+ * lock-free. Slots are released when their thread exits.
+ */
+class epoch_reclaimer
+{
+	struct reader_slot;
+
+public:
+	static constexpr uint64_t idle_epoch = UINT64_MAX;
+
+	/**
+	 * @brief A reader critical section, objects retired after it started
+	 * are not freed before it's destroyed. Critical sections must not be
+	 * nested.
+	 */
+	class guard
+	{
+	public:
+		explicit guard(reader_slot* s): m_slot(s) {}
+		guard(const guard&) = delete;
+		guard& operator=(const guard&) = delete;
+		~guard()
+		{
+			m_slot->epoch.store(idle_epoch, std::memory_order_release);
+		}
+
+	private:
+		reader_slot* m_slot;
+	};
+
+	epoch_reclaimer():
+		m_id(s_next_id.fetch_add(1, std::memory_order_relaxed)),
+		m_state(std::make_shared<shared_state>())
+	{
+	}
+
+	~epoch_reclaimer()
+	{
+		// no reader can be inside a critical section at this point
+		for (auto& r : m_retired)
+		{
+			r.second();
+		}
+	}
+
+	epoch_reclaimer(const epoch_reclaimer&) = delete;
+	epoch_reclaimer& operator=(const epoch_reclaimer&) = delete;
+
+	/**
+	 * @brief Opens a reader critical section, can be called by any thread.
+	 */
+	inline guard enter() const
+	{
+		reader_slot* s = local_slot();
+		s->epoch.store(m_state->epoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+		return guard(s);
+	}
+
+	/**
+	 * @brief Called by the writer after unlinking an object from the shared
+	 * structure, `deleter` runs on the writer thread once no reader can
+	 * still access the object.
+	 */
+	inline void retire(std::function<void()> deleter)
+	{
+		uint64_t e = m_state->epoch.fetch_add(1, std::memory_order_seq_cst);
+		m_retired.emplace_back(e, std::move(deleter));
+	}
+
+	/**
+	 * @brief Frees the retired objects that are not reachable by readers
+	 * anymore. Must be called by the writer.
+	 */
+	inline void collect()
+	{
+		if (m_retired.empty())
+		{
+			return;
+		}
+
+		uint64_t min_epoch = idle_epoch;
+		for (reader_slot* s = m_state->slots.load(std::memory_order_seq_cst); s != nullptr; s = s->next)
+		{
+			uint64_t e = s->epoch.load(std::memory_order_seq_cst);
+			min_epoch = e < min_epoch ? e : min_epoch;
+		}
+
+		// retired entries are ordered by epoch
+		size_t n = 0;
+		while (n < m_retired.size() && m_retired[n].first < min_epoch)
+		{
+			m_retired[n].second();
+			n++;
+		}
+		m_retired.erase(m_retired.begin(), m_retired.begin() + n);
+	}
+
+	/**
+	 * @brief Returns the number of retired objects still waiting for readers.
+	 */
+	inline size_t pending() const
+	{
+		return m_retired.size();
+	}
+
+private:
+	struct reader_slot
+	{
+		alignas(64) std::atomic<uint64_t> epoch{idle_epoch};
+		std::atomic<bool> owned{false};
+		reader_slot* next{nullptr};
+	};
+
+	// shared with the reader threads, so that a thread exiting after the
+	// reclaimer has been destroyed does not touch freed memory
+	struct shared_state
+	{
+		~shared_state()
+		{
+			reader_slot* s = slots.load();
+			while (s != nullptr)
+			{
+				reader_slot* next = s->next;
+				delete s;
+				s = next;
+			}
+		}
+
+		std::atomic<uint64_t> epoch{0};
+		std::atomic<reader_slot*> slots{nullptr};
+	};
+
+	struct reader_entry
+	{
+		uint64_t reclaimer_id;
+		std::weak_ptr<shared_state> state;
+		reader_slot* slot;
+	};
+
+	struct reader_cache
+	{
+		~reader_cache()
+		{
+			for (auto& e : entries)
+			{
+				if (auto s = e.state.lock())
+				{
+					e.slot->owned.store(false, std::memory_order_release);
+				}
+			}
+		}
+
+		std::vector<reader_entry> entries;
+	};
+
+	inline reader_slot* local_slot() const
+	{
+		static thread_local reader_cache t_cache;
+		for (const auto& e : t_cache.entries)
+		{
+			if (e.reclaimer_id == m_id)
+			{
+				return e.slot;
+			}
+		}
+
+		// first critical section of this thread, forget the reclaimers
+		// that don't exist anymore and claim a free slot or add one
+		auto& entries = t_cache.entries;
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			it = it->state.expired() ? entries.erase(it) : it + 1;
+		}
+
+		reader_slot* s = m_state->slots.load(std::memory_order_acquire);
+		for (; s != nullptr; s = s->next)
+		{
+			bool expected = false;
+			if (s->owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+			{
+				break;
+			}
+		}
+
+		if (s == nullptr)
+		{
+			s = new reader_slot();
+			s->owned.store(true, std::memory_order_relaxed);
+			s->next = m_state->slots.load(std::memory_order_relaxed);
+			while (!m_state->slots.compare_exchange_weak(s->next, s, std::memory_order_acq_rel))
+			{
+			}
+		}
+
+		entries.push_back(reader_entry{m_id, m_state, s});
+		return s;
+	}
+
+	static inline std::atomic<uint64_t> s_next_id{0};
+
+	const uint64_t m_id;
+	std::shared_ptr<shared_state> m_state;
+
+	// writer-only state
+	std::vector<std::pair<uint64_t, std::function<void()>>> m_retired;
+};
@@ -600,7 +600,7 @@ int sinsp_evt::render_fd_json(Json::Value *ret, int64_t fd, const char** resolve
 
 	if(fd >= 0)
 	{
-		sinsp_fdinfo *fdinfo = tinfo->get_fd(fd);
+		const sinsp_fdinfo *fdinfo = tinfo->const_get_fd(fd);
 		if(fdinfo)
 		{
 			char tch = fdinfo->get_typechar();
@@ -642,7 +642,7 @@ int sinsp_evt::render_fd_json(Json::Value *ret, int64_t fd, const char** resolve
 			//
 			// Make sure we remove invalid characters from the resolved name
 			//
-			std::string sanitized_str = fdinfo->m_name;
+			std::string sanitized_str = fdinfo->get_name();
 
 			sanitize_string(sanitized_str);
 
@@ -693,7 +693,7 @@ char* sinsp_evt::render_fd(int64_t fd, const char** resolved_str, sinsp_evt::par
 
 	if(fd >= 0)
 	{
-		sinsp_fdinfo *fdinfo = tinfo->get_fd(fd);
+		const sinsp_fdinfo *fdinfo = tinfo->const_get_fd(fd);
 		if(fdinfo)
 		{
 			char tch = fdinfo->get_typechar();
@@ -735,7 +735,7 @@ char* sinsp_evt::render_fd(int64_t fd, const char** resolved_str, sinsp_evt::par
 			//
 			// Make sure we remove invalid characters from the resolved name
 			//
-			std::string sanitized_str = fdinfo->m_name;
+			std::string sanitized_str = fdinfo->get_name();
 
 			sanitize_string(sanitized_str);
 
@@ -1293,7 +1293,7 @@ const char* sinsp_evt::get_param_as_str(uint32_t id, OUT const char** resolved_s
 				int64_t fd = 0;
 				memcpy(&fd, param->m_val + pos, sizeof(uint64_t));
 
-				sinsp_fdinfo *fdinfo = tinfo->get_fd(fd);
+				const sinsp_fdinfo *fdinfo = tinfo->const_get_fd(fd);
 				if(fdinfo)
 				{
 					tch = fdinfo->get_typechar();
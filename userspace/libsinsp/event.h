@@ -520,6 +520,10 @@ public:
 	inline void init_keep_threadinfo()
 	{
 		m_flags = EF_NONE;
+		if(m_preparsed_pevt != nullptr)
+		{
+			adopt_preparsed_params();
+		}
 		m_info = &(m_event_info_table[m_pevt->type]);
 		m_fdinfo = NULL;
 		m_fdinfo_ref.reset();
@@ -586,16 +590,30 @@ public:
 	}
 
 	inline void load_params()
+	{
+		decode_params(this, m_pevt, m_event_info_table, m_params);
+	}
+
+	/*!
+	  \brief Decode the parameters of the scap event `pevt` into `out`, as
+	  they would be loaded by an event `owner`. This does not touch any
+	  state and can run on any thread, which is what the pre-parse pipeline
+	  relies on.
+	*/
+	static inline void decode_params(const sinsp_evt* owner,
+					 const scap_evt* pevt,
+					 const ppm_event_info* event_info_table,
+					 std::vector<sinsp_evt_param>& out)
 	{
 		uint32_t j;
 		struct scap_sized_buffer params[PPM_MAX_EVENT_PARAMS];
 
-		m_params.clear();
+		out.clear();
 
-		uint32_t nparams = scap_event_decode_params(m_pevt, params);
+		uint32_t nparams = scap_event_decode_params(pevt, params);
 
 		/* We need the event info to overwrite some parameters if necessary. */
-		const struct ppm_event_info* event_info = &m_event_info_table[m_pevt->type];
+		const struct ppm_event_info* event_info = &event_info_table[pevt->type];
 		int param_type = 0;
 
 		for(j = 0; j < nparams; j++)
@@ -658,7 +676,7 @@ public:
 				params[j].size = 5;
 			}
 
-			m_params.emplace_back(this, j, static_cast<const char*>(params[j].buf), params[j].size);
+			out.emplace_back(owner, j, static_cast<const char*>(params[j].buf), params[j].size);
 		}
 	}
 	std::string get_param_value_str(uint32_t id, bool resolved);
@@ -791,6 +809,23 @@ public:
 		return m_params;
 	}
 
+	/*!
+	  \brief Hand over the parameters decoded ahead of time for the current
+	  scap event. They are swapped with `params`, which gets back the storage
+	  of a previous handover, and are adopted the next time the event is
+	  initialized for parsing.
+	*/
+	inline void set_preparsed_params(std::vector<sinsp_evt_param>& params)
+	{
+		m_preparsed_params.swap(params);
+		m_preparsed_pevt = m_pevt;
+	}
+
+	inline void clear_preparsed_params()
+	{
+		m_preparsed_pevt = nullptr;
+	}
+
 	inline std::vector<sinsp_evt_param>& get_params()
 	{
 		return m_params;
@@ -798,6 +833,16 @@ public:
 
 private:
 
+	inline void adopt_preparsed_params()
+	{
+		if(m_preparsed_pevt == m_pevt)
+		{
+			m_params.swap(m_preparsed_params);
+			m_flags |= (uint32_t)sinsp_evt::SINSP_EF_PARAMS_LOADED;
+		}
+		m_preparsed_pevt = nullptr;
+	}
+
 	sinsp* m_inspector;
 	scap_evt* m_pevt;
 	char *m_pevt_storage;           // In some cases an alternate buffer is used to hold m_pevt. This points to that storage.
@@ -809,6 +854,11 @@ private:
 	const struct ppm_event_info* m_info;
 	std::vector<sinsp_evt_param> m_params;
 
+	// parameters decoded by the pre-parse pipeline, only valid
+	// if m_preparsed_pevt is the current scap event
+	std::vector<sinsp_evt_param> m_preparsed_params;
+	const scap_evt* m_preparsed_pevt = nullptr;
+
 	std::vector<char> m_paramstr_storage;
 	std::vector<char> m_resolved_paramstr_storage;
 
@@ -21,6 +21,7 @@ limitations under the License.
 #include <libsinsp/filter.h>
 #include <libsinsp/filterchecks.h>
 #include <libsinsp/eventformatter.h>
+#include <libsinsp/plugin_filtercheck.h>
 
 ///////////////////////////////////////////////////////////////////////////////
 // rawstring_check implementation
@@ -169,6 +170,13 @@ void sinsp_evt_formatter::set_format(output_format of, const std::string& fmt)
 		m_checks.emplace_back(std::move(chk));
 		m_tokenlens.push_back(0);
 	}
+
+	std::vector<sinsp_filter_check*> checks;
+	for(const auto& tkn : m_tokens)
+	{
+		checks.push_back(tkn.second);
+	}
+	sinsp_filter_check_plugin::group_batch_fields(checks);
 }
 
 bool sinsp_evt_formatter::on_capture_end(OUT std::string* res)
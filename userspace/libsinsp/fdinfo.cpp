@@ -22,6 +22,7 @@ limitations under the License.
 #endif
 #include <libsinsp/sinsp.h>
 #include <libsinsp/sinsp_int.h>
+#include <libsinsp/dns_manager.h>
 #include <libscap/scap-int.h>
 
 char sinsp_fdinfo::get_typechar() const
@@ -125,7 +126,7 @@ const char* sinsp_fdinfo::get_typestring() const
 
 std::string sinsp_fdinfo::tostring_clean() const
 {
-	std::string tstr = m_name;
+	std::string tstr = get_name();
 	sanitize_string(tstr);
 
 	return tstr;
@@ -139,6 +140,26 @@ void sinsp_fdinfo::add_filename_raw(std::string_view rawpath)
 void sinsp_fdinfo::add_filename(std::string_view fullpath)
 {
 	m_name = std::string(fullpath);
+	m_name_pending = false;
+	m_name_resolve = false;
+}
+
+libsinsp::interned_string sinsp_fdinfo::render_name() const
+{
+	char buf[1024];
+	buf[0] = '\0';
+	sinsp_utils::sockinfo_to_str(&m_sockinfo, m_type, buf, sizeof(buf), m_name_resolve);
+	return libsinsp::interned_string(buf);
+}
+
+uint64_t sinsp_fdinfo::resolved_names_generation()
+{
+	return sinsp_reverse_dns_manager::get().generation();
+}
+
+bool sinsp_fdinfo::resolved_names_changed() const
+{
+	return m_name_generation != resolved_names_generation();
 }
 
 bool sinsp_fdinfo::set_net_role_by_guessing(sinsp* inspector,
@@ -256,9 +277,9 @@ sinsp_fdinfo* sinsp_fdtable::find(int64_t fd)
 	//
 	// Caching failed, do a real lookup
 	//
-	auto fdit = m_table.find(fd);
+	auto pit = m_pages.find(page_index(fd));
 
-	if(fdit == m_table.end())
+	if(pit == m_pages.end() || pit->second.ptr->fds[page_slot(fd)] == nullptr)
 	{
 		if (m_inspector != nullptr && m_inspector->get_sinsp_stats_v2())
 		{
@@ -273,28 +294,57 @@ sinsp_fdinfo* sinsp_fdtable::find(int64_t fd)
 			m_inspector->get_sinsp_stats_v2()->m_n_noncached_fd_lookups++;
 		}
 
+		// the caller can modify the fd
+		page* p = writable_page(pit->second);
 		m_last_accessed_fd = fd;
-		m_last_accessed_fdinfo = fdit->second.get();
+		m_last_accessed_fdinfo = p->fds[page_slot(fd)].get();
 		lookup_device(m_last_accessed_fdinfo, fd);
 		return m_last_accessed_fdinfo;
 	}
 }
 
+const sinsp_fdinfo* sinsp_fdtable::const_find(int64_t fd) const
+{
+	// the cached fd is always on a page of our own
+	if(m_last_accessed_fd != -1 && fd == m_last_accessed_fd)
+	{
+		if (m_inspector != nullptr && m_inspector->get_sinsp_stats_v2())
+		{
+			m_inspector->get_sinsp_stats_v2()->m_n_cached_fd_lookups++;
+		}
+		return m_last_accessed_fdinfo;
+	}
+
+	auto it = find_slot(fd);
+	if (m_inspector != nullptr && m_inspector->get_sinsp_stats_v2())
+	{
+		if(it == nullptr)
+		{
+			m_inspector->get_sinsp_stats_v2()->m_n_failed_fd_lookups++;
+		}
+		else
+		{
+			m_inspector->get_sinsp_stats_v2()->m_n_noncached_fd_lookups++;
+		}
+	}
+	return it != nullptr ? it->get() : nullptr;
+}
+
 sinsp_fdinfo* sinsp_fdtable::add(int64_t fd, std::unique_ptr<sinsp_fdinfo> fdinfo)
 {
 	//
 	// Look for the FD in the table
 	//
-	auto it = m_table.find(fd);
+	auto it = find_slot(fd);
 
 	// Three possible exits here:
 	// 1. fd is not on the table
 	//   a. the table size is under the limit so create a new entry
 	//   b. table size is over the limit, discard the fd
 	// 2. fd is already in the table, replace it
-	if(it == m_table.end())
+	if(it == nullptr)
 	{
-		if(m_table.size() < m_inspector->m_max_fdtable_size)
+		if(m_size < m_inspector->m_max_fdtable_size)
 		{
 			//
 			// No entry in the table, this is the normal case
@@ -305,7 +355,7 @@ sinsp_fdinfo* sinsp_fdtable::add(int64_t fd, std::unique_ptr<sinsp_fdinfo> fdinf
 				m_inspector->get_sinsp_stats_v2()->m_n_added_fds++;
 			}
 
-			return m_table.emplace(fd, std::move(fdinfo)).first->second.get();
+			return put(fd, std::move(fdinfo));
 		}
 		else
 		{
@@ -317,7 +367,7 @@ sinsp_fdinfo* sinsp_fdtable::add(int64_t fd, std::unique_ptr<sinsp_fdinfo> fdinf
 		//
 		// the fd is already in the table.
 		//
-		if(it->second->m_flags & sinsp_fdinfo::FLAGS_CLOSE_IN_PROGRESS)
+		if((*it)->m_flags & sinsp_fdinfo::FLAGS_CLOSE_IN_PROGRESS)
 		{
 			//
 			// Sometimes an FD-creating syscall can be called on an FD that is being closed (i.e
@@ -328,7 +378,7 @@ sinsp_fdinfo* sinsp_fdtable::add(int64_t fd, std::unique_ptr<sinsp_fdinfo> fdinf
 			fdinfo->m_flags &= ~sinsp_fdinfo::FLAGS_CLOSE_IN_PROGRESS;
 			fdinfo->m_flags |= sinsp_fdinfo::FLAGS_CLOSE_CANCELED;
 
-			m_table[CANCELED_FD_NUMBER] = it->second->clone();
+			put(CANCELED_FD_NUMBER, (*it)->clone());
 		}
 		else
 		{
@@ -349,21 +399,20 @@ sinsp_fdinfo* sinsp_fdtable::add(int64_t fd, std::unique_ptr<sinsp_fdinfo> fdinf
 		// Replace the fd as a struct copy
 		//
 		m_last_accessed_fd = -1;
-		it->second = std::move(fdinfo);
-		return it->second.get();
+		return put(fd, std::move(fdinfo));
 	}
 }
 
 bool sinsp_fdtable::erase(int64_t fd)
 {
-	auto fdit = m_table.find(fd);
+	auto pit = m_pages.find(page_index(fd));
 
 	if(fd == m_last_accessed_fd)
 	{
 		m_last_accessed_fd = -1;
 	}
 
-	if(fdit == m_table.end())
+	if(pit == m_pages.end() || pit->second.ptr->fds[page_slot(fd)] == nullptr)
 	{
 		//
 		// Looks like there's no fd to remove.
@@ -380,7 +429,13 @@ bool sinsp_fdtable::erase(int64_t fd)
 	}
 	else
 	{
-		m_table.erase(fdit);
+		page* p = writable_page(pit->second);
+		p->fds[page_slot(fd)].reset();
+		m_size--;
+		if(--p->count == 0)
+		{
+			m_pages.erase(pit);
+		}
 		if (m_inspector != nullptr && m_inspector->get_sinsp_stats_v2())
 		{
 			m_inspector->get_sinsp_stats_v2()->m_n_noncached_fd_lookups++;
@@ -392,12 +447,104 @@ bool sinsp_fdtable::erase(int64_t fd)
 
 void sinsp_fdtable::clear()
 {
-	m_table.clear();
+	m_pages.clear();
+	m_size = 0;
+	m_last_accessed_fd = -1;
 }
 
 size_t sinsp_fdtable::size() const
 {
-	return m_table.size();
+	return m_size;
+}
+
+void sinsp_fdtable::inherit_from(sinsp_fdtable& parent)
+{
+	if(&parent == this)
+	{
+		return;
+	}
+	clear();
+
+	// the cache of the parent points into pages that are going to be shared
+	parent.m_last_accessed_fd = -1;
+	m_pages = parent.m_pages;
+	for(auto& it : m_pages)
+	{
+		it.second.inherited = true;
+	}
+	m_size = parent.m_size;
+
+	if (m_inspector != nullptr && m_inspector->get_sinsp_stats_v2())
+	{
+		m_inspector->get_sinsp_stats_v2()->m_n_inherited_fds += m_size;
+	}
+}
+
+uint64_t sinsp_fdtable::get_memory_usage() const
+{
+	uint64_t res = 0;
+	for(const auto& it : m_pages)
+	{
+		res += (sizeof(page) + it.second.ptr->count * sizeof(sinsp_fdinfo)) / it.second.ptr.use_count();
+	}
+	return res;
+}
+
+sinsp_fdtable::page* sinsp_fdtable::writable_page(page_ref& ref)
+{
+	if(ref.ptr.use_count() > 1)
+	{
+		auto copy = std::make_shared<page>();
+		for(int64_t i = 0; i < page_size; i++)
+		{
+			if(ref.ptr->fds[i] != nullptr)
+			{
+				copy->fds[i] = ref.ptr->fds[i]->clone();
+			}
+		}
+		copy->count = ref.ptr->count;
+		ref.ptr = std::move(copy);
+
+		// the cached fd might be in the shared page
+		m_last_accessed_fd = -1;
+		if (m_inspector != nullptr && m_inspector->get_sinsp_stats_v2())
+		{
+			m_inspector->get_sinsp_stats_v2()->m_n_fdtable_page_copies++;
+		}
+	}
+
+	if(ref.inherited)
+	{
+		// track down that those are cloned fds
+		for(int64_t i = 0; i < page_size; i++)
+		{
+			if(ref.ptr->fds[i] != nullptr)
+			{
+				ref.ptr->fds[i]->set_is_cloned();
+			}
+		}
+		ref.inherited = false;
+	}
+	return ref.ptr.get();
+}
+
+sinsp_fdinfo* sinsp_fdtable::put(int64_t fd, std::unique_ptr<sinsp_fdinfo> fdinfo)
+{
+	page_ref& ref = m_pages[page_index(fd)];
+	if(ref.ptr == nullptr)
+	{
+		ref.ptr = std::make_shared<page>();
+	}
+
+	page* p = writable_page(ref);
+	auto& slot = p->fds[page_slot(fd)];
+	if(slot == nullptr)
+	{
+		p->count++;
+		m_size++;
+	}
+	slot = std::move(fdinfo);
+	return slot.get();
 }
 
 void sinsp_fdtable::reset_cache()
@@ -418,6 +565,7 @@ void sinsp_fdtable::lookup_device(sinsp_fdinfo* fdi, uint64_t fd)
 	{
 		char procdir[SCAP_MAX_PATH_SIZE];
 		snprintf(procdir, sizeof(procdir), "%s/proc/%ld/", scap_get_host_root(), m_tid);
+		auto platform_lock = m_inspector->m_thread_manager->lock_scap_platform();
 		fdi->m_dev = scap_get_device_by_mount_id(m_inspector->get_scap_platform(), procdir, fdi->m_mount_id);
 		fdi->m_mount_id = 0; // don't try again
 	}
@@ -21,6 +21,7 @@ limitations under the License.
 #include <libscap/scap.h>
 #include <libsinsp/tuples.h>
 #include <libsinsp/sinsp_public.h>
+#include <libsinsp/sinsp_string_pool.h>
 
 #include <unordered_map>
 #include <vector>
@@ -144,12 +145,76 @@ public:
 	*/
 	std::string tostring_clean() const;
 
+	/*!
+	  \brief Return the fd name. For IPv4 and IPv6 sockets the name is
+	  rendered from the tuple the first time it's needed after the tuple
+	  changed, and kept until it changes again or, with hostname
+	  resolution, until new host names get resolved, see
+	  set_name_from_tuple().
+	*/
+	inline const libsinsp::interned_string& get_name()
+	{
+		if(m_name_pending || (m_name_resolve && resolved_names_changed()))
+		{
+			m_name_generation = resolved_names_generation();
+			m_name = render_name();
+			m_name_pending = false;
+		}
+		return m_name;
+	}
+
+	/*!
+	  \brief Return the fd name, without keeping it if it had to be
+	  rendered from the socket tuple.
+	*/
+	inline libsinsp::interned_string get_name() const
+	{
+		return (m_name_pending || (m_name_resolve && resolved_names_changed())) ? render_name() : m_name;
+	}
+
+	/*!
+	  \brief Mark the name of this socket as outdated after its tuple
+	  changed. The name is rendered from m_sockinfo by get_name(), so
+	  events for which nobody reads it don't pay for the formatting.
+	*/
+	inline void set_name_from_tuple(bool resolve_hostname_and_port)
+	{
+		m_name_pending = true;
+		m_name_resolve = resolve_hostname_and_port;
+	}
+
+	/*!
+	  \brief Set the fd name, replacing a name still to be rendered from
+	  the socket tuple.
+	*/
+	inline void set_name(const libsinsp::interned_string& name)
+	{
+		m_name = name;
+		m_name_pending = false;
+		m_name_resolve = false;
+	}
+
+	/*!
+	  \brief Return true if the name is outdated and must be rendered from
+	  the socket tuple by get_name().
+	*/
+	inline bool is_name_pending() const
+	{
+		return m_name_pending;
+	}
+
 	/*!
 	  \brief Return true if this is a log device.
 	*/
 	inline bool is_syslog() const
 	{
-		return m_name.find("/dev/log") != std::string::npos;
+		// names rendered from an IP tuple can't be /dev/log, don't render them
+		if(m_name_pending || m_name_resolve || is_ipv4_socket() || is_ipv6_socket() ||
+		   m_type == SCAP_FD_IPV4_SERVSOCK || m_type == SCAP_FD_IPV6_SERVSOCK)
+		{
+			return false;
+		}
+		return m_name.str().find("/dev/log") != std::string::npos;
 	}
 
 	/*!
@@ -424,14 +489,23 @@ public:
 	scap_fd_type m_type = SCAP_FD_UNINITIALIZED; ///< The fd type, e.g. file, directory, IPv4 socket...
 	uint32_t m_openflags = 0; ///< If this FD is a file, the flags that were used when opening it. See the PPM_O_* definitions in driver/ppm_events_public.h.
 	sinsp_sockinfo m_sockinfo = {}; ///< Socket-specific state. This is uninitialized (zero) for non-socket FDs.
-	std::string m_name; ///< Human readable rendering of this FD. For files, this is the full file name. For sockets, this is the tuple. And so on.
-	std::string m_name_raw; // Human readable rendering of this FD. See m_name, only used if fd is a file path. Path is kept "raw" with limited sanitization and without absolute path derivation.
-	std::string m_oldname; // The name of this fd at the beginning of event parsing. Used to detect name changes that result from parsing an event.
+	libsinsp::interned_string m_name_raw; // Human readable rendering of this FD. See get_name(), only used if fd is a file path. Path is kept "raw" with limited sanitization and without absolute path derivation.
+	libsinsp::interned_string m_oldname; // The name of this fd at the beginning of event parsing. Used to detect name changes that result from parsing an event.
 	uint32_t m_flags = FLAGS_NONE;
 	uint32_t m_dev = 0;
 	uint32_t m_mount_id = 0;
 	uint64_t m_ino = 0;
 	int64_t m_pid = 0; // only if fd is a pidfd
+
+private:
+	libsinsp::interned_string render_name() const;
+	static uint64_t resolved_names_generation();
+	bool resolved_names_changed() const;
+
+	libsinsp::interned_string m_name; // Human readable rendering of this FD. For files, this is the full file name. For sockets, this is the tuple. And so on.
+	bool m_name_pending = false; // m_name must be rendered from m_sockinfo
+	bool m_name_resolve = false; // resolve hostnames and ports when rendering m_name
+	uint64_t m_name_generation = 0; // reverse DNS generation m_name was rendered at
 };
 
 /*@}*/
@@ -453,29 +527,43 @@ public:
 		return sinsp_fdinfo{}.clone();
 	}
 
+	// note: this gives the table its own copy of the page of the fd if
+	// it's shared, use const_find() when the fd is not modified
 	sinsp_fdinfo* find(int64_t fd);
 
+	const sinsp_fdinfo* const_find(int64_t fd) const;
+
 	sinsp_fdinfo* add(int64_t fd, std::unique_ptr<sinsp_fdinfo> fdinfo);
 
 	inline bool const_loop(const fdtable_const_visitor_t callback) const
 	{
-		for(auto it = m_table.begin(); it != m_table.end(); ++it)
+		for(auto it = m_pages.begin(); it != m_pages.end(); ++it)
 		{
-			if (!callback(it->first, *(it->second.get())))
+			const page* p = it->second.ptr.get();
+			for(int64_t i = 0; i < page_size; i++)
 			{
-				return false;
+				if(p->fds[i] != nullptr && !callback(it->first * page_size + i, *(p->fds[i].get())))
+				{
+					return false;
+				}
 			}
 		}
 		return true;
 	}
 
+	// note: this gives the table its own copy of all the shared pages,
+	// use const_loop() when the fds are not modified
 	inline bool loop(const fdtable_visitor_t callback)
 	{
-		for(auto it = m_table.begin(); it != m_table.end(); ++it)
+		for(auto it = m_pages.begin(); it != m_pages.end(); ++it)
 		{
-			if (!callback(it->first, *(it->second.get())))
+			page* p = writable_page(it->second);
+			for(int64_t i = 0; i < page_size; i++)
 			{
-				return false;
+				if(p->fds[i] != nullptr && !callback(it->first * page_size + i, *(p->fds[i].get())))
+				{
+					return false;
+				}
 			}
 		}
 		return true;
@@ -488,6 +576,20 @@ public:
 
 	size_t size() const;
 
+	//
+	// Makes this table a copy of the table of the parent process, after a
+	// fork. The two tables share their fds until one of them modifies them,
+	// and then only the modified page of fds is copied. The fds get the
+	// FLAGS_IS_CLONED flag when the child gets its own copy of them.
+	//
+	void inherit_from(sinsp_fdtable& parent);
+
+	//
+	// Returns the approximate memory used by the fds of the table, the
+	// pages shared with other tables are split among them
+	//
+	uint64_t get_memory_usage() const;
+
 	void reset_cache();
 
 	inline uint64_t get_tid() const
@@ -501,8 +603,54 @@ public:
 	}
 
 private:
+	//
+	// The fds are stored in fixed-size pages, which are shared between the
+	// table of a process and the ones of its children after a fork, and
+	// copied the first time that one of the tables modifies them
+	//
+	static constexpr int64_t page_bits = 5;
+	static constexpr int64_t page_size = 1 << page_bits;
+
+	struct page
+	{
+		std::unique_ptr<sinsp_fdinfo> fds[page_size];
+		uint32_t count = 0;
+	};
+
+	struct page_ref
+	{
+		std::shared_ptr<page> ptr;
+		// the page comes from the parent table
+		bool inherited = false;
+	};
+
+	static inline int64_t page_index(int64_t fd)
+	{
+		// rounds down for negative fds too
+		return fd >= 0 ? fd >> page_bits : -((-(fd + 1)) >> page_bits) - 1;
+	}
+
+	static inline int64_t page_slot(int64_t fd)
+	{
+		return fd - page_index(fd) * page_size;
+	}
+
+	inline const std::unique_ptr<sinsp_fdinfo>* find_slot(int64_t fd) const
+	{
+		auto it = m_pages.find(page_index(fd));
+		if(it == m_pages.end() || it->second.ptr->fds[page_slot(fd)] == nullptr)
+		{
+			return nullptr;
+		}
+		return &it->second.ptr->fds[page_slot(fd)];
+	}
+
+	page* writable_page(page_ref& ref);
+	sinsp_fdinfo* put(int64_t fd, std::unique_ptr<sinsp_fdinfo> fdinfo);
+
 	sinsp* m_inspector;
-	std::unordered_map<int64_t, std::unique_ptr<sinsp_fdinfo>> m_table;
+	std::unordered_map<int64_t, page_ref> m_pages;
+	size_t m_size = 0;
 
 	//
 	// Simple fd cache
@@ -35,6 +35,7 @@ limitations under the License.
 #include <libsinsp/filter.h>
 #include <libsinsp/filter/parser.h>
 #include <libsinsp/sinsp_filtercheck.h>
+#include <libsinsp/plugin_filtercheck.h>
 
 ///////////////////////////////////////////////////////////////////////////////
 // sinsp_filter_expression implementation
@@ -218,6 +219,22 @@ sinsp_filter_compiler::sinsp_filter_compiler(
 	m_flt_ast = fltast;
 }
 
+// the leaves of the filtering tree
+static void collect_checks(sinsp_filter_check* chk, std::vector<sinsp_filter_check*>& checks)
+{
+	auto expr = dynamic_cast<sinsp_filter_expression*>(chk);
+	if(expr == nullptr)
+	{
+		checks.push_back(chk);
+		return;
+	}
+
+	for(const auto& c : expr->m_checks)
+	{
+		collect_checks(c.get(), checks);
+	}
+}
+
 std::unique_ptr<sinsp_filter> sinsp_filter_compiler::compile()
 {
 	// parse filter string on-the-fly if not pre-parsed AST is provided
@@ -251,6 +268,10 @@ std::unique_ptr<sinsp_filter> sinsp_filter_compiler::compile()
 		throw e;
 	}
 
+	std::vector<sinsp_filter_check*> checks;
+	collect_checks(m_filter->m_filter.get(), checks);
+	sinsp_filter_check_plugin::group_batch_fields(checks);
+
 	// return compiled filter
 	return std::move(m_filter);
 }
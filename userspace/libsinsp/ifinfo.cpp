@@ -212,15 +212,8 @@ bool sinsp_network_interfaces::is_ipv4addr_in_subnet(uint32_t addr) const
 	}
 
 	// try to find an interface for the same subnet
-	for(auto& el : m_ipv4_interfaces)
-	{
-		if((el.m_addr & el.m_netmask) == (addr & el.m_netmask))
-		{
-			return true;
-		}
-	}
-
-	return false;
+	update_indexes();
+	return m_ipv4_subnets.match(addr);
 }
 
 bool sinsp_network_interfaces::is_ipv4addr_in_local_machine(uint32_t addr, sinsp_threadinfo* tinfo) const
@@ -284,15 +277,8 @@ bool sinsp_network_interfaces::is_ipv4addr_in_local_machine(uint32_t addr, sinsp
 	}
 
 	// try to find an interface that has the given IP as address
-	for(const auto& ipv4interface : m_ipv4_interfaces)
-	{
-		if(ipv4interface.m_addr == addr)
-		{
-			return true;
-		}
-	}
-
-	return false;
+	update_indexes();
+	return m_ipv4_addrs.match(addr);
 }
 
 void sinsp_network_interfaces::import_ipv4_ifaddr_list(uint32_t count, scap_ifinfo_ipv4* plist)
@@ -311,6 +297,7 @@ void sinsp_network_interfaces::import_ipv4_ifaddr_list(uint32_t count, scap_ifin
 		m_ipv4_interfaces.push_back(info);
 		plist++;
 	}
+	m_indexes_stale = true;
 }
 
 ipv6addr sinsp_network_interfaces::infer_ipv6_address(ipv6addr &destination_address)
@@ -355,16 +342,9 @@ bool sinsp_network_interfaces::is_ipv6addr_in_local_machine(ipv6addr &addr, sins
 		return false;
 	}
 
-	// try to find an interface that has the given IP as address
-	for(const auto& ipv6interface : m_ipv6_interfaces)
-	{
-		if(addr.in_subnet(ipv6interface.m_net))
-		{
-			return true;
-		}
-	}
-
-	return false;
+	// try to find an interface in the same /64 as the given IP
+	update_indexes();
+	return m_ipv6_subnets.match(addr);
 }
 
 void sinsp_network_interfaces::import_ipv6_ifaddr_list(uint32_t count, scap_ifinfo_ipv6* plist)
@@ -386,6 +366,7 @@ void sinsp_network_interfaces::import_ipv6_ifaddr_list(uint32_t count, scap_ifin
 		m_ipv6_interfaces.push_back(info);
 		plist++;
 	}
+	m_indexes_stale = true;
 }
 
 void sinsp_network_interfaces::import_interfaces(scap_addrlist* paddrlist)
@@ -401,19 +382,48 @@ void sinsp_network_interfaces::import_interfaces(scap_addrlist* paddrlist)
 void sinsp_network_interfaces::import_ipv4_interface(const sinsp_ipv4_ifinfo& ifinfo)
 {
 	m_ipv4_interfaces.push_back(ifinfo);
+	m_indexes_stale = true;
 }
 
 void sinsp_network_interfaces::import_ipv6_interface(const sinsp_ipv6_ifinfo& ifinfo)
 {
 	m_ipv6_interfaces.push_back(ifinfo);
+	m_indexes_stale = true;
 }
 
 std::vector<sinsp_ipv4_ifinfo>* sinsp_network_interfaces::get_ipv4_list()
 {
+	// the caller can modify the list
+	m_indexes_stale = true;
 	return &m_ipv4_interfaces;
 }
 
 std::vector<sinsp_ipv6_ifinfo>* sinsp_network_interfaces::get_ipv6_list()
 {
+	m_indexes_stale = true;
 	return &m_ipv6_interfaces;
 }
+
+void sinsp_network_interfaces::update_indexes() const
+{
+	if(!m_indexes_stale)
+	{
+		return;
+	}
+
+	m_ipv4_addrs.clear();
+	m_ipv4_subnets.clear();
+	for(const auto& el : m_ipv4_interfaces)
+	{
+		m_ipv4_addrs.add_network(el.m_addr, 0xffffffff);
+		m_ipv4_subnets.add_network(el.m_addr, el.m_netmask);
+	}
+
+	m_ipv6_subnets.clear();
+	for(const auto& el : m_ipv6_interfaces)
+	{
+		m_ipv6_subnets.add_network(el.m_net, 64);
+	}
+
+	m_indexes_stale = false;
+}
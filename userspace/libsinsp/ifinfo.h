@@ -22,6 +22,7 @@ limitations under the License.
 #include <libsinsp/sinsp_public.h>
 #include <libsinsp/tuples.h>
 #include <libsinsp/fdinfo.h>
+#include <libsinsp/ip_prefix_search.h>
 
 #include <string>
 #include <vector>
@@ -87,13 +88,23 @@ public:
 	void import_ipv6_ifaddr_list(uint32_t count, scap_ifinfo_ipv6* plist);
 
 private:
+	void update_indexes() const;
+
 	ipv6addr m_ipv6_loopback_addr;
 	std::vector<sinsp_ipv4_ifinfo> m_ipv4_interfaces;
 	std::vector<sinsp_ipv6_ifinfo> m_ipv6_interfaces;
+
+	// lookup indexes over the interface lists, rebuilt on the first
+	// lookup after the lists changed
+	mutable ip_prefix_search m_ipv4_addrs;
+	mutable ip_prefix_search m_ipv4_subnets;
+	mutable ip_prefix_search m_ipv6_subnets;
+	mutable bool m_indexes_stale = false;
 };
 
 void sinsp_network_interfaces::clear()
 {
 	m_ipv4_interfaces.clear();
 	m_ipv6_interfaces.clear();
+	m_indexes_stale = true;
 }
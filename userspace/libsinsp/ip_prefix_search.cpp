@@ -0,0 +1,181 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/ip_prefix_search.h>
+
+#include <algorithm>
+
+namespace
+{
+inline uint32_t to_host_order(uint32_t addr)
+{
+	const uint8_t* b = (const uint8_t*)&addr;
+	return ((uint32_t)b[0] << 24) | ((uint32_t)b[1] << 16) | ((uint32_t)b[2] << 8) | (uint32_t)b[3];
+}
+
+// the address that follows a, wrapping around after the last one
+inline uint32_t next_addr(uint32_t a)
+{
+	return a + 1;
+}
+
+inline std::pair<uint64_t, uint64_t> next_addr(const std::pair<uint64_t, uint64_t>& a)
+{
+	return {a.second == UINT64_MAX ? a.first + 1 : a.first, a.second + 1};
+}
+}
+
+ip_prefix_search::uint128_t ip_prefix_search::to_uint128(const ipv6addr& addr)
+{
+	const uint8_t* b = (const uint8_t*)addr.m_b;
+	uint128_t res = {0, 0};
+	for(int j = 0; j < 8; j++)
+	{
+		res.first = (res.first << 8) | b[j];
+		res.second = (res.second << 8) | b[j + 8];
+	}
+	return res;
+}
+
+void ip_prefix_search::add_network(uint32_t addr, uint32_t netmask)
+{
+	uint32_t mask = to_host_order(netmask);
+	uint32_t first = to_host_order(addr) & mask;
+	m_ipv4.push_back({first, first | ~mask});
+	m_compacted = false;
+}
+
+void ip_prefix_search::add_network(const ipv4net& net)
+{
+	add_network(net.m_ip, net.m_netmask);
+}
+
+void ip_prefix_search::add_network(const ipv6addr& addr, uint32_t prefix_len)
+{
+	prefix_len = std::min(prefix_len, (uint32_t)128);
+	uint128_t mask;
+	mask.first = prefix_len >= 64 ? UINT64_MAX : (prefix_len == 0 ? 0 : UINT64_MAX << (64 - prefix_len));
+	mask.second = prefix_len <= 64 ? 0 : UINT64_MAX << (128 - prefix_len);
+
+	uint128_t first = to_uint128(addr);
+	first.first &= mask.first;
+	first.second &= mask.second;
+	m_ipv6.push_back({first, {first.first | ~mask.first, first.second | ~mask.second}});
+	m_compacted = false;
+}
+
+void ip_prefix_search::add_network(const ipv6net& net)
+{
+	add_network(net.get_addr(), net.get_prefix_len());
+}
+
+bool ip_prefix_search::add_network(const filter_value_t& net)
+{
+	// PT_IPNET values are parsed either as PT_IPV4NET or PT_IPV6NET,
+	// the size tells which one
+	if(net.second == sizeof(ipv4net))
+	{
+		add_network(*(const ipv4net*)net.first);
+		return true;
+	}
+	if(net.second == sizeof(ipv6net))
+	{
+		add_network(*(const ipv6net*)net.first);
+		return true;
+	}
+	return false;
+}
+
+bool ip_prefix_search::match(uint32_t addr) const
+{
+	compact();
+	return search(m_ipv4, to_host_order(addr));
+}
+
+bool ip_prefix_search::match(const ipv6addr& addr) const
+{
+	compact();
+	return search(m_ipv6, to_uint128(addr));
+}
+
+size_t ip_prefix_search::size() const
+{
+	compact();
+	return m_ipv4.size() + m_ipv6.size();
+}
+
+bool ip_prefix_search::empty() const
+{
+	return m_ipv4.empty() && m_ipv6.empty();
+}
+
+void ip_prefix_search::clear()
+{
+	m_ipv4.clear();
+	m_ipv6.clear();
+	m_compacted = true;
+}
+
+template<typename T>
+void ip_prefix_search::compact(std::vector<range<T>>& ranges)
+{
+	if(ranges.size() < 2)
+	{
+		return;
+	}
+
+	std::sort(ranges.begin(), ranges.end(), [](const range<T>& a, const range<T>& b)
+	{
+		return a.first < b.first;
+	});
+
+	size_t n = 0;
+	for(size_t j = 1; j < ranges.size(); j++)
+	{
+		range<T>& cur = ranges[n];
+		const range<T>& r = ranges[j];
+
+		// when cur ends at the last address the wrapped successor is
+		// the first one, but then r.first <= cur.last always holds
+		if(r.first <= cur.last || r.first == next_addr(cur.last))
+		{
+			cur.last = std::max(cur.last, r.last);
+		}
+		else
+		{
+			ranges[++n] = r;
+		}
+	}
+	ranges.resize(n + 1);
+}
+
+template<typename T>
+bool ip_prefix_search::search(const std::vector<range<T>>& ranges, const T& addr)
+{
+	// the last range starting at or before addr is the only candidate
+	auto it = std::upper_bound(ranges.begin(), ranges.end(), addr, [](const T& a, const range<T>& r)
+	{
+		return a < r.first;
+	});
+	if(it == ranges.begin())
+	{
+		return false;
+	}
+	--it;
+	return addr <= it->last;
+}
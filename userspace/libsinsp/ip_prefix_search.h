@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <libsinsp/filter_value.h>
+#include <libsinsp/tuples.h>
+
+//
+// A data structure that allows testing an IPv4 or IPv6 address against
+// a set of networks. The search succeeds if any of the networks
+// contains the address.
+//
+// The networks are stored as sorted, non-overlapping address ranges, so
+// that a search is a binary search no matter how many networks were
+// added. Overlapping and adjacent networks are merged into one range,
+// e.g. 10.0.0.0/9 and 10.128.0.0/9 are stored as 10.0.0.0/8.
+//
+// Networks can be added at any time, the ranges are sorted again by the
+// first search that follows.
+//
+class ip_prefix_search
+{
+public:
+	// addr and netmask are in network byte order
+	void add_network(uint32_t addr, uint32_t netmask);
+	void add_network(const ipv4net& net);
+	void add_network(const ipv6addr& addr, uint32_t prefix_len);
+	void add_network(const ipv6net& net);
+
+	// Adds a network parsed from a PT_IPV4NET, PT_IPV6NET or PT_IPNET
+	// filter value. Returns false if the value is not a network.
+	bool add_network(const filter_value_t& net);
+
+	// addr is in network byte order
+	bool match(uint32_t addr) const;
+	bool match(const ipv6addr& addr) const;
+
+	// Number of address ranges the networks were merged into
+	size_t size() const;
+	bool empty() const;
+	void clear();
+
+private:
+	// 128 bit addresses as (high, low) halves in host byte order
+	typedef std::pair<uint64_t, uint64_t> uint128_t;
+
+	template<typename T>
+	struct range
+	{
+		T first;
+		T last;
+	};
+
+	static uint128_t to_uint128(const ipv6addr& addr);
+
+	template<typename T>
+	static void compact(std::vector<range<T>>& ranges);
+
+	template<typename T>
+	static bool search(const std::vector<range<T>>& ranges, const T& addr);
+
+	inline void compact() const
+	{
+		if(!m_compacted)
+		{
+			compact(m_ipv4);
+			compact(m_ipv6);
+			m_compacted = true;
+		}
+	}
+
+	mutable std::vector<range<uint32_t>> m_ipv4;
+	mutable std::vector<range<uint128_t>> m_ipv6;
+	mutable bool m_compacted = true;
+};
@@ -0,0 +1,350 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <queue>
+#include <type_traits>
+#include <vector>
+
+/**
+ * @brief Lock-free priority queue for multiple producer/single consumer
+ * (mpsc) use cases, with the same interface of mpsc_priority_queue.
+ * Every producer thread is assigned a bounded single-producer/single-consumer
+ * ring, so producers never contend with each other nor with the consumer.
+ * The consumer moves the elements of all the rings into a private heap
+ * ordered by Cmp, so the top element can be checked against a predicate
+ * before popping. Elements with equal priority follow the order with which
+ * they have been received by the consumer, which preserves the push order
+ * of every single producer.
+ * Pushes fail and are counted as drops when the ring of the producer is full
+ * or when all the rings are assigned to other live threads.
+ */
+template<typename Elm, typename Cmp>
+class mpsc_ring_queue
+{
+	// limit the implementation of Elm to std::shared_ptr | std::unique_ptr
+	static_assert(
+		std::is_same<Elm, std::shared_ptr<typename Elm::element_type>>::value ||
+		std::is_same<Elm, std::unique_ptr<typename Elm::element_type>>::value,
+		"mpsc_ring_queue requires std::shared_ptr or std::unique_ptr elements");
+
+public:
+	static constexpr size_t default_ring_capacity = 512;
+	static constexpr size_t default_max_producers = 64;
+
+	/**
+	 * @brief Creates a queue. capacity bounds the number of elements held
+	 * by the consumer (0 means unbounded), ring_capacity is the number of
+	 * elements each producer can have in flight (rounded up to a power of 2).
+	 */
+	explicit mpsc_ring_queue(
+			size_t capacity = 0,
+			size_t ring_capacity = default_ring_capacity,
+			size_t max_producers = default_max_producers):
+		m_capacity(capacity),
+		m_ring_capacity(round_up_pow2(ring_capacity)),
+		m_id(s_next_id.fetch_add(1, std::memory_order_relaxed)),
+		m_state(std::make_shared<shared_state>(max_producers == 0 ? 1 : max_producers))
+	{
+	}
+
+	mpsc_ring_queue(const mpsc_ring_queue&) = delete;
+	mpsc_ring_queue& operator=(const mpsc_ring_queue&) = delete;
+
+	/**
+	 * @brief Returns true if the queue contains no elements. Must be
+	 * called by the consumer only.
+	 */
+	inline bool empty() const
+	{
+		if (!m_heap.empty())
+		{
+			return false;
+		}
+
+		size_t n = m_state->nslots_used.load(std::memory_order_acquire);
+		for (size_t i = 0; i < n; i++)
+		{
+			ring* r = m_state->slots[i].r.load(std::memory_order_acquire);
+			if (r != nullptr && r->head.load(std::memory_order_acquire) != r->tail.load(std::memory_order_relaxed))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+
+	/**
+	 * @brief Push an element into queue, and returns false in case the
+	 * ring of the calling thread is full.
+	 */
+	inline bool push(Elm&& e)
+	{
+		ring* r = producer_ring();
+		if (r == nullptr)
+		{
+			m_num_drops.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		uint64_t head = r->head.load(std::memory_order_relaxed);
+		if (head - r->tail.load(std::memory_order_acquire) >= m_ring_capacity)
+		{
+			m_num_drops.fetch_add(1, std::memory_order_relaxed);
+			return false;
+		}
+
+		r->buf[head & (m_ring_capacity - 1)] = std::move(e);
+		r->head.store(head + 1, std::memory_order_release);
+		return true;
+	}
+
+	/**
+	 * @brief Pops the highest priority element from the queue. Returns false
+	 * in case of empty queue.
+	 */
+	inline bool try_pop(Elm& res)
+	{
+		drain();
+		if (m_heap.empty())
+		{
+			return false;
+		}
+
+		res = std::move(m_heap.top().elm);
+		m_heap.pop();
+		return true;
+	}
+
+	/**
+	 * @brief This is analoguous to pop() but evaluates the element against
+	 * a predicate before returning it. If the predicate returns false, the
+	 * element is not popped from the queue and this method returns false.
+	 */
+	template <typename Callable>
+	inline bool try_pop_if(Elm& res, const Callable& pred)
+	{
+		drain();
+		if (m_heap.empty() || !pred(*m_heap.top().elm))
+		{
+			return false;
+		}
+
+		res = std::move(m_heap.top().elm);
+		m_heap.pop();
+		return true;
+	}
+
+	/**
+	 * @brief Returns the number of elements that could not be pushed.
+	 */
+	inline uint64_t get_num_drops() const
+	{
+		return m_num_drops.load(std::memory_order_relaxed);
+	}
+
+private:
+	struct ring
+	{
+		explicit ring(size_t capacity): buf(capacity) {}
+
+		std::vector<Elm> buf;
+		alignas(64) std::atomic<uint64_t> head{0}; // written by the producer
+		alignas(64) std::atomic<uint64_t> tail{0}; // written by the consumer
+	};
+
+	struct slot
+	{
+		std::atomic<bool> owned{false};
+		std::atomic<ring*> r{nullptr};
+	};
+
+	// shared with the producer threads, so that a thread exiting after the
+	// queue has been destroyed does not touch freed memory
+	struct shared_state
+	{
+		explicit shared_state(size_t n): slots(n) {}
+		~shared_state()
+		{
+			for (auto& s : slots)
+			{
+				delete s.r.load();
+			}
+		}
+
+		std::vector<slot> slots;
+		std::atomic<size_t> nslots_used{0};
+	};
+
+	// ring assigned to the current thread for a given queue. The slot is
+	// released when the thread exits, so that another thread can reuse it.
+	struct producer_entry
+	{
+		uint64_t queue_id;
+		std::weak_ptr<shared_state> state;
+		size_t slot_idx;
+		ring* r;
+	};
+
+	struct producer_cache
+	{
+		~producer_cache()
+		{
+			for (auto& e : entries)
+			{
+				if (auto s = e.state.lock())
+				{
+					s->slots[e.slot_idx].owned.store(false, std::memory_order_release);
+				}
+			}
+		}
+
+		std::vector<producer_entry> entries;
+	};
+
+	struct queue_elm
+	{
+		inline bool operator < (const queue_elm& r) const
+		{
+			// same ordering of mpsc_priority_queue: elements with the
+			// same priority are ordered by arrival
+			Cmp c{};
+			auto res = c(*elm.get(), *r.elm.get());
+			if (res == c(*r.elm.get(), *elm.get()))
+			{
+				return std::greater_equal<uint64_t>{}(num, r.num);
+			}
+			return res;
+		}
+		// using mutable is a workaround to make unique_ptr usable when copying
+		// the queue top(), which is returned a const unique<ptr>& and denies moving
+		mutable Elm elm;
+		uint64_t num;
+	};
+
+	static size_t round_up_pow2(size_t v)
+	{
+		size_t res = 1;
+		while (res < v)
+		{
+			res <<= 1;
+		}
+		return res;
+	}
+
+	inline ring* producer_ring()
+	{
+		static thread_local producer_cache t_cache;
+		for (const auto& e : t_cache.entries)
+		{
+			if (e.queue_id == m_id)
+			{
+				return e.r;
+			}
+		}
+
+		// first push from this thread, forget the queues that don't exist
+		// anymore and claim a free slot
+		auto& entries = t_cache.entries;
+		for (auto it = entries.begin(); it != entries.end();)
+		{
+			it = it->state.expired() ? entries.erase(it) : it + 1;
+		}
+
+		auto& slots = m_state->slots;
+		for (size_t i = 0; i < slots.size(); i++)
+		{
+			bool expected = false;
+			if (!slots[i].owned.compare_exchange_strong(expected, true, std::memory_order_acq_rel))
+			{
+				continue;
+			}
+
+			ring* r = slots[i].r.load(std::memory_order_acquire);
+			if (r == nullptr)
+			{
+				r = new ring(m_ring_capacity);
+				slots[i].r.store(r, std::memory_order_release);
+			}
+
+			size_t used = m_state->nslots_used.load(std::memory_order_relaxed);
+			while (used < i + 1 &&
+				!m_state->nslots_used.compare_exchange_weak(used, i + 1, std::memory_order_release))
+			{
+			}
+
+			entries.push_back(producer_entry{m_id, m_state, i, r});
+			return r;
+		}
+		return nullptr;
+	}
+
+	// move the available elements of the rings into the heap
+	inline void drain()
+	{
+		size_t n = m_state->nslots_used.load(std::memory_order_acquire);
+		for (size_t j = 0; j < n; j++)
+		{
+			// rotate the starting ring so that no producer is starved
+			// when the consumer-side capacity is met
+			size_t i = (m_next_ring + j) % n;
+			ring* r = m_state->slots[i].r.load(std::memory_order_acquire);
+			if (r == nullptr)
+			{
+				continue;
+			}
+
+			uint64_t tail = r->tail.load(std::memory_order_relaxed);
+			uint64_t head = r->head.load(std::memory_order_acquire);
+			if (tail == head)
+			{
+				continue;
+			}
+
+			while (tail != head && (m_capacity == 0 || m_heap.size() < m_capacity))
+			{
+				m_heap.push(queue_elm{std::move(r->buf[tail & (m_ring_capacity - 1)]), m_elem_counter++});
+				tail++;
+			}
+			r->tail.store(tail, std::memory_order_release);
+
+			if (m_capacity != 0 && m_heap.size() >= m_capacity)
+			{
+				m_next_ring = i + 1;
+				break;
+			}
+		}
+	}
+
+	static inline std::atomic<uint64_t> s_next_id{0};
+
+	const size_t m_capacity;
+	const size_t m_ring_capacity;
+	const uint64_t m_id;
+	std::shared_ptr<shared_state> m_state;
+	std::atomic<uint64_t> m_num_drops{0};
+
+	// consumer-only state
+	std::priority_queue<queue_elm> m_heap{};
+	uint64_t m_elem_counter{0};
+	size_t m_next_ring{0};
+};
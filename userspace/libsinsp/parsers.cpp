@@ -42,10 +42,6 @@ limitations under the License.
 #include <libsinsp/sinsp_observer.h>
 #include <libsinsp/sinsp_int.h>
 
-#if !defined(MINIMAL_BUILD) && !defined(__EMSCRIPTEN__)
-#include <libsinsp/container_engine/docker/async_source.h>
-#endif
-
 sinsp_parser::sinsp_parser(sinsp *inspector) :
 	m_inspector(inspector),
 	m_tmp_evt(m_inspector),
@@ -111,7 +107,8 @@ void sinsp_parser::process_event(sinsp_evt *evt)
 	{
 		ppm_event_flags eflags = evt->get_info_flags();
 
-		if(eflags & EF_MODIFIES_STATE)
+		// async events can carry the result of a /proc lookup
+		if(eflags & EF_MODIFIES_STATE || etype == PPME_ASYNCEVENT_E)
 		{
 			do_filter_later = true;
 		}
@@ -426,6 +423,9 @@ void sinsp_parser::process_event(sinsp_evt *evt)
 	case PPME_GROUP_DELETED_E:
 		parse_group_evt(evt);
 		break;
+	case PPME_ASYNCEVENT_E:
+		parse_async_evt(evt);
+		break;
 	case PPME_SYSCALL_PRCTL_X:
 		parse_prctl_exit_event(evt);
 		break;
@@ -461,10 +461,12 @@ void sinsp_parser::process_event(sinsp_evt *evt)
 
 	// Check to see if the name changed as a side-effect of
 	// parsing this event. Try to avoid the overhead of a string
-	// compare for every event.
-	if(evt->get_fd_info())
+	// compare for every event. Names still to be rendered from
+	// the socket tuple were checked when the tuple was updated.
+	if(evt->get_fd_info() && !evt->get_fd_info()->is_name_pending() &&
+	   evt->get_fd_info()->get_name() != evt->get_fd_info()->m_oldname)
 	{
-		evt->set_fdinfo_name_changed(evt->get_fd_info()->m_name != evt->get_fd_info()->m_oldname);
+		evt->set_fdinfo_name_changed(true);
 	}
 }
 
@@ -1156,19 +1158,10 @@ void sinsp_parser::parse_clone_exit_caller(sinsp_evt *evt, int64_t child_tid)
 			sinsp_fdtable* fd_table_ptr = caller_tinfo->get_fd_table();
 			if(fd_table_ptr != NULL)
 			{
-				child_tinfo->get_fdtable().clear();
-				fd_table_ptr->const_loop([&child_tinfo](int64_t fd, const sinsp_fdinfo& info) {
-					/* Track down that those are cloned fds */
-					auto newinfo = info.clone();
-					newinfo->set_is_cloned();
-					child_tinfo->get_fdtable().add(fd, std::move(newinfo));
-					return true;
-				});
-
-				/* It's important to reset the cache of the child thread, to prevent it from
-				* referring to an element in the parent's table.
+				/* The fds are shared with the parent until one of the two
+				* modifies them, they are marked as cloned then.
 				*/
-				child_tinfo->get_fdtable().reset_cache();
+				child_tinfo->get_fdtable().inherit_from(*fd_table_ptr);
 			}
 			else
 			{
@@ -1253,6 +1246,9 @@ void sinsp_parser::parse_clone_exit_caller(sinsp_evt *evt, int64_t child_tid)
 		ASSERT(false);
 	}
 
+	/* the env and the args are set before the comm */
+	child_tinfo->update_derived_strings();
+
 	/* fdlimit */
 	child_tinfo->m_fdlimit = evt->get_param(7)->as<int64_t>();
 
@@ -1748,21 +1744,11 @@ void sinsp_parser::parse_clone_exit_child(sinsp_evt *evt)
 			sinsp_fdtable *fd_table_ptr = lookup_tinfo->get_fd_table();
 			if(fd_table_ptr != NULL)
 			{
-				child_tinfo->get_fdtable().clear();
-				fd_table_ptr->loop([&child_tinfo](int64_t fd, const sinsp_fdinfo& info) {
-					/* Track down that those are cloned fds.
-					* This flag `FLAGS_IS_CLONED` seems to be never used...
-					*/
-					auto newinfo = info.clone();
-					newinfo->set_is_cloned();
-					child_tinfo->get_fdtable().add(fd, std::move(newinfo));
-					return true;
-				});
-
-				/* It's important to reset the cache of the child thread, to prevent it from
-				 * referring to an element in the parent's table.
+				/* The fds are shared with the parent until one of the two
+				 * modifies them, they are marked as cloned then.
+				 * This flag `FLAGS_IS_CLONED` seems to be never used...
 				 */
-				child_tinfo->get_fdtable().reset_cache();
+				child_tinfo->get_fdtable().inherit_from(*fd_table_ptr);
 			}
 			else
 			{
@@ -1777,6 +1763,7 @@ void sinsp_parser::parse_clone_exit_child(sinsp_evt *evt)
 
 			/* Not a thread, copy env */
 			child_tinfo->m_env = lookup_tinfo->m_env;
+			child_tinfo->update_derived_strings();
 		}
 		else
 		{
@@ -2049,6 +2036,10 @@ void sinsp_parser::parse_execve_exit(sinsp_evt *evt)
 		evt->get_tinfo()->resurrect_thread();
 	}
 
+	// The ancestors cached by the thread and its descendants
+	// must be looked up again after the exec
+	evt->get_tinfo()->invalidate_lineage();
+
 	// Get the exe
 	parinfo = evt->get_param(1);
 	evt->get_tinfo()->m_exe = parinfo->m_val;
@@ -2536,12 +2527,12 @@ std::string sinsp_parser::parse_dirfd(sinsp_evt *evt, std::string_view name, int
 		return "<UNKNOWN>";
 	}
 
-	if(evt->get_fd_info()->m_name[evt->get_fd_info()->m_name.length()] == '/')
+	if(evt->get_fd_info()->get_name().str()[evt->get_fd_info()->get_name().length()] == '/')
 	{
-		return evt->get_fd_info()->m_name;
+		return evt->get_fd_info()->get_name();
 	}
 
-	tdirstr = evt->get_fd_info()->m_name + '/';
+	tdirstr = evt->get_fd_info()->get_name().str() + '/';
 	return tdirstr;
 }
 
@@ -3075,7 +3066,7 @@ void sinsp_parser::parse_bind_exit(sinsp_evt *evt)
 	//
 	// Update the name of this socket
 	//
-	evt->get_fd_info()->m_name = evt->get_param_as_str(1, &parstr, sinsp_evt::PF_SIMPLE);
+	evt->get_fd_info()->set_name(evt->get_param_as_str(1, &parstr, sinsp_evt::PF_SIMPLE));
 
 	//
 	// If there's a listener callback, invoke it
@@ -3105,6 +3096,7 @@ void sinsp_parser::parse_connect_enter(sinsp_evt *evt){
 
 	if(evt->get_num_params() < 2)
 	{
+		sinsp_sockinfo prev_sockinfo = evt->get_fd_info()->m_sockinfo;
 		switch(evt->get_fd_info()->m_type)
 		{
 		case SCAP_FD_IPV4_SOCK:
@@ -3118,12 +3110,7 @@ void sinsp_parser::parse_connect_enter(sinsp_evt *evt){
 		default:
 			break;
 		}
-		sinsp_utils::sockinfo_to_str(&evt->get_fd_info()->m_sockinfo,
-					     evt->get_fd_info()->m_type, &evt->get_paramstr_storage()[0],
-					     (uint32_t)evt->get_paramstr_storage().size(),
-					     m_inspector->is_hostname_and_port_resolution_enabled());
-
-		evt->get_fd_info()->m_name = &evt->get_paramstr_storage()[0];
+		set_fd_name_from_tuple(evt, prev_sockinfo);
 		return;
 	}
 
@@ -3143,6 +3130,13 @@ void sinsp_parser::parse_connect_enter(sinsp_evt *evt){
 
 	uint8_t family = *packed_data;
 
+	// the name must not follow the tuple changes below until the
+	// connection succeeds, render it from the current tuple first
+	if(evt->get_fd_info()->is_name_pending())
+	{
+		evt->get_fd_info()->get_name();
+	}
+
 	if(family == PPM_AF_INET)
 	{
 		evt->get_fd_info()->m_type = SCAP_FD_IPV4_SOCK;
@@ -3171,7 +3165,7 @@ void sinsp_parser::parse_connect_enter(sinsp_evt *evt){
         //
         // Add the friendly name to the fd info
         //
-        evt->get_fd_info()->m_name = evt->get_param_as_str(1, &parstr, sinsp_evt::PF_SIMPLE);
+        evt->get_fd_info()->set_name(evt->get_param_as_str(1, &parstr, sinsp_evt::PF_SIMPLE));
 
         //
         // Update the FD with this tuple
@@ -3192,6 +3186,7 @@ inline void sinsp_parser::fill_client_socket_info(sinsp_evt *evt, uint8_t *packe
     uint8_t family;
     const char *parstr;
     bool changed;
+    sinsp_sockinfo prev_sockinfo = evt->get_fd_info()->m_sockinfo;
 
     //
     // Validate the family
@@ -3242,12 +3237,7 @@ inline void sinsp_parser::fill_client_socket_info(sinsp_evt *evt, uint8_t *packe
         //
         // Add the friendly name to the fd info
         //
-		sinsp_utils::sockinfo_to_str(&evt->get_fd_info()->m_sockinfo,
-										evt->get_fd_info()->m_type, &evt->get_paramstr_storage()[0],
-										(uint32_t)evt->get_paramstr_storage().size(),
-										m_inspector->is_hostname_and_port_resolution_enabled());
-
-		evt->get_fd_info()->m_name = &evt->get_paramstr_storage()[0];
+		set_fd_name_from_tuple(evt, prev_sockinfo);
     }
     else
     {
@@ -3264,7 +3254,7 @@ inline void sinsp_parser::fill_client_socket_info(sinsp_evt *evt, uint8_t *packe
         //
         // Add the friendly name to the fd info
         //
-        evt->get_fd_info()->m_name = evt->get_param_as_str(1, &parstr, sinsp_evt::PF_SIMPLE);
+        evt->get_fd_info()->set_name(evt->get_param_as_str(1, &parstr, sinsp_evt::PF_SIMPLE));
 
         //
         // Update the FD with this tuple
@@ -3472,7 +3462,14 @@ void sinsp_parser::parse_accept_exit(sinsp_evt *evt)
 		return;
 	}
 
-	fdi->m_name = evt->get_param_as_str(1, &parstr, sinsp_evt::PF_SIMPLE);
+	if(fdi->m_type == SCAP_FD_UNIX_SOCK)
+	{
+		fdi->set_name(evt->get_param_as_str(1, &parstr, sinsp_evt::PF_SIMPLE));
+	}
+	else
+	{
+		fdi->set_name_from_tuple(m_inspector->is_hostname_and_port_resolution_enabled());
+	}
 	fdi->m_flags = 0;
 
 	if(m_inspector->get_observer())
@@ -3547,6 +3544,11 @@ void sinsp_parser::erase_fd(erase_fd_params* params)
 	{
 		m_inspector->get_observer()->on_erase_fd(params);
 	}
+
+	if(m_inspector->get_flow_table()->is_enabled())
+	{
+		m_inspector->get_flow_table()->on_close(params->m_tinfo->m_pid, params->m_fd);
+	}
 }
 
 void sinsp_parser::parse_close_exit(sinsp_evt *evt)
@@ -3952,7 +3954,7 @@ bool sinsp_parser::update_fd(sinsp_evt *evt, const sinsp_evt_param *parinfo)
 	{
 		evt->get_fd_info()->m_type = SCAP_FD_UNIX_SOCK;
 		evt->get_fd_info()->set_unix_info(packed_data);
-		evt->get_fd_info()->m_name = ((char*)packed_data) + 17;
+		evt->get_fd_info()->set_name(((char*)packed_data) + 17);
 
 		return true;
 	}
@@ -3985,6 +3987,20 @@ bool sinsp_parser::update_fd(sinsp_evt *evt, const sinsp_evt_param *parinfo)
 	return true;
 }
 
+void sinsp_parser::set_fd_name_from_tuple(sinsp_evt* evt, const sinsp_sockinfo& prev_sockinfo)
+{
+	sinsp_fdinfo* fdinfo = evt->get_fd_info();
+	bool had_name = fdinfo->is_name_pending() || !fdinfo->get_name().empty();
+
+	// the name is rendered only if somebody reads it, but a new tuple
+	// tells already if it changed
+	fdinfo->set_name_from_tuple(m_inspector->is_hostname_and_port_resolution_enabled());
+	if(!had_name || memcmp(&prev_sockinfo, &fdinfo->m_sockinfo, sizeof(sinsp_sockinfo)) != 0)
+	{
+		evt->set_fdinfo_name_changed(true);
+	}
+}
+
 void sinsp_parser::swap_addresses(sinsp_fdinfo* fdinfo)
 {
 	if(fdinfo->m_type == SCAP_FD_IPV4_SOCK)
@@ -4069,8 +4085,10 @@ void sinsp_parser::parse_rw_exit(sinsp_evt *evt)
 				tupleparam = 3;
 			}
 
-			if(tupleparam != -1 && (evt->get_fd_info()->m_name.length() == 0 || !evt->get_fd_info()->is_tcp_socket()))
+			if(tupleparam != -1 && ((!evt->get_fd_info()->is_name_pending() && evt->get_fd_info()->get_name().empty()) || !evt->get_fd_info()->is_tcp_socket()))
 			{
+				sinsp_sockinfo prev_sockinfo = evt->get_fd_info()->m_sockinfo;
+
 				//
 				// recvfrom contains tuple info.
 				// If the fd still doesn't contain tuple info (because the socket is a
@@ -4099,16 +4117,11 @@ void sinsp_parser::parse_rw_exit(sinsp_evt *evt)
 							swap_addresses(evt->get_fd_info());
 						}
 
-						sinsp_utils::sockinfo_to_str(&evt->get_fd_info()->m_sockinfo,
-							fdtype, &evt->get_paramstr_storage()[0],
-							(uint32_t)evt->get_paramstr_storage().size(),
-							m_inspector->is_hostname_and_port_resolution_enabled());
-
-						evt->get_fd_info()->m_name = &evt->get_paramstr_storage()[0];
+						set_fd_name_from_tuple(evt, prev_sockinfo);
 					}
 					else
 					{
-						evt->get_fd_info()->m_name = evt->get_param_as_str(tupleparam, &parstr, sinsp_evt::PF_SIMPLE);
+						evt->get_fd_info()->set_name(evt->get_param_as_str(tupleparam, &parstr, sinsp_evt::PF_SIMPLE));
 					}
 				}
 			}
@@ -4137,6 +4150,14 @@ void sinsp_parser::parse_rw_exit(sinsp_evt *evt)
 					data, (uint32_t)retval, datalen);
 			}
 
+			if(m_inspector->get_flow_table()->is_enabled())
+			{
+				sinsp_threadinfo* main_thread = evt->get_tinfo()->get_main_thread();
+				m_inspector->get_flow_table()->on_io(evt->get_tinfo()->m_pid,
+					main_thread != nullptr ? main_thread->m_clone_ts : 0, evt->get_tinfo()->m_lastevent_fd,
+					*evt->get_fd_info(), true, (uint64_t)retval, evt->get_ts());
+			}
+
 			//
 			// Check if recvmsg contains ancillary data. If so, we check for SCM_RIGHTS,
 			// which is used to pass FDs between processes, and update the sinsp state
@@ -4161,6 +4182,7 @@ void sinsp_parser::parse_rw_exit(sinsp_evt *evt)
 
 						// Get the new fds. The callbacks we have registered populate the fd table
 						// with the new file descriptors.
+						auto platform_lock = m_inspector->m_thread_manager->lock_scap_platform();
 						if (scap_get_fdlist(m_inspector->get_scap_platform(), &scap_tinfo, error) != SCAP_SUCCESS)
 						{
 							libsinsp_logger()->format(sinsp_logger::SEV_DEBUG, "scap_get_fdlist failed: %s, proc table will not be updated with new fds.",
@@ -4183,8 +4205,10 @@ void sinsp_parser::parse_rw_exit(sinsp_evt *evt)
 				tupleparam = 2;
 			}
 
-			if(tupleparam != -1 && (evt->get_fd_info()->m_name.length() == 0 || !evt->get_fd_info()->is_tcp_socket()))
+			if(tupleparam != -1 && ((!evt->get_fd_info()->is_name_pending() && evt->get_fd_info()->get_name().empty()) || !evt->get_fd_info()->is_tcp_socket()))
 			{
+				sinsp_sockinfo prev_sockinfo = evt->get_fd_info()->m_sockinfo;
+
 				//
 				// sendto contains tuple info in the enter event.
 				// If the fd still doesn't contain tuple info (because the socket is a datagram one or because some event was lost),
@@ -4217,16 +4241,11 @@ void sinsp_parser::parse_rw_exit(sinsp_evt *evt)
 							swap_addresses(evt->get_fd_info());
 						}
 
-						sinsp_utils::sockinfo_to_str(&evt->get_fd_info()->m_sockinfo,
-							fdtype, &evt->get_paramstr_storage()[0],
-							(uint32_t)evt->get_paramstr_storage().size(),
-							m_inspector->is_hostname_and_port_resolution_enabled());
-
-						evt->get_fd_info()->m_name = &evt->get_paramstr_storage()[0];
+						set_fd_name_from_tuple(evt, prev_sockinfo);
 					}
 					else
 					{
-						evt->get_fd_info()->m_name = enter_evt->get_param_as_str(tupleparam, &parstr, sinsp_evt::PF_SIMPLE);
+						evt->get_fd_info()->set_name(enter_evt->get_param_as_str(tupleparam, &parstr, sinsp_evt::PF_SIMPLE));
 					}
 				}
 			}
@@ -4247,6 +4266,14 @@ void sinsp_parser::parse_rw_exit(sinsp_evt *evt)
 					data, (uint32_t)retval, datalen);
 			}
 
+			if(m_inspector->get_flow_table()->is_enabled())
+			{
+				sinsp_threadinfo* main_thread = evt->get_tinfo()->get_main_thread();
+				m_inspector->get_flow_table()->on_io(evt->get_tinfo()->m_pid,
+					main_thread != nullptr ? main_thread->m_clone_ts : 0, evt->get_tinfo()->m_lastevent_fd,
+					*evt->get_fd_info(), false, (uint64_t)retval, evt->get_ts());
+			}
+
 			// perform syslog decoding if applicable
 			if (evt->get_fd_info()->is_syslog())
 			{
@@ -4393,7 +4420,7 @@ void sinsp_parser::parse_fchdir_exit(sinsp_evt *evt)
 		}
 
 		// Update the thread working directory
-		evt->get_tinfo()->update_cwd(evt->get_fd_info()->m_name);
+		evt->get_tinfo()->update_cwd(evt->get_fd_info()->get_name().str());
 	}
 }
 
@@ -4947,53 +4974,6 @@ void sinsp_parser::parse_setgid_exit(sinsp_evt *evt)
 	}
 }
 
-namespace
-{
-	std::string generate_error_message(const Json::Value& value, const char* field) {
-		std::string val_as_string = value.isConvertibleTo(Json::stringValue) ? value.asString().c_str() : "value not convertible to string";
-		std::string err_msg = "Unable to convert json value '" + val_as_string + "' for the field: '" + field +"'";
-
-		return err_msg;
-	}
-
-	bool check_int64_json_is_convertible(const Json::Value& value, const char* field) {
-		if(!value.isNull())
-		{
-			// isConvertibleTo doesn't seem to work on large 64 bit numbers
-			if(value.isInt64()) {
-				return true;
-			} else {
-				std::string err_msg = generate_error_message(value, field);
-				SINSP_DEBUG("%s",err_msg.c_str());
-			}
-		}
-		return false;
-	}
-
-	bool check_json_val_is_convertible(const Json::Value& value, Json::ValueType other, const char* field, bool log_message=false)
-	{
-		if(value.isNull()) {
-			return false;
-		}
-
-		if(!value.isConvertibleTo(other)) {
-			std::string err_msg;
-
-			if(log_message) {
-				err_msg = generate_error_message(value, field);
-				SINSP_WARNING("%s",err_msg.c_str());
-			} else {
-				if(libsinsp_logger()->get_severity() >= sinsp_logger::SEV_DEBUG) {
-					err_msg = generate_error_message(value, field);
-					SINSP_DEBUG("%s",err_msg.c_str());
-				}
-			}
-			return false;
-		}
-		return true;
-	}
-}
-
 void sinsp_parser::parse_container_json_evt(sinsp_evt *evt)
 {
 	if(evt->get_tinfo_ref() != nullptr)
@@ -5013,223 +4993,16 @@ void sinsp_parser::parse_container_json_evt(sinsp_evt *evt)
 	ASSERT(parinfo->m_len > 0);
 	std::string json(parinfo->m_val, parinfo->m_len);
 	SINSP_DEBUG("Parsing Container JSON=%s", json.c_str());
-	Json::Value root;
-	if(Json::Reader().parse(json, root))
+	auto container_info = std::make_shared<sinsp_container_info>();
+	if(m_inspector->m_container_manager.container_from_json(json, *container_info))
 	{
-		auto container_info = std::make_shared<sinsp_container_info>();
-		const Json::Value& container = root["container"];
-		const Json::Value& id = container["id"];
-		if(check_json_val_is_convertible(id, Json::stringValue, "id"))
-		{
-			container_info->m_id = id.asString();
-		}
-		const Json::Value& full_id = container["full_id"];
-		if(check_json_val_is_convertible(full_id, Json::stringValue, "full_id"))
-		{
-			container_info->m_full_id = full_id.asString();
-		}
-		const Json::Value& type = container["type"];
-		if(check_json_val_is_convertible(type, Json::uintValue, "type"))
-		{
-			container_info->m_type = static_cast<sinsp_container_type>(type.asUInt());
-		}
-		const Json::Value& name = container["name"];
-		if(check_json_val_is_convertible(name, Json::stringValue, "name"))
-		{
-			container_info->m_name = name.asString();
-		}
-
-		const Json::Value& is_pod_sandbox = container["is_pod_sandbox"];
-		if(check_json_val_is_convertible(is_pod_sandbox, Json::booleanValue, "is_pod_sandbox"))
-		{
-			container_info->m_is_pod_sandbox = is_pod_sandbox.asBool();
-		}
-
-		const Json::Value& image = container["image"];
-		if(check_json_val_is_convertible(image, Json::stringValue, "image"))
-		{
-			container_info->m_image = image.asString();
-		}
-		const Json::Value& imageid = container["imageid"];
-		if(check_json_val_is_convertible(imageid, Json::stringValue, "imageid"))
-		{
-			container_info->m_imageid = imageid.asString();
-		}
-		const Json::Value& imagerepo = container["imagerepo"];
-		if(check_json_val_is_convertible(imagerepo, Json::stringValue, "imagerepo"))
-		{
-			container_info->m_imagerepo = imagerepo.asString();
-		}
-		const Json::Value& imagetag = container["imagetag"];
-		if(check_json_val_is_convertible(imagetag, Json::stringValue, "imagetag"))
-		{
-			container_info->m_imagetag = imagetag.asString();
-		}
-		const Json::Value& imagedigest = container["imagedigest"];
-		if(check_json_val_is_convertible(imagedigest, Json::stringValue, "imagedigest"))
-		{
-			container_info->m_imagedigest = imagedigest.asString();
-		}
-		const Json::Value& privileged = container["privileged"];
-		if(check_json_val_is_convertible(privileged, Json::booleanValue, "privileged"))
-		{
-			container_info->m_privileged = privileged.asBool();
-		}
-		const Json::Value& lookup_state = container["lookup_state"];
-		if(check_json_val_is_convertible(lookup_state, Json::uintValue, "lookup_state"))
-		{
-			container_info->set_lookup_status(static_cast<sinsp_container_lookup::state>(lookup_state.asUInt()));
-			switch(container_info->get_lookup_status())
-			{
-			case sinsp_container_lookup::state::STARTED:
-			case sinsp_container_lookup::state::SUCCESSFUL:
-			case sinsp_container_lookup::state::FAILED:
-				break;
-			default:
-				container_info->set_lookup_status(sinsp_container_lookup::state::SUCCESSFUL);
-			}
-
-			// state == STARTED doesn't make sense in a scap file
-			// as there's no actual lookup that would ever finish
-			if(!evt->get_tinfo_ref() && container_info->get_lookup_status() == sinsp_container_lookup::state::STARTED)
-			{
-				SINSP_DEBUG("Rewriting lookup_state = STARTED from scap file to FAILED for container %s",
-					container_info->m_id.c_str());
-				container_info->set_lookup_status(sinsp_container_lookup::state::FAILED);
-			}
-		}
-
-		const Json::Value& created_time = container["created_time"];
-		if(check_int64_json_is_convertible(created_time, "created_time"))
-		{
-			container_info->m_created_time = created_time.asInt64();
-		}
-
-#if !defined(MINIMAL_BUILD) && !defined(_WIN32) && !defined(__EMSCRIPTEN__)
-		libsinsp::container_engine::docker_async_source::parse_json_mounts(container["Mounts"], container_info->m_mounts);
-#endif
-
-		const Json::Value& user = container["User"];
-		if(check_json_val_is_convertible(user, Json::stringValue, "User"))
+		// state == STARTED doesn't make sense in a scap file
+		// as there's no actual lookup that would ever finish
+		if(!evt->get_tinfo_ref() && container_info->get_lookup_status() == sinsp_container_lookup::state::STARTED)
 		{
-			container_info->m_container_user = user.asString();
-		}
-
-		sinsp_container_info::container_health_probe::parse_health_probes(container, container_info->m_health_probes);
-
-		const Json::Value& contip = container["ip"];
-		if(check_json_val_is_convertible(contip, Json::stringValue, "ip"))
-		{
-			uint32_t ip;
-
-			if(inet_pton(AF_INET, contip.asString().c_str(), &ip) == -1)
-			{
-				throw sinsp_exception("Invalid 'ip' field while parsing container info: " + json);
-			}
-
-			container_info->m_container_ip = ntohl(ip);
-		}
-
-		const Json::Value& cniresult = container["cni_json"];
-		if(check_json_val_is_convertible(cniresult, Json::stringValue, "cni_json"))
-		{
-			container_info->m_pod_cniresult = cniresult.asString();
-		}
-
-		const Json::Value &port_mappings = container["port_mappings"];
-
-		if(check_json_val_is_convertible(port_mappings, Json::arrayValue, "port_mappings"))
-		{
-			for (Json::Value::ArrayIndex i = 0; i != port_mappings.size(); i++)
-			{
-				sinsp_container_info::container_port_mapping map;
-				const Json::Value &host_ip = port_mappings[i]["HostIp"];
-				// We log message for HostIp conversion failure at Warning level
-				if(check_json_val_is_convertible(host_ip, Json::intValue, "HostIp", true)) {
-					map.m_host_ip = host_ip.asInt();
-				}
-				const Json::Value& host_port = port_mappings[i]["HostPort"];
-				// We log message for HostPort conversion failure at Warning level
-				if(check_json_val_is_convertible(host_port, Json::intValue, "HostPort", true)) {
-					map.m_host_port = (uint16_t) host_port.asInt();
-				}
-				const Json::Value& container_port = port_mappings[i]["ContainerPort"];
-				// We log message for ContainerPort conversion failure at Warning level
-				if(check_json_val_is_convertible(container_port, Json::intValue, "ContainerPort", true)) {
-					map.m_container_port = (uint16_t) container_port.asInt();
-				}
-				container_info->m_port_mappings.push_back(map);
-			}
-		}
-
-		std::vector<std::string> labels = container["labels"].getMemberNames();
-		for(std::vector<std::string>::const_iterator it = labels.begin(); it != labels.end(); ++it)
-		{
-			std::string val = container["labels"][*it].asString();
-			container_info->m_labels[*it] = val;
-		}
-
-		const Json::Value& env_vars = container["env"];
-
-		for(const auto& env_var : env_vars)
-		{
-			if(env_var.isString())
-			{
-				container_info->m_env.emplace_back(env_var.asString());
-			}
-		}
-
-		const Json::Value& memory_limit = container["memory_limit"];
-		if(check_int64_json_is_convertible(memory_limit, "memory_limit"))
-		{
-			container_info->m_memory_limit = memory_limit.asInt64();
-		}
-
-		const Json::Value& swap_limit = container["swap_limit"];
-		if(check_int64_json_is_convertible(swap_limit, "swap_limit"))
-		{
-			container_info->m_swap_limit = swap_limit.asInt64();
-		}
-
-		const Json::Value& cpu_shares = container["cpu_shares"];
-		if(check_int64_json_is_convertible(cpu_shares, "cpu_shares"))
-		{
-			container_info->m_cpu_shares = cpu_shares.asInt64();
-		}
-
-		const Json::Value& cpu_quota = container["cpu_quota"];
-		if(check_int64_json_is_convertible(cpu_quota, "cpu_quota"))
-		{
-			container_info->m_cpu_quota = cpu_quota.asInt64();
-		}
-
-		const Json::Value& cpu_period = container["cpu_period"];
-		if(check_int64_json_is_convertible(cpu_period, "cpu_period"))
-		{
-			container_info->m_cpu_period = cpu_period.asInt64();
-		}
-
-		const Json::Value& cpuset_cpu_count = container["cpuset_cpu_count"];
-		if(check_json_val_is_convertible(cpuset_cpu_count, Json::intValue, "cpuset_cpu_count"))
-		{
-			container_info->m_cpuset_cpu_count = cpuset_cpu_count.asInt();
-		}
-
-		const Json::Value& mesos_task_id = container["mesos_task_id"];
-		if(check_json_val_is_convertible(mesos_task_id, Json::stringValue, "mesos_task_id"))
-		{
-			container_info->m_mesos_task_id = mesos_task_id.asString();
-		}
-
-		const Json::Value& metadata_deadline = container["metadata_deadline"];
-		if(!metadata_deadline.isNull())
-		{
-			// isConvertibleTo doesn't seem to work on large 64 bit numbers
-			if(metadata_deadline.isUInt64()) {
-				container_info->m_metadata_deadline = metadata_deadline.asUInt64();
-			} else {
-				SINSP_DEBUG("Unable to convert json value for field: %s", "metadata_deadline");
-			}
+			SINSP_DEBUG("Rewriting lookup_state = STARTED from scap file to FAILED for container %s",
+				container_info->m_id.c_str());
+			container_info->set_lookup_status(sinsp_container_lookup::state::FAILED);
 		}
 
 		if(!container_info->is_successful())
@@ -5314,6 +5087,17 @@ void sinsp_parser::parse_group_evt(sinsp_evt *evt)
 	}
 }
 
+void sinsp_parser::parse_async_evt(sinsp_evt *evt)
+{
+	// plugins can also send async events with a zero plugin ID, in which
+	// case the thread manager ignores the tid as it has no lookup pending
+	if(evt->get_param(0)->as<uint32_t>() == 0 &&
+	   evt->get_param(1)->as<std::string_view>() == sinsp_thread_manager::s_proc_lookup_event_name)
+	{
+		m_inspector->m_thread_manager->merge_proc_lookup(evt->get_scap_evt()->tid);
+	}
+}
+
 void sinsp_parser::parse_cpu_hotplug_enter(sinsp_evt *evt)
 {
 	if(m_inspector->is_live() || m_inspector->is_syscall_plugin())
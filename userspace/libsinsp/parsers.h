@@ -113,6 +113,7 @@ private:
 	void parse_container_json_evt(sinsp_evt *evt);
 	void parse_user_evt(sinsp_evt *evt);
 	void parse_group_evt(sinsp_evt *evt);
+	void parse_async_evt(sinsp_evt *evt);
 	void parse_cpu_hotplug_enter(sinsp_evt* evt);
 	void parse_chroot_exit(sinsp_evt *evt);
 	void parse_setsid_exit(sinsp_evt *evt);
@@ -136,6 +137,8 @@ private:
 	bool set_unix_info(sinsp_fdinfo* fdinfo, uint8_t* packed_data);
 
 	void swap_addresses(sinsp_fdinfo* fdinfo);
+	// Mark the fd name to be rendered from its tuple, prev_sockinfo is the tuple before the update
+	void set_fd_name_from_tuple(sinsp_evt* evt, const sinsp_sockinfo& prev_sockinfo);
 	uint8_t* reserve_event_buffer();
 	void free_event_buffer(uint8_t*);
 
@@ -0,0 +1,435 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/persistent_cache.h>
+#include <libsinsp/logger.h>
+
+#include <cerrno>
+#include <cstring>
+#include <vector>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// "SPC" + format version
+const uint32_t file_magic = 0x02435053;
+const uint64_t header_size = sizeof(file_magic);
+// "SPCR", marks the start of every record so that the ones after a
+// damaged record can still be found
+const uint32_t record_marker = 0x52435053;
+// marker, type, key length, value length, checksum
+const uint64_t record_header_size = sizeof(record_marker) + 1 + 3 * sizeof(uint32_t);
+// smaller files are never compacted
+const uint64_t min_compact_size = 64 * 1024;
+
+uint64_t record_size(const std::string& key, const std::string& value)
+{
+	return record_header_size + key.size() + value.size();
+}
+
+// FNV-1a, covering the lengths too so that a damaged one is detected
+uint32_t checksum(uint8_t type, const char* key, uint32_t key_len, const char* value, uint32_t value_len)
+{
+	uint32_t h = 2166136261u;
+	auto update = [&h](const char* p, uint32_t len)
+	{
+		for(uint32_t j = 0; j < len; j++)
+		{
+			h = (h ^ (uint8_t)p[j]) * 16777619u;
+		}
+	};
+	update((const char*)&type, 1);
+	update((const char*)&key_len, sizeof(key_len));
+	update((const char*)&value_len, sizeof(value_len));
+	update(key, key_len);
+	update(value, value_len);
+	return h;
+}
+
+// The entries can hold container metadata, only the owner can read them
+FILE* open_private(const std::string& path, bool truncate)
+{
+#ifdef _WIN32
+	return fopen(path.c_str(), truncate ? "wb" : "ab");
+#else
+	int fd = open(path.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0), 0600);
+	if(fd < 0)
+	{
+		return nullptr;
+	}
+
+	// an existing file keeps its mode otherwise
+	FILE* f = nullptr;
+	if(fchmod(fd, 0600) != 0 || (f = fdopen(fd, "ab")) == nullptr)
+	{
+		int err = errno;
+		close(fd);
+		errno = err;
+		return nullptr;
+	}
+	return f;
+#endif
+}
+
+}
+
+libsinsp::persistent_cache::persistent_cache(const std::string& path):
+	m_path(path)
+{
+}
+
+libsinsp::persistent_cache::~persistent_cache()
+{
+	if(m_file)
+	{
+		fclose(m_file);
+	}
+}
+
+bool libsinsp::persistent_cache::load()
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+
+	if(m_file)
+	{
+		fclose(m_file);
+		m_file = nullptr;
+	}
+	m_entries.clear();
+	m_live_size = 0;
+	m_write_failed = false;
+
+	std::vector<char> buf;
+	FILE* f = fopen(m_path.c_str(), "rb");
+	if(f == nullptr)
+	{
+		if(errno != ENOENT)
+		{
+			libsinsp_logger()->format(sinsp_logger::SEV_WARNING,
+					"Cannot read state cache %s: %s, starting from scratch",
+					m_path.c_str(), strerror(errno));
+		}
+		return open_file(true);
+	}
+
+	char tmp[65536];
+	size_t n;
+	while((n = fread(tmp, 1, sizeof(tmp), f)) > 0)
+	{
+		buf.insert(buf.end(), tmp, tmp + n);
+	}
+	fclose(f);
+
+	uint32_t magic = 0;
+	if(buf.size() < header_size || (memcpy(&magic, buf.data(), sizeof(magic)), magic != file_magic))
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_WARNING,
+				"Unknown format for state cache %s, starting from scratch",
+				m_path.c_str());
+		return open_file(true);
+	}
+
+	uint64_t offset = header_size;
+	uint64_t damaged = 0;
+	while(offset < buf.size())
+	{
+		uint64_t size = read_record(buf, offset);
+		if(size == 0)
+		{
+			// skip to the next record, e.g. the one appended after a
+			// write that only partly succeeded
+			uint64_t next = offset + 1;
+			while(next + sizeof(record_marker) <= buf.size() &&
+			      memcmp(buf.data() + next, &record_marker, sizeof(record_marker)) != 0)
+			{
+				next++;
+			}
+			if(next + sizeof(record_marker) > buf.size())
+			{
+				next = buf.size();
+			}
+			damaged += next - offset;
+			offset = next;
+			continue;
+		}
+		offset += size;
+	}
+
+	for(const auto& e : m_entries)
+	{
+		m_live_size += record_size(e.first, e.second);
+	}
+	m_file_size = offset;
+
+	libsinsp_logger()->format(sinsp_logger::SEV_INFO,
+			"Loaded %zu entries from state cache %s",
+			m_entries.size(), m_path.c_str());
+
+	// start a clean file, so that the damaged bytes don't pile up
+	if(damaged > 0)
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_WARNING,
+				"Skipped %lu damaged bytes in state cache %s",
+				(unsigned long)damaged, m_path.c_str());
+		compact();
+		return m_file != nullptr;
+	}
+
+	return open_file(false);
+}
+
+void libsinsp::persistent_cache::foreach_entry(const std::string& prefix, const std::function<bool(const std::string& key, const std::string& value)>& pred)
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+	for(const auto& e : m_entries)
+	{
+		if(e.first.compare(0, prefix.size(), prefix) == 0 && !pred(e.first, e.second))
+		{
+			return;
+		}
+	}
+}
+
+bool libsinsp::persistent_cache::get(const std::string& key, std::string& value)
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+	auto it = m_entries.find(key);
+	if(it == m_entries.end())
+	{
+		return false;
+	}
+	value = it->second;
+	return true;
+}
+
+void libsinsp::persistent_cache::put(const std::string& key, const std::string& value)
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+	auto it = m_entries.find(key);
+	if(it != m_entries.end())
+	{
+		if(it->second == value)
+		{
+			return;
+		}
+		m_live_size -= record_size(key, it->second);
+		it->second = value;
+	}
+	else
+	{
+		m_entries.emplace(key, value);
+	}
+	m_live_size += record_size(key, value);
+
+	if(m_file)
+	{
+		append(m_file, RECORD_PUT, key, value);
+	}
+}
+
+void libsinsp::persistent_cache::erase(const std::string& key)
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+	auto it = m_entries.find(key);
+	if(it == m_entries.end())
+	{
+		return;
+	}
+	m_live_size -= record_size(key, it->second);
+	m_entries.erase(it);
+
+	if(m_file)
+	{
+		append(m_file, RECORD_ERASE, key, "");
+	}
+}
+
+void libsinsp::persistent_cache::flush()
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+	if(m_file == nullptr)
+	{
+		return;
+	}
+
+	// a failed append leaves the file behind the entries
+	if(m_write_failed ||
+	   (m_file_size > min_compact_size && m_file_size - header_size > 2 * m_live_size))
+	{
+		compact();
+	}
+	else
+	{
+		fflush(m_file);
+	}
+}
+
+size_t libsinsp::persistent_cache::get_num_entries()
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+	return m_entries.size();
+}
+
+uint64_t libsinsp::persistent_cache::read_record(const std::vector<char>& buf, uint64_t offset)
+{
+	if(offset + record_header_size > buf.size())
+	{
+		return 0;
+	}
+
+	const char* p = buf.data() + offset;
+	uint32_t marker, key_len, value_len, sum;
+	memcpy(&marker, p, sizeof(marker));
+	p += sizeof(marker);
+	uint8_t type = (uint8_t)p[0];
+	memcpy(&key_len, p + 1, sizeof(uint32_t));
+	memcpy(&value_len, p + 1 + sizeof(uint32_t), sizeof(uint32_t));
+	memcpy(&sum, p + 1 + 2 * sizeof(uint32_t), sizeof(uint32_t));
+
+	uint64_t size = record_header_size + (uint64_t)key_len + value_len;
+	if(marker != record_marker || offset + size > buf.size())
+	{
+		return 0;
+	}
+
+	const char* key = buf.data() + offset + record_header_size;
+	const char* value = key + key_len;
+	if((type != RECORD_PUT && type != RECORD_ERASE) ||
+	   checksum(type, key, key_len, value, value_len) != sum)
+	{
+		return 0;
+	}
+
+	if(type == RECORD_PUT)
+	{
+		m_entries[std::string(key, key_len)] = std::string(value, value_len);
+	}
+	else
+	{
+		m_entries.erase(std::string(key, key_len));
+	}
+	return size;
+}
+
+bool libsinsp::persistent_cache::append(FILE* f, record_type type, const std::string& key, const std::string& value)
+{
+	uint8_t t = type;
+	uint32_t key_len = key.size();
+	uint32_t value_len = value.size();
+	uint32_t sum = checksum(t, key.data(), key_len, value.data(), value_len);
+
+	// a single write, so that a failure doesn't leave half of the
+	// record buffered to be written later
+	std::string record;
+	record.reserve(record_size(key, value));
+	record.append((const char*)&record_marker, sizeof(record_marker));
+	record.append((const char*)&t, 1);
+	record.append((const char*)&key_len, sizeof(key_len));
+	record.append((const char*)&value_len, sizeof(value_len));
+	record.append((const char*)&sum, sizeof(sum));
+	record.append(key);
+	record.append(value);
+
+	size_t written = fwrite(record.data(), 1, record.size(), f);
+	if(f == m_file)
+	{
+		m_file_size += written;
+	}
+	if(written != record.size())
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_WARNING,
+				"Cannot write state cache %s: %s",
+				m_path.c_str(), strerror(errno));
+		m_write_failed = true;
+		return false;
+	}
+	return true;
+}
+
+bool libsinsp::persistent_cache::open_file(bool truncate)
+{
+	m_file = open_private(m_path, truncate);
+	if(m_file == nullptr)
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_WARNING,
+				"Cannot open state cache %s: %s, updates will not be saved",
+				m_path.c_str(), strerror(errno));
+		return false;
+	}
+
+	if(truncate)
+	{
+		m_file_size = header_size;
+		if(fwrite(&file_magic, sizeof(file_magic), 1, m_file) != 1)
+		{
+			fclose(m_file);
+			m_file = nullptr;
+			return false;
+		}
+	}
+	return true;
+}
+
+void libsinsp::persistent_cache::compact()
+{
+	if(m_file)
+	{
+		fclose(m_file);
+		m_file = nullptr;
+	}
+
+	// the new file replaces the old one only once complete
+	std::string tmp_path = m_path + ".tmp";
+	FILE* f = open_private(tmp_path, true);
+	bool ok = f != nullptr && fwrite(&file_magic, sizeof(file_magic), 1, f) == 1;
+	for(auto it = m_entries.begin(); ok && it != m_entries.end(); ++it)
+	{
+		ok = append(f, RECORD_PUT, it->first, it->second);
+	}
+	if(f != nullptr && fclose(f) != 0)
+	{
+		ok = false;
+	}
+
+#ifdef _WIN32
+	if(ok)
+	{
+		remove(m_path.c_str());
+	}
+#endif
+	if(!ok || rename(tmp_path.c_str(), m_path.c_str()) != 0)
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_WARNING,
+				"Cannot rewrite state cache %s: %s",
+				m_path.c_str(), strerror(errno));
+		remove(tmp_path.c_str());
+		// keep appending to the old file, the log is still valid
+		open_file(false);
+		return;
+	}
+
+	m_file_size = header_size + m_live_size;
+	m_write_failed = false;
+	m_n_compactions++;
+	open_file(false);
+}
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace libsinsp
+{
+
+//
+// Key/value store kept in a local binary file, used to carry state that is
+// expensive to rebuild, e.g. the container metadata, across restarts. The
+// file is an append-only log of updates: load() replays it once, then
+// every put() and erase() appends a record, and the file is rewritten with
+// only the live entries once the stale records take more room than them.
+// Records are checksummed and start with a marker, the damaged ones (e.g.
+// torn by a crash or a full disk) are skipped on load. The file is only
+// readable by its owner, and only meant to be read back on the same host,
+// so integers are stored in native byte order.
+//
+class persistent_cache
+{
+public:
+	explicit persistent_cache(const std::string& path);
+	~persistent_cache();
+
+	persistent_cache(const persistent_cache&) = delete;
+	persistent_cache& operator=(const persistent_cache&) = delete;
+
+	//
+	// Reads the entries stored in the file and opens it for the updates.
+	// A missing file is not an error, an unreadable one or one with an
+	// unknown format is replaced by an empty one
+	//
+	bool load();
+
+	const std::string& get_path() const { return m_path; }
+
+	//
+	// Calls pred for every entry whose key starts with prefix, pred
+	// returns false to stop the loop
+	//
+	void foreach_entry(const std::string& prefix, const std::function<bool(const std::string& key, const std::string& value)>& pred);
+
+	bool get(const std::string& key, std::string& value);
+	void put(const std::string& key, const std::string& value);
+	void erase(const std::string& key);
+
+	//
+	// Pushes the pending updates to the file, compacting it if worth it
+	//
+	void flush();
+
+	size_t get_num_entries();
+
+	inline uint64_t get_n_compactions() const
+	{
+		return m_n_compactions;
+	}
+
+private:
+	enum record_type : uint8_t
+	{
+		RECORD_PUT = 1,
+		RECORD_ERASE = 2,
+	};
+
+	// Applies the record at offset, returns its size or 0 if it's damaged
+	uint64_t read_record(const std::vector<char>& buf, uint64_t offset);
+	bool append(FILE* f, record_type type, const std::string& key, const std::string& value);
+	bool open_file(bool truncate);
+	void compact();
+
+	std::string m_path;
+	FILE* m_file = nullptr;
+	std::mutex m_mtx;
+	std::unordered_map<std::string, std::string> m_entries;
+	// size of the file and of the records of the live entries
+	uint64_t m_file_size = 0;
+	uint64_t m_live_size = 0;
+	uint64_t m_n_compactions = 0;
+	bool m_write_failed = false;
+};
+
+}
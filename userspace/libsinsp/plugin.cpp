@@ -211,6 +211,11 @@ bool sinsp_plugin::init(const std::string &config, std::string &errstr)
 		/* Here we populate the `m_extract_event_codes` for the plugin, while `m_extract_event_sources` is already populated in the plugin_init */
 		resolve_dylib_compatible_codes(m_handle->api.get_extract_event_types,
 			m_extract_event_sources, m_extract_event_codes);
+
+		// extracting several fields per call is opt-in: plugins written
+		// before it may share their result storage between fields
+		m_extract_batch_support = m_handle->api.get_extract_batch_support != NULL
+			&& m_handle->api.get_extract_batch_support(m_state);
 	}
 	if (m_caps & CAP_PARSING)
 	{
@@ -755,6 +760,7 @@ scap_source_plugin& sinsp_plugin::as_scap_source()
 	m_scap_source_plugin.close = m_handle->api.close;
 	m_scap_source_plugin.get_last_error = m_handle->api.get_last_error;
 	m_scap_source_plugin.next_batch = m_handle->api.next_batch;
+	m_scap_source_plugin.get_max_concurrent_instances = m_handle->api.get_max_concurrent_instances;
 	return m_scap_source_plugin;
 }
 
@@ -890,16 +896,68 @@ bool sinsp_plugin::extract_fields(sinsp_evt* evt, uint32_t num_fields, ss_plugin
 	ev.evtsrc = evt->get_source_name();
 
 	ss_plugin_field_extract_input in;
-	ss_plugin_table_reader_vtable_ext table_reader_ext;
 	in.num_fields = num_fields;
 	in.fields = fields;
 	in.owner = (ss_plugin_owner_t *) this;
 	in.get_owner_last_error = sinsp_plugin::get_owner_last_error;
-	in.table_reader_ext = &table_reader_ext;
-	sinsp_plugin::table_read_api(in.table_reader, table_reader_ext);
+	in.table_reader = m_extract_table_reader;
+	in.table_reader_ext = const_cast<ss_plugin_table_reader_vtable_ext*>(&m_extract_table_reader_ext);
+	m_num_extract_calls++;
 	return m_handle->api.extract_fields(m_state, &ev, &in) == SS_PLUGIN_SUCCESS;
 }
 
+size_t sinsp_plugin_extract_batch::add_field(const ss_plugin_extract_field& field)
+{
+	std::string arg_key = field.arg_key ? field.arg_key : "";
+	for (size_t i = 0; i < m_fields.size(); i++)
+	{
+		const auto& f = m_fields[i];
+		if (f.field_id == field.field_id
+			&& f.arg_present == field.arg_present
+			&& f.arg_index == field.arg_index
+			&& (f.arg_key != nullptr) == (field.arg_key != nullptr)
+			&& (f.arg_key == nullptr || arg_key == f.arg_key))
+		{
+			return i;
+		}
+	}
+
+	m_fields.push_back(field);
+	if (field.arg_key != nullptr)
+	{
+		m_arg_keys.push_back(arg_key);
+		m_fields.back().arg_key = (char*) m_arg_keys.back().c_str();
+	}
+
+	// the new field has no result for the cached event
+	m_evt = nullptr;
+	return m_fields.size() - 1;
+}
+
+const ss_plugin_extract_field* sinsp_plugin_extract_batch::extract(sinsp_evt* evt, size_t slot)
+{
+	// the results are valid until the plugin is asked for another extraction,
+	// a failed batch is not retried for the same event
+	if (m_evt != evt
+		|| m_scap_evt != evt->get_scap_evt()
+		|| m_evtnum != evt->get_num()
+		|| (m_ok && m_calls != m_plugin->num_extract_calls()))
+	{
+		for (auto& f : m_fields)
+		{
+			f.res_len = 0;
+		}
+		m_ok = m_plugin->extract_fields(evt, m_fields.size(), m_fields.data());
+		m_calls = m_plugin->num_extract_calls();
+		m_evt = evt;
+		m_scap_evt = evt->get_scap_evt();
+		m_evtnum = evt->get_num();
+	}
+
+	ASSERT(slot < m_fields.size());
+	return m_ok ? &m_fields[slot] : nullptr;
+}
+
 /** End of Field Extraction CAP **/
 
 /** Event Parsing CAP **/
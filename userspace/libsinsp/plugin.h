@@ -18,6 +18,7 @@ limitations under the License.
 
 #pragma once
 
+#include <deque>
 #include <memory>
 #include <unordered_set>
 #include <string>
@@ -118,7 +119,10 @@ public:
 		m_accessed_tables(),
 		m_async_event_sources(),
 		m_async_event_names(),
-		m_async_evt_handler(nullptr) { }
+		m_async_evt_handler(nullptr)
+	{
+		table_read_api(m_extract_table_reader, m_extract_table_reader_ext);
+	}
 	virtual ~sinsp_plugin();
 	sinsp_plugin(const sinsp_plugin& s) = delete;
 	sinsp_plugin& operator = (const sinsp_plugin& s) = delete;
@@ -191,6 +195,24 @@ public:
 
 	bool extract_fields(sinsp_evt* evt, uint32_t num_fields, ss_plugin_extract_field *fields) const;
 
+	/**
+	 * Whether the plugin allows extracting several fields per
+	 * extract_fields() call, see get_extract_batch_support in the plugin API.
+	 */
+	inline bool extract_batch_support() const
+	{
+		return m_extract_batch_support;
+	}
+
+	/**
+	 * Number of extract_fields() calls so far. The results of an extraction
+	 * are owned by the plugin and may be overwritten by the next call.
+	 */
+	inline uint64_t num_extract_calls() const
+	{
+		return m_num_extract_calls;
+	}
+
 	/** Event Parsing **/
 	inline const std::unordered_set<std::string>& parse_event_sources() const
 	{
@@ -245,6 +267,11 @@ private:
 	std::vector<filtercheck_field_info> m_fields;
 	std::unordered_set<std::string> m_extract_event_sources;
 	libsinsp::events::set<ppm_event_code> m_extract_event_codes;
+	ss_plugin_table_reader_vtable m_extract_table_reader;
+	ss_plugin_table_reader_vtable_ext m_extract_table_reader_ext;
+	mutable uint64_t m_num_extract_calls = 0;
+	bool m_extract_batch_support = false;
+
 
 	/** Event Parsing **/
 	struct accessed_table_input_deleter { void operator()(ss_plugin_table_input* r); };
@@ -291,3 +318,38 @@ private:
 
 	friend struct sinsp_table_wrapper;
 };
+
+/**
+ * Fields of a plugin extracted with a single extract_fields() call per event.
+ * Each filter and formatter groups the fields of its plugin filterchecks in
+ * one batch, see sinsp_filter_check_plugin::group_batch_fields().
+ */
+class sinsp_plugin_extract_batch
+{
+public:
+	explicit sinsp_plugin_extract_batch(std::shared_ptr<sinsp_plugin> plugin):
+		m_plugin(std::move(plugin)) { }
+
+	/**
+	 * Adds a field to the batch and returns its slot. The same field
+	 * added twice is extracted once.
+	 */
+	size_t add_field(const ss_plugin_extract_field& field);
+
+	/**
+	 * Returns the result of a field, extracting the whole batch on the first
+	 * request of an event. Returns nullptr if the plugin failed to extract
+	 * the batch, in which case the field must be extracted alone.
+	 */
+	const ss_plugin_extract_field* extract(sinsp_evt* evt, size_t slot);
+
+private:
+	std::shared_ptr<sinsp_plugin> m_plugin;
+	std::vector<ss_plugin_extract_field> m_fields;
+	std::deque<std::string> m_arg_keys; // stable storage for the fields arg_key
+	bool m_ok = false;
+	const sinsp_evt* m_evt = nullptr;
+	const scap_evt* m_scap_evt = nullptr;
+	uint64_t m_evtnum = 0;
+	uint64_t m_calls = 0;
+};
@@ -19,6 +19,8 @@ limitations under the License.
 #include <libsinsp/plugin_filtercheck.h>
 #include <libsinsp/plugin_manager.h>
 
+#include <unordered_map>
+
 using namespace std;
 
 sinsp_filter_check_plugin::sinsp_filter_check_plugin()
@@ -53,6 +55,9 @@ sinsp_filter_check_plugin::sinsp_filter_check_plugin(const sinsp_filter_check_pl
 
 int32_t sinsp_filter_check_plugin::parse_field_name(const char* str, bool alloc_state, bool needed_for_filtering)
 {
+	m_batchable = false;
+	m_batch.reset();
+
 	int32_t res = sinsp_filter_check::parse_field_name(str, alloc_state, needed_for_filtering);
 
 	m_arg_present = false;
@@ -123,6 +128,9 @@ int32_t sinsp_filter_check_plugin::parse_field_name(const char* str, bool alloc_
 		{
 			throw sinsp_exception(string("filter '") + string(str) + string("': ") + m_field->m_name + string(" requires an argument but none provided"));
 		}
+
+		// only the checks that will extract values take part in a batch
+		m_batchable = alloc_state;
 	}
 
 	return res;
@@ -166,25 +174,33 @@ bool sinsp_filter_check_plugin::extract(sinsp_evt *evt, OUT vector<extract_value
 
 	auto type = m_info.m_fields[m_field_id].m_type;
 
-	// here we want to extract just one field
-	uint32_t num_fields = 1;
-
-	// populate the field to extract for the plugin
+	// the field is extracted along with the other fields of the plugin used
+	// by the same filter or formatter, once per event
+	const ss_plugin_extract_field* res_field = nullptr;
 	ss_plugin_extract_field efield;
-	efield.field_id = m_field_id;
-	efield.field = m_info.m_fields[m_field_id].m_name;
-	efield.arg_key = m_arg_key;
-	efield.arg_index = m_arg_index;
-	efield.arg_present = m_arg_present;
-	efield.ftype = type;
-	efield.flist = m_info.m_fields[m_field_id].m_flags & EPF_IS_LIST;
-	if (!m_eplugin->extract_fields(evt, num_fields, &efield) || efield.res_len == 0)
+	if (m_batch)
+	{
+		res_field = m_batch->extract(evt, m_batch_slot);
+	}
+	if (res_field == nullptr)
+	{
+		// not batched, or the plugin failed the whole batch: extract just
+		// this field so that the failure of other fields does not affect it
+		init_extract_field(efield);
+		if (!m_eplugin->extract_fields(evt, 1, &efield))
+		{
+			return false;
+		}
+		res_field = &efield;
+	}
+
+	if (res_field->res_len == 0)
 	{
 		return false;
 	}
 
 	values.clear();
-	for (uint32_t i = 0; i < efield.res_len; ++i)
+	for (uint32_t i = 0; i < res_field->res_len; ++i)
 	{
 		extract_value_t res;
 		switch(type)
@@ -194,26 +210,26 @@ bool sinsp_filter_check_plugin::extract(sinsp_evt *evt, OUT vector<extract_value
 			case PT_ABSTIME:
 			{
 				res.len = sizeof(uint64_t);
-				res.ptr = (uint8_t*) &efield.res.u64[i];
+				res.ptr = (uint8_t*) &res_field->res.u64[i];
 				break;
 			}
 			case PT_IPADDR:
 			case PT_IPNET:
 			{
-				res.len = (uint32_t) efield.res.buf[i].len;
-				res.ptr = (uint8_t*) efield.res.buf[i].ptr;
+				res.len = (uint32_t) res_field->res.buf[i].len;
+				res.ptr = (uint8_t*) res_field->res.buf[i].ptr;
 				break;
 			}
 			case PT_CHARBUF:
 			{
-				res.len = strlen(efield.res.str[i]);
-				res.ptr = (uint8_t*) efield.res.str[i];
+				res.len = strlen(res_field->res.str[i]);
+				res.ptr = (uint8_t*) res_field->res.str[i];
 				break;
 			}
 			case PT_BOOL:
 			{
 				res.len = sizeof(ss_plugin_bool);
-				res.ptr = (uint8_t*) &efield.res.boolean[i];
+				res.ptr = (uint8_t*) &res_field->res.boolean[i];
 				break;
 			}
 			default:
@@ -227,6 +243,49 @@ bool sinsp_filter_check_plugin::extract(sinsp_evt *evt, OUT vector<extract_value
 	return true;
 }
 
+void sinsp_filter_check_plugin::group_batch_fields(const std::vector<sinsp_filter_check*>& checks)
+{
+	std::unordered_map<sinsp_plugin*, std::vector<sinsp_filter_check_plugin*>> by_plugin;
+	for (auto chk : checks)
+	{
+		auto pchk = dynamic_cast<sinsp_filter_check_plugin*>(chk);
+		if (pchk != nullptr && pchk->m_batchable && pchk->m_eplugin->extract_batch_support())
+		{
+			by_plugin[pchk->m_eplugin.get()].push_back(pchk);
+		}
+	}
+
+	for (auto& it : by_plugin)
+	{
+		// a single field gains nothing from the batch
+		if (it.second.size() < 2)
+		{
+			continue;
+		}
+
+		auto batch = std::make_shared<sinsp_plugin_extract_batch>(it.second[0]->m_eplugin);
+		for (auto pchk : it.second)
+		{
+			ss_plugin_extract_field efield;
+			pchk->init_extract_field(efield);
+			pchk->m_batch_slot = batch->add_field(efield);
+			pchk->m_batch = batch;
+		}
+	}
+}
+
+void sinsp_filter_check_plugin::init_extract_field(ss_plugin_extract_field& efield) const
+{
+	efield.field_id = m_field_id;
+	efield.field = m_info.m_fields[m_field_id].m_name;
+	efield.arg_key = m_arg_key;
+	efield.arg_index = m_arg_index;
+	efield.arg_present = m_arg_present;
+	efield.ftype = m_info.m_fields[m_field_id].m_type;
+	efield.flist = m_info.m_fields[m_field_id].m_flags & EPF_IS_LIST;
+	efield.res_len = 0;
+}
+
 void sinsp_filter_check_plugin::extract_arg_index(const char* full_field_name)
 {
 	int length = m_argstr.length();
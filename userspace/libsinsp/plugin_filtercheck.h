@@ -53,6 +53,13 @@ public:
 		OUT std::vector<extract_value_t>& values,
 		bool sanitize_strings = true) override;
 
+	/**
+	 * Makes the plugin filterchecks of a filter or formatter extract their
+	 * fields with one plugin call per event, one batch for each plugin.
+	 * The other filterchecks are ignored.
+	 */
+	static void group_batch_fields(const std::vector<sinsp_filter_check*>& checks);
+
 private:
 	std::string m_argstr;
 	char* m_arg_key;
@@ -64,6 +71,14 @@ private:
 	std::vector<bool> m_compatible_plugin_sources_bitmap;
 	std::shared_ptr<sinsp_plugin> m_eplugin;
 
+	// the batch extracting this field along with the other fields of the
+	// same filter or formatter, see group_batch_fields()
+	bool m_batchable = false;
+	std::shared_ptr<sinsp_plugin_extract_batch> m_batch;
+	size_t m_batch_slot = 0;
+
+	void init_extract_field(ss_plugin_extract_field& efield) const;
+
 	// extract_arg_index() extracts a valid index from the argument if 
 	// format is valid, otherwise it throws an exception.
 	// `full_field_name` has the format "field[argument]" and it is necessary
@@ -190,6 +190,15 @@ static inline owned_table_input_t copy_and_check_table_input(const sinsp_plugin*
 		res->fields_ext->list_table_fields = in->fields_ext->list_table_fields;
 		res->fields_ext->get_table_field = in->fields_ext->get_table_field;
 		res->fields_ext->add_table_field = in->fields_ext->add_table_field;
+
+		// note: the bulk read functions have been introduced in minor v5.
+		// They are optional, and when missing we fall back to reading entries
+		// one by one through the functions above
+		if (p->required_api_version().minor() >= 5)
+		{
+			res->reader_ext->read_entries_fields = in->reader_ext->read_entries_fields;
+			res->reader_ext->iterate_entries_batch = in->reader_ext->iterate_entries_batch;
+		}
 	}
 
 	if ((!res->reader_ext->get_table_name || res->reader_ext->get_table_name != res->reader.get_table_name) ||
@@ -726,6 +735,38 @@ struct sinsp_table_wrapper
 		}
 	}
 
+	// collects the entries visited during an iteration and dispatches them
+	// in chunks to a batch iterator callback
+	struct batch_iterator_state
+	{
+		ss_plugin_table_iterator_batch_func_t it;
+		ss_plugin_table_iterator_state_t* s;
+		uint32_t max_batch;
+		std::vector<ss_plugin_table_entry_t*> entries;
+
+		inline bool add(ss_plugin_table_entry_t* e)
+		{
+			entries.push_back(e);
+			return entries.size() < max_batch || flush();
+		}
+
+		inline bool flush()
+		{
+			if (entries.empty())
+			{
+				return true;
+			}
+			auto res = it(s, entries.data(), entries.size()) != 0;
+			entries.clear();
+			return res;
+		}
+
+		static ss_plugin_bool add_entry(ss_plugin_table_iterator_state_t* s, ss_plugin_table_entry_t* e)
+		{
+			return static_cast<batch_iterator_state*>(s)->add(e);
+		}
+	};
+
 	sinsp_plugin* m_owner_plugin;
 	ss_plugin_state_type m_key_type;
 	libsinsp::state::base_table* m_table;
@@ -966,6 +1007,8 @@ struct sinsp_table_wrapper
 
 	static ss_plugin_rc read_entry_field(ss_plugin_table_t* _t, ss_plugin_table_entry_t* _e, const ss_plugin_table_field_t* f, ss_plugin_state_data* out);
 
+	static ss_plugin_rc read_entries_fields(ss_plugin_table_t* _t, ss_plugin_table_entry_t** entries, uint32_t nentries, const ss_plugin_table_field_t** fields, uint32_t nfields, ss_plugin_state_data* out);
+
 	static void release_table_entry(ss_plugin_table_t* _t, ss_plugin_table_entry_t* _e)
 	{
 		auto t = static_cast<sinsp_table_wrapper*>(_t);
@@ -1010,6 +1053,46 @@ struct sinsp_table_wrapper
 
 		return false;
 	}
+
+	static ss_plugin_bool iterate_entries_batch(ss_plugin_table_t* _t, ss_plugin_table_iterator_batch_func_t it, uint32_t max_batch, ss_plugin_table_iterator_state_t* s)
+	{
+		auto t = static_cast<sinsp_table_wrapper*>(_t);
+
+		if (max_batch == 0)
+		{
+			t->m_owner_plugin->m_last_owner_err = "invalid batch size for table iteration";
+			return false;
+		}
+
+		batch_iterator_state bs{it, s, max_batch, {}};
+		if (t->m_table_plugin_input)
+		{
+			auto pt = t->m_table_plugin_input->table;
+			auto reader = t->m_table_plugin_input->reader_ext;
+			if (reader->iterate_entries_batch)
+			{
+				return reader->iterate_entries_batch(pt, it, max_batch, s);
+			}
+			return reader->iterate_entries(pt, batch_iterator_state::add_entry, &bs) && bs.flush();
+		}
+
+		std::function<bool(libsinsp::state::table_entry&)> iter = [&bs](auto& e)
+		{
+			return bs.add(static_cast<ss_plugin_table_entry_t*>(&e));
+		};
+
+		#define _X(_type, _dtype) \
+		{ \
+			auto tt = static_cast<libsinsp::state::table<_type>*>(t->m_table); \
+			return tt->foreach_entry(iter) && bs.flush(); \
+		}
+		__CATCH_ERR_MSG(t->m_owner_plugin->m_last_owner_err, {
+			__PLUGIN_STATETYPE_SWITCH(t->m_key_type);
+		});
+		#undef _X
+
+		return false;
+	}
 	
 	static ss_plugin_rc clear(ss_plugin_table_t* _t)
 	{
@@ -1188,6 +1271,71 @@ ss_plugin_rc sinsp_table_wrapper::read_entry_field(ss_plugin_table_t* _t, ss_plu
 	return SS_PLUGIN_FAILURE;
 }
 
+ss_plugin_rc sinsp_table_wrapper::read_entries_fields(ss_plugin_table_t* _t, ss_plugin_table_entry_t** entries, uint32_t nentries, const ss_plugin_table_field_t** fields, uint32_t nfields, ss_plugin_state_data* out)
+{
+	auto t = static_cast<sinsp_table_wrapper*>(_t);
+
+	if (t->m_table_plugin_input)
+	{
+		auto pt = t->m_table_plugin_input->table;
+		auto reader = t->m_table_plugin_input->reader_ext;
+		auto ret = SS_PLUGIN_SUCCESS;
+		if (reader->read_entries_fields)
+		{
+			ret = reader->read_entries_fields(pt, entries, nentries, fields, nfields, out);
+		}
+		else
+		{
+			for (uint32_t i = 0; i < nentries && ret == SS_PLUGIN_SUCCESS; i++)
+			{
+				for (uint32_t j = 0; j < nfields && ret == SS_PLUGIN_SUCCESS; j++)
+				{
+					ret = reader->read_entry_field(pt, entries[i], fields[j], &out[i * nfields + j]);
+				}
+			}
+		}
+		if (ret == SS_PLUGIN_FAILURE)
+		{
+			t->m_owner_plugin->m_last_owner_err = t->m_table_plugin_owner->get_last_error();
+		}
+		return ret;
+	}
+
+	// the accessor and its type are resolved once for each field, and then
+	// the same field is read from all the entries
+	#define _X(_type, _dtype) \
+	{ \
+		if (a->dynamic) \
+		{ \
+			auto aa = static_cast<libsinsp::state::dynamic_struct::field_accessor<_type>*>(a->accessor); \
+			for (uint32_t i = 0; i < nentries; i++) \
+			{ \
+				auto e = static_cast<libsinsp::state::table_entry*>(entries[i]); \
+				e->get_dynamic_field<_type>(*aa, out[i * nfields + j]._dtype); \
+			} \
+		} \
+		else \
+		{ \
+			auto aa = static_cast<libsinsp::state::static_struct::field_accessor<_type>*>(a->accessor); \
+			for (uint32_t i = 0; i < nentries; i++) \
+			{ \
+				auto e = static_cast<libsinsp::state::table_entry*>(entries[i]); \
+				e->get_static_field<_type>(*aa, out[i * nfields + j]._dtype); \
+			} \
+		} \
+	}
+	__CATCH_ERR_MSG(t->m_owner_plugin->m_last_owner_err, {
+		for (uint32_t j = 0; j < nfields; j++)
+		{
+			auto a = static_cast<const sinsp_table_wrapper::field_accessor_wrapper*>(fields[j]);
+			__PLUGIN_STATETYPE_SWITCH(a->data_type);
+		}
+		return SS_PLUGIN_SUCCESS;
+	});
+	#undef _X
+	return SS_PLUGIN_FAILURE;
+}
+
 ss_plugin_rc sinsp_table_wrapper::write_entry_field(ss_plugin_table_t* _t, ss_plugin_table_entry_t* _e, const ss_plugin_table_field_t* f, const ss_plugin_state_data* in)
 {
 	auto t = static_cast<sinsp_table_wrapper*>(_t);
@@ -1273,6 +1421,12 @@ static ss_plugin_rc dispatch_read_entry_field(ss_plugin_table_t* _t, ss_plugin_t
 	return t->reader_ext->read_entry_field(t->table, e, f, out);
 }
 
+static ss_plugin_rc dispatch_read_entries_fields(ss_plugin_table_t* _t, ss_plugin_table_entry_t** e, uint32_t ne, const ss_plugin_table_field_t** f, uint32_t nf, ss_plugin_state_data* out)
+{
+	auto t = static_cast<ss_plugin_table_input*>(_t);
+	return t->reader_ext->read_entries_fields(t->table, e, ne, f, nf, out);
+}
+
 static void dispatch_release_table_entry(ss_plugin_table_t* _t, ss_plugin_table_entry_t* e)
 {
 	auto t = static_cast<ss_plugin_table_input*>(_t);
@@ -1285,6 +1439,12 @@ static ss_plugin_bool dispatch_iterate_entries(ss_plugin_table_t* _t, ss_plugin_
 	return t->reader_ext->iterate_entries(t->table, it, s);
 }
 
+static ss_plugin_bool dispatch_iterate_entries_batch(ss_plugin_table_t* _t, ss_plugin_table_iterator_batch_func_t it, uint32_t max_batch, ss_plugin_table_iterator_state_t* s)
+{
+	auto t = static_cast<ss_plugin_table_input*>(_t);
+	return t->reader_ext->iterate_entries_batch(t->table, it, max_batch, s);
+}
+
 static ss_plugin_rc dispatch_clear(ss_plugin_table_t* _t)
 {
 	auto t = static_cast<ss_plugin_table_input*>(_t);
@@ -1340,6 +1500,8 @@ void sinsp_plugin::table_read_api(ss_plugin_table_reader_vtable& out, ss_plugin_
 	extout.read_entry_field = dispatch_read_entry_field;
 	extout.release_table_entry = dispatch_release_table_entry;
 	extout.iterate_entries = dispatch_iterate_entries;
+	extout.read_entries_fields = dispatch_read_entries_fields;
+	extout.iterate_entries_batch = dispatch_iterate_entries_batch;
 	/* Deprecated */
 	out.get_table_name = extout.get_table_name;
 	out.get_table_size = extout.get_table_size;
@@ -1422,6 +1584,8 @@ ss_plugin_table_t* sinsp_plugin::table_api_get_table(ss_plugin_owner_t *o, const
 		res->reader_ext->read_entry_field = sinsp_table_wrapper::read_entry_field; \
 		res->reader_ext->release_table_entry = sinsp_table_wrapper::release_table_entry; \
 		res->reader_ext->iterate_entries = sinsp_table_wrapper::iterate_entries; \
+		res->reader_ext->read_entries_fields = sinsp_table_wrapper::read_entries_fields; \
+		res->reader_ext->iterate_entries_batch = sinsp_table_wrapper::iterate_entries_batch; \
 		res->writer_ext->clear_table = sinsp_table_wrapper::clear; \
 		res->writer_ext->erase_table_entry = sinsp_table_wrapper::erase_entry; \
 		res->writer_ext->create_table_entry = sinsp_table_wrapper::create_table_entry; \
@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/proc_lookup_source.h>
+#include <libsinsp/utils.h>
+#include <libscap/scap_platform_api.h>
+
+libsinsp::proc_lookup_source::proc_lookup_source(scap_platform* platform, std::recursive_mutex& platform_mtx, uint64_t ttl_ms, const done_handler& on_done):
+	async_key_value_source(NO_WAIT_LOOKUP, ttl_ms),
+	m_platform(platform),
+	m_platform_mtx(platform_mtx),
+	m_on_done(on_done)
+{
+}
+
+libsinsp::proc_lookup_source::~proc_lookup_source()
+{
+	stop();
+}
+
+void libsinsp::proc_lookup_source::queue(int64_t tid, bool scan_sockets)
+{
+	proc_lookup request;
+	request.m_scan_sockets = scan_sockets;
+	{
+		std::lock_guard<std::mutex> lock(m_idle_mtx);
+		m_queued.insert(tid);
+	}
+
+	// a lookup pruned before it runs is done too
+	lookup(tid, request, callback_handler(), [this](const int64_t& tid) { lookup_done(tid); });
+}
+
+void libsinsp::proc_lookup_source::wait_idle()
+{
+	std::unique_lock<std::mutex> lock(m_idle_mtx);
+	m_idle_cv.wait(lock, [this] { return m_queued.empty(); });
+}
+
+void libsinsp::proc_lookup_source::lookup_done(int64_t tid)
+{
+	std::lock_guard<std::mutex> lock(m_idle_mtx);
+	m_queued.erase(tid);
+	m_idle_cv.notify_all();
+}
+
+void libsinsp::proc_lookup_source::run_impl()
+{
+	int64_t tid;
+	proc_lookup result;
+
+	while(dequeue_next_key(tid, &result))
+	{
+		result.m_proc = {};
+		result.m_proc.tid = -1;
+		result.m_proc.pid = -1;
+		result.m_proc.ptid = -1;
+
+		// taken before reading /proc: the events older than this are
+		// already reflected in what we read
+		{
+			std::lock_guard<std::recursive_mutex> lock(m_platform_mtx);
+			result.m_ts = sinsp_utils::get_current_time_ns();
+			result.m_found = scap_proc_get(m_platform, tid, &result.m_proc, result.m_scan_sockets) == SCAP_SUCCESS;
+			result.m_duration_ns = sinsp_utils::get_current_time_ns() - result.m_ts;
+		}
+
+		store_value(tid, result);
+		if(m_on_done)
+		{
+			m_on_done(tid, result);
+		}
+		lookup_done(tid);
+	}
+}
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <libsinsp/async/async_key_value_source.h>
+#include <libscap/scap.h>
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
+
+struct scap_platform;
+
+namespace libsinsp
+{
+
+//
+// State of a /proc lookup for a thread missing from the thread table.
+// The requester sets m_scan_sockets, the rest is filled by the lookup
+//
+struct proc_lookup
+{
+	bool m_scan_sockets = false;
+	bool m_found = false;
+	// when /proc was read, and how long it took
+	uint64_t m_ts = 0;
+	uint64_t m_duration_ns = 0;
+	scap_threadinfo m_proc = {};
+};
+
+//
+// Reads the info of threads from /proc in a background thread, so that
+// the event thread doesn't stall on it. The results are kept until the
+// event thread collects them with get_complete_results(), done_handler is
+// called from the background thread once each of them is available.
+//
+// The platform is shared with the event thread: each read holds
+// platform_mtx, that the event thread holds too while using the platform.
+//
+class proc_lookup_source : public async_key_value_source<int64_t, proc_lookup>
+{
+public:
+	typedef std::function<void(int64_t tid, const proc_lookup& lookup)> done_handler;
+
+	proc_lookup_source(scap_platform* platform, std::recursive_mutex& platform_mtx, uint64_t ttl_ms, const done_handler& on_done);
+	~proc_lookup_source() override;
+
+	// The caller must not queue a tid again before collecting its result
+	void queue(int64_t tid, bool scan_sockets);
+
+	// Blocks until every queued lookup is done and its handler returned
+	void wait_idle();
+
+private:
+	void run_impl() override;
+	void lookup_done(int64_t tid);
+
+	scap_platform* m_platform;
+	std::recursive_mutex& m_platform_mtx;
+	done_handler m_on_done;
+
+	std::mutex m_idle_mtx;
+	std::condition_variable m_idle_cv;
+	// queued lookups whose handler didn't return yet
+	std::unordered_set<int64_t> m_queued;
+};
+
+}
@@ -99,6 +99,7 @@ sinsp::sinsp(bool static_container, const std::string &static_id, const std::str
 	m_isfatfile_enabled = false;
 	m_isinternal_events_enabled = false;
 	m_hostname_and_port_resolution_enabled = false;
+	m_reverse_dns_resolution_enabled = false;
 	m_output_time_flag = 'h';
 	m_max_evt_output_len = 0;
 	m_filesize = -1;
@@ -131,6 +132,7 @@ sinsp::sinsp(bool static_container, const std::string &static_id, const std::str
 	// create state tables registry
 	m_table_registry = std::make_shared<libsinsp::state::table_registry>();
 	m_table_registry->add_table(m_thread_manager.get());
+	m_flow_table = std::make_unique<libsinsp::sinsp_flow_table>();
 }
 
 sinsp::~sinsp()
@@ -144,6 +146,7 @@ sinsp::~sinsp()
 	if (--instance_count == 0)
 	{
 		sinsp_dns_manager::get().cleanup();
+		sinsp_reverse_dns_manager::get().cleanup();
 	}
 #endif
 }
@@ -299,6 +302,7 @@ void sinsp::init()
 		ASSERT(res == SCAP_SUCCESS || res == SCAP_NOT_SUPPORTED);
 		(void)res;
 	}
+	m_thread_manager->get_threads()->publish();
 	m_inited = true;
 }
 
@@ -325,6 +329,18 @@ void sinsp::open_common(scap_open_args* oargs, const scap_vtable* vtable, scap_p
 	// scap starts scanning proc.
 	m_usergroup_manager.subscribe_container_mgr();
 
+	// Same for the saved containers, so the threads found in proc don't
+	// need any lookup
+	if(is_live() && !m_persistent_cache_path.empty())
+	{
+		m_persistent_cache = std::make_shared<libsinsp::persistent_cache>(m_persistent_cache_path);
+		m_persistent_cache->load();
+		m_container_manager.set_persistent_cache(m_persistent_cache);
+		m_container_manager.load_persistent_cache();
+		m_usergroup_manager.set_persistent_cache(m_persistent_cache);
+		m_usergroup_manager.load_persistent_cache();
+	}
+
 	oargs->log_fn = &sinsp_scap_log_fn;
 	oargs->proc_scan_timeout_ms = m_proc_scan_timeout_ms;
 	oargs->proc_scan_log_interval_ms = m_proc_scan_log_interval_ms;
@@ -439,6 +455,7 @@ void sinsp::open_kmod(unsigned long driver_buffer_bytes_dim, const libsinsp::eve
 	/* Engine-specific args. */
 	scap_kmod_engine_params params;
 	params.buffer_bytes_dim = driver_buffer_bytes_dim;
+	params.numa_consumers = m_numa_consumers;
 	oargs.engine_params = &params;
 
 	scap_platform* platform = scap_linux_alloc_platform(::on_new_entry_from_proc, this);
@@ -472,6 +489,7 @@ void sinsp::open_bpf(const std::string& bpf_path, unsigned long driver_buffer_by
 	scap_bpf_engine_params params;
 	params.buffer_bytes_dim = driver_buffer_bytes_dim;
 	params.bpf_probe = bpf_path.data();
+	params.numa_consumers = m_numa_consumers;
 	oargs.engine_params = &params;
 
 	scap_platform* platform = scap_linux_alloc_platform(::on_new_entry_from_proc, this);
@@ -553,13 +571,30 @@ void sinsp::open_savefile(const std::string& filename, int fd)
 }
 
 void sinsp::open_plugin(const std::string& plugin_name, const std::string& plugin_open_params, sinsp_mode_t mode)
+{
+	open_plugin(plugin_name, std::vector<std::string>{plugin_open_params}, mode);
+}
+
+void sinsp::open_plugin(const std::string& plugin_name, const std::vector<std::string>& instances_open_params, sinsp_mode_t mode)
 {
 #ifdef HAS_ENGINE_SOURCE_PLUGIN
+	if(instances_open_params.empty())
+	{
+		throw sinsp_exception("at least one set of open parameters is required to open plugin " + plugin_name);
+	}
+
 	scap_open_args oargs {};
-	scap_source_plugin_engine_params params;
-	set_input_plugin(plugin_name, plugin_open_params);
+	scap_source_plugin_engine_params params {};
+	std::vector<const char*> instances_params;
+	set_input_plugin(plugin_name, instances_open_params[0]);
+	for(const auto& p : instances_open_params)
+	{
+		instances_params.push_back(p.c_str());
+	}
 	params.input_plugin = &m_input_plugin->as_scap_source();
 	params.input_plugin_params = (char*)m_input_plugin_open_params.c_str();
+	params.num_instances = instances_params.size();
+	params.instances_params = instances_params.data();
 	oargs.engine_params = &params;
 
 	scap_platform* platform;
@@ -608,7 +643,7 @@ void sinsp::open_gvisor(const std::string& config_path, const std::string& root_
 #endif
 }
 
-void sinsp::open_modern_bpf(unsigned long driver_buffer_bytes_dim, uint16_t cpus_for_each_buffer, bool online_only, const libsinsp::events::set<ppm_sc_code> &ppm_sc_of_interest)
+void sinsp::open_modern_bpf(unsigned long driver_buffer_bytes_dim, uint16_t cpus_for_each_buffer, bool online_only, const libsinsp::events::set<ppm_sc_code> &ppm_sc_of_interest, const sinsp_modern_bpf_buffers_layout &buffers_layout)
 {
 #ifdef HAS_ENGINE_MODERN_BPF
 	scap_open_args oargs {};
@@ -621,7 +656,34 @@ void sinsp::open_modern_bpf(unsigned long driver_buffer_bytes_dim, uint16_t cpus
 	params.buffer_bytes_dim = driver_buffer_bytes_dim;
 	params.cpus_for_each_buffer = cpus_for_each_buffer;
 	params.allocate_online_only = online_only;
+	switch(buffers_layout.topology)
+	{
+	case sinsp_modern_bpf_buffers_layout::TOPOLOGY_NUMA:
+		params.buffers_topology = MODERN_BPF_BUFFERS_TOPOLOGY_NUMA;
+		break;
+	case sinsp_modern_bpf_buffers_layout::TOPOLOGY_CACHE:
+		params.buffers_topology = MODERN_BPF_BUFFERS_TOPOLOGY_CACHE;
+		break;
+	default:
+		params.buffers_topology = MODERN_BPF_BUFFERS_TOPOLOGY_CPUS;
+		break;
+	}
+	params.buffers_bytes_dim = buffers_layout.buffers_bytes_dim.empty() ? nullptr : buffers_layout.buffers_bytes_dim.data();
+	params.n_buffers_bytes_dim = buffers_layout.buffers_bytes_dim.size();
+	params.buffers_history = nullptr;
+	params.n_buffers_history = 0;
+	if(buffers_layout.auto_tune)
+	{
+		// the history is indexed by CPU, it is reset if the CPUs changed
+		if(m_modern_bpf_buffers_history.size() != num_possible_cpus())
+		{
+			m_modern_bpf_buffers_history.assign(num_possible_cpus(), scap_modern_bpf_buffer_history{});
+		}
+		params.buffers_history = m_modern_bpf_buffers_history.data();
+		params.n_buffers_history = m_modern_bpf_buffers_history.size();
+	}
 	oargs.engine_params = &params;
+	m_driver_buffer_bytes_dim = driver_buffer_bytes_dim;
 
 	scap_platform* platform = scap_linux_alloc_platform(::on_new_entry_from_proc, this);
 	open_common(&oargs, &scap_modern_bpf_engine, platform, SINSP_MODE_LIVE);
@@ -756,6 +818,9 @@ std::string sinsp::get_error_desc(const std::string& msg)
 
 void sinsp::close()
 {
+	// the lookups read /proc through the platform
+	m_thread_manager->stop_proc_lookups();
+
 	if(m_platform)
 	{
 		scap_platform_close(m_platform);
@@ -763,6 +828,12 @@ void sinsp::close()
 		m_platform = nullptr;
 	}
 
+	// the pre-parse workers must release the events before they're freed
+	if(m_preparse_pipeline)
+	{
+		m_preparse_pipeline->end_batch();
+	}
+
 	if(m_h)
 	{
 		scap_close(m_h);
@@ -771,6 +842,18 @@ void sinsp::close()
 
 	m_is_dumping = false;
 
+	m_delayed_scap_evt.reset();
+
+	if(m_persistent_cache)
+	{
+		m_container_manager.set_persistent_cache(nullptr);
+		m_usergroup_manager.set_persistent_cache(nullptr);
+		m_persistent_cache->flush();
+		m_persistent_cache.reset();
+	}
+
+	m_adaptive_sampler.reset();
+
 	deinit_state();
 
 	m_filter.reset();
@@ -811,6 +894,7 @@ void sinsp::deinit_state()
 {
 	m_network_interfaces.clear();
 	m_thread_manager->clear();
+	m_thread_manager->get_threads()->publish();
 }
 
 void sinsp::on_new_entry_from_proc(void* context,
@@ -1016,6 +1100,11 @@ void sinsp::restart_capture()
 	// De-initialize the insternal state
 	deinit_state();
 
+	if (m_preparse_pipeline)
+	{
+		m_preparse_pipeline->end_batch();
+	}
+
 	// Restart the scap capture, which also trigger a re-initialization of
 	// scap's internal state.
 	if (scap_restart_capture(m_h) != SCAP_SUCCESS)
@@ -1170,6 +1259,56 @@ int32_t sinsp::fetch_next_event(sinsp_evt*& evt)
 }
 
 int32_t sinsp::next(OUT sinsp_evt **puevt)
+{
+	return next_event(puevt, true);
+}
+
+int32_t sinsp::next_batch(uint32_t max_evts, const std::function<void(sinsp_evt*)>& on_evt, OUT uint32_t* nevts)
+{
+	*nevts = 0;
+	if(max_evts == 0)
+	{
+		return SCAP_SUCCESS;
+	}
+
+	m_delayed_scap_evt.m_batch_size = max_evts;
+
+	int32_t res = SCAP_SUCCESS;
+	uint32_t nread = 0;
+	while(nread < max_evts)
+	{
+		sinsp_evt* evt = nullptr;
+		res = next_event(&evt, nread == 0);
+		if(res != SCAP_SUCCESS && res != SCAP_FILTERED_EVENT)
+		{
+			break;
+		}
+
+		nread++;
+		if(res == SCAP_SUCCESS)
+		{
+			on_evt(evt);
+			(*nevts)++;
+		}
+
+		// stop at the end of the driver batch, so that the
+		// next call reads a fresh one
+		if(m_delayed_scap_evt.empty() && m_delayed_scap_evt.batch_exhausted())
+		{
+			break;
+		}
+	}
+
+	m_delayed_scap_evt.m_batch_size = 1;
+
+	if(nread > 0 && (res == SCAP_TIMEOUT || res == SCAP_FILTERED_EVENT))
+	{
+		return SCAP_SUCCESS;
+	}
+	return res;
+}
+
+int32_t sinsp::next_event(OUT sinsp_evt **puevt, bool housekeeping)
 {
 	*puevt = NULL;
 	sinsp_evt* evt = &m_evt;
@@ -1244,11 +1383,32 @@ int32_t sinsp::next(OUT sinsp_evt **puevt)
 	//
 	// If required, retrieve the processes cpu from the kernel
 	//
-	if(m_get_procs_cpu_from_driver && is_live())
+	if(housekeeping && m_get_procs_cpu_from_driver && is_live())
 	{
 		get_procs_cpu_from_driver(ts);
 	}
 
+	//
+	// If enabled, feed the adaptive sampler and periodically let it
+	// adjust the sampling ratios based on the driver pressure
+	//
+	if(m_adaptive_sampler != nullptr && is_live())
+	{
+		m_adaptive_sampler->count_event(evt->get_type());
+		if(housekeeping && m_adaptive_sampler->is_update_due(ts))
+		{
+			update_adaptive_sampler(ts);
+		}
+	}
+
+	//
+	// If enabled, periodically export the flow counters
+	//
+	if(housekeeping)
+	{
+		m_flow_table->on_event(ts);
+	}
+
 	//
 	// Store a couple of values that we'll need later inside the event.
 	// These are potentially used both for parsing the event for internal
@@ -1270,13 +1430,13 @@ int32_t sinsp::next(OUT sinsp_evt **puevt)
 			m_tid_to_remove = -1;
 		}
 
-		if(!is_offline())
+		if(housekeeping && !is_offline())
 		{
 			m_thread_manager->remove_inactive_threads();
 		}
 	}
 
-	if (m_auto_stats_print && is_debug_enabled() && is_live())
+	if (housekeeping && m_auto_stats_print && is_debug_enabled() && is_live())
 	{
 		if(ts > m_next_stats_print_time_ns)
 		{
@@ -1289,12 +1449,23 @@ int32_t sinsp::next(OUT sinsp_evt **puevt)
 		}
 	}
 
-	if (m_auto_containers_purging && !is_offline())
+	if (housekeeping && m_auto_containers_purging && !is_offline())
 	{
 		m_container_manager.remove_inactive_containers();
 	}
 
-	if (m_auto_usergroups_purging && !is_offline())
+	if (housekeeping && !is_offline())
+	{
+		m_container_manager.process_cgroup_events(ts);
+	}
+
+	if (housekeeping && m_persistent_cache && ts >= m_next_persistent_cache_flush_ts)
+	{
+		m_persistent_cache->flush();
+		m_next_persistent_cache_flush_ts = ts + ONE_SECOND_IN_NS;
+	}
+
+	if (housekeeping && m_auto_usergroups_purging && !is_offline())
 	{
 		m_usergroup_manager.clear_host_users_groups();
 	}
@@ -1337,6 +1508,19 @@ int32_t sinsp::next(OUT sinsp_evt **puevt)
 		pp.process_event(evt, m_event_sources);
 	}
 
+	// let the concurrent readers see the thread table updates, the
+	// parsers change the event thread and its main thread in place. Only
+	// the events that modify the state can do that, but the plugin parsers
+	// could write to the threads on any event.
+	auto threads = m_thread_manager->get_threads();
+	if(threads->concurrent_reads_enabled() && evt->get_tinfo() != nullptr &&
+	   ((evt->get_info_flags() & EF_MODIFIES_STATE) || evt->get_type() == PPME_ASYNCEVENT_E || !m_plugin_parsers.empty()))
+	{
+		threads->touch(evt->get_tinfo()->m_tid);
+		threads->touch(evt->get_tinfo()->m_pid);
+	}
+	threads->publish();
+
 	// Finally set output evt;
 	// From now on, any return must have the correct output being set.
 	*puevt = evt;
@@ -1434,6 +1618,11 @@ void sinsp::set_query_docker_image_info(bool query_image_info)
 	m_container_manager.set_query_docker_image_info(query_image_info);
 }
 
+void sinsp::set_docker_max_in_flight(uint32_t max_in_flight)
+{
+	m_container_manager.set_docker_max_in_flight(max_in_flight);
+}
+
 void sinsp::set_cri_extra_queries(bool extra_queries)
 {
 	m_container_manager.set_cri_extra_queries(extra_queries);
@@ -1454,6 +1643,11 @@ void sinsp::set_cri_timeout(int64_t timeout_ms)
 	m_container_manager.set_cri_timeout(timeout_ms);
 }
 
+void sinsp::set_cri_max_in_flight(uint32_t max_in_flight)
+{
+	m_container_manager.set_cri_max_in_flight(max_in_flight);
+}
+
 void sinsp::set_cri_async(bool async)
 {
 	m_container_manager.set_cri_async(async);
@@ -1464,6 +1658,21 @@ void sinsp::set_container_labels_max_len(uint32_t max_label_len)
 	m_container_manager.set_container_labels_max_len(max_label_len);
 }
 
+void sinsp::set_cgroup_watch(bool enable, uint64_t poll_interval_ns)
+{
+	m_container_manager.set_cgroup_watch(enable, poll_interval_ns);
+}
+
+void sinsp::set_persistent_cache_path(const std::string& path)
+{
+	m_persistent_cache_path = path;
+}
+
+void sinsp::set_async_proc_lookups(bool enabled, uint32_t max_pending)
+{
+	m_thread_manager->set_async_proc_lookups(enabled, max_pending);
+}
+
 void sinsp::set_snaplen(uint32_t snaplen)
 {
 	//
@@ -1678,6 +1887,98 @@ void sinsp::start_dropping_mode(uint32_t sampling_ratio)
 }
 #endif // _WIN32
 
+void sinsp::set_adaptive_sampling(bool enable)
+{
+	if(!enable)
+	{
+		if(m_adaptive_sampler != nullptr && m_h != NULL)
+		{
+			m_adaptive_sampler->reset();
+		}
+		m_adaptive_sampler.reset();
+		return;
+	}
+
+	if(m_adaptive_sampler != nullptr)
+	{
+		return;
+	}
+
+#ifdef HAS_ENGINE_MODERN_BPF
+	if(!is_live() || !check_current_engine(MODERN_BPF_ENGINE))
+#endif
+	{
+		throw sinsp_exception("adaptive sampling is only supported by the modern BPF engine in live mode");
+	}
+
+	libsinsp::sinsp_adaptive_sampler::config cfg;
+	cfg.buffer_bytes_dim = m_driver_buffer_bytes_dim;
+	m_adaptive_sampler = std::make_unique<libsinsp::sinsp_adaptive_sampler>(
+		[this](ppm_sc_code sc, uint32_t ratio)
+		{
+			if(scap_set_sc_sampling_ratio(m_h, sc, ratio) != SCAP_SUCCESS)
+			{
+				libsinsp_logger()->format(sinsp_logger::SEV_DEBUG, "cannot set sampling ratio %" PRIu32 " for syscall %d: %s", ratio, (int)sc, scap_getlasterr(m_h));
+			}
+		},
+		cfg);
+}
+
+void sinsp::set_flow_accounting(bool enable, uint64_t snapshot_interval_ns)
+{
+	m_flow_table->set_snapshot_interval(snapshot_interval_ns);
+	m_flow_table->set_enabled(enable);
+
+	// the table stays registered once it's been enabled, plugins may
+	// still hold a reference to it
+	if(enable && m_table_registry->tables().find(m_flow_table->name()) == m_table_registry->tables().end())
+	{
+		m_table_registry->add_table(m_flow_table.get());
+	}
+}
+
+void sinsp::set_preparse_workers(uint32_t nworkers)
+{
+#ifdef __EMSCRIPTEN__
+	if(nworkers > 0)
+	{
+		throw sinsp_exception("the pre-parse pipeline is not supported on this platform");
+	}
+#endif
+	m_delayed_scap_evt.m_preparse = nullptr;
+	m_preparse_pipeline.reset();
+	m_evt.clear_preparsed_params();
+	if(nworkers > 0)
+	{
+		m_preparse_pipeline = std::make_unique<libsinsp::sinsp_preparse_pipeline>(&m_evt, nworkers);
+		m_delayed_scap_evt.m_preparse = m_preparse_pipeline.get();
+	}
+}
+
+void sinsp::update_adaptive_sampler(uint64_t ts)
+{
+	scap_stats stats;
+	uint64_t n_drops = 0;
+	if(scap_get_stats(m_h, &stats) == SCAP_SUCCESS)
+	{
+		n_drops = stats.n_drops;
+	}
+
+	if(m_adaptive_sampler->update(ts, n_drops, scap_max_buf_used(m_h)))
+	{
+		libsinsp_logger()->format(sinsp_logger::SEV_INFO, "adaptive sampling ratios: io_read=%" PRIu32 " io_write=%" PRIu32,
+			m_adaptive_sampler->get_ratio(libsinsp::sinsp_adaptive_sampler::CATEGORY_IO_READ),
+			m_adaptive_sampler->get_ratio(libsinsp::sinsp_adaptive_sampler::CATEGORY_IO_WRITE));
+	}
+
+	if(m_sinsp_stats_v2)
+	{
+		m_sinsp_stats_v2->m_n_adaptive_sampling_adjustments = m_adaptive_sampler->get_n_adjustments();
+		m_sinsp_stats_v2->m_adaptive_sampling_ratio_io_read = m_adaptive_sampler->get_ratio(libsinsp::sinsp_adaptive_sampler::CATEGORY_IO_READ);
+		m_sinsp_stats_v2->m_adaptive_sampling_ratio_io_write = m_adaptive_sampler->get_ratio(libsinsp::sinsp_adaptive_sampler::CATEGORY_IO_WRITE);
+	}
+}
+
 void sinsp::set_filter(std::unique_ptr<sinsp_filter> filter)
 {
 	if(m_filter != NULL)
@@ -1748,6 +2049,15 @@ const scap_stats_v2* sinsp::get_sinsp_stats_v2_buffer() const
 
 std::shared_ptr<sinsp_stats_v2> sinsp::get_sinsp_stats_v2()
 {
+	if(m_sinsp_stats_v2)
+	{
+		m_sinsp_stats_v2->m_n_drops_async_evts = m_async_events_queue.get_num_drops();
+		if(m_preparse_pipeline != nullptr)
+		{
+			m_sinsp_stats_v2->m_n_preparsed_evts = m_preparse_pipeline->get_n_preparsed();
+			m_sinsp_stats_v2->m_n_preparse_inline_evts = m_preparse_pipeline->get_n_inline();
+		}
+	}
 	return m_sinsp_stats_v2;
 }
 
@@ -1902,6 +2212,12 @@ void sinsp::set_hostname_and_port_resolution_mode(bool enable)
 	m_hostname_and_port_resolution_enabled = enable;
 }
 
+void sinsp::set_reverse_dns_resolution_mode(bool enable)
+{
+	m_reverse_dns_resolution_enabled = enable;
+	sinsp_reverse_dns_manager::get().set_enabled(enable);
+}
+
 void sinsp::set_max_evt_output_len(uint32_t len)
 {
 	m_max_evt_output_len = len;
@@ -2027,6 +2343,18 @@ void sinsp::set_sinsp_stats_v2_enabled()
 		m_sinsp_stats_v2->m_n_drops_full_threadtable = 0;
 		m_sinsp_stats_v2->m_n_missing_container_images = 0;
 		m_sinsp_stats_v2->m_n_containers= 0;
+		m_sinsp_stats_v2->m_n_adaptive_sampling_adjustments = 0;
+		m_sinsp_stats_v2->m_adaptive_sampling_ratio_io_read = 1;
+		m_sinsp_stats_v2->m_adaptive_sampling_ratio_io_write = 1;
+		m_sinsp_stats_v2->m_n_drops_async_evts = 0;
+		m_sinsp_stats_v2->m_n_preparsed_evts = 0;
+		m_sinsp_stats_v2->m_n_preparse_inline_evts = 0;
+		m_sinsp_stats_v2->m_n_inherited_fds = 0;
+		m_sinsp_stats_v2->m_n_fdtable_page_copies = 0;
+		m_sinsp_stats_v2->m_n_async_proc_lookups = 0;
+		m_sinsp_stats_v2->m_n_drops_async_proc_lookups = 0;
+		m_sinsp_stats_v2->m_n_merged_async_proc_lookups = 0;
+		m_sinsp_stats_v2->m_async_proc_lookups_merge_latency_ns = 0;
 	}
 }
 
@@ -2085,6 +2413,8 @@ bool sinsp_thread_manager::remove_inactive_threads()
 
 		/* Clean expired threads in the group and children */
 		reset_child_dependencies();
+
+		remove_stale_proc_lookups();
 		return true;
 	}
 
@@ -59,7 +59,7 @@ limitations under the License.
 #include <libsinsp/filter/ppm_codes.h>
 #include <libsinsp/gvisor_config.h>
 #include <libsinsp/logger.h>
-#include <libsinsp/mpsc_priority_queue.h>
+#include <libsinsp/mpsc_ring_queue.h>
 #include <libsinsp/plugin.h>
 #include <libsinsp/plugin_parser.h>
 #include <libsinsp/settings.h>
@@ -69,6 +69,9 @@ limitations under the License.
 #include <libsinsp/sinsp_inet.h>
 #include <libsinsp/sinsp_public.h>
 #include <libsinsp/sinsp_suppress.h>
+#include <libsinsp/sinsp_adaptive_sampler.h>
+#include <libsinsp/sinsp_flow_table.h>
+#include <libsinsp/sinsp_preparse_pipeline.h>
 #include <libsinsp/state/table_registry.h>
 #include <libsinsp/stats.h>
 #include <libsinsp/threadinfo.h>
@@ -141,6 +144,37 @@ enum sinsp_mode_t
 	SINSP_MODE_TEST,
 };
 
+/*!
+  \brief [EXPERIMENTAL] Ring buffers layout of the modern BPF probe
+*/
+struct sinsp_modern_bpf_buffers_layout
+{
+	enum topology_t
+	{
+		/*!
+		 * A ring buffer every `cpus_for_each_buffer` CPUs.
+		 */
+		TOPOLOGY_CPUS = 0,
+		/*!
+		 * A ring buffer for every NUMA node.
+		 */
+		TOPOLOGY_NUMA,
+		/*!
+		 * A ring buffer for every group of CPUs sharing the last level cache.
+		 */
+		TOPOLOGY_CACHE,
+	};
+
+	topology_t topology = TOPOLOGY_CPUS;
+	// Optional dimension of every ring buffer, indexed by ring buffer id.
+	// Missing or `0` entries use `driver_buffer_bytes_dim`. Ring buffers of
+	// different sizes require kernel 5.10 or newer.
+	std::vector<unsigned long> buffers_bytes_dim;
+	// Grow the ring buffers that dropped events during the previous
+	// modern BPF capture opened by this inspector.
+	bool auto_tune = false;
+};
+
 /** @defgroup inspector Main library
  @{
 */
@@ -172,12 +206,21 @@ public:
 	virtual void open_savefile(const std::string &filename, int fd = 0);
 	virtual void open_plugin(const std::string& plugin_name, const std::string& plugin_open_params,
 				 sinsp_mode_t mode = SINSP_MODE_PLUGIN);
+	/*!
+	  \brief Opens one instance of the source plugin for every string of
+	  `instances_open_params`. With more than one, every instance is read by
+	  its own worker thread and the events are merged by timestamp, so the
+	  plugin must support concurrent next_batch calls on distinct instances.
+	*/
+	virtual void open_plugin(const std::string& plugin_name, const std::vector<std::string>& instances_open_params,
+				 sinsp_mode_t mode = SINSP_MODE_PLUGIN);
 	virtual void open_gvisor(const std::string &config_path, const std::string &root_path, bool no_events = false, int epoll_timeout = -1);
 	/*[EXPERIMENTAL] This API could change between releases, we are trying to find the right configuration to deploy the modern bpf probe:
 	 * `cpus_for_each_buffer` and `online_only` are the 2 experimental params. The first one allows associating more than one CPU to a single ring buffer.
 	 * The last one allows allocating ring buffers only for online CPUs and not for all system-available CPUs.
+	 * `buffers_layout` allows grouping CPUs by NUMA node or by shared cache and sizing every ring buffer independently.
 	 */
-	virtual void open_modern_bpf(unsigned long driver_buffer_bytes_dim = DEFAULT_DRIVER_BUFFER_BYTES_DIM, uint16_t cpus_for_each_buffer = DEFAULT_CPU_FOR_EACH_BUFFER, bool online_only = true, const libsinsp::events::set<ppm_sc_code> &ppm_sc_of_interest = {});
+	virtual void open_modern_bpf(unsigned long driver_buffer_bytes_dim = DEFAULT_DRIVER_BUFFER_BYTES_DIM, uint16_t cpus_for_each_buffer = DEFAULT_CPU_FOR_EACH_BUFFER, bool online_only = true, const libsinsp::events::set<ppm_sc_code> &ppm_sc_of_interest = {}, const sinsp_modern_bpf_buffers_layout &buffers_layout = {});
 	virtual void open_test_input(scap_test_input_data* data, sinsp_mode_t mode = SINSP_MODE_TEST);
 
 	void fseek(uint64_t filepos)
@@ -210,6 +253,21 @@ public:
 	*/
 	virtual int32_t next(OUT sinsp_evt **evt);
 
+	/*!
+	  \brief Process up to `max_evts` events fetched with a single batched
+	  read from the capture source, invoking `on_evt` for every event that
+	  would be returned by \ref next(). The per-event state updates are the
+	  same as \ref next(), while the periodic housekeeping runs once per batch.
+
+	  \param max_evts maximum number of events to process.
+	  \param on_evt callback receiving each event, valid only during the call.
+	  \param nevts number of events passed to the callback.
+
+	  \return SCAP_SUCCESS if at least one event was read, otherwise the same
+	   result \ref next() would return.
+	*/
+	int32_t next_batch(uint32_t max_evts, const std::function<void(sinsp_evt*)>& on_evt, OUT uint32_t* nevts);
+
 	/*!
 	  \brief Get the maximum number of bytes currently in use by any CPU buffer
      */
@@ -741,8 +799,9 @@ public:
 	/*!
 	  \brief Set whether to resolve hostnames and port protocols or not.
 
-	  \note It can use the system library functions getservbyport and so to
-	   resolve protocol names and domain names.
+	  \note Port names come from the system services database, which is
+	   read once. Host names are only resolved if reverse DNS resolution
+	   is enabled too, see set_reverse_dns_resolution_mode().
 
 	  \param enable If set to false it will enable this function and use plain
 	   numerical values.
@@ -754,6 +813,24 @@ public:
 		return m_hostname_and_port_resolution_enabled;
 	}
 
+	/*!
+	  \brief Set whether to resolve the host names of socket addresses
+	   with reverse DNS lookups when hostname and port resolution is
+	   enabled. It's disabled by default.
+
+	  \note The lookups run in the background and are cached for the
+	   whole process, so the setting applies to all the inspectors.
+	   Addresses are rendered numerically until their name is known.
+
+	  \param enable If set to true the names of the addresses are looked up.
+	*/
+	void set_reverse_dns_resolution_mode(bool enable);
+
+	inline bool is_reverse_dns_resolution_enabled() const
+	{
+		return m_reverse_dns_resolution_enabled;
+	}
+
 	/*!
 	  \brief Set the runtime flag for resolving the timespan in a human
 	   readable mode.
@@ -851,6 +928,76 @@ public:
 	//
 	void stop_dropping_mode();
 	void start_dropping_mode(uint32_t sampling_ratio);
+	/*!
+	  \brief Enable or disable the adaptive per-syscall sampling. When
+	  enabled, the sampling ratio of the high-volume I/O syscalls is
+	  raised in the driver while the ring buffers are under pressure and
+	  lowered again once the pressure goes away. Only supported by the
+	  modern BPF engine during live captures.
+	*/
+	void set_adaptive_sampling(bool enable);
+	inline bool is_adaptive_sampling_enabled() const
+	{
+		return m_adaptive_sampler != nullptr;
+	}
+	/*!
+	  \brief If enabled, the kmod and BPF engines drain the ring buffers with
+	  one reader thread pinned on every NUMA node, and the capture thread only
+	  merges the events staged by the readers. Must be set before opening the
+	  capture.
+	*/
+	inline void set_numa_consumers(bool enable)
+	{
+		m_numa_consumers = enable;
+	}
+	inline bool get_numa_consumers() const
+	{
+		return m_numa_consumers;
+	}
+	/*!
+	  \brief If enabled, other threads can look up the thread table with
+	  the concurrent_* methods of \ref threadinfo_map_t, e.g. for
+	  enrichment or metrics, without locks and without stalling the
+	  capture. They see immutable copies of the threads, as they were
+	  after the last parsed event. Must be set while no other thread
+	  reads the table.
+	*/
+	inline void set_concurrent_thread_reads(bool enable)
+	{
+		m_thread_manager->get_threads()->set_concurrent_reads(enable);
+	}
+	inline bool get_concurrent_thread_reads() const
+	{
+		return m_thread_manager->get_threads()->concurrent_reads_enabled();
+	}
+	/*!
+	  \brief Set the number of worker threads decoding the parameters of
+	  the events ahead of the parser, 0 disables the pre-parse pipeline.
+	  The pipeline only works on the events read with \ref next_batch()
+	  from engines supporting batched reads, where it keeps the stateless
+	  decoding work off the capture thread. Events are still parsed and
+	  returned in order on the capture thread. Must not be called from
+	  within a \ref next_batch() callback.
+	*/
+	void set_preparse_workers(uint32_t nworkers);
+	inline uint32_t get_preparse_workers() const
+	{
+		return m_preparse_pipeline != nullptr ? m_preparse_pipeline->get_num_workers() : 0;
+	}
+	/*!
+	  \brief Enable or disable the per-connection flow accounting. When
+	  enabled, the parser keeps bytes, operations, timestamps and a
+	  histogram of the request/response gaps of every TCP and UDP socket,
+	  and every snapshot_interval_ns of event time exports them in the
+	  "flows" state table, see \ref libsinsp::sinsp_flow_table. The table
+	  is registered the first time the accounting is enabled, so it must
+	  be enabled before loading the plugins that use it.
+	*/
+	void set_flow_accounting(bool enable, uint64_t snapshot_interval_ns = ONE_SECOND_IN_NS);
+	inline libsinsp::sinsp_flow_table* get_flow_table() const
+	{
+		return m_flow_table.get();
+	}
 	void on_new_entry_from_proc(void* context, int64_t tid, scap_threadinfo* tinfo, scap_fdinfo* fdinfo);
 	void set_get_procs_cpu_from_driver(bool get_procs_cpu_from_driver)
 	{
@@ -925,6 +1072,10 @@ public:
 
 	void set_docker_socket_path(std::string socket_path);
 	void set_query_docker_image_info(bool query_image_info);
+	/*!
+	  \brief Set how many docker/podman metadata lookups can run concurrently
+	*/
+	void set_docker_max_in_flight(uint32_t max_in_flight);
 
 	void set_cri_extra_queries(bool extra_queries);
 
@@ -941,10 +1092,36 @@ public:
 	*/
 	void add_cri_socket_path(const std::string &path);
 	void set_cri_timeout(int64_t timeout_ms);
+	/*!
+	  \brief Set how many CRI metadata lookups can run concurrently
+	*/
+	void set_cri_max_in_flight(uint32_t max_in_flight);
 	void set_cri_async(bool async);
 
 	void set_container_labels_max_len(uint32_t max_label_len);
 
+	/*!
+	  \brief Resolve the container of a thread once per cgroup set, see
+	  \ref sinsp_container_manager::set_cgroup_watch.
+	*/
+	void set_cgroup_watch(bool enable, uint64_t poll_interval_ns = ONE_SECOND_IN_NS);
+
+	/*!
+	  \brief Keep the metadata of the running containers, and the users
+	  and groups read from them, in a local file, so that after a restart
+	  they are available before the first event instead of being looked
+	  up again. Only used in live captures, must be set before opening.
+
+	  \param path path of the file, empty to disable
+	*/
+	void set_persistent_cache_path(const std::string& path);
+
+	/*!
+	  \brief Read /proc in a background thread for the threads missing from
+	  the table, see \ref sinsp_thread_manager::set_async_proc_lookups.
+	*/
+	void set_async_proc_lookups(bool enabled, uint32_t max_pending = 1024);
+
 	// Create and register a plugin from a shared library pointed
 	// to by filepath, and add it to the inspector.
 	// The created sinsp_plugin is returned.
@@ -1083,6 +1260,7 @@ private:
 	void import_ifaddr_list();
 	void import_user_list();
 	int32_t fetch_next_event(sinsp_evt*& evt);
+	int32_t next_event(OUT sinsp_evt **puevt, bool housekeeping);
 
 	//
 	// Note: lookup_only should be used when the query for the thread is made
@@ -1110,6 +1288,7 @@ private:
 	void get_read_progress_plugin(OUT double* nres, std::string* sres) const;
 
 	void get_procs_cpu_from_driver(uint64_t ts);
+	void update_adaptive_sampler(uint64_t ts);
 
 	// regulates the logic behind event timestamp ordering.
 	// returns true if left "comes first" than right, and false otherwise.
@@ -1134,6 +1313,7 @@ private:
 	bool m_isfatfile_enabled;
 	bool m_isinternal_events_enabled;
 	bool m_hostname_and_port_resolution_enabled;
+	bool m_reverse_dns_resolution_enabled;
 	char m_output_time_flag;
 	uint32_t m_max_evt_output_len;
 	sinsp_evt m_evt;
@@ -1241,8 +1421,8 @@ public:
 		}
 	};
 
-	// priority queue to hold injected events
-	mpsc_priority_queue<sinsp_evt_ptr, state_evts_less> m_async_events_queue;
+	// lock-free priority queue to hold injected events
+	mpsc_ring_queue<sinsp_evt_ptr, state_evts_less> m_async_events_queue;
 
 	// predicate struct for checking the head of the async events queue.
 	// keeping a struct in the internal state makes sure that we don't do
@@ -1262,22 +1442,78 @@ public:
 
 	// temp storage for scap_next
 	// stores top scap_evt while qualified events from m_async_events_queue are being processed
+	// when a batch size greater than 1 is set, events are read in batches
+	// and served from m_batch until it's exhausted. If a pre-parse pipeline
+	// is set, every batch is handed to it as soon as it's read.
 	struct
 	{
 		inline auto next(scap_t* h)
 		{
-			auto res = scap_next(h, &m_pevt, &m_cpuid, &m_dump_flags);
+			int32_t res = SCAP_SUCCESS;
+			if (m_batch_pos == m_batch_n && m_batch_size > 1)
+			{
+				if (m_preparse != nullptr)
+				{
+					m_preparse->end_batch();
+				}
+				m_batch.resize(m_batch_size);
+				m_batch_pos = 0;
+				res = scap_next_batch(h, m_batch.data(), m_batch_size, &m_batch_n);
+				if (m_preparse != nullptr && m_batch_n > 1)
+				{
+					m_preparse->begin_batch(m_batch.data(), m_batch_n);
+				}
+			}
+
+			if (m_batch_pos < m_batch_n)
+			{
+				m_pevt = m_batch[m_batch_pos].evt;
+				m_cpuid = m_batch[m_batch_pos].devid;
+				m_dump_flags = m_batch[m_batch_pos].flags;
+				m_batch_pos++;
+				m_from_batch = true;
+				return res;
+			}
+
+			m_from_batch = false;
+			if (m_batch_size <= 1)
+			{
+				if (m_preparse != nullptr)
+				{
+					m_preparse->end_batch();
+				}
+				res = scap_next(h, &m_pevt, &m_cpuid, &m_dump_flags);
+			}
 			if (res != SCAP_SUCCESS)
 			{
 				clear();
 			}
 			return res;
 		}
+		inline bool batch_exhausted() const
+		{
+			return m_batch_pos == m_batch_n;
+		}
+		inline void reset()
+		{
+			if (m_preparse != nullptr)
+			{
+				m_preparse->end_batch();
+			}
+			clear();
+			m_batch_n = 0;
+			m_batch_pos = 0;
+			m_batch_size = 1;
+		}
 		inline void move(sinsp_evt * evt)
 		{
 			evt->set_scap_evt(m_pevt);
 			evt->set_cpuid(m_cpuid);
 			evt->set_dump_flags(m_dump_flags);
+			if (m_preparse != nullptr)
+			{
+				m_preparse->consume(m_from_batch ? m_batch_pos - 1 : UINT32_MAX, evt);
+			}
 			clear();
 		}
 		inline bool empty() const
@@ -1294,8 +1530,16 @@ public:
 		scap_evt* m_pevt{nullptr};
 		uint16_t  m_cpuid{0};
 		uint32_t  m_dump_flags;
+		std::vector<scap_batch_evt> m_batch;
+		uint32_t  m_batch_n{0};
+		uint32_t  m_batch_pos{0};
+		uint32_t  m_batch_size{1};
+		bool      m_from_batch{false};
+		libsinsp::sinsp_preparse_pipeline* m_preparse{nullptr};
 	} m_delayed_scap_evt;
 
+	std::unique_ptr<libsinsp::sinsp_preparse_pipeline> m_preparse_pipeline;
+
 	//
 	// Used for collecting process CPU and res usage info from the kernel
 	//
@@ -1326,6 +1570,28 @@ public:
 
 	libsinsp::sinsp_suppress m_suppress;
 
+	//
+	// Adaptive sampling controller, only allocated when enabled
+	//
+	std::unique_ptr<libsinsp::sinsp_adaptive_sampler> m_adaptive_sampler;
+
+	//
+	// Per-connection flow accounting, only fed while enabled
+	//
+	std::unique_ptr<libsinsp::sinsp_flow_table> m_flow_table;
+
+	//
+	// Container state saved across restarts, only open in live captures
+	//
+	std::string m_persistent_cache_path;
+	std::shared_ptr<libsinsp::persistent_cache> m_persistent_cache;
+	uint64_t m_next_persistent_cache_flush_ts = 0;
+	unsigned long m_driver_buffer_bytes_dim = 0;
+	bool m_numa_consumers = false;
+	// per-CPU ring buffers drops of the last modern BPF capture, used to
+	// auto-tune the next one
+	std::vector<scap_modern_bpf_buffer_history> m_modern_bpf_buffers_history;
+
 	//
 	// Internal manager for plugins
 	//
@@ -0,0 +1,172 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/sinsp_adaptive_sampler.h>
+
+#include <libscap/scap.h>
+#include <libsinsp/events/sinsp_events.h>
+
+libsinsp::sinsp_adaptive_sampler::sinsp_adaptive_sampler(apply_fn_t apply, const config& cfg):
+	m_apply(std::move(apply)),
+	m_config(cfg)
+{
+	libsinsp::events::set<ppm_event_code> category_events[CATEGORY_MAX];
+
+	for(uint32_t ev = 0; ev < PPM_EVENT_MAX; ev++)
+	{
+		m_evt_category[ev] = CATEGORY_MAX;
+		if(!libsinsp::events::is_syscall_event((ppm_event_code)ev))
+		{
+			continue;
+		}
+
+		switch(scap_get_syscall_category_from_event((ppm_event_code)ev))
+		{
+		case EC_IO_READ:
+			m_evt_category[ev] = CATEGORY_IO_READ;
+			break;
+		case EC_IO_WRITE:
+			m_evt_category[ev] = CATEGORY_IO_WRITE;
+			break;
+		default:
+			continue;
+		}
+		category_events[m_evt_category[ev]].insert((ppm_event_code)ev);
+	}
+
+	// syscalls that modify the sinsp state must never be sampled
+	auto state_sc = libsinsp::events::sinsp_state_sc_set();
+	for(uint32_t c = 0; c < CATEGORY_MAX; c++)
+	{
+		m_ratios[c] = 1;
+		auto sc_set = libsinsp::events::event_set_to_sc_set(category_events[c]).diff(state_sc);
+		for(auto sc : sc_set)
+		{
+			m_category_sc[c].push_back(sc);
+		}
+	}
+}
+
+bool libsinsp::sinsp_adaptive_sampler::update(uint64_t ts, uint64_t n_drops, uint64_t max_buf_used)
+{
+	m_next_update_ts = ts + m_config.interval_ns;
+
+	uint64_t n_drops_delta = 0;
+	if(m_has_last_n_drops && n_drops > m_last_n_drops)
+	{
+		n_drops_delta = n_drops - m_last_n_drops;
+	}
+	m_last_n_drops = n_drops;
+	m_has_last_n_drops = true;
+
+	bool high_pressure = n_drops_delta > 0;
+	bool low_pressure = n_drops_delta == 0;
+	if(m_config.buffer_bytes_dim != 0)
+	{
+		high_pressure |= max_buf_used >= m_config.buffer_bytes_dim * m_config.high_watermark;
+		low_pressure &= max_buf_used <= m_config.buffer_bytes_dim * m_config.low_watermark;
+	}
+
+	bool changed = false;
+	if(high_pressure)
+	{
+		m_idle_intervals = 0;
+
+		// thin the category with the highest estimated volume, the observed
+		// counts are rescaled by the ratio already applied to the category
+		int32_t busiest = -1;
+		uint64_t busiest_volume = 0;
+		for(uint32_t c = 0; c < CATEGORY_MAX; c++)
+		{
+			if(m_ratios[c] >= m_config.max_ratio || m_category_sc[c].empty())
+			{
+				continue;
+			}
+
+			uint64_t volume = m_counts[c] * m_ratios[c];
+			if(busiest == -1 || volume > busiest_volume)
+			{
+				busiest = c;
+				busiest_volume = volume;
+			}
+		}
+
+		if(busiest != -1)
+		{
+			set_ratio((category)busiest, m_ratios[busiest] * 2);
+			changed = true;
+		}
+	}
+	else if(low_pressure)
+	{
+		if(++m_idle_intervals >= m_config.relax_intervals)
+		{
+			m_idle_intervals = 0;
+
+			// relax the most sampled category first
+			int32_t most_sampled = -1;
+			for(uint32_t c = 0; c < CATEGORY_MAX; c++)
+			{
+				if(m_ratios[c] > 1 && (most_sampled == -1 || m_ratios[c] > m_ratios[most_sampled]))
+				{
+					most_sampled = c;
+				}
+			}
+
+			if(most_sampled != -1)
+			{
+				set_ratio((category)most_sampled, m_ratios[most_sampled] / 2);
+				changed = true;
+			}
+		}
+	}
+	else
+	{
+		m_idle_intervals = 0;
+	}
+
+	for(uint32_t c = 0; c < CATEGORY_MAX; c++)
+	{
+		m_counts[c] = 0;
+	}
+	return changed;
+}
+
+void libsinsp::sinsp_adaptive_sampler::reset()
+{
+	for(uint32_t c = 0; c < CATEGORY_MAX; c++)
+	{
+		if(m_ratios[c] != 1)
+		{
+			set_ratio((category)c, 1);
+		}
+		m_counts[c] = 0;
+	}
+	m_idle_intervals = 0;
+	m_has_last_n_drops = false;
+}
+
+void libsinsp::sinsp_adaptive_sampler::set_ratio(category c, uint32_t ratio)
+{
+	for(auto sc : m_category_sc[c])
+	{
+		m_apply(sc, ratio);
+	}
+	m_ratios[c] = ratio;
+	m_n_adjustments++;
+}
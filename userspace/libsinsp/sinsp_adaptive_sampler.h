@@ -0,0 +1,122 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include <driver/ppm_events_public.h>
+
+namespace libsinsp
+{
+
+//
+// Closed-loop controller that thins high-volume I/O syscalls in the driver
+// when the ring buffers are under pressure. Once per interval it looks at
+// the kernel drop counters and at the ring buffer occupancy: under pressure
+// it doubles the sampling ratio of the busiest category, when the pressure
+// goes away it slowly relaxes the ratios back to 1.
+// Syscalls needed to build the sinsp state are never sampled.
+//
+class sinsp_adaptive_sampler
+{
+public:
+	enum category : uint8_t
+	{
+		CATEGORY_IO_READ = 0,
+		CATEGORY_IO_WRITE,
+		CATEGORY_MAX
+	};
+
+	struct config
+	{
+		// Size of a single ring buffer, 0 if unknown. When unknown
+		// only the drop counters are used as pressure signal.
+		uint64_t buffer_bytes_dim = 0;
+		// Buffer occupancy (fraction of buffer_bytes_dim) above which we
+		// consider the buffers under pressure.
+		double high_watermark = 0.75;
+		// Buffer occupancy below which we consider the buffers idle.
+		double low_watermark = 0.25;
+		// Max sampling ratio, must be a power of 2 <= 128.
+		uint32_t max_ratio = 128;
+		// Number of consecutive idle intervals before relaxing a ratio.
+		uint32_t relax_intervals = 3;
+		uint64_t interval_ns = 1000000000;
+	};
+
+	// Pushes the sampling ratio of a single syscall to the driver.
+	using apply_fn_t = std::function<void(ppm_sc_code sc, uint32_t ratio)>;
+
+	sinsp_adaptive_sampler(apply_fn_t apply, const config& cfg);
+
+	//
+	// Account an event of the given type in the current interval
+	//
+	inline void count_event(uint16_t evt_type)
+	{
+		if(evt_type < PPM_EVENT_MAX && m_evt_category[evt_type] != CATEGORY_MAX)
+		{
+			m_counts[m_evt_category[evt_type]]++;
+		}
+	}
+
+	inline bool is_update_due(uint64_t ts) const
+	{
+		return ts >= m_next_update_ts;
+	}
+
+	//
+	// Feed the controller with the current pressure signals and adjust
+	// the sampling ratios if needed. Returns true if a ratio changed.
+	// n_drops is the cumulative number of kernel drops.
+	//
+	bool update(uint64_t ts, uint64_t n_drops, uint64_t max_buf_used);
+
+	//
+	// Restore all the ratios to 1
+	//
+	void reset();
+
+	uint32_t get_ratio(category c) const { return m_ratios[c]; }
+
+	uint64_t get_n_adjustments() const { return m_n_adjustments; }
+
+	const std::vector<ppm_sc_code>& get_category_sc(category c) const { return m_category_sc[c]; }
+
+private:
+	void set_ratio(category c, uint32_t ratio);
+
+	apply_fn_t m_apply;
+	config m_config;
+
+	uint8_t m_evt_category[PPM_EVENT_MAX];
+	std::vector<ppm_sc_code> m_category_sc[CATEGORY_MAX];
+	uint32_t m_ratios[CATEGORY_MAX];
+	uint64_t m_counts[CATEGORY_MAX] {};
+
+	uint64_t m_next_update_ts = 0;
+	uint64_t m_last_n_drops = 0;
+	bool m_has_last_n_drops = false;
+	uint32_t m_idle_intervals = 0;
+	uint64_t m_n_adjustments = 0;
+};
+
+}
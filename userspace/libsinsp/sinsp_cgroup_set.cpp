@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/sinsp_cgroup_set.h>
+
+#include <cstring>
+
+libsinsp::sinsp_cgroup_set_pool& libsinsp::sinsp_cgroup_set_pool::instance()
+{
+	// never destroyed, sets can outlive static destructors
+	static sinsp_cgroup_set_pool* s_pool = new sinsp_cgroup_set_pool();
+	return *s_pool;
+}
+
+libsinsp::sinsp_cgroup_set_pool::set_ptr_t libsinsp::sinsp_cgroup_set_pool::intern(const char* cgroups, size_t len)
+{
+	std::string key(cgroups, len);
+
+	std::lock_guard<std::mutex> lk(m_mtx);
+	auto& entry = m_sets[key];
+	if(auto set = entry.lock())
+	{
+		return set;
+	}
+
+	auto parsed = std::make_unique<cgroups_t>();
+	if(!parse(cgroups, len, *parsed))
+	{
+		if(entry.expired())
+		{
+			m_sets.erase(key);
+		}
+		return nullptr;
+	}
+
+	set_ptr_t set(parsed.release(), [this, key](const cgroups_t* p)
+	{
+		delete p;
+		release(key);
+	});
+	entry = set;
+	return set;
+}
+
+size_t libsinsp::sinsp_cgroup_set_pool::get_num_sets()
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+	return m_sets.size();
+}
+
+void libsinsp::sinsp_cgroup_set_pool::release(const std::string& key)
+{
+	std::lock_guard<std::mutex> lk(m_mtx);
+
+	// the set may have been interned again in the meantime
+	auto it = m_sets.find(key);
+	if(it != m_sets.end() && it->second.expired())
+	{
+		m_sets.erase(it);
+	}
+}
+
+bool libsinsp::sinsp_cgroup_set_pool::parse(const char* cgroups, size_t len, cgroups_t& out)
+{
+	size_t offset = 0;
+	while(offset < len)
+	{
+		const char* str = cgroups + offset;
+		const char* sep = strrchr(str, '=');
+		if(sep == NULL)
+		{
+			return false;
+		}
+
+		std::string subsys(str, sep - str);
+		std::string cgroup(sep + 1);
+
+		size_t subsys_length = subsys.length();
+		size_t pos = subsys.find("_cgroup");
+		if(pos != std::string::npos)
+		{
+			subsys.erase(pos, sizeof("_cgroup") - 1);
+		}
+
+		if(subsys == "perf")
+		{
+			subsys = "perf_event";
+		}
+		else if(subsys == "mem")
+		{
+			subsys = "memory";
+		}
+		else if(subsys == "io")
+		{
+			// blkio has been renamed just `io`
+			// in kernel space:
+			// https://github.com/torvalds/linux/commit/c165b3e3c7bb68c2ed55a5ac2623f030d01d9567
+			subsys = "blkio";
+		}
+
+		out.push_back(std::make_pair(subsys, cgroup));
+		offset += subsys_length + 1 + cgroup.length() + 1;
+	}
+
+	return true;
+}
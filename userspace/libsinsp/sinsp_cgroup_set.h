@@ -0,0 +1,73 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace libsinsp
+{
+
+//
+// Process-wide pool of the cgroup memberships of the threads. All the
+// threads with the same membership, e.g. the ones of a container, share a
+// single immutable cgroup set, so two threads have the same membership if
+// and only if they point to the same set. Sets are keyed by the raw
+// "subsys=cgroup" list read from the driver or from /proc, so the list of
+// a known set is not parsed again, and they go away with the last thread
+// that uses them. Sets can be looked up from any thread.
+//
+class sinsp_cgroup_set_pool
+{
+public:
+	using cgroups_t = std::vector<std::pair<std::string, std::string>>;
+	using set_ptr_t = std::shared_ptr<const cgroups_t>;
+
+	static sinsp_cgroup_set_pool& instance();
+
+	sinsp_cgroup_set_pool(const sinsp_cgroup_set_pool&) = delete;
+	sinsp_cgroup_set_pool& operator=(const sinsp_cgroup_set_pool&) = delete;
+
+	//
+	// Returns the set for a list of NUL-terminated "subsys=cgroup"
+	// strings, or nullptr if the list is malformed
+	//
+	set_ptr_t intern(const char* cgroups, size_t len);
+
+	//
+	// Number of distinct sets in use
+	//
+	size_t get_num_sets();
+
+private:
+	sinsp_cgroup_set_pool() = default;
+
+	static bool parse(const char* cgroups, size_t len, cgroups_t& out);
+	void release(const std::string& key);
+
+	std::mutex m_mtx;
+	std::unordered_map<std::string, std::weak_ptr<const cgroups_t>> m_sets;
+};
+
+}
@@ -1287,6 +1287,14 @@ void sinsp_filter_check::add_filter_value(const char* str, uint32_t len, uint32_
 	{
 		m_val_storages_paths.add_search_path(item);
 	}
+
+	// Networks can't be looked up in the members set, index them so
+	// that lists of networks don't need to be scanned.
+	if ((m_cmpop == CO_IN || m_cmpop == CO_INTERSECTS) &&
+	    (m_field->m_type == PT_IPV4NET || m_field->m_type == PT_IPV6NET || m_field->m_type == PT_IPNET))
+	{
+		m_val_storages_nets.add_network(item);
+	}
 }
 
 size_t sinsp_filter_check::parse_filter_value(const char* str, uint32_t len, uint8_t *storage, uint32_t storage_len)
@@ -1366,7 +1374,14 @@ bool sinsp_filter_check::compare_rhs(cmpop op, ppm_param_type type, std::vector<
 
 					// note: PT_IPNET would not work with simple memcmp comparison
 					// todo(jasondellaluce): refactor filter_value_t to actually use flt_compare instead of memcmp.
-					if (type == PT_IPNET)
+					if (type == PT_IPNET && !m_val_storages_nets.empty())
+					{
+						if (!compare_rhs_nets(type, item.first, item.second))
+						{
+							return false;
+						}
+					}
+					else if (type == PT_IPNET)
 					{
 						bool found = false;
 						for (const auto& m : m_val_storages_members)
@@ -1400,7 +1415,14 @@ bool sinsp_filter_check::compare_rhs(cmpop op, ppm_param_type type, std::vector<
 
 					// note: PT_IPNET would not work with simple memcmp comparison
 					// todo(jasondellaluce): refactor filter_value_t to actually use flt_compare instead of memcmp.
-					if (type == PT_IPNET)
+					if (type == PT_IPNET && !m_val_storages_nets.empty())
+					{
+						if (compare_rhs_nets(type, item.first, item.second))
+						{
+							return true;
+						}
+					}
+					else if (type == PT_IPNET)
 					{
 						for (const auto& m : m_val_storages_members)
 						{
@@ -1442,8 +1464,28 @@ bool sinsp_filter_check::compare_rhs(cmpop op, ppm_param_type type, std::vector<
 		values[0].len);
 }
 
+bool sinsp_filter_check::compare_rhs_nets(ppm_param_type type, const void* operand1, uint32_t op1_len) const
+{
+	if (type == PT_IPV4NET || (type == PT_IPNET && op1_len == sizeof(struct in_addr)))
+	{
+		return m_val_storages_nets.match(*(const uint32_t*)operand1);
+	}
+	else if (type == PT_IPV6NET || (type == PT_IPNET && op1_len == sizeof(struct in6_addr)))
+	{
+		return m_val_storages_nets.match(*(const ipv6addr*)operand1);
+	}
+
+	throw sinsp_exception("compare_rhs_nets called with IP address of incorrect size " + std::to_string(op1_len));
+}
+
 bool sinsp_filter_check::compare_rhs(cmpop op, ppm_param_type type, const void* operand1, uint32_t op1_len)
 {
+	if ((op == CO_IN || op == CO_INTERSECTS) && !m_val_storages_nets.empty() &&
+	    (type == PT_IPV4NET || type == PT_IPV6NET || type == PT_IPNET))
+	{
+		return compare_rhs_nets(type, operand1, op1_len);
+	}
+
 	if (op == CO_IN || op == CO_PMATCH || op == CO_INTERSECTS)
 	{
 		// Certain filterchecks can't be done as a set
@@ -26,6 +26,7 @@ limitations under the License.
 #include <libsinsp/tuples.h>
 #include <libsinsp/filter_value.h>
 #include <libsinsp/prefix_search.h>
+#include <libsinsp/ip_prefix_search.h>
 #include <libsinsp/event.h>
 
 /*
@@ -263,6 +264,7 @@ protected:
 
 	bool compare_rhs(cmpop op, ppm_param_type type, const void* operand1, uint32_t op1_len = 0);
 	bool compare_rhs(cmpop op, ppm_param_type type, std::vector<extract_value_t>& values);
+	bool compare_rhs_nets(ppm_param_type type, const void* operand1, uint32_t op1_len) const;
 
 	Json::Value rawval_to_json(uint8_t* rawval, ppm_param_type ptype, ppm_print_format print_format, uint32_t len);
 
@@ -288,6 +290,7 @@ private:
 		g_hash_membuf,
 		g_equal_to_membuf> m_val_storages_members;
 	path_prefix_search m_val_storages_paths;
+	ip_prefix_search m_val_storages_nets;
 	uint32_t m_val_storages_min_size;
 	uint32_t m_val_storages_max_size;
 };
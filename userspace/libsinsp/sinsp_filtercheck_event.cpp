@@ -561,13 +561,13 @@ uint8_t *sinsp_filter_check_event::extract_abspath(sinsp_evt *evt, OUT uint32_t
 		}
 		else
 		{
-			if(evt->get_fd_info()->m_name[evt->get_fd_info()->m_name.length()] == '/')
+			if(evt->get_fd_info()->get_name().str()[evt->get_fd_info()->get_name().length()] == '/')
 			{
-				sdir = evt->get_fd_info()->m_name;
+				sdir = evt->get_fd_info()->get_name();
 			}
 			else
 			{
-				sdir = evt->get_fd_info()->m_name + '/';
+				sdir = evt->get_fd_info()->get_name().str() + '/';
 			}
 		}
 	}
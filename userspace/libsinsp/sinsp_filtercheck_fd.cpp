@@ -503,11 +503,16 @@ uint8_t* sinsp_filter_check_fd::extract(sinsp_evt *evt, OUT uint32_t* len, bool
 		if(m_field_id == TYPE_CONTAINERNAME)
 		{
 			ASSERT(m_tinfo != NULL);
-			m_tstr = m_tinfo->m_container_id + ':' + m_fdinfo->m_name;
+			m_tstr = m_tinfo->m_container_id + ':' + m_fdinfo->get_name().str();
+		}
+		else if(!sanitize_strings)
+		{
+			// no need to copy the name, it can't change during the extraction
+			RETURN_EXTRACT_STRING(m_fdinfo->get_name());
 		}
 		else
 		{
-			m_tstr = m_fdinfo->m_name;
+			m_tstr = m_fdinfo->get_name();
 		}
 
 		if(sanitize_strings)
@@ -541,7 +546,7 @@ uint8_t* sinsp_filter_check_fd::extract(sinsp_evt *evt, OUT uint32_t* len, bool
 				return NULL;
 			}
 
-			m_tstr = m_fdinfo->m_name;
+			m_tstr = m_fdinfo->get_name();
 			if(sanitize_strings)
 			{
 				sanitize_string(m_tstr);
@@ -583,7 +588,7 @@ uint8_t* sinsp_filter_check_fd::extract(sinsp_evt *evt, OUT uint32_t* len, bool
 				return NULL;
 			}
 
-			m_tstr = m_fdinfo->m_name;
+			m_tstr = m_fdinfo->get_name();
 			if(sanitize_strings)
 			{
 				sanitize_string(m_tstr);
@@ -1487,6 +1492,30 @@ bool sinsp_filter_check_fd::compare_net(sinsp_evt *evt)
 	bool sip_cmp = false;
 	bool dip_cmp = false;
 
+	if(m_cmpop == CO_IN)
+	{
+		// match against the whole list of networks, not just the first one
+		switch (m_fdinfo->m_type)
+		{
+		case SCAP_FD_IPV4_SERVSOCK:
+			return compare_rhs(CO_IN, PT_IPNET, &m_fdinfo->m_sockinfo.m_ipv4serverinfo.m_ip, sizeof(uint32_t));
+
+		case SCAP_FD_IPV6_SERVSOCK:
+			return compare_rhs(CO_IN, PT_IPNET, &m_fdinfo->m_sockinfo.m_ipv6serverinfo.m_ip, sizeof(ipv6addr));
+
+		case SCAP_FD_IPV4_SOCK:
+			return compare_rhs(CO_IN, PT_IPNET, &m_fdinfo->m_sockinfo.m_ipv4info.m_fields.m_sip, sizeof(uint32_t)) ||
+				compare_rhs(CO_IN, PT_IPNET, &m_fdinfo->m_sockinfo.m_ipv4info.m_fields.m_dip, sizeof(uint32_t));
+
+		case SCAP_FD_IPV6_SOCK:
+			return compare_rhs(CO_IN, PT_IPNET, &m_fdinfo->m_sockinfo.m_ipv6info.m_fields.m_sip, sizeof(ipv6addr)) ||
+				compare_rhs(CO_IN, PT_IPNET, &m_fdinfo->m_sockinfo.m_ipv6info.m_fields.m_dip, sizeof(ipv6addr));
+
+		default:
+			return false;
+		}
+	}
+
 	switch (m_fdinfo->m_type)
 	{
 	case SCAP_FD_IPV4_SERVSOCK:
@@ -1785,7 +1814,8 @@ bool sinsp_filter_check_fd::extract_fd(sinsp_evt *evt)
 
 		if (m_argid != -1)
 		{
-			m_fdinfo = m_tinfo->get_fd(m_argid);
+			// the filterchecks only read the fd
+			m_fdinfo = const_cast<sinsp_fdinfo*>(m_tinfo->const_get_fd(m_argid));
 		}
 		else
 		{
@@ -1793,7 +1823,7 @@ bool sinsp_filter_check_fd::extract_fd(sinsp_evt *evt)
 
 			if (m_fdinfo == NULL && m_tinfo->m_lastevent_fd != -1)
 			{
-				m_fdinfo = m_tinfo->get_fd(m_tinfo->m_lastevent_fd);
+				m_fdinfo = const_cast<sinsp_fdinfo*>(m_tinfo->const_get_fd(m_tinfo->m_lastevent_fd));
 			}
 		}
 		// We'll check if fd is null below
@@ -1806,6 +1836,18 @@ bool sinsp_filter_check_fd::extract_fd(sinsp_evt *evt)
 	return true;
 }
 
+void sinsp_filter_check_fd::add_filter_value(const char* str, uint32_t len, uint32_t i)
+{
+	sinsp_filter_check::add_filter_value(str, len, i);
+
+	// equality checks on fd.name can be done on the interned names
+	m_has_interned_name = m_field_id == TYPE_FDNAME && i == 0 && (m_cmpop == CO_EQ || m_cmpop == CO_NE);
+	if(m_has_interned_name)
+	{
+		m_interned_name = libsinsp::interned_string((const char*)filter_value_p(0));
+	}
+}
+
 bool sinsp_filter_check_fd::compare_nocache(sinsp_evt *evt)
 {
 	//
@@ -1842,6 +1884,12 @@ bool sinsp_filter_check_fd::compare_nocache(sinsp_evt *evt)
 	// class does not support multi-valued extraction
 	uint8_t* extracted_val = extract(evt, &len, sanitize_strings);
 
+	if(m_has_interned_name && m_fdinfo != NULL && extracted_val == (uint8_t*)m_fdinfo->get_name().c_str())
+	{
+		// two interned strings are equal only if they are the same string
+		return (m_fdinfo->get_name() == m_interned_name) == (m_cmpop == CO_EQ);
+	}
+
 	if(extracted_val == NULL)
 	{
 		// optimization for *_NAME fields
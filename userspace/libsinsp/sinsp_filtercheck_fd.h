@@ -76,6 +76,7 @@ public:
 
 	std::unique_ptr<sinsp_filter_check> allocate_new() override;
 	int32_t parse_field_name(const char* str, bool alloc_state, bool needed_for_filtering) override;
+	void add_filter_value(const char* str, uint32_t len, uint32_t i = 0) override;
 	bool extract(sinsp_evt*, OUT std::vector<extract_value_t>& values, bool sanitize_strings = true) override;
 
 protected:
@@ -102,4 +103,8 @@ private:
 
 	/* Used in extract helper to save uint64_t data */
 	uint64_t m_conv_uint64;
+
+	/* The filter value of fd.name, fd names are interned too */
+	libsinsp::interned_string m_interned_name;
+	bool m_has_interned_name = false;
 };
@@ -89,7 +89,7 @@ uint8_t* sinsp_filter_check_fdlist::extract(sinsp_evt *evt, OUT uint32_t* len, b
 		bool add_comma = true;
 		int64_t fd = *(int64_t *)(payload + pos);
 
-		sinsp_fdinfo *fdinfo = tinfo ? tinfo->get_fd(fd) : NULL;
+		const sinsp_fdinfo *fdinfo = tinfo ? tinfo->const_get_fd(fd) : NULL;
 
 		switch(m_field_id)
 		{
@@ -102,9 +102,9 @@ uint8_t* sinsp_filter_check_fdlist::extract(sinsp_evt *evt, OUT uint32_t* len, b
 		{
 			if(fdinfo != NULL)
 			{
-				if(fdinfo->m_name != "")
+				if(!fdinfo->get_name().empty())
 				{
-					m_strval += fdinfo->m_name;
+					m_strval += fdinfo->get_name().str();
 				}
 				else
 				{
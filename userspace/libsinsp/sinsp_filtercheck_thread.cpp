@@ -577,17 +577,14 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			// declare it to be the session leader.
 			sinsp_threadinfo* session_leader = tinfo;
 
-			sinsp_threadinfo::visitor_func_t visitor = [sid, &session_leader](sinsp_threadinfo* pt)
+			for(auto pt : tinfo->get_ancestors())
 			{
 				if(pt->m_sid != sid)
 				{
-					return false;
+					break;
 				}
 				session_leader = pt;
-				return true;
-			};
-
-			tinfo->traverse_parent_state(visitor);
+			}
 
 			// session_leader has been updated to the highest process that has the same session id.
 			// session_leader's comm is considered the session leader.
@@ -619,17 +616,14 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			// declare it to be the session leader.
 			sinsp_threadinfo* session_leader = tinfo;
 
-			sinsp_threadinfo::visitor_func_t visitor = [sid, &session_leader](sinsp_threadinfo* pt)
+			for(auto pt : tinfo->get_ancestors())
 			{
 				if(pt->m_sid != sid)
 				{
-					return false;
+					break;
 				}
 				session_leader = pt;
-				return true;
-			};
-
-			tinfo->traverse_parent_state(visitor);
+			}
 
 			// session_leader has been updated to the highest process that has the same session id.
 			// session_leader's exe is considered the session leader.
@@ -661,17 +655,14 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			// declare it to be the session leader.
 			sinsp_threadinfo* session_leader = tinfo;
 
-			sinsp_threadinfo::visitor_func_t visitor = [sid, &session_leader](sinsp_threadinfo* pt)
+			for(auto pt : tinfo->get_ancestors())
 			{
 				if(pt->m_sid != sid)
 				{
-					return false;
+					break;
 				}
 				session_leader = pt;
-				return true;
-			};
-
-			tinfo->traverse_parent_state(visitor);
+			}
 
 			// session_leader has been updated to the highest process that has the same session id.
 			// session_leader's exepath is considered the session leader.
@@ -702,17 +693,14 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			// declare it to be the process group leader.
 			sinsp_threadinfo* group_leader = tinfo;
 
-			sinsp_threadinfo::visitor_func_t visitor = [vpgid, &group_leader](sinsp_threadinfo* pt)
+			for(auto pt : tinfo->get_ancestors())
 			{
 				if(pt->m_vpgid != vpgid)
 				{
-					return false;
+					break;
 				}
 				group_leader = pt;
-				return true;
-			};
-
-			tinfo->traverse_parent_state(visitor);
+			}
 
 			// group_leader has been updated to the highest process that has the same process group id.
 			// group_leader's comm is considered the process group leader.
@@ -743,17 +731,14 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			// declare it to be the process group leader.
 			sinsp_threadinfo* group_leader = tinfo;
 
-			sinsp_threadinfo::visitor_func_t visitor = [vpgid, &group_leader](sinsp_threadinfo* pt)
+			for(auto pt : tinfo->get_ancestors())
 			{
 				if(pt->m_vpgid != vpgid)
 				{
-					return false;
+					break;
 				}
 				group_leader = pt;
-				return true;
-			};
-
-			tinfo->traverse_parent_state(visitor);
+			}
 
 			// group_leader has been updated to the highest process that has the same process group id.
 			// group_leader's exe is considered the process group leader.
@@ -786,17 +771,14 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			// declare it to be the process group leader.
 			sinsp_threadinfo* group_leader = tinfo;
 
-			sinsp_threadinfo::visitor_func_t visitor = [vpgid, &group_leader](sinsp_threadinfo* pt)
+			for(auto pt : tinfo->get_ancestors())
 			{
 				if(pt->m_vpgid != vpgid)
 				{
-					return false;
+					break;
 				}
 				group_leader = pt;
-				return true;
-			};
-
-			tinfo->traverse_parent_state(visitor);
+			}
 
 			// group_leader has been updated to the highest process that has the same process group id.
 			// group_leader's exepath is considered the process group leader.
@@ -844,8 +826,8 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			}
 			else
 			{
-				m_tstr = tinfo->concatenate_all_env();
-				RETURN_EXTRACT_STRING(m_tstr);
+				const std::string& env = tinfo->get_concatenated_env(m_tstr);
+				RETURN_EXTRACT_STRING(env);
 			}
 		}
 	case TYPE_AENV:
@@ -855,8 +837,8 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			// in case of proc.aenv without [ENV_NAME] return proc.env; same applies for proc.aenv[0]
 			if(m_argname.empty() && m_argid < 1)
 			{
-				m_tstr = tinfo->concatenate_all_env();
-				RETURN_EXTRACT_STRING(m_tstr);
+				const std::string& env = tinfo->get_concatenated_env(m_tstr);
+				RETURN_EXTRACT_STRING(env);
 			}
 
 			// get current tinfo / init for subsequent parent lineage traversal
@@ -877,16 +859,10 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			if(!m_argname.empty()) // extract a specific ENV_NAME value
 			{
 				// start parent lineage traversal
-				for(int32_t j = 0; j < 20; j++) // up to 20 levels, but realistically we will exit way before given the mt nullptr check
+				auto& ancestors = mt->get_ancestors();
+				for(size_t j = 0; j < ancestors.size() && j < 20; j++) // up to 20 levels
 				{
-					mt = mt->get_parent_thread();
-
-					if(mt == NULL)
-					{
-						break;
-					}
-
-					m_tstr = mt->get_env(m_argname);
+					m_tstr = ancestors[j]->get_env(m_argname);
 					if(!m_tstr.empty())
 					{
 						break;
@@ -897,44 +873,27 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			else if(m_argid > 0)
 			{
 				// start parent lineage traversal
-				for(int32_t j = 0; j < m_argid; j++)
+				mt = mt->get_ancestor(m_argid);
+				if(mt == NULL)
 				{
-					mt = mt->get_parent_thread();
-
-					if(mt == NULL)
-					{
-						return NULL;
-					}
+					return NULL;
 				}
 
 				// parent tinfo specified found; extract env
-				m_tstr = mt->concatenate_all_env();
-				RETURN_EXTRACT_STRING(m_tstr);
+				const std::string& env = mt->get_concatenated_env(m_tstr);
+				RETURN_EXTRACT_STRING(env);
 			}
 			RETURN_EXTRACT_STRING(m_tstr);
 		}
 	case TYPE_CMDLINE:
 		{
-			sinsp_threadinfo::populate_cmdline(m_tstr, tinfo);
-			RETURN_EXTRACT_STRING(m_tstr);
+			const std::string& cmdline = tinfo->get_cmdline(m_tstr);
+			RETURN_EXTRACT_STRING(cmdline);
 		}
 	case TYPE_EXELINE:
 		{
-			m_tstr = tinfo->get_exe() + " ";
-
-			uint32_t j;
-			uint32_t nargs = (uint32_t)tinfo->m_args.size();
-
-			for(j = 0; j < nargs; j++)
-			{
-				m_tstr += tinfo->m_args[j];
-				if(j < nargs -1)
-				{
-					m_tstr += ' ';
-				}
-			}
-
-			RETURN_EXTRACT_STRING(m_tstr);
+			const std::string& exeline = tinfo->get_exeline(m_tstr);
+			RETURN_EXTRACT_STRING(exeline);
 		}
 	case TYPE_CWD:
 		m_tstr = tinfo->get_cwd();
@@ -1039,8 +998,8 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 
 			if(ptinfo != NULL)
 			{
-				sinsp_threadinfo::populate_cmdline(m_tstr, ptinfo);
-				RETURN_EXTRACT_STRING(m_tstr);
+				const std::string& cmdline = ptinfo->get_cmdline(m_tstr);
+				RETURN_EXTRACT_STRING(cmdline);
 			}
 			else
 			{
@@ -1065,17 +1024,17 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 				}
 			}
 
-			for(int32_t j = 0; j < m_argid; j++)
+			if(m_argid > 0)
 			{
-				mt = mt->get_parent_thread();
+				mt = mt->get_ancestor(m_argid);
 
 				if(mt == NULL)
 				{
 					return NULL;
 				}
 			}
-			sinsp_threadinfo::populate_cmdline(m_tstr, mt);
-			RETURN_EXTRACT_STRING(m_tstr);
+			const std::string& cmdline = mt->get_cmdline(m_tstr);
+			RETURN_EXTRACT_STRING(cmdline);
 		}
 	case TYPE_APID:
 		{
@@ -1098,9 +1057,9 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			//
 			// Search for a specific ancestors
 			//
-			for(int32_t j = 0; j < m_argid; j++)
+			if(m_argid > 0)
 			{
-				mt = mt->get_parent_thread();
+				mt = mt->get_ancestor(m_argid);
 
 				if(mt == NULL)
 				{
@@ -1132,9 +1091,9 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 				}
 			}
 
-			for(int32_t j = 0; j < m_argid; j++)
+			if(m_argid > 0)
 			{
-				mt = mt->get_parent_thread();
+				mt = mt->get_ancestor(m_argid);
 
 				if(mt == NULL)
 				{
@@ -1178,9 +1137,9 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 				}
 			}
 
-			for(int32_t j = 0; j < m_argid; j++)
+			if(m_argid > 0)
 			{
-				mt = mt->get_parent_thread();
+				mt = mt->get_ancestor(m_argid);
 
 				if(mt == NULL)
 				{
@@ -1224,9 +1183,9 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 				}
 			}
 
-			for(int32_t j = 0; j < m_argid; j++)
+			if(m_argid > 0)
 			{
-				mt = mt->get_parent_thread();
+				mt = mt->get_ancestor(m_argid);
 
 				if(mt == NULL)
 				{
@@ -1272,7 +1231,10 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 			check_thread_for_shell(mt);
 
 			// Then check all its parents to see if they are shells
-			mt->traverse_parent_state(check_thread_for_shell);
+			for(auto pt : mt->get_ancestors())
+			{
+				check_thread_for_shell(pt);
+			}
 
 			RETURN_EXTRACT_PTR(res);
 		}
@@ -1377,7 +1339,7 @@ uint8_t* sinsp_filter_check_thread::extract(sinsp_evt *evt, OUT uint32_t* len, b
 	case TYPE_CGROUPS:
 		{
 			m_tstr.clear();
-			auto cgroups = tinfo->cgroups();
+			const auto& cgroups = tinfo->cgroups();
 
 			uint32_t j;
 			uint32_t nargs = (uint32_t)cgroups.size();
@@ -1643,8 +1605,7 @@ bool sinsp_filter_check_thread::compare_full_apid(sinsp_evt *evt)
 	//
 	// No id specified, search in all of the ancestors
 	//
-	bool found = false;
-	sinsp_threadinfo::visitor_func_t visitor = [this, &found] (sinsp_threadinfo *pt)
+	for(auto pt : mt->get_ancestors())
 	{
 		bool res;
 
@@ -1654,18 +1615,11 @@ bool sinsp_filter_check_thread::compare_full_apid(sinsp_evt *evt)
 
 		if(res == true)
 		{
-			found = true;
-
-			// Can stop traversing parent state
-			return false;
+			return true;
 		}
+	}
 
-		return true;
-	};
-
-	mt->traverse_parent_state(visitor);
-
-	return found;
+	return false;
 }
 
 bool sinsp_filter_check_thread::compare_full_aname(sinsp_evt *evt)
@@ -1696,8 +1650,7 @@ bool sinsp_filter_check_thread::compare_full_aname(sinsp_evt *evt)
 	//
 	// No id specified, search in all of the ancestors
 	//
-	bool found = false;
-	sinsp_threadinfo::visitor_func_t visitor = [this, &found] (sinsp_threadinfo *pt)
+	for(auto pt : mt->get_ancestors())
 	{
 		bool res;
 
@@ -1707,18 +1660,11 @@ bool sinsp_filter_check_thread::compare_full_aname(sinsp_evt *evt)
 
 		if(res == true)
 		{
-			found = true;
-
-			// Can stop traversing parent state
-			return false;
+			return true;
 		}
+	}
 
-		return true;
-	};
-
-	mt->traverse_parent_state(visitor);
-
-	return found;
+	return false;
 }
 
 bool sinsp_filter_check_thread::compare_full_aexe(sinsp_evt *evt)
@@ -1749,8 +1695,7 @@ bool sinsp_filter_check_thread::compare_full_aexe(sinsp_evt *evt)
 	//
 	// No id specified, search in all of the ancestors
 	//
-	bool found = false;
-	sinsp_threadinfo::visitor_func_t visitor = [this, &found] (sinsp_threadinfo *pt)
+	for(auto pt : mt->get_ancestors())
 	{
 		bool res;
 
@@ -1760,18 +1705,11 @@ bool sinsp_filter_check_thread::compare_full_aexe(sinsp_evt *evt)
 
 		if(res == true)
 		{
-			found = true;
-
-			// Can stop traversing parent state
-			return false;
+			return true;
 		}
+	}
 
-		return true;
-	};
-
-	mt->traverse_parent_state(visitor);
-
-	return found;
+	return false;
 }
 
 bool sinsp_filter_check_thread::compare_full_aexepath(sinsp_evt *evt)
@@ -1802,8 +1740,7 @@ bool sinsp_filter_check_thread::compare_full_aexepath(sinsp_evt *evt)
 	//
 	// No id specified, search in all of the ancestors
 	//
-	bool found = false;
-	sinsp_threadinfo::visitor_func_t visitor = [this, &found] (sinsp_threadinfo *pt)
+	for(auto pt : mt->get_ancestors())
 	{
 		bool res;
 
@@ -1813,18 +1750,11 @@ bool sinsp_filter_check_thread::compare_full_aexepath(sinsp_evt *evt)
 
 		if(res == true)
 		{
-			found = true;
-
-			// Can stop traversing parent state
-			return false;
+			return true;
 		}
+	}
 
-		return true;
-	};
-
-	mt->traverse_parent_state(visitor);
-
-	return found;
+	return false;
 }
 
 bool sinsp_filter_check_thread::compare_full_acmdline(sinsp_evt *evt)
@@ -1855,12 +1785,10 @@ bool sinsp_filter_check_thread::compare_full_acmdline(sinsp_evt *evt)
 	//
 	// No id specified, search in all of the ancestors
 	//
-	bool found = false;
-	sinsp_threadinfo::visitor_func_t visitor = [this, &found] (sinsp_threadinfo *pt)
+	for(auto pt : mt->get_ancestors())
 	{
 		bool res;
-		std::string cmdline;
-		sinsp_threadinfo::populate_cmdline(cmdline, pt);
+		const std::string& cmdline = pt->get_cmdline(m_tstr);
 
 		res = compare_rhs(m_cmpop,
 				  PT_CHARBUF,
@@ -1868,18 +1796,11 @@ bool sinsp_filter_check_thread::compare_full_acmdline(sinsp_evt *evt)
 
 		if(res == true)
 		{
-			found = true;
-
-			// Can stop traversing parent state
-			return false;
+			return true;
 		}
+	}
 
-		return true;
-	};
-
-	mt->traverse_parent_state(visitor);
-
-	return found;
+	return false;
 }
 
 bool sinsp_filter_check_thread::compare_full_aenv(sinsp_evt *evt)
@@ -1910,28 +1831,20 @@ bool sinsp_filter_check_thread::compare_full_aenv(sinsp_evt *evt)
 	//
 	// No id specified, search in all of the ancestors
 	//
-	bool found = false;
-	sinsp_threadinfo::visitor_func_t visitor = [this, &found] (sinsp_threadinfo *pt)
+	for(auto pt : mt->get_ancestors())
 	{
-		std::string full_env = pt->concatenate_all_env();
+		const std::string& full_env = pt->get_concatenated_env(m_tstr);
 		bool res = compare_rhs(m_cmpop,
 				  PT_CHARBUF,
 				  (void*)full_env.c_str());
 
 		if(res == true)
 		{
-			found = true;
-
-			// Can stop traversing parent state
-			return false;
+			return true;
 		}
+	}
 
-		return true;
-	};
-
-	mt->traverse_parent_state(visitor);
-
-	return found;
+	return false;
 }
 
 bool sinsp_filter_check_thread::compare_nocache(sinsp_evt *evt)
@@ -0,0 +1,233 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/sinsp_flow_table.h>
+#include <libsinsp/sinsp_exception.h>
+#include <libsinsp/utils.h>
+
+libsinsp::sinsp_flow_info::sinsp_flow_info():
+	sinsp_flow_info(std::make_shared<state::dynamic_struct::field_infos>())
+{
+}
+
+libsinsp::sinsp_flow_info::sinsp_flow_info(const std::shared_ptr<state::dynamic_struct::field_infos>& dyn_fields):
+	table_entry(dyn_fields)
+{
+	static const char* gap_names[num_gap_buckets] = {
+		"gap_10us", "gap_100us", "gap_1ms", "gap_10ms",
+		"gap_100ms", "gap_1s", "gap_10s", "gap_inf"
+	};
+
+	define_static_field(this, m_pid, "pid", true);
+	define_static_field(this, m_fd, "fd", true);
+	define_static_field(this, m_tuple, "tuple", true);
+	define_static_field(this, m_l4proto, "l4proto", true);
+	define_static_field(this, m_closed, "closed", true);
+	define_static_field(this, m_bytes_in, "bytes_in", true);
+	define_static_field(this, m_bytes_out, "bytes_out", true);
+	define_static_field(this, m_ops_in, "ops_in", true);
+	define_static_field(this, m_ops_out, "ops_out", true);
+	define_static_field(this, m_first_ts, "first_ts", true);
+	define_static_field(this, m_last_ts, "last_ts", true);
+	for(uint32_t j = 0; j < num_gap_buckets; j++)
+	{
+		define_static_field(this, m_gap_hist[j], gap_names[j], true);
+	}
+}
+
+libsinsp::sinsp_flow_table::sinsp_flow_table():
+	table(s_table_name, sinsp_flow_info().static_fields())
+{
+}
+
+uint32_t libsinsp::sinsp_flow_table::gap_bucket(uint64_t gap_ns)
+{
+	uint64_t limit = 10000;
+	uint32_t j = 0;
+	while(j < sinsp_flow_info::num_gap_buckets - 1 && gap_ns >= limit)
+	{
+		limit *= 10;
+		j++;
+	}
+	return j;
+}
+
+void libsinsp::sinsp_flow_table::on_io(int64_t pid, uint64_t pid_start_ts, int64_t fd, const sinsp_fdinfo& fdinfo, bool in, uint64_t bytes, uint64_t ts)
+{
+	if(fdinfo.m_type != SCAP_FD_IPV4_SOCK && fdinfo.m_type != SCAP_FD_IPV6_SOCK)
+	{
+		return;
+	}
+
+	uint64_t key = flow_key(pid, fd);
+	auto it = m_flows.find(key);
+	if(it == m_flows.end() || it->second.closed || it->second.pid_start_ts != pid_start_ts)
+	{
+		if(it == m_flows.end() && m_flows.size() >= m_max_flows)
+		{
+			m_n_dropped_flows++;
+			return;
+		}
+
+		// the fd number of a closed flow, or the pid of an exited
+		// process, got reused before the snapshot: the new connection
+		// starts from scratch
+		flow& f = m_flows[key];
+		f = {};
+		f.pid = pid;
+		f.pid_start_ts = pid_start_ts;
+		f.fd = fd;
+		f.first_ts = ts;
+		f.last_in = in;
+		it = m_flows.find(key);
+	}
+
+	flow& f = it->second;
+	f.type = fdinfo.m_type;
+	f.sockinfo = fdinfo.m_sockinfo;
+
+	if(in)
+	{
+		f.bytes_in += bytes;
+		f.ops_in++;
+	}
+	else
+	{
+		f.bytes_out += bytes;
+		f.ops_out++;
+	}
+
+	if(in != f.last_in)
+	{
+		f.gap_hist[gap_bucket(ts > f.last_ts ? ts - f.last_ts : 0)]++;
+		f.last_in = in;
+	}
+	f.last_ts = ts;
+}
+
+void libsinsp::sinsp_flow_table::on_close(int64_t pid, int64_t fd)
+{
+	auto it = m_flows.find(flow_key(pid, fd));
+	if(it != m_flows.end())
+	{
+		it->second.closed = true;
+	}
+}
+
+void libsinsp::sinsp_flow_table::export_flow(const flow& f, sinsp_flow_info& info) const
+{
+	char buf[1024];
+
+	info.m_pid = f.pid;
+	info.m_fd = f.fd;
+	if(sinsp_utils::sockinfo_to_str(&f.sockinfo, f.type, buf, sizeof(buf)))
+	{
+		info.m_tuple = buf;
+	}
+	info.m_l4proto = f.type == SCAP_FD_IPV4_SOCK ?
+		f.sockinfo.m_ipv4info.m_fields.m_l4proto :
+		f.sockinfo.m_ipv6info.m_fields.m_l4proto;
+	info.m_closed = f.closed;
+	info.m_bytes_in = f.bytes_in;
+	info.m_bytes_out = f.bytes_out;
+	info.m_ops_in = f.ops_in;
+	info.m_ops_out = f.ops_out;
+	info.m_first_ts = f.first_ts;
+	info.m_last_ts = f.last_ts;
+	for(uint32_t j = 0; j < sinsp_flow_info::num_gap_buckets; j++)
+	{
+		info.m_gap_hist[j] = f.gap_hist[j];
+	}
+}
+
+void libsinsp::sinsp_flow_table::snapshot(uint64_t ts)
+{
+	m_next_snapshot_ts = ts + m_snapshot_interval_ns;
+
+	// entries of the flows that went away are not exported again
+	for(auto it = m_snapshot.begin(); it != m_snapshot.end();)
+	{
+		it = m_flows.count(it->first) == 0 ? m_snapshot.erase(it) : std::next(it);
+	}
+
+	for(auto it = m_flows.begin(); it != m_flows.end();)
+	{
+		const flow& f = it->second;
+		auto& info = m_snapshot[it->first];
+		if(info == nullptr)
+		{
+			info = std::make_shared<sinsp_flow_info>(dynamic_fields());
+		}
+		export_flow(f, *info);
+
+		// closed flows are exported once, idle ones are not exported
+		// anymore after the next snapshot
+		if(f.closed || (ts > f.last_ts && ts - f.last_ts > m_idle_timeout_ns))
+		{
+			it = m_flows.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void libsinsp::sinsp_flow_table::clear()
+{
+	m_flows.clear();
+	m_snapshot.clear();
+	m_next_snapshot_ts = 0;
+}
+
+std::unique_ptr<libsinsp::state::table_entry> libsinsp::sinsp_flow_table::new_entry() const
+{
+	return std::make_unique<sinsp_flow_info>(dynamic_fields());
+}
+
+bool libsinsp::sinsp_flow_table::foreach_entry(std::function<bool(state::table_entry& e)> pred)
+{
+	for(const auto& e : m_snapshot)
+	{
+		if(!pred(*e.second))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+std::shared_ptr<libsinsp::state::table_entry> libsinsp::sinsp_flow_table::get_entry(const uint64_t& key)
+{
+	auto it = m_snapshot.find(key);
+	if(it == m_snapshot.end())
+	{
+		return nullptr;
+	}
+	return it->second;
+}
+
+std::shared_ptr<libsinsp::state::table_entry> libsinsp::sinsp_flow_table::add_entry(const uint64_t& key, std::unique_ptr<state::table_entry> entry)
+{
+	throw sinsp_exception("entries can't be added to the read-only flow table");
+}
+
+bool libsinsp::sinsp_flow_table::erase_entry(const uint64_t& key)
+{
+	throw sinsp_exception("entries can't be erased from the read-only flow table");
+}
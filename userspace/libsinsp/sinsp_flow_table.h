@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <libsinsp/fdinfo.h>
+#include <libsinsp/state/table.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+namespace libsinsp
+{
+
+//
+// Counters of a single flow, as exported in the flow table. Gaps are the
+// times between the last operation in a direction and the first one in
+// the other direction, e.g. between a request and its response.
+//
+struct sinsp_flow_info: public state::table_entry
+{
+	static constexpr uint32_t num_gap_buckets = 8;
+
+	sinsp_flow_info();
+	sinsp_flow_info(const std::shared_ptr<state::dynamic_struct::field_infos>& dyn_fields);
+
+	int64_t m_pid = -1;
+	int64_t m_fd = -1;
+	std::string m_tuple;
+	uint8_t m_l4proto = 0;
+	bool m_closed = false;
+	uint64_t m_bytes_in = 0;
+	uint64_t m_bytes_out = 0;
+	uint64_t m_ops_in = 0;
+	uint64_t m_ops_out = 0;
+	uint64_t m_first_ts = 0;
+	uint64_t m_last_ts = 0;
+	// gaps < 10us, < 100us, ..., < 10s, >= 10s
+	uint64_t m_gap_hist[num_gap_buckets] = {};
+};
+
+//
+// Per-connection accounting of the I/O on TCP and UDP sockets, keyed by
+// process and fd. The parser updates the live counters inline with the
+// read and write events, and every snapshot interval of event time they
+// are copied into the "flows" state table, that consumers read instead of
+// looking at the I/O events themselves. Closed flows are exported by the
+// next snapshot and then dropped, flows without I/O for longer than the
+// idle timeout are dropped as well.
+//
+class sinsp_flow_table: public state::table<uint64_t>
+{
+public:
+	static constexpr const char* s_table_name = "flows";
+
+	sinsp_flow_table();
+
+	inline void set_enabled(bool enable)
+	{
+		m_enabled = enable;
+		if(!enable)
+		{
+			clear();
+		}
+	}
+
+	inline bool is_enabled() const
+	{
+		return m_enabled;
+	}
+
+	inline void set_snapshot_interval(uint64_t interval_ns)
+	{
+		m_snapshot_interval_ns = interval_ns;
+	}
+
+	inline void set_idle_timeout(uint64_t timeout_ns)
+	{
+		m_idle_timeout_ns = timeout_ns;
+	}
+
+	//
+	// Flows beyond this limit are not tracked, see get_n_dropped_flows()
+	//
+	inline void set_max_flows(uint32_t max_flows)
+	{
+		m_max_flows = max_flows;
+	}
+
+	static inline uint64_t flow_key(int64_t pid, int64_t fd)
+	{
+		return ((uint64_t)pid << 32) | (uint32_t)fd;
+	}
+
+	static uint32_t gap_bucket(uint64_t gap_ns);
+
+	//
+	// Accounts a successful read (in) or write on the given fd.
+	// pid_start_ts is the creation time of the process, a flow of an
+	// earlier process with the same pid starts from scratch.
+	//
+	void on_io(int64_t pid, uint64_t pid_start_ts, int64_t fd, const sinsp_fdinfo& fdinfo, bool in, uint64_t bytes, uint64_t ts);
+	void on_close(int64_t pid, int64_t fd);
+
+	//
+	// Called for every event, takes a snapshot when one is due
+	//
+	inline void on_event(uint64_t ts)
+	{
+		if(m_enabled && ts >= m_next_snapshot_ts)
+		{
+			snapshot(ts);
+		}
+	}
+
+	void snapshot(uint64_t ts);
+	void clear();
+
+	inline uint64_t get_num_flows() const
+	{
+		return m_flows.size();
+	}
+
+	inline uint64_t get_n_dropped_flows() const
+	{
+		return m_n_dropped_flows;
+	}
+
+	// ---- libsinsp::state::table implementation ----
+
+	size_t entries_count() const override
+	{
+		return m_snapshot.size();
+	}
+
+	void clear_entries() override
+	{
+		m_snapshot.clear();
+	}
+
+	std::unique_ptr<state::table_entry> new_entry() const override;
+
+	bool foreach_entry(std::function<bool(state::table_entry& e)> pred) override;
+
+	std::shared_ptr<state::table_entry> get_entry(const uint64_t& key) override;
+
+	// the entries are only written by the snapshots
+	std::shared_ptr<state::table_entry> add_entry(const uint64_t& key, std::unique_ptr<state::table_entry> entry) override;
+
+	bool erase_entry(const uint64_t& key) override;
+
+private:
+	struct flow
+	{
+		int64_t pid;
+		uint64_t pid_start_ts;
+		int64_t fd;
+		scap_fd_type type;
+		sinsp_sockinfo sockinfo;
+		bool closed;
+		bool last_in;
+		uint64_t bytes_in;
+		uint64_t bytes_out;
+		uint64_t ops_in;
+		uint64_t ops_out;
+		uint64_t first_ts;
+		uint64_t last_ts;
+		uint64_t gap_hist[sinsp_flow_info::num_gap_buckets];
+	};
+
+	void export_flow(const flow& f, sinsp_flow_info& info) const;
+
+	bool m_enabled = false;
+	uint64_t m_snapshot_interval_ns = 1000000000;
+	uint64_t m_idle_timeout_ns = 300 * (uint64_t)1000000000;
+	uint32_t m_max_flows = 65536;
+	uint64_t m_next_snapshot_ts = 0;
+	uint64_t m_n_dropped_flows = 0;
+
+	std::unordered_map<uint64_t, flow> m_flows;
+	std::unordered_map<uint64_t, std::shared_ptr<sinsp_flow_info>> m_snapshot;
+};
+
+}
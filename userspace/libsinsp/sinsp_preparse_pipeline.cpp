@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/sinsp_preparse_pipeline.h>
+
+#include <libsinsp/utils.h>
+
+libsinsp::sinsp_preparse_pipeline::sinsp_preparse_pipeline(sinsp_evt* target, uint32_t nworkers):
+	m_target(target),
+	m_event_info_table(g_infotables.m_event_info)
+{
+	for(uint32_t i = 0; i < nworkers; i++)
+	{
+		m_workers.emplace_back(&sinsp_preparse_pipeline::worker_loop, this);
+	}
+}
+
+libsinsp::sinsp_preparse_pipeline::~sinsp_preparse_pipeline()
+{
+	end_batch();
+	{
+		std::lock_guard<std::mutex> lk(m_mtx);
+		m_stop = true;
+	}
+	m_batch_cv.notify_all();
+	for(auto& w : m_workers)
+	{
+		w.join();
+	}
+}
+
+void libsinsp::sinsp_preparse_pipeline::begin_batch(const scap_batch_evt* evts, uint32_t nevts)
+{
+	end_batch();
+
+	std::unique_lock<std::mutex> lk(m_mtx);
+	// a worker could have started with the previous batch after end_batch()
+	// returned, the batch state can only change once it's done
+	m_idle_cv.wait(lk, [this] { return m_active == 0; });
+	if(nevts > m_slots_capacity)
+	{
+		m_slots = std::make_unique<slot[]>(nevts);
+		m_slots_capacity = nevts;
+	}
+	for(uint32_t i = 0; i < nevts; i++)
+	{
+		m_slots[i].state.store(SLOT_PENDING, std::memory_order_relaxed);
+	}
+	m_evts = evts;
+	m_nevts = nevts;
+	m_next.store(0, std::memory_order_relaxed);
+	m_generation++;
+	lk.unlock();
+	m_batch_cv.notify_all();
+}
+
+void libsinsp::sinsp_preparse_pipeline::end_batch()
+{
+	if(m_nevts == 0)
+	{
+		return;
+	}
+
+	// claim back what the workers did not start with yet
+	for(uint32_t i = 0; i < m_nevts; i++)
+	{
+		uint8_t state = SLOT_PENDING;
+		m_slots[i].state.compare_exchange_strong(state, SLOT_DONE, std::memory_order_acq_rel);
+	}
+
+	std::unique_lock<std::mutex> lk(m_mtx);
+	m_idle_cv.wait(lk, [this] { return m_active == 0; });
+	m_evts = nullptr;
+	m_nevts = 0;
+}
+
+void libsinsp::sinsp_preparse_pipeline::wait_batch_preparsed()
+{
+	if(m_workers.empty())
+	{
+		return;
+	}
+
+	std::unique_lock<std::mutex> lk(m_mtx);
+	m_idle_cv.wait(lk, [this] { return m_active == 0 && m_next.load(std::memory_order_relaxed) >= m_nevts; });
+}
+
+void libsinsp::sinsp_preparse_pipeline::worker_loop()
+{
+	uint64_t generation = 0;
+	while(true)
+	{
+		const scap_batch_evt* evts;
+		uint32_t nevts;
+		slot* slots;
+		{
+			std::unique_lock<std::mutex> lk(m_mtx);
+			m_batch_cv.wait(lk, [&] { return m_stop || m_generation != generation; });
+			if(m_stop)
+			{
+				return;
+			}
+			generation = m_generation;
+			m_active++;
+
+			// the batch state can't change while this worker is active
+			evts = m_evts;
+			nevts = m_nevts;
+			slots = m_slots.get();
+		}
+
+		run_batch(evts, nevts, slots);
+
+		{
+			std::lock_guard<std::mutex> lk(m_mtx);
+			m_active--;
+			if(m_active == 0)
+			{
+				m_idle_cv.notify_all();
+			}
+		}
+	}
+}
+
+void libsinsp::sinsp_preparse_pipeline::run_batch(const scap_batch_evt* evts, uint32_t nevts, slot* slots)
+{
+	while(true)
+	{
+		uint32_t idx = m_next.fetch_add(1, std::memory_order_relaxed);
+		if(idx >= nevts)
+		{
+			return;
+		}
+
+		slot& s = slots[idx];
+		uint8_t state = SLOT_PENDING;
+		if(!s.state.compare_exchange_strong(state, SLOT_CLAIMED, std::memory_order_acq_rel))
+		{
+			// the capture thread is already past this event
+			continue;
+		}
+
+		sinsp_evt::decode_params(m_target, evts[idx].evt, m_event_info_table, s.params);
+		s.state.store(SLOT_READY, std::memory_order_release);
+	}
+}
@@ -0,0 +1,179 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <libscap/scap.h>
+#include <libsinsp/event.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace libsinsp
+{
+
+//
+// Runs the stateless part of the event parsing on worker threads, ahead of
+// the stateful parser running on the capture thread.
+// Every batch returned by scap_next_batch is published to the workers, which
+// claim its events one by one and decode their parameters. When the capture
+// thread gets to an event, it adopts the decoded parameters if a worker is
+// done with it, or claims it back and lets the event load its parameters
+// lazily as usual. The capture thread never waits on an event that no worker
+// has started with, so a busy pipeline can't be slower than no pipeline.
+// Workers only read the events of the current batch, which stay valid until
+// the next scap_next_batch call: end_batch() must be called before that.
+//
+class sinsp_preparse_pipeline
+{
+public:
+	//
+	// Creates a pipeline with `nworkers` threads, whose output is
+	// adopted by `target`, the event used by the capture thread
+	//
+	sinsp_preparse_pipeline(sinsp_evt* target, uint32_t nworkers);
+	~sinsp_preparse_pipeline();
+
+	sinsp_preparse_pipeline(const sinsp_preparse_pipeline&) = delete;
+	sinsp_preparse_pipeline& operator=(const sinsp_preparse_pipeline&) = delete;
+
+	//
+	// Publishes a new batch of events to the workers
+	//
+	void begin_batch(const scap_batch_evt* evts, uint32_t nevts);
+
+	//
+	// Waits for the workers to release the events of the current batch
+	//
+	void end_batch();
+
+	//
+	// Waits for the workers to be done with every event of the current
+	// batch they can claim, so that all of them are pre-parsed unless
+	// the capture thread got to them first
+	//
+	void wait_batch_preparsed();
+
+	//
+	// Called by the capture thread when the event at position `idx`
+	// of the current batch has been loaded into `evt`
+	//
+	inline void consume(uint32_t idx, sinsp_evt* evt)
+	{
+		if(idx >= m_nevts)
+		{
+			evt->clear_preparsed_params();
+			return;
+		}
+
+		slot& s = m_slots[idx];
+		uint8_t state = SLOT_PENDING;
+		if(s.state.compare_exchange_strong(state, SLOT_DONE, std::memory_order_acq_rel))
+		{
+			// no worker got here yet, the event will be decoded lazily
+			evt->clear_preparsed_params();
+			m_n_inline++;
+			return;
+		}
+
+		while(state == SLOT_CLAIMED)
+		{
+			std::this_thread::yield();
+			state = s.state.load(std::memory_order_acquire);
+		}
+
+		if(state == SLOT_READY)
+		{
+			evt->set_preparsed_params(s.params);
+			s.state.store(SLOT_DONE, std::memory_order_relaxed);
+			m_n_preparsed++;
+		}
+		else
+		{
+			evt->clear_preparsed_params();
+		}
+	}
+
+	inline uint32_t get_num_workers() const
+	{
+		return (uint32_t)m_workers.size();
+	}
+
+	//
+	// Number of events whose parameters were decoded by a worker
+	//
+	inline uint64_t get_n_preparsed() const
+	{
+		return m_n_preparsed;
+	}
+
+	//
+	// Number of events reached by the capture thread before any worker
+	//
+	inline uint64_t get_n_inline() const
+	{
+		return m_n_inline;
+	}
+
+private:
+	enum slot_state : uint8_t
+	{
+		SLOT_PENDING = 0,
+		SLOT_CLAIMED,
+		SLOT_READY,
+		SLOT_DONE,
+	};
+
+	struct slot
+	{
+		std::atomic<uint8_t> state{SLOT_DONE};
+		std::vector<sinsp_evt_param> params;
+	};
+
+	void worker_loop();
+	void run_batch(const scap_batch_evt* evts, uint32_t nevts, slot* slots);
+
+	sinsp_evt* m_target;
+	const ppm_event_info* m_event_info_table;
+
+	// batch state, only written under m_mtx while no worker is active
+	const scap_batch_evt* m_evts = nullptr;
+	uint32_t m_nevts = 0;
+	std::unique_ptr<slot[]> m_slots;
+	uint32_t m_slots_capacity = 0;
+	std::atomic<uint32_t> m_next{0};
+
+	std::mutex m_mtx;
+	std::condition_variable m_batch_cv;
+	std::condition_variable m_idle_cv;
+	uint64_t m_generation = 0;
+	uint32_t m_active = 0;
+	bool m_stop = false;
+	std::vector<std::thread> m_workers;
+
+	// capture thread counters
+	uint64_t m_n_preparsed = 0;
+	uint64_t m_n_inline = 0;
+};
+
+}
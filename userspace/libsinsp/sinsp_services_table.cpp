@@ -0,0 +1,125 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/sinsp_services_table.h>
+#include <libscap/scap.h>
+
+#ifdef _WIN32
+#include <WinSock2.h>
+#else
+#include <arpa/inet.h>
+#include <netdb.h>
+#endif
+
+libsinsp::sinsp_services_table::sinsp_services_table():
+	m_names(1)
+{
+	for(auto& idx : m_index)
+	{
+		idx = std::make_unique<uint16_t[]>(num_ports);
+	}
+}
+
+const libsinsp::sinsp_services_table& libsinsp::sinsp_services_table::get()
+{
+	static const sinsp_services_table* s_table = []
+	{
+		auto t = new sinsp_services_table();
+		t->load_system_services();
+		return t;
+	}();
+	return *s_table;
+}
+
+void libsinsp::sinsp_services_table::add(const std::string& name, uint16_t port, const std::string& proto)
+{
+	if(name.empty() || m_names.size() > UINT16_MAX)
+	{
+		return;
+	}
+
+	uint16_t* by_proto = nullptr;
+	if(proto == "tcp")
+	{
+		by_proto = m_index[PROTO_TCP].get();
+	}
+	else if(proto == "udp")
+	{
+		by_proto = m_index[PROTO_UDP].get();
+	}
+
+	bool any_free = m_index[PROTO_ANY][port] == 0;
+	bool proto_free = by_proto != nullptr && by_proto[port] == 0;
+	if(!any_free && !proto_free)
+	{
+		return;
+	}
+
+	// consecutive entries are often the same service with another protocol
+	uint16_t id = (uint16_t)(m_names.size() - 1);
+	if(m_names.back() != name)
+	{
+		m_names.push_back(name);
+		id = (uint16_t)(m_names.size() - 1);
+	}
+
+	if(any_free)
+	{
+		m_index[PROTO_ANY][port] = id;
+	}
+	if(proto_free)
+	{
+		by_proto[port] = id;
+	}
+}
+
+const char* libsinsp::sinsp_services_table::lookup(uint16_t port, uint8_t l4proto) const
+{
+	uint16_t id;
+	switch(l4proto)
+	{
+	case SCAP_L4_TCP:
+		id = m_index[PROTO_TCP][port];
+		break;
+	case SCAP_L4_UDP:
+		id = m_index[PROTO_UDP][port];
+		break;
+	default:
+		id = m_index[PROTO_ANY][port];
+		break;
+	}
+	return id != 0 ? m_names[id].c_str() : nullptr;
+}
+
+void libsinsp::sinsp_services_table::load_system_services()
+{
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+	// getservent() walks the whole services database configured in
+	// nsswitch.conf, this runs once and before any other user of the table
+	setservent(0);
+	struct servent* s;
+	while((s = getservent()) != nullptr)
+	{
+		if(s->s_name != nullptr && s->s_proto != nullptr)
+		{
+			add(s->s_name, ntohs((uint16_t)s->s_port), s->s_proto);
+		}
+	}
+	endservent();
+#endif
+}
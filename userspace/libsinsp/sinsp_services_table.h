@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace libsinsp
+{
+
+//
+// Port to service name table, indexed by port and L4 protocol. The system
+// services database is read once, so that resolving a port does not go
+// through the NSS on every formatted socket tuple.
+//
+class sinsp_services_table
+{
+public:
+	static constexpr uint32_t num_ports = 65536;
+
+	sinsp_services_table();
+
+	//
+	// Returns the table loaded from the system services database,
+	// which is read on the first call
+	//
+	static const sinsp_services_table& get();
+
+	//
+	// Adds a service, only the first name added for a port and protocol
+	// is kept, like getservbyport() does. `proto` is the protocol name as
+	// found in the services database, e.g. "tcp"
+	//
+	void add(const std::string& name, uint16_t port, const std::string& proto);
+
+	//
+	// Returns the name of the service using `port` (in host byte order)
+	// with the given SCAP_L4_* protocol, or nullptr if it's not known.
+	// Protocols other than TCP and UDP match the services of any protocol.
+	//
+	const char* lookup(uint16_t port, uint8_t l4proto) const;
+
+	inline size_t size() const
+	{
+		return m_names.size() - 1;
+	}
+
+private:
+	enum proto_index
+	{
+		PROTO_ANY = 0,
+		PROTO_TCP = 1,
+		PROTO_UDP = 2,
+		PROTO_MAX = 3,
+	};
+
+	void load_system_services();
+
+	// index 0 means no service, so that the tables can start zeroed
+	std::vector<std::string> m_names;
+	std::unique_ptr<uint16_t[]> m_index[PROTO_MAX];
+};
+
+}
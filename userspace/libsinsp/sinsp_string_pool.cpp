@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/sinsp_string_pool.h>
+
+const std::string libsinsp::interned_string::s_empty;
+
+thread_local libsinsp::interned_string::local_cache libsinsp::interned_string::s_local_cache;
+
+libsinsp::interned_string::local_cache::local_cache():
+	slots(new interned_string[num_slots])
+{
+}
+
+libsinsp::interned_string::local_cache::~local_cache()
+{
+	delete[] slots;
+}
+
+libsinsp::interned_string::interned_string(std::string_view s)
+{
+	if(s.empty())
+	{
+		return;
+	}
+
+	// the low bits of the hash pick the pool shard
+	size_t hash = std::hash<std::string_view>{}(s);
+	interned_string& cached = s_local_cache.slots[(hash / sinsp_string_pool::num_shards) % local_cache::num_slots];
+	if(cached.m_entry != nullptr && cached.m_entry->value == s)
+	{
+		m_entry = cached.m_entry;
+		acquire();
+		return;
+	}
+
+	m_entry = sinsp_string_pool::instance().intern(s, hash);
+	cached = *this;
+}
+
+void libsinsp::interned_string::clear_local_cache()
+{
+	for(size_t i = 0; i < local_cache::num_slots; i++)
+	{
+		s_local_cache.slots[i].clear();
+	}
+}
+
+libsinsp::sinsp_string_pool& libsinsp::sinsp_string_pool::instance()
+{
+	// never destroyed, handles can outlive static destructors
+	static sinsp_string_pool* s_pool = new sinsp_string_pool();
+	return *s_pool;
+}
+
+libsinsp::sinsp_string_pool::entry* libsinsp::sinsp_string_pool::intern(std::string_view s, size_t hash)
+{
+	uint32_t idx = (uint32_t)(hash % num_shards);
+	shard& sh = m_shards[idx];
+
+	std::lock_guard<std::mutex> lk(sh.mtx);
+	auto it = sh.strings.find(s);
+	if(it != sh.strings.end())
+	{
+		it->second->refs.fetch_add(1, std::memory_order_relaxed);
+		return it->second;
+	}
+
+	entry* e = new entry{std::string(s), {1}, idx};
+	// the key views the string owned by the entry
+	sh.strings.emplace(std::string_view(e->value), e);
+	m_n_strings.fetch_add(1, std::memory_order_relaxed);
+	m_bytes.fetch_add(e->value.size(), std::memory_order_relaxed);
+	return e;
+}
+
+uint64_t libsinsp::sinsp_string_pool::get_saved_memory() const
+{
+	uint64_t saved = 0;
+	for(const auto& sh : m_shards)
+	{
+		std::lock_guard<std::mutex> lk(sh.mtx);
+		for(const auto& it : sh.strings)
+		{
+			uint64_t refs = it.second->refs.load(std::memory_order_relaxed);
+			saved += (refs - 1) * it.second->value.size();
+		}
+	}
+	return saved;
+}
+
+void libsinsp::sinsp_string_pool::release(entry* e)
+{
+	shard& sh = m_shards[e->shard];
+
+	std::unique_lock<std::mutex> lk(sh.mtx);
+	if(e->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+	{
+		return;
+	}
+
+	sh.strings.erase(std::string_view(e->value));
+	lk.unlock();
+
+	m_n_strings.fetch_sub(1, std::memory_order_relaxed);
+	m_bytes.fetch_sub(e->value.size(), std::memory_order_relaxed);
+	delete e;
+}
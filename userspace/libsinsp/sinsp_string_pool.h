@@ -0,0 +1,278 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+namespace libsinsp
+{
+
+class sinsp_string_pool;
+
+//
+// Refcounted handle to an immutable string stored once in the process-wide
+// sinsp_string_pool. Two handles hold equal strings if and only if they
+// point to the same pooled string, so comparing them is a pointer compare.
+// Handles can be created, copied and destroyed from any thread.
+//
+class interned_string
+{
+public:
+	interned_string() = default;
+	interned_string(std::string_view s);
+	interned_string(const std::string& s): interned_string(std::string_view(s)) {}
+	interned_string(const char* s): interned_string(std::string_view(s)) {}
+
+	interned_string(const interned_string& o): m_entry(o.m_entry)
+	{
+		acquire();
+	}
+
+	interned_string(interned_string&& o) noexcept: m_entry(o.m_entry)
+	{
+		o.m_entry = nullptr;
+	}
+
+	interned_string& operator=(const interned_string& o)
+	{
+		if(m_entry != o.m_entry)
+		{
+			release();
+			m_entry = o.m_entry;
+			acquire();
+		}
+		return *this;
+	}
+
+	interned_string& operator=(interned_string&& o) noexcept
+	{
+		if(this != &o)
+		{
+			release();
+			m_entry = o.m_entry;
+			o.m_entry = nullptr;
+		}
+		return *this;
+	}
+
+	~interned_string()
+	{
+		release();
+	}
+
+	inline const std::string& str() const
+	{
+		return m_entry ? m_entry->value : s_empty;
+	}
+
+	inline operator const std::string&() const
+	{
+		return str();
+	}
+
+	inline const char* c_str() const
+	{
+		return str().c_str();
+	}
+
+	inline size_t size() const
+	{
+		return str().size();
+	}
+
+	inline size_t length() const
+	{
+		return str().size();
+	}
+
+	inline bool empty() const
+	{
+		return m_entry == nullptr;
+	}
+
+	inline void clear()
+	{
+		release();
+		m_entry = nullptr;
+	}
+
+	//
+	// Drops the strings cached by the calling thread, see local_cache
+	//
+	static void clear_local_cache();
+
+	friend inline bool operator==(const interned_string& a, const interned_string& b)
+	{
+		return a.m_entry == b.m_entry;
+	}
+
+	friend inline bool operator!=(const interned_string& a, const interned_string& b)
+	{
+		return a.m_entry != b.m_entry;
+	}
+
+	friend inline bool operator==(const interned_string& a, const std::string& b) { return a.str() == b; }
+	friend inline bool operator==(const std::string& a, const interned_string& b) { return a == b.str(); }
+	friend inline bool operator==(const interned_string& a, const char* b) { return a.str() == b; }
+	friend inline bool operator==(const char* a, const interned_string& b) { return a == b.str(); }
+	friend inline bool operator!=(const interned_string& a, const std::string& b) { return a.str() != b; }
+	friend inline bool operator!=(const std::string& a, const interned_string& b) { return a != b.str(); }
+	friend inline bool operator!=(const interned_string& a, const char* b) { return a.str() != b; }
+	friend inline bool operator!=(const char* a, const interned_string& b) { return a != b.str(); }
+
+	friend inline std::ostream& operator<<(std::ostream& os, const interned_string& s)
+	{
+		return os << s.str();
+	}
+
+private:
+	friend class sinsp_string_pool;
+
+	struct entry
+	{
+		std::string value;
+		std::atomic<uint32_t> refs{1};
+		uint32_t shard;
+	};
+
+	// The latest strings interned by a thread, so that interning again a
+	// string seen recently (e.g. the same path opened over and over) only
+	// costs a refcount increment instead of the pool shard lock. The
+	// cached handles keep their strings in the pool until they are
+	// replaced or the thread exits.
+	struct local_cache
+	{
+		static constexpr size_t num_slots = 64;
+		interned_string* slots;
+
+		local_cache();
+		~local_cache();
+	};
+
+	inline void acquire();
+	inline void release();
+
+	static const std::string s_empty;
+	static thread_local local_cache s_local_cache;
+
+	entry* m_entry = nullptr;
+};
+
+//
+// Process-wide pool of interned strings, sharded to keep the contention low
+// when strings are interned from several threads. The empty string is never
+// stored.
+// Only the fd names use it. The string fields of sinsp_threadinfo (comm,
+// exe, exepath, cwd, container id, root) are not interned: the state table
+// API exposes them to plugins as std::string static fields read and written
+// in place, which an interned_string can't back.
+//
+class sinsp_string_pool
+{
+public:
+	static constexpr uint32_t num_shards = 16;
+
+	//
+	// Returns the pool used by all the interned_string handles
+	//
+	static sinsp_string_pool& instance();
+
+	sinsp_string_pool(const sinsp_string_pool&) = delete;
+	sinsp_string_pool& operator=(const sinsp_string_pool&) = delete;
+
+	//
+	// Number of distinct strings in the pool
+	//
+	inline uint64_t get_num_strings() const
+	{
+		return m_n_strings.load(std::memory_order_relaxed);
+	}
+
+	//
+	// Bytes of the distinct strings stored in the pool
+	//
+	inline uint64_t get_memory() const
+	{
+		return m_bytes.load(std::memory_order_relaxed);
+	}
+
+	//
+	// Bytes that the handles would use if each of them had its own copy
+	// of the string, minus the ones actually stored in the pool. This
+	// walks the whole pool, it's meant for the stats only.
+	//
+	uint64_t get_saved_memory() const;
+
+private:
+	friend class interned_string;
+	using entry = interned_string::entry;
+
+	sinsp_string_pool() = default;
+
+	struct shard
+	{
+		mutable std::mutex mtx;
+		std::unordered_map<std::string_view, entry*> strings;
+	};
+
+	entry* intern(std::string_view s, size_t hash);
+	void release(entry* e);
+
+	shard m_shards[num_shards];
+	std::atomic<uint64_t> m_n_strings{0};
+	std::atomic<uint64_t> m_bytes{0};
+};
+
+inline void interned_string::acquire()
+{
+	if(m_entry != nullptr)
+	{
+		// the caller already holds a reference, no need to lock
+		m_entry->refs.fetch_add(1, std::memory_order_relaxed);
+	}
+}
+
+inline void interned_string::release()
+{
+	if(m_entry == nullptr)
+	{
+		return;
+	}
+
+	// only the last reference is dropped under the shard lock, so that
+	// it can't race with the string being interned again
+	uint32_t refs = m_entry->refs.load(std::memory_order_relaxed);
+	while(refs > 1)
+	{
+		if(m_entry->refs.compare_exchange_weak(refs, refs - 1, std::memory_order_acq_rel))
+		{
+			return;
+		}
+	}
+	sinsp_string_pool::instance().release(m_entry);
+}
+
+}
@@ -23,6 +23,7 @@ limitations under the License.
 #include <string>
 #include <unordered_map>
 #include <memory>
+#include <vector>
 
 namespace libsinsp {
 namespace state {
@@ -35,6 +36,7 @@ class dynamic_struct
 {
 public:
     template<typename T> class field_accessor;
+    class columnar_field_infos;
 
     /**
      * @brief Info about a given field in a dynamic struct.
@@ -219,6 +221,15 @@ public:
             return m_definitions;
         }
 
+        /**
+         * @brief Returns non-null if the values of the fields are stored
+         * in columns owned by the definitions, see columnar_field_infos.
+         */
+        virtual columnar_field_infos* columnar()
+        {
+            return nullptr;
+        }
+
 protected:
         virtual const field_info& add_field(const field_info& field)
         {
@@ -244,12 +255,244 @@ protected:
         friend class dynamic_struct;
     };
 
+    /**
+     * @brief Dynamic fields metadata that also own the values of the fields
+     * for all the structs sharing them. Every field is stored in a typed
+     * column, and every struct is assigned a dense slot that indexes all the
+     * columns. Reading the same field from many structs touches contiguous
+     * memory, and no allocation is performed per field and per struct.
+     */
+    class columnar_field_infos: public field_infos
+    {
+    public:
+        columnar_field_infos() = default;
+        virtual ~columnar_field_infos() = default;
+        columnar_field_infos(columnar_field_infos&&) = default;
+        columnar_field_infos& operator = (columnar_field_infos&&) = default;
+        columnar_field_infos(const columnar_field_infos& s) = delete;
+        columnar_field_infos& operator = (const columnar_field_infos& s) = delete;
+
+        columnar_field_infos* columnar() override
+        {
+            return this;
+        }
+
+        template<typename T>
+        inline const field_info& add_field(const std::string& name)
+        {
+            return field_infos::add_field<T>(name);
+        }
+
+        /**
+         * @brief Returns the number of slots currently assigned to structs.
+         */
+        inline size_t used_slots() const
+        {
+            return m_nslots - m_free_slots.size();
+        }
+
+    protected:
+        // the column of a field is created with its definition, so that
+        // accessing the values never changes the set of columns
+        const field_info& add_field(const field_info& field) override
+        {
+            const auto& def = field_infos::add_field(field);
+            _add_column(def);
+            return def;
+        }
+
+    private:
+        // columns grow by fixed-size chunks that are never moved, so that
+        // the pointers to the values (e.g. strings) stay valid like with
+        // the per-struct storage
+        static constexpr size_t s_chunk_bits = 8;
+        static constexpr size_t s_chunk_size = (size_t) 1 << s_chunk_bits;
+        static constexpr size_t s_chunk_mask = s_chunk_size - 1;
+
+        struct column_base
+        {
+            virtual ~column_base() = default;
+            virtual void add_chunk() = 0;
+            virtual void reset(size_t slot) = 0;
+            virtual void copy(size_t from, size_t to) = 0;
+
+            // a value is reached with an offset computation only
+            inline void* at(size_t slot)
+            {
+                return m_chunks[slot >> s_chunk_bits] + ((slot & s_chunk_mask) * m_elem_size);
+            }
+
+            std::vector<uint8_t*> m_chunks;
+            size_t m_elem_size = 0;
+        };
+
+        template <typename T>
+        struct column: public column_base
+        {
+            column(size_t nchunks)
+            {
+                m_elem_size = sizeof(T);
+                for (size_t i = 0; i < nchunks; i++)
+                {
+                    add_chunk();
+                }
+            }
+
+            void add_chunk() override
+            {
+                m_owned.emplace_back(new T[s_chunk_size]());
+                m_chunks.push_back(reinterpret_cast<uint8_t*>(m_owned.back().get()));
+            }
+
+            void reset(size_t slot) override
+            {
+                *static_cast<T*>(at(slot)) = T{};
+            }
+
+            void copy(size_t from, size_t to) override
+            {
+                *static_cast<T*>(at(to)) = *static_cast<T*>(at(from));
+            }
+
+            std::vector<std::unique_ptr<T[]>> m_owned;
+        };
+
+        inline void _add_column(const field_info& i)
+        {
+            if (i.index() >= m_columns.size())
+            {
+                m_columns.resize(i.index() + 1);
+            }
+            auto& col = m_columns[i.index()];
+            if (!col)
+            {
+                auto nchunks = (m_nslots + s_chunk_size - 1) >> s_chunk_bits;
+                switch (i.info().index())
+                {
+                    case PT_BOOL: col.reset(new column<bool>(nchunks)); break;
+                    case PT_INT8: col.reset(new column<int8_t>(nchunks)); break;
+                    case PT_INT16: col.reset(new column<int16_t>(nchunks)); break;
+                    case PT_INT32: col.reset(new column<int32_t>(nchunks)); break;
+                    case PT_INT64: col.reset(new column<int64_t>(nchunks)); break;
+                    case PT_UINT8: col.reset(new column<uint8_t>(nchunks)); break;
+                    case PT_UINT16: col.reset(new column<uint16_t>(nchunks)); break;
+                    case PT_UINT32: col.reset(new column<uint32_t>(nchunks)); break;
+                    case PT_UINT64: col.reset(new column<uint64_t>(nchunks)); break;
+                    case PT_CHARBUF: col.reset(new column<std::string>(nchunks)); break;
+                    default:
+                        throw sinsp_exception("unsupported type for columnar dynamic field: " + i.name());
+                }
+            }
+        }
+
+        inline void* _value(const field_info& i, size_t slot)
+        {
+            return m_columns[i.index()]->at(slot);
+        }
+
+        inline size_t _acquire_slot()
+        {
+            if (!m_free_slots.empty())
+            {
+                auto slot = m_free_slots.back();
+                m_free_slots.pop_back();
+                return slot;
+            }
+            if ((m_nslots & s_chunk_mask) == 0)
+            {
+                for (auto& col : m_columns)
+                {
+                    if (col)
+                    {
+                        col->add_chunk();
+                    }
+                }
+            }
+            return m_nslots++;
+        }
+
+        inline void _release_slot(size_t slot)
+        {
+            // reused slots start from default values
+            for (auto& col : m_columns)
+            {
+                if (col)
+                {
+                    col->reset(slot);
+                }
+            }
+            m_free_slots.push_back(slot);
+        }
+
+        inline void _copy_slot(size_t from, size_t to)
+        {
+            for (auto& col : m_columns)
+            {
+                if (col)
+                {
+                    col->copy(from, to);
+                }
+            }
+        }
+
+        std::vector<std::unique_ptr<column_base>> m_columns;
+        std::vector<size_t> m_free_slots;
+        size_t m_nslots = 0;
+
+        friend class dynamic_struct;
+    };
+
     dynamic_struct(const std::shared_ptr<field_infos>& dynamic_fields)
-        : m_fields_len(0), m_fields(), m_dynamic_fields(dynamic_fields) { }
-    dynamic_struct(dynamic_struct&&) = default;
-    dynamic_struct& operator = (dynamic_struct&&) = default;
-    dynamic_struct(const dynamic_struct& s) = default;
-    dynamic_struct& operator = (const dynamic_struct& s) = default;
+        : m_fields_len(0),
+          m_fields(),
+          m_dynamic_fields(dynamic_fields),
+          m_columnar(dynamic_fields ? dynamic_fields->columnar() : nullptr),
+          m_slot(s_no_slot) { }
+    dynamic_struct(dynamic_struct&& s)
+        : m_fields_len(s.m_fields_len),
+          m_fields(std::move(s.m_fields)),
+          m_dynamic_fields(std::move(s.m_dynamic_fields)),
+          m_columnar(s.m_columnar),
+          m_slot(s.m_slot)
+    {
+        s.m_slot = s_no_slot;
+    }
+    dynamic_struct& operator = (dynamic_struct&& s)
+    {
+        if (this != &s)
+        {
+            _release_slot();
+            m_fields_len = s.m_fields_len;
+            m_fields = std::move(s.m_fields);
+            m_dynamic_fields = std::move(s.m_dynamic_fields);
+            m_columnar = s.m_columnar;
+            m_slot = s.m_slot;
+            s.m_slot = s_no_slot;
+        }
+        return *this;
+    }
+    dynamic_struct(const dynamic_struct& s)
+        : m_fields_len(s.m_fields_len),
+          m_fields(s.m_fields),
+          m_dynamic_fields(s.m_dynamic_fields),
+          m_columnar(s.m_columnar),
+          m_slot(s_no_slot)
+    {
+        _copy_slot(s);
+    }
+    dynamic_struct& operator = (const dynamic_struct& s)
+    {
+        if (this != &s)
+        {
+            _release_slot();
+            m_fields_len = s.m_fields_len;
+            m_fields = s.m_fields;
+            m_dynamic_fields = s.m_dynamic_fields;
+            m_columnar = s.m_columnar;
+            _copy_slot(s);
+        }
+        return *this;
+    }
     virtual ~dynamic_struct()
     {
         if (m_dynamic_fields)
@@ -260,6 +503,7 @@ protected:
                 free(m_fields[i]);
             }
         }
+        _release_slot();
     }
 
     /**
@@ -310,6 +554,7 @@ protected:
             throw sinsp_exception("dynamic struct constructed with null field definitions");
         }
         m_dynamic_fields = defs;
+        m_columnar = defs->columnar();
     }
 
 protected:
@@ -321,7 +566,20 @@ protected:
     */
     virtual void get_dynamic_field(const field_info& i, void* out)
     {
-        const auto* buf = _access_dynamic_field(i.m_index);
+        const auto* buf = _read_dynamic_field(i.m_index);
+        if (buf == nullptr)
+        {
+            // never written, the field has its default value
+            if (i.info().index() == PT_CHARBUF)
+            {
+                *((const char**) out) = "";
+            }
+            else
+            {
+                memset(out, 0, i.info().size());
+            }
+            return;
+        }
         if (i.info().index() == PT_CHARBUF)
         {
             *((const char**) out) = ((const std::string*) buf)->c_str();
@@ -368,6 +626,30 @@ private:
         }
     }
 
+    // reading never allocates: returns nullptr if the field has not been
+    // written yet, in which case it holds its default value
+    inline const void* _read_dynamic_field(size_t index) const
+    {
+        if (!m_dynamic_fields)
+        {
+            throw sinsp_exception("dynamic struct has no field definitions");
+        }
+        if (index >= m_dynamic_fields->m_definitions_ordered.size())
+        {
+            throw sinsp_exception("dynamic struct access overflow: " + std::to_string(index));
+        }
+        if (m_columnar)
+        {
+            if (m_slot == s_no_slot)
+            {
+                return nullptr;
+            }
+            return m_columnar->_value(*m_dynamic_fields->m_definitions_ordered[index], m_slot);
+        }
+        return index < m_fields_len ? m_fields[index] : nullptr;
+    }
+
+    // the slot of columnar structs is assigned at the first write
     inline void* _access_dynamic_field(size_t index)
     {
         if (!m_dynamic_fields)
@@ -378,6 +660,14 @@ private:
         {
             throw sinsp_exception("dynamic struct access overflow: " + std::to_string(index));
         }
+        if (m_columnar)
+        {
+            if (m_slot == s_no_slot)
+            {
+                m_slot = m_columnar->_acquire_slot();
+            }
+            return m_columnar->_value(*m_dynamic_fields->m_definitions_ordered[index], m_slot);
+        }
         while (m_fields_len <= index)
         {
             auto def = m_dynamic_fields->m_definitions_ordered[m_fields_len];
@@ -389,9 +679,35 @@ private:
         return m_fields[index];
     }
 
+    inline void _release_slot()
+    {
+        if (m_columnar && m_slot != s_no_slot)
+        {
+            m_columnar->_release_slot(m_slot);
+            m_slot = s_no_slot;
+        }
+    }
+
+    inline void _copy_slot(const dynamic_struct& s)
+    {
+        if (m_columnar && s.m_slot != s_no_slot)
+        {
+            m_slot = m_columnar->_acquire_slot();
+            m_columnar->_copy_slot(s.m_slot, m_slot);
+        }
+    }
+
+    static constexpr size_t s_no_slot = (size_t) -1;
+
     size_t m_fields_len;
     std::vector<void*> m_fields;
     std::shared_ptr<field_infos> m_dynamic_fields;
+    // non-null if the values are stored in the columns of m_dynamic_fields,
+    // in which case m_slot is the index of this struct in the columns
+    columnar_field_infos* m_columnar;
+    size_t m_slot;
+
+    template <typename KeyType> friend class table;
 };
 
 
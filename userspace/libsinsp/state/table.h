@@ -48,10 +48,21 @@ class base_table
 public:
     base_table(const std::string& name, const typeinfo& key_info,
         const static_struct::field_infos& static_fields)
+            : base_table(name, key_info, static_fields,
+                std::make_shared<dynamic_struct::field_infos>()) { }
+
+    /**
+     * @brief Constructs a table with the given dynamic fields definitions,
+     * e.g. a dynamic_struct::columnar_field_infos to store the values of
+     * the dynamic fields of all the entries in columns.
+     */
+    base_table(const std::string& name, const typeinfo& key_info,
+        const static_struct::field_infos& static_fields,
+        const std::shared_ptr<dynamic_struct::field_infos>& dynamic_fields)
             : m_name(name),
               m_key_info(key_info), 
               m_static_fields(static_fields),
-              m_dynamic_fields(std::make_shared<dynamic_struct::field_infos>()) { }
+              m_dynamic_fields(dynamic_fields) { }
 
     virtual ~base_table() = default;
     base_table(base_table&&) = default;
@@ -149,6 +160,9 @@ public:
     table(const std::string& name, const static_struct::field_infos& static_fields)
             : base_table(name, typeinfo::of<KeyType>(), static_fields) {}
     table(const std::string& name): table(name, static_struct::field_infos()) {}
+    table(const std::string& name, const static_struct::field_infos& static_fields,
+        const std::shared_ptr<dynamic_struct::field_infos>& dynamic_fields)
+            : base_table(name, typeinfo::of<KeyType>(), static_fields, dynamic_fields) {}
     virtual ~table() = default;
     table(table&&) = default;
     table& operator = (table&&) = default;
@@ -187,6 +201,64 @@ public:
      * @return false If an entry was not present at the given key.
      */
     virtual bool erase_entry(const KeyType& key) = 0;
+
+    /**
+     * @brief Reads the value of a dynamic field from the entries at the
+     * given keys with a single call. "out" points to an array of n values
+     * having the type of the field, or of const char* for strings. The
+     * values at the keys not present in the table are left untouched.
+     *
+     * @return size_t The number of entries found in the table.
+     */
+    virtual size_t read_entries_dynamic_field(const dynamic_struct::field_info& field,
+        const KeyType* keys, size_t n, void* out)
+    {
+        auto stride = dynamic_value_size(field);
+        size_t found = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            auto e = get_entry(keys[i]);
+            if (e)
+            {
+                e->_check_defsptr(field, false);
+                e->get_dynamic_field(field, static_cast<uint8_t*>(out) + i * stride);
+                found++;
+            }
+        }
+        return found;
+    }
+
+    /**
+     * @brief Writes the value of a dynamic field to the entries at the
+     * given keys with a single call. "in" points to an array of n values
+     * having the type of the field, or of const char* for strings. The keys
+     * not present in the table are skipped.
+     *
+     * @return size_t The number of entries found in the table.
+     */
+    virtual size_t write_entries_dynamic_field(const dynamic_struct::field_info& field,
+        const KeyType* keys, size_t n, const void* in)
+    {
+        auto stride = dynamic_value_size(field);
+        size_t found = 0;
+        for (size_t i = 0; i < n; i++)
+        {
+            auto e = get_entry(keys[i]);
+            if (e)
+            {
+                e->_check_defsptr(field, true);
+                e->set_dynamic_field(field, static_cast<const uint8_t*>(in) + i * stride);
+                found++;
+            }
+        }
+        return found;
+    }
+
+protected:
+    static inline size_t dynamic_value_size(const dynamic_struct::field_info& field)
+    {
+        return field.info().index() == PT_CHARBUF ? sizeof(const char*) : field.info().size();
+    }
 };
 
 }; // state
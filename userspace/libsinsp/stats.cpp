@@ -23,6 +23,7 @@ limitations under the License.
 #include <sys/times.h>
 #include <sys/stat.h>
 #include <libsinsp/stats.h>
+#include <libsinsp/sinsp_string_pool.h>
 #include <libscap/strl.h>
 
 static const char *const sinsp_stats_v2_resource_utilization_names[] = {
@@ -54,6 +55,23 @@ static const char *const sinsp_stats_v2_resource_utilization_names[] = {
 	[SINSP_STATS_V2_N_DROPS_FULL_THREADTABLE] = "n_drops_full_threadtable",
 	[SINSP_STATS_V2_N_MISSING_CONTAINER_IMAGES] = "n_missing_container_images",
 	[SINSP_STATS_V2_N_CONTAINERS] = "n_containers",
+	[SINSP_STATS_V2_N_ADAPTIVE_SAMPLING_ADJUSTMENTS] = "n_adaptive_sampling_adjustments",
+	[SINSP_STATS_V2_ADAPTIVE_SAMPLING_RATIO_IO_READ] = "adaptive_sampling_ratio_io_read",
+	[SINSP_STATS_V2_ADAPTIVE_SAMPLING_RATIO_IO_WRITE] = "adaptive_sampling_ratio_io_write",
+	[SINSP_STATS_V2_N_DROPS_ASYNC_EVTS] = "n_drops_async_evts",
+	[SINSP_STATS_V2_N_PREPARSED_EVTS] = "n_preparsed_evts",
+	[SINSP_STATS_V2_N_PREPARSE_INLINE_EVTS] = "n_preparse_inline_evts",
+	[SINSP_STATS_V2_N_INHERITED_FDS] = "n_inherited_fds",
+	[SINSP_STATS_V2_N_FDTABLE_PAGE_COPIES] = "n_fdtable_page_copies",
+	[SINSP_STATS_V2_FDTABLE_MEMORY] = "fdtable_memory_bytes",
+	[SINSP_STATS_V2_N_INTERNED_STRINGS] = "n_interned_strings",
+	[SINSP_STATS_V2_INTERNED_STRINGS_MEMORY] = "interned_strings_memory_bytes",
+	[SINSP_STATS_V2_INTERNED_STRINGS_SAVED_MEMORY] = "interned_strings_saved_memory_bytes",
+	[SINSP_STATS_V2_N_ASYNC_PROC_LOOKUPS] = "n_async_proc_lookups",
+	[SINSP_STATS_V2_N_DROPS_ASYNC_PROC_LOOKUPS] = "n_drops_async_proc_lookups",
+	[SINSP_STATS_V2_N_MERGED_ASYNC_PROC_LOOKUPS] = "n_merged_async_proc_lookups",
+	[SINSP_STATS_V2_ASYNC_PROC_LOOKUPS_QUEUE_DEPTH] = "async_proc_lookups_queue_depth",
+	[SINSP_STATS_V2_ASYNC_PROC_LOOKUPS_MERGE_LATENCY] = "async_proc_lookups_merge_latency_ns",
 };
 
 void get_rss_vsz_pss_total_memory_and_open_fds(uint32_t &rss, uint32_t &vsz, uint32_t &pss, uint64_t &memory_used_host, uint64_t &open_fds_host)
@@ -379,6 +397,23 @@ const scap_stats_v2* libsinsp::stats::get_sinsp_stats_v2(uint32_t flags, const s
 			buffer[SINSP_STATS_V2_N_DROPS_FULL_THREADTABLE].type = STATS_VALUE_TYPE_U32;
 			buffer[SINSP_STATS_V2_N_MISSING_CONTAINER_IMAGES].type = STATS_VALUE_TYPE_U32;
 			buffer[SINSP_STATS_V2_N_CONTAINERS].type = STATS_VALUE_TYPE_U32;
+			buffer[SINSP_STATS_V2_N_ADAPTIVE_SAMPLING_ADJUSTMENTS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_ADAPTIVE_SAMPLING_RATIO_IO_READ].type = STATS_VALUE_TYPE_U32;
+			buffer[SINSP_STATS_V2_ADAPTIVE_SAMPLING_RATIO_IO_WRITE].type = STATS_VALUE_TYPE_U32;
+			buffer[SINSP_STATS_V2_N_DROPS_ASYNC_EVTS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_N_PREPARSED_EVTS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_N_PREPARSE_INLINE_EVTS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_N_INHERITED_FDS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_N_FDTABLE_PAGE_COPIES].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_FDTABLE_MEMORY].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_N_INTERNED_STRINGS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_INTERNED_STRINGS_MEMORY].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_INTERNED_STRINGS_SAVED_MEMORY].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_N_ASYNC_PROC_LOOKUPS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_N_DROPS_ASYNC_PROC_LOOKUPS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_N_MERGED_ASYNC_PROC_LOOKUPS].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_ASYNC_PROC_LOOKUPS_QUEUE_DEPTH].type = STATS_VALUE_TYPE_U64;
+			buffer[SINSP_STATS_V2_ASYNC_PROC_LOOKUPS_MERGE_LATENCY].type = STATS_VALUE_TYPE_U64;
 
 		}
 
@@ -386,12 +421,18 @@ const scap_stats_v2* libsinsp::stats::get_sinsp_stats_v2(uint32_t flags, const s
 
 		buffer[SINSP_STATS_V2_N_THREADS].value.u64 = thread_manager->get_thread_count();
 		buffer[SINSP_STATS_V2_N_FDS].value.u64 = 0;
+		buffer[SINSP_STATS_V2_FDTABLE_MEMORY].value.u64 = 0;
 		threadinfo_map_t* threadtable = thread_manager->get_threads();
 		threadtable->loop([&] (sinsp_threadinfo& tinfo) {
 			sinsp_fdtable* fdtable = tinfo.get_fd_table();
 			if (fdtable != nullptr)
 			{
 				buffer[SINSP_STATS_V2_N_FDS].value.u64 += fdtable->size();
+				// only main threads have their own fdtable
+				if (tinfo.is_main_thread())
+				{
+					buffer[SINSP_STATS_V2_FDTABLE_MEMORY].value.u64 += fdtable->get_memory_usage();
+				}
 			}
 			return true;
 		});
@@ -412,6 +453,23 @@ const scap_stats_v2* libsinsp::stats::get_sinsp_stats_v2(uint32_t flags, const s
 		buffer[SINSP_STATS_V2_N_DROPS_FULL_THREADTABLE].value.u32 = stats_v2->m_n_drops_full_threadtable;
 		buffer[SINSP_STATS_V2_N_MISSING_CONTAINER_IMAGES].value.u32 = stats_v2->m_n_missing_container_images;
 		buffer[SINSP_STATS_V2_N_CONTAINERS].value.u32 = stats_v2->m_n_containers;
+		buffer[SINSP_STATS_V2_N_ADAPTIVE_SAMPLING_ADJUSTMENTS].value.u64 = stats_v2->m_n_adaptive_sampling_adjustments;
+		buffer[SINSP_STATS_V2_ADAPTIVE_SAMPLING_RATIO_IO_READ].value.u32 = stats_v2->m_adaptive_sampling_ratio_io_read;
+		buffer[SINSP_STATS_V2_ADAPTIVE_SAMPLING_RATIO_IO_WRITE].value.u32 = stats_v2->m_adaptive_sampling_ratio_io_write;
+		buffer[SINSP_STATS_V2_N_DROPS_ASYNC_EVTS].value.u64 = stats_v2->m_n_drops_async_evts;
+		buffer[SINSP_STATS_V2_N_PREPARSED_EVTS].value.u64 = stats_v2->m_n_preparsed_evts;
+		buffer[SINSP_STATS_V2_N_PREPARSE_INLINE_EVTS].value.u64 = stats_v2->m_n_preparse_inline_evts;
+		buffer[SINSP_STATS_V2_N_INHERITED_FDS].value.u64 = stats_v2->m_n_inherited_fds;
+		buffer[SINSP_STATS_V2_N_FDTABLE_PAGE_COPIES].value.u64 = stats_v2->m_n_fdtable_page_copies;
+		const auto& string_pool = libsinsp::sinsp_string_pool::instance();
+		buffer[SINSP_STATS_V2_N_INTERNED_STRINGS].value.u64 = string_pool.get_num_strings();
+		buffer[SINSP_STATS_V2_INTERNED_STRINGS_MEMORY].value.u64 = string_pool.get_memory();
+		buffer[SINSP_STATS_V2_INTERNED_STRINGS_SAVED_MEMORY].value.u64 = string_pool.get_saved_memory();
+		buffer[SINSP_STATS_V2_N_ASYNC_PROC_LOOKUPS].value.u64 = stats_v2->m_n_async_proc_lookups;
+		buffer[SINSP_STATS_V2_N_DROPS_ASYNC_PROC_LOOKUPS].value.u64 = stats_v2->m_n_drops_async_proc_lookups;
+		buffer[SINSP_STATS_V2_N_MERGED_ASYNC_PROC_LOOKUPS].value.u64 = stats_v2->m_n_merged_async_proc_lookups;
+		buffer[SINSP_STATS_V2_ASYNC_PROC_LOOKUPS_QUEUE_DEPTH].value.u64 = thread_manager->get_n_pending_proc_lookups();
+		buffer[SINSP_STATS_V2_ASYNC_PROC_LOOKUPS_MERGE_LATENCY].value.u64 = stats_v2->m_async_proc_lookups_merge_latency_ns;
 
 		*nstats = SINSP_MAX_STATS_V2;
 	}
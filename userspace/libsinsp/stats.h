@@ -40,6 +40,18 @@ struct sinsp_stats_v2
 	uint32_t m_n_drops_full_threadtable;
 	uint32_t m_n_missing_container_images;
 	uint32_t m_n_containers;
+	uint64_t m_n_adaptive_sampling_adjustments;
+	uint32_t m_adaptive_sampling_ratio_io_read;
+	uint32_t m_adaptive_sampling_ratio_io_write;
+	uint64_t m_n_drops_async_evts;
+	uint64_t m_n_preparsed_evts;
+	uint64_t m_n_preparse_inline_evts;
+	uint64_t m_n_inherited_fds;
+	uint64_t m_n_fdtable_page_copies;
+	uint64_t m_n_async_proc_lookups;
+	uint64_t m_n_drops_async_proc_lookups;
+	uint64_t m_n_merged_async_proc_lookups;
+	uint64_t m_async_proc_lookups_merge_latency_ns;
 };
 
 enum sinsp_stats_v2_resource_utilization
@@ -72,6 +84,23 @@ enum sinsp_stats_v2_resource_utilization
 	SINSP_STATS_V2_N_DROPS_FULL_THREADTABLE, ///< Number of drops due to full threadtable, unit: count.
 	SINSP_STATS_V2_N_MISSING_CONTAINER_IMAGES, ///<  Number of cached containers (cgroups) without container info such as image, hijacked sinsp_container_manager::remove_inactive_containers() -> every flush snapshot update, unit: count.
 	SINSP_STATS_V2_N_CONTAINERS, ///<  Number of containers (cgroups) currently cached by sinsp_container_manager, hijacked sinsp_container_manager::remove_inactive_containers() -> every flush snapshot update, unit: count.
+	SINSP_STATS_V2_N_ADAPTIVE_SAMPLING_ADJUSTMENTS, ///< Number of sampling ratio changes pushed to the driver by the adaptive sampler, unit: count.
+	SINSP_STATS_V2_ADAPTIVE_SAMPLING_RATIO_IO_READ, ///< Current adaptive sampling ratio applied to the I/O read syscalls, 1 means no sampling, unit: ratio.
+	SINSP_STATS_V2_ADAPTIVE_SAMPLING_RATIO_IO_WRITE, ///< Current adaptive sampling ratio applied to the I/O write syscalls, 1 means no sampling, unit: ratio.
+	SINSP_STATS_V2_N_DROPS_ASYNC_EVTS, ///< Number of async events dropped because the queue of the producer was full, unit: count.
+	SINSP_STATS_V2_N_PREPARSED_EVTS, ///< Number of events whose parameters were decoded by the pre-parse workers, unit: count.
+	SINSP_STATS_V2_N_PREPARSE_INLINE_EVTS, ///< Number of events reached by the capture thread before any pre-parse worker, unit: count.
+	SINSP_STATS_V2_N_INHERITED_FDS, ///< Number of fds inherited by child processes without copying them, unit: count.
+	SINSP_STATS_V2_N_FDTABLE_PAGE_COPIES, ///< Number of pages of fds shared after a fork and copied on the first write, unit: count.
+	SINSP_STATS_V2_FDTABLE_MEMORY, ///< Approximate memory used by the fd tables of all processes, pages shared after a fork are counted once, unit: bytes.
+	SINSP_STATS_V2_N_INTERNED_STRINGS, ///< Number of distinct strings in the string interning pool (e.g. fd names), unit: count.
+	SINSP_STATS_V2_INTERNED_STRINGS_MEMORY, ///< Bytes of the distinct strings stored in the string interning pool, unit: bytes.
+	SINSP_STATS_V2_INTERNED_STRINGS_SAVED_MEMORY, ///< Bytes saved by the string interning pool compared to storing a copy of the string for each use, unit: bytes.
+	SINSP_STATS_V2_N_ASYNC_PROC_LOOKUPS, ///< Number of /proc lookups of unknown threads handed to the background thread, unit: count.
+	SINSP_STATS_V2_N_DROPS_ASYNC_PROC_LOOKUPS, ///< Number of /proc lookups not done because too many were already pending, unit: count.
+	SINSP_STATS_V2_N_MERGED_ASYNC_PROC_LOOKUPS, ///< Number of /proc lookups whose result reached the thread table, unit: count.
+	SINSP_STATS_V2_ASYNC_PROC_LOOKUPS_QUEUE_DEPTH, ///< Number of /proc lookups queued or waiting to be merged, unit: count.
+	SINSP_STATS_V2_ASYNC_PROC_LOOKUPS_MERGE_LATENCY, ///< Total time from queuing a /proc lookup to merging its result, divide by the merged lookups for the average, unit: ns.
 	SINSP_MAX_STATS_V2
 };
 
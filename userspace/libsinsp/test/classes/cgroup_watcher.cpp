@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#ifdef __linux__
+
+#include <gtest/gtest.h>
+#include <libsinsp/cgroup_watcher.h>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+static void check_removals(bool use_inotify)
+{
+	char tmpl[] = "/tmp/cgroup_watcher.XXXXXX";
+	ASSERT_NE(mkdtemp(tmpl), nullptr);
+	std::string root = tmpl;
+	std::string a = root + "/a";
+	std::string b = root + "/b";
+	ASSERT_EQ(mkdir(a.c_str(), 0700), 0);
+	ASSERT_EQ(mkdir(b.c_str(), 0700), 0);
+
+	libsinsp::cgroup_watcher w(1000, use_inotify);
+	ASSERT_EQ(w.using_inotify(), use_inotify);
+
+	ASSERT_FALSE(w.watch(root + "/missing"));
+	ASSERT_TRUE(w.watch(a));
+	ASSERT_TRUE(w.watch(b));
+	ASSERT_TRUE(w.watch(a));
+	ASSERT_EQ(w.get_num_watched(), 2);
+
+	std::vector<std::string> removed;
+	ASSERT_TRUE(w.poll(0, removed));
+	ASSERT_TRUE(removed.empty());
+
+	// removals are only looked for once per poll interval
+	ASSERT_EQ(rmdir(a.c_str()), 0);
+	ASSERT_FALSE(w.poll(500, removed));
+	ASSERT_TRUE(w.poll(1000, removed));
+	ASSERT_EQ(removed, std::vector<std::string>{a});
+	ASSERT_EQ(w.get_num_watched(), 1);
+
+	// unwatched directories are not reported
+	removed.clear();
+	w.unwatch(b);
+	ASSERT_EQ(w.get_num_watched(), 0);
+	ASSERT_EQ(rmdir(b.c_str()), 0);
+	ASSERT_TRUE(w.poll(2000, removed));
+	ASSERT_TRUE(removed.empty());
+
+	rmdir(root.c_str());
+}
+
+TEST(cgroup_watcher, inotify)
+{
+	check_removals(true);
+}
+
+TEST(cgroup_watcher, polling)
+{
+	check_removals(false);
+}
+
+#endif
@@ -0,0 +1,215 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libsinsp/ip_prefix_search.h>
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cinttypes>
+#include <random>
+#include <string>
+#include <vector>
+
+static uint32_t ipv4(const char* str)
+{
+	uint32_t addr;
+	EXPECT_EQ(inet_pton(AF_INET, str, &addr), 1) << str;
+	return addr;
+}
+
+static ipv4net ipv4_net(const char* str, uint32_t prefix_len)
+{
+	return ipv4net{ipv4(str), prefix_len == 0 ? 0 : htonl(0xffffffff << (32 - prefix_len))};
+}
+
+TEST(ip_prefix_search, ipv4)
+{
+	ip_prefix_search s;
+	ASSERT_TRUE(s.empty());
+	ASSERT_FALSE(s.match(ipv4("10.0.0.1")));
+
+	s.add_network(ipv4_net("10.0.0.0", 8));
+	s.add_network(ipv4_net("192.168.1.77", 24));
+	s.add_network(ipv4_net("172.16.0.1", 32));
+
+	ASSERT_TRUE(s.match(ipv4("10.0.0.0")));
+	ASSERT_TRUE(s.match(ipv4("10.255.255.255")));
+	ASSERT_FALSE(s.match(ipv4("11.0.0.0")));
+	ASSERT_FALSE(s.match(ipv4("9.255.255.255")));
+	ASSERT_TRUE(s.match(ipv4("192.168.1.0")));
+	ASSERT_TRUE(s.match(ipv4("192.168.1.255")));
+	ASSERT_FALSE(s.match(ipv4("192.168.2.0")));
+	ASSERT_TRUE(s.match(ipv4("172.16.0.1")));
+	ASSERT_FALSE(s.match(ipv4("172.16.0.2")));
+	ASSERT_FALSE(s.match(ipv4("0.0.0.0")));
+	ASSERT_FALSE(s.match(ipv4("255.255.255.255")));
+
+	// no IPv6 network was added
+	ASSERT_FALSE(s.match(ipv6addr("::ffff:10.0.0.1")));
+
+	s.add_network(ipv4_net("0.0.0.0", 0));
+	ASSERT_TRUE(s.match(ipv4("255.255.255.255")));
+	ASSERT_EQ(s.size(), 1);
+
+	s.clear();
+	ASSERT_TRUE(s.empty());
+	ASSERT_FALSE(s.match(ipv4("10.0.0.1")));
+}
+
+TEST(ip_prefix_search, ipv4_merge)
+{
+	ip_prefix_search s;
+
+	// adjacent and overlapping networks become a single range
+	s.add_network(ipv4_net("10.128.0.0", 9));
+	s.add_network(ipv4_net("10.0.0.0", 9));
+	s.add_network(ipv4_net("10.1.0.0", 16));
+	s.add_network(ipv4_net("11.0.0.0", 8));
+	s.add_network(ipv4_net("13.0.0.0", 8));
+	s.add_network(ipv4_net("255.255.255.255", 32));
+	s.add_network(ipv4_net("255.255.255.0", 24));
+	ASSERT_EQ(s.size(), 3);
+
+	ASSERT_TRUE(s.match(ipv4("10.127.255.255")));
+	ASSERT_TRUE(s.match(ipv4("11.255.255.255")));
+	ASSERT_FALSE(s.match(ipv4("12.0.0.0")));
+	ASSERT_TRUE(s.match(ipv4("13.0.0.0")));
+	ASSERT_TRUE(s.match(ipv4("255.255.255.255")));
+
+	// networks added after a search are taken into account
+	s.add_network(ipv4_net("12.0.0.0", 8));
+	ASSERT_TRUE(s.match(ipv4("12.0.0.0")));
+	ASSERT_EQ(s.size(), 2);
+}
+
+TEST(ip_prefix_search, ipv6)
+{
+	ip_prefix_search s;
+	s.add_network(ipv6net("2001:db8::/32"));
+	s.add_network(ipv6net("fe80::/10"));
+	s.add_network(ipv6net("::1/128"));
+	s.add_network(ipv6net("2001:db9:0:1::/127"));
+
+	ASSERT_TRUE(s.match(ipv6addr("2001:db8::")));
+	ASSERT_TRUE(s.match(ipv6addr("2001:db8:ffff:ffff:ffff:ffff:ffff:ffff")));
+	ASSERT_FALSE(s.match(ipv6addr("2001:db7:ffff:ffff:ffff:ffff:ffff:ffff")));
+	ASSERT_TRUE(s.match(ipv6addr("febf::1")));
+	ASSERT_FALSE(s.match(ipv6addr("fec0::")));
+	ASSERT_TRUE(s.match(ipv6addr("::1")));
+	ASSERT_FALSE(s.match(ipv6addr("::2")));
+	ASSERT_FALSE(s.match(ipv6addr("::")));
+	ASSERT_TRUE(s.match(ipv6addr("2001:db9:0:1::1")));
+	ASSERT_FALSE(s.match(ipv6addr("2001:db9:0:1::2")));
+
+	// no IPv4 network was added
+	ASSERT_FALSE(s.match(ipv4("0.0.0.1")));
+
+	// ranges that cross the middle of the address
+	s.add_network(ipv6addr("2001:dba::"), 64);
+	s.add_network(ipv6addr("2001:dba:0:1::"), 64);
+	ASSERT_EQ(s.size(), 5);
+	ASSERT_TRUE(s.match(ipv6addr("2001:dba:0:1:ffff:ffff:ffff:ffff")));
+	ASSERT_FALSE(s.match(ipv6addr("2001:dba:0:2::")));
+}
+
+TEST(ip_prefix_search, filter_values)
+{
+	ipv4net v4 = ipv4_net("10.0.0.0", 8);
+	ipv6net v6("2001:db8::/32");
+	uint32_t addr = ipv4("10.0.0.1");
+
+	ip_prefix_search s;
+	ASSERT_TRUE(s.add_network(filter_value_t((uint8_t*)&v4, sizeof(v4))));
+	ASSERT_TRUE(s.add_network(filter_value_t((uint8_t*)&v6, sizeof(v6))));
+	ASSERT_FALSE(s.add_network(filter_value_t((uint8_t*)&addr, sizeof(addr))));
+	ASSERT_EQ(s.size(), 2);
+	ASSERT_TRUE(s.match(addr));
+	ASSERT_TRUE(s.match(ipv6addr("2001:db8::1")));
+}
+
+TEST(ip_prefix_search, large_lists)
+{
+	// 4096 disjoint /24 networks, every other one
+	ip_prefix_search s;
+	for(uint32_t i = 0; i < 4096; i++)
+	{
+		std::string net = "10." + std::to_string(i * 2 / 256) + "." + std::to_string(i * 2 % 256) + ".0";
+		s.add_network(ipv4_net(net.c_str(), 24));
+	}
+	ASSERT_EQ(s.size(), 4096);
+
+	for(uint32_t i = 0; i < 8192; i++)
+	{
+		std::string addr = "10." + std::to_string(i / 256) + "." + std::to_string(i % 256) + ".1";
+		ASSERT_EQ(s.match(ipv4(addr.c_str())), i % 2 == 0) << addr;
+	}
+}
+
+// compare the range search with the linear scan over the networks that
+// the `in` filters on network fields used to do
+/* Benchmark, run it with `--gtest_also_run_disabled_tests` */
+TEST(ip_prefix_search, DISABLED_lookup_benchmark)
+{
+	const size_t num_nets = 500;
+	const size_t num_lookups = 1000000;
+	std::mt19937 rng(42);
+
+	std::vector<ipv4net> nets;
+	ip_prefix_search s;
+	for(size_t i = 0; i < num_nets; i++)
+	{
+		uint32_t prefix_len = 8 + rng() % 25;
+		uint32_t netmask = htonl(0xffffffff << (32 - prefix_len));
+		nets.push_back(ipv4net{(uint32_t)rng() & netmask, netmask});
+		s.add_network(nets.back());
+	}
+
+	std::vector<uint32_t> addrs;
+	for(size_t i = 0; i < num_lookups; i++)
+	{
+		addrs.push_back(rng());
+	}
+
+	auto start = std::chrono::steady_clock::now();
+	size_t linear_matches = 0;
+	for(auto addr : addrs)
+	{
+		for(const auto& net : nets)
+		{
+			if((addr & net.m_netmask) == net.m_ip)
+			{
+				linear_matches++;
+				break;
+			}
+		}
+	}
+	auto linear = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	size_t range_matches = 0;
+	for(auto addr : addrs)
+	{
+		range_matches += s.match(addr);
+	}
+	auto ranges = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+
+	ASSERT_EQ(linear_matches, range_matches);
+	printf("[ INFO     ] lookups in %zu IPv4 networks: linear scan %" PRId64 " ns, ranges %" PRId64 " ns\n",
+	       num_nets, (int64_t)(linear / num_lookups), (int64_t)(ranges / num_lookups));
+}
@@ -0,0 +1,218 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libsinsp/persistent_cache.h>
+
+#include <cstdio>
+#include <map>
+#include <string>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+
+std::string cache_path()
+{
+	return "/tmp/persistent_cache_ut." + std::to_string(getpid());
+}
+
+std::map<std::string, std::string> entries(libsinsp::persistent_cache& cache, const std::string& prefix = "")
+{
+	std::map<std::string, std::string> res;
+	cache.foreach_entry(prefix, [&](const std::string& key, const std::string& value)
+	{
+		res[key] = value;
+		return true;
+	});
+	return res;
+}
+
+off_t file_size(const std::string& path)
+{
+	struct stat st;
+	return stat(path.c_str(), &st) == 0 ? st.st_size : -1;
+}
+
+}
+
+TEST(persistent_cache, reload)
+{
+	std::string path = cache_path();
+	unlink(path.c_str());
+
+	{
+		libsinsp::persistent_cache cache(path);
+		ASSERT_TRUE(cache.load());
+		ASSERT_EQ(cache.get_num_entries(), 0);
+
+		cache.put("container:a", "aaa");
+		cache.put("container:b", std::string("b\0b", 3));
+		cache.put("users:a", "");
+		cache.put("container:c", "ccc");
+		cache.put("container:a", "AAA");
+		cache.erase("container:c");
+		cache.erase("container:missing");
+	}
+
+	libsinsp::persistent_cache cache(path);
+	ASSERT_TRUE(cache.load());
+	std::map<std::string, std::string> expected = {
+		{"container:a", "AAA"},
+		{"container:b", std::string("b\0b", 3)},
+		{"users:a", ""},
+	};
+	ASSERT_EQ(entries(cache), expected);
+	ASSERT_EQ(entries(cache, "users:").size(), 1);
+
+	std::string value;
+	ASSERT_TRUE(cache.get("container:a", value));
+	ASSERT_EQ(value, "AAA");
+	ASSERT_FALSE(cache.get("container:c", value));
+
+	unlink(path.c_str());
+}
+
+TEST(persistent_cache, damaged_file)
+{
+	std::string path = cache_path();
+	unlink(path.c_str());
+
+	{
+		libsinsp::persistent_cache cache(path);
+		ASSERT_TRUE(cache.load());
+		cache.put("a", "1");
+		cache.put("b", "2");
+	}
+
+	// a record torn in the middle, e.g. by a crash
+	ASSERT_EQ(truncate(path.c_str(), file_size(path) - 1), 0);
+	{
+		libsinsp::persistent_cache cache(path);
+		ASSERT_TRUE(cache.load());
+		std::map<std::string, std::string> expected = {{"a", "1"}};
+		ASSERT_EQ(entries(cache), expected);
+
+		// the file was cleaned up, later updates are kept
+		cache.put("c", "3");
+	}
+	{
+		libsinsp::persistent_cache cache(path);
+		ASSERT_TRUE(cache.load());
+		std::map<std::string, std::string> expected = {{"a", "1"}, {"c", "3"}};
+		ASSERT_EQ(entries(cache), expected);
+	}
+
+	// a record damaged in the middle, e.g. by a write that only partly
+	// succeeded before the next ones
+	unlink(path.c_str());
+	{
+		libsinsp::persistent_cache cache(path);
+		ASSERT_TRUE(cache.load());
+		cache.put("a", "1");
+		cache.put("b", "2");
+		cache.put("c", "3");
+	}
+	{
+		FILE* f = fopen(path.c_str(), "r+b");
+		ASSERT_NE(f, nullptr);
+		// somewhere in the value of "b"
+		ASSERT_EQ(fseek(f, file_size(path) / 2, SEEK_SET), 0);
+		fputc('X', f);
+		fclose(f);
+	}
+	{
+		libsinsp::persistent_cache cache(path);
+		ASSERT_TRUE(cache.load());
+		std::map<std::string, std::string> expected = {{"a", "1"}, {"c", "3"}};
+		ASSERT_EQ(entries(cache), expected);
+	}
+
+	// not a cache file at all
+	FILE* f = fopen(path.c_str(), "w");
+	ASSERT_NE(f, nullptr);
+	fputs("garbage", f);
+	fclose(f);
+	{
+		libsinsp::persistent_cache cache(path);
+		ASSERT_TRUE(cache.load());
+		ASSERT_EQ(cache.get_num_entries(), 0);
+		cache.put("a", "1");
+	}
+	{
+		libsinsp::persistent_cache cache(path);
+		ASSERT_TRUE(cache.load());
+		ASSERT_EQ(cache.get_num_entries(), 1);
+	}
+
+	unlink(path.c_str());
+}
+
+TEST(persistent_cache, compaction)
+{
+	std::string path = cache_path();
+	unlink(path.c_str());
+
+	libsinsp::persistent_cache cache(path);
+	ASSERT_TRUE(cache.load());
+
+	std::string value(1024, 'x');
+	for(int i = 0; i < 256; i++)
+	{
+		cache.put("container:" + std::to_string(i % 4), value + std::to_string(i));
+	}
+	cache.flush();
+	ASSERT_EQ(cache.get_n_compactions(), 1);
+	ASSERT_LT(file_size(path), 8 * 1024);
+
+	libsinsp::persistent_cache reloaded(path);
+	ASSERT_TRUE(reloaded.load());
+	ASSERT_EQ(reloaded.get_num_entries(), 4);
+	std::string v;
+	ASSERT_TRUE(reloaded.get("container:3", v));
+	ASSERT_EQ(v, value + "255");
+
+	// nothing to gain, the file is left alone
+	cache.flush();
+	ASSERT_EQ(cache.get_n_compactions(), 1);
+
+	unlink(path.c_str());
+	unlink((path + ".tmp").c_str());
+}
+
+TEST(persistent_cache, owner_only)
+{
+	std::string path = cache_path();
+	unlink(path.c_str());
+
+	// even if it was created readable by others
+	FILE* f = fopen(path.c_str(), "w");
+	ASSERT_NE(f, nullptr);
+	fclose(f);
+	ASSERT_EQ(chmod(path.c_str(), 0644), 0);
+
+	libsinsp::persistent_cache cache(path);
+	ASSERT_TRUE(cache.load());
+	struct stat st;
+	ASSERT_EQ(stat(path.c_str(), &st), 0);
+	ASSERT_EQ(st.st_mode & 0777, 0600);
+
+	unlink(path.c_str());
+}
@@ -0,0 +1,82 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libsinsp/sinsp_cgroup_set.h>
+#include <libsinsp/sinsp.h>
+
+#include <string>
+
+using libsinsp::sinsp_cgroup_set_pool;
+
+static const char s_cgroups_a[] = "cpuset=/docker/aaaa\0perf=/docker/aaaa\0memory=/docker/aaaa";
+static const char s_cgroups_b[] = "cpuset=/docker/bbbb\0perf=/docker/bbbb\0memory=/docker/bbbb";
+
+TEST(sinsp_cgroup_set, identical_sets_are_shared)
+{
+	auto& pool = sinsp_cgroup_set_pool::instance();
+	size_t n = pool.get_num_sets();
+
+	{
+		auto a1 = pool.intern(s_cgroups_a, sizeof(s_cgroups_a));
+		auto a2 = pool.intern(std::string(s_cgroups_a, sizeof(s_cgroups_a)).data(), sizeof(s_cgroups_a));
+		auto b = pool.intern(s_cgroups_b, sizeof(s_cgroups_b));
+		ASSERT_NE(a1, nullptr);
+		ASSERT_EQ(a1, a2);
+		ASSERT_NE(a1, b);
+		ASSERT_EQ(pool.get_num_sets(), n + 2);
+
+		ASSERT_EQ(a1->size(), 3);
+		ASSERT_EQ((*a1)[0], std::make_pair(std::string("cpuset"), std::string("/docker/aaaa")));
+		ASSERT_EQ((*a1)[1].first, "perf_event");
+		ASSERT_EQ((*b)[2].second, "/docker/bbbb");
+
+		auto empty = pool.intern("", 0);
+		ASSERT_NE(empty, nullptr);
+		ASSERT_TRUE(empty->empty());
+	}
+
+	// the sets go away with their last user
+	ASSERT_EQ(pool.get_num_sets(), n);
+
+	// malformed lists are rejected
+	const char bad[] = "cpuset";
+	ASSERT_EQ(pool.intern(bad, sizeof(bad)), nullptr);
+	ASSERT_EQ(pool.get_num_sets(), n);
+}
+
+TEST(sinsp_cgroup_set, threads_share_sets)
+{
+	sinsp_threadinfo t1, t2, t3;
+	ASSERT_EQ(t1.get_cgroup_set(), nullptr);
+	ASSERT_TRUE(t1.cgroups().empty());
+
+	t1.set_cgroups(s_cgroups_a, sizeof(s_cgroups_a));
+	t2.set_cgroups(s_cgroups_a, sizeof(s_cgroups_a));
+	t3.set_cgroups(s_cgroups_b, sizeof(s_cgroups_b));
+	ASSERT_EQ(t1.get_cgroup_set(), t2.get_cgroup_set());
+	ASSERT_NE(t1.get_cgroup_set(), t3.get_cgroup_set());
+	ASSERT_EQ(&t1.cgroups(), &t2.cgroups());
+	ASSERT_EQ(t1.get_cgroup("memory"), "/docker/aaaa");
+	ASSERT_EQ(t3.get_cgroup("perf_event"), "/docker/bbbb");
+	ASSERT_EQ(t3.get_cgroup("pids"), "/");
+
+	t2.set_cgroups(s_cgroups_b, sizeof(s_cgroups_b));
+	ASSERT_EQ(t2.get_cgroup_set(), t3.get_cgroup_set());
+	ASSERT_EQ(t1.get_cgroup("memory"), "/docker/aaaa");
+}
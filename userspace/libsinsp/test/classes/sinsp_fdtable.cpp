@@ -0,0 +1,124 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libsinsp/sinsp.h>
+
+#include <set>
+
+static sinsp_fdinfo* add_file(sinsp_fdtable& table, int64_t fd, const std::string& name)
+{
+	auto fdinfo = table.new_fdinfo();
+	fdinfo->m_type = SCAP_FD_FILE_V2;
+	fdinfo->set_name(name);
+	return table.add(fd, std::move(fdinfo));
+}
+
+TEST(sinsp_fdtable, inherit_copy_on_write)
+{
+	sinsp inspector;
+	sinsp_fdtable parent(&inspector);
+	for(int64_t fd = 0; fd < 100; fd++)
+	{
+		ASSERT_NE(add_file(parent, fd, "/parent/" + std::to_string(fd)), nullptr);
+	}
+	uint64_t parent_memory = parent.get_memory_usage();
+
+	sinsp_fdtable child(&inspector);
+	child.inherit_from(parent);
+	ASSERT_EQ(child.size(), 100);
+
+	/* The shared fds are only accounted once */
+	ASSERT_LE(parent.get_memory_usage() + child.get_memory_usage(), parent_memory);
+
+	/* The fds modified by the child are not modified for the parent */
+	sinsp_fdinfo* fdinfo = child.find(10);
+	ASSERT_NE(fdinfo, nullptr);
+	ASSERT_EQ(fdinfo->get_name(), "/parent/10");
+	ASSERT_TRUE(fdinfo->is_cloned());
+	fdinfo->set_name("/child/10");
+	ASSERT_EQ(parent.find(10)->get_name(), "/parent/10");
+	ASSERT_FALSE(parent.find(10)->is_cloned());
+	ASSERT_EQ(child.find(10)->get_name(), "/child/10");
+
+	/* And the other way around */
+	parent.find(50)->set_name("/parent/50/modified");
+	ASSERT_EQ(child.find(50)->get_name(), "/parent/50");
+
+	ASSERT_TRUE(parent.erase(20));
+	ASSERT_NE(child.find(20), nullptr);
+	ASSERT_NE(add_file(child, 200, "/child/200"), nullptr);
+	ASSERT_EQ(parent.find(200), nullptr);
+	ASSERT_EQ(parent.size(), 99);
+	ASSERT_EQ(child.size(), 101);
+
+	/* Looping on the shared fds does not copy them */
+	sinsp_fdtable grandchild(&inspector);
+	grandchild.inherit_from(child);
+	size_t count = 0;
+	grandchild.const_loop([&](int64_t fd, const sinsp_fdinfo& fdinfo) {
+		count++;
+		return true;
+	});
+	ASSERT_EQ(count, 101);
+
+	/* Nor does reading them */
+	const sinsp_fdinfo* shared = grandchild.const_find(10);
+	ASSERT_NE(shared, nullptr);
+	ASSERT_EQ(shared, child.const_find(10));
+	ASSERT_EQ(grandchild.const_find(300), nullptr);
+	ASSERT_EQ(grandchild.find(10)->get_name(), "/child/10");
+	ASSERT_NE(grandchild.const_find(10), child.const_find(10));
+
+	/* The tables must stay usable after the other ones are gone */
+	parent.clear();
+	child.clear();
+	ASSERT_EQ(grandchild.find(50)->get_name(), "/parent/50");
+	ASSERT_TRUE(grandchild.erase(50));
+	ASSERT_EQ(grandchild.size(), 100);
+}
+
+TEST(sinsp_fdtable, sparse_and_negative_fds)
+{
+	sinsp inspector;
+	sinsp_fdtable table(&inspector);
+	std::set<int64_t> fds = {-33, -32, -1, 0, 31, 32, 65536, CANCELED_FD_NUMBER};
+	for(auto fd : fds)
+	{
+		ASSERT_NE(add_file(table, fd, std::to_string(fd)), nullptr);
+	}
+	ASSERT_EQ(table.size(), fds.size());
+
+	std::set<int64_t> looped;
+	table.loop([&](int64_t fd, sinsp_fdinfo& fdinfo) {
+		EXPECT_EQ(fdinfo.get_name(), std::to_string(fd));
+		looped.insert(fd);
+		return true;
+	});
+	ASSERT_EQ(looped, fds);
+
+	for(auto fd : fds)
+	{
+		ASSERT_NE(table.find(fd), nullptr);
+		ASSERT_EQ(table.find(fd)->get_name(), std::to_string(fd));
+		ASSERT_TRUE(table.erase(fd));
+		ASSERT_EQ(table.find(fd), nullptr);
+	}
+	ASSERT_EQ(table.size(), 0);
+	ASSERT_EQ(table.get_memory_usage(), 0);
+}
@@ -0,0 +1,57 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libsinsp/sinsp.h>
+#include <libsinsp/sinsp_services_table.h>
+
+using libsinsp::sinsp_services_table;
+
+TEST(sinsp_services_table, lookup)
+{
+	sinsp_services_table t;
+	t.add("http", 80, "tcp");
+	t.add("http", 80, "udp");
+	t.add("www", 80, "tcp");
+	t.add("syslog", 514, "udp");
+	t.add("shell", 514, "tcp");
+	t.add("rtmp", 1, "ddp");
+
+	ASSERT_STREQ(t.lookup(80, SCAP_L4_TCP), "http");
+	ASSERT_STREQ(t.lookup(80, SCAP_L4_UDP), "http");
+	ASSERT_STREQ(t.lookup(514, SCAP_L4_UDP), "syslog");
+	ASSERT_STREQ(t.lookup(514, SCAP_L4_TCP), "shell");
+
+	// other protocols get the first service using the port, like
+	// getservbyport() with no protocol
+	ASSERT_STREQ(t.lookup(514, SCAP_L4_UNKNOWN), "syslog");
+	ASSERT_STREQ(t.lookup(1, SCAP_L4_RAW), "rtmp");
+	ASSERT_EQ(t.lookup(1, SCAP_L4_TCP), nullptr);
+	ASSERT_EQ(t.lookup(443, SCAP_L4_TCP), nullptr);
+
+	// the aliases of the same name are stored once
+	ASSERT_EQ(t.size(), 4);
+}
+
+TEST(sinsp_services_table, port_to_string)
+{
+	ASSERT_EQ(port_to_string(65000, SCAP_L4_TCP, false), "65000");
+
+	const char* name = sinsp_services_table::get().lookup(65000, SCAP_L4_TCP);
+	ASSERT_EQ(port_to_string(65000, SCAP_L4_TCP, true), name != nullptr ? name : "65000");
+}
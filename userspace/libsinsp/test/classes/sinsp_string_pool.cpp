@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libsinsp/sinsp_string_pool.h>
+
+#include <string>
+#include <thread>
+#include <vector>
+
+using libsinsp::interned_string;
+using libsinsp::sinsp_string_pool;
+
+TEST(sinsp_string_pool, equal_strings_are_shared)
+{
+	interned_string a("/etc/passwd");
+	interned_string b(std::string("/etc/") + "passwd");
+	interned_string c("/etc/shadow");
+
+	ASSERT_EQ(a, b);
+	ASSERT_EQ(a.c_str(), b.c_str());
+	ASSERT_NE(a, c);
+	ASSERT_EQ(a, "/etc/passwd");
+	ASSERT_EQ(std::string("/etc/shadow"), c);
+	ASSERT_EQ(a.size(), 11);
+
+	interned_string empty("");
+	ASSERT_TRUE(empty.empty());
+	ASSERT_EQ(empty, interned_string());
+	ASSERT_STREQ(empty.c_str(), "");
+}
+
+TEST(sinsp_string_pool, refcount)
+{
+	auto& pool = sinsp_string_pool::instance();
+	const std::string s = "sinsp_string_pool.refcount";
+	// the strings cached by this thread hold a reference too
+	interned_string::clear_local_cache();
+	uint64_t n = pool.get_num_strings();
+	uint64_t mem = pool.get_memory();
+
+	{
+		interned_string a(s);
+		ASSERT_EQ(pool.get_num_strings(), n + 1);
+		ASSERT_EQ(pool.get_memory(), mem + s.size());
+
+		interned_string b = a;
+		interned_string c(s);
+		ASSERT_EQ(pool.get_num_strings(), n + 1);
+		ASSERT_GE(pool.get_saved_memory(), 2 * s.size());
+
+		interned_string d = std::move(b);
+		ASSERT_TRUE(b.empty());
+		ASSERT_EQ(d, a);
+
+		a.clear();
+		c = "sinsp_string_pool.other";
+		ASSERT_EQ(pool.get_num_strings(), n + 2);
+		ASSERT_EQ(d, s);
+	}
+
+	// the strings are still cached by this thread
+	ASSERT_EQ(pool.get_num_strings(), n + 2);
+
+	// the last handles went away with the strings
+	interned_string::clear_local_cache();
+	ASSERT_EQ(pool.get_num_strings(), n);
+	ASSERT_EQ(pool.get_memory(), mem);
+}
+
+// note: emscripten does not support launching threads
+#ifndef __EMSCRIPTEN__
+
+TEST(sinsp_string_pool, concurrent_intern_release)
+{
+	auto& pool = sinsp_string_pool::instance();
+	uint64_t n = pool.get_num_strings();
+
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([]
+		{
+			for(int i = 0; i < 20000; i++)
+			{
+				// a small key space makes the threads drop and
+				// re-intern the same strings all the time
+				interned_string a("/proc/" + std::to_string(i % 64));
+				interned_string b = a;
+				interned_string c("/proc/" + std::to_string(i % 64));
+				ASSERT_EQ(b, c);
+			}
+		});
+	}
+	for(auto& t : threads)
+	{
+		t.join();
+	}
+
+	// the threads dropped their cached strings on exit
+	ASSERT_EQ(pool.get_num_strings(), n);
+}
+
+#endif // __EMSCRIPTEN__
@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <gtest/gtest.h>
+#include <libsinsp/container_engine/container_async_source.h>
+#include <libsinsp/container_engine/container_cache_interface.h>
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <set>
+#include <thread>
+
+using namespace libsinsp::container_engine;
+
+namespace
+{
+
+class null_cache : public container_cache_interface
+{
+public:
+	void notify_new_container(const sinsp_container_info& container_info, sinsp_threadinfo *tinfo) override {}
+	bool should_lookup(const std::string& container_id, sinsp_container_type ctype) override { return true; }
+	void set_lookup_status(const std::string& container_id, sinsp_container_type ctype, sinsp_container_lookup::state state) override {}
+	sinsp_container_info::ptr_t get_container(const std::string& id) const override { return nullptr; }
+	void add_container(const sinsp_container_info::ptr_t& container_info, sinsp_threadinfo *thread) override {}
+	void replace_container(const sinsp_container_info::ptr_t& container_info) override {}
+	bool container_exists(const std::string& container_id) const override { return false; }
+	bool async_allowed() const override { return true; }
+};
+
+// Takes a while to answer and records how many lookups overlap
+class slow_source : public container_async_source<std::string>
+{
+public:
+	slow_source(container_cache_interface* cache):
+		container_async_source(NO_WAIT_LOOKUP, 10000, cache)
+	{
+	}
+
+	~slow_source()
+	{
+		stop();
+	}
+
+	std::atomic<uint32_t> m_in_flight{0};
+	std::atomic<uint32_t> m_max_in_flight{0};
+
+private:
+	const char* name() const override { return "slow"; }
+	sinsp_container_type container_type(const std::string& key) const override { return CT_CRI; }
+	std::string container_id(const std::string& key) const override { return key; }
+
+	bool parse(const std::string& key, sinsp_container_info& value) override
+	{
+		uint32_t n = ++m_in_flight;
+		uint32_t max = m_max_in_flight;
+		while(n > max && !m_max_in_flight.compare_exchange_weak(max, n))
+		{
+		}
+		std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		value.m_name = "name-" + key;
+		m_in_flight--;
+		return true;
+	}
+};
+
+}
+
+TEST(container_async_source, bounded_concurrent_lookups)
+{
+	null_cache cache;
+	slow_source source(&cache);
+	source.set_max_in_flight(4);
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	std::set<std::string> done;
+	auto cb = [&](const std::string& key, const sinsp_container_info& res)
+	{
+		EXPECT_TRUE(res.is_successful());
+		EXPECT_EQ(res.m_name, "name-" + key);
+		std::lock_guard<std::mutex> lock(mtx);
+		done.insert(key);
+		cv.notify_all();
+	};
+
+	for(int i = 0; i < 12; i++)
+	{
+		sinsp_container_info res;
+		ASSERT_FALSE(source.lookup(std::to_string(i), res, cb));
+	}
+
+	std::unique_lock<std::mutex> lock(mtx);
+	ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&]() { return done.size() == 12; }));
+	ASSERT_LE(source.m_max_in_flight, 4);
+	ASSERT_GE(source.m_max_in_flight, 2);
+}
+
+TEST(container_async_source, stop_waits_for_workers)
+{
+	null_cache cache;
+	slow_source source(&cache);
+	source.set_max_in_flight(2);
+
+	std::mutex mtx;
+	std::condition_variable cv;
+	size_t done = 0;
+	auto cb = [&](const std::string& key, const sinsp_container_info& res)
+	{
+		std::lock_guard<std::mutex> lock(mtx);
+		done++;
+		cv.notify_all();
+	};
+
+	for(int i = 0; i < 8; i++)
+	{
+		sinsp_container_info res;
+		ASSERT_FALSE(source.lookup(std::to_string(i), res, cb));
+	}
+
+	{
+		std::unique_lock<std::mutex> lock(mtx);
+		ASSERT_TRUE(cv.wait_for(lock, std::chrono::seconds(10), [&]() { return done > 0; }));
+	}
+
+	// the lookups handed to the workers complete before stop() returns,
+	// the others are dropped
+	source.stop();
+	ASSERT_EQ(source.m_in_flight, 0);
+	std::lock_guard<std::mutex> lock(mtx);
+	ASSERT_LT(done, 8);
+}
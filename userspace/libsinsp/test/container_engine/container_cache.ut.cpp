@@ -59,3 +59,58 @@ TEST_F(sinsp_with_test_input, container_manager_cache_threadtable_lifecycle)
     const sinsp_container_info::ptr_t container_info_check_removed = m_inspector.m_container_manager.get_container(test_container_id);
     ASSERT_FALSE(container_info_check_removed); // now a nullptr since the container was removed
 }
+
+#if !defined(MINIMAL_BUILD) && !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+TEST_F(sinsp_with_test_input, container_manager_cgroup_resolution)
+{
+	m_inspector.set_container_engine_mask(1 << CT_BPM);
+	add_default_init_thread();
+	open_inspector();
+
+	auto& manager = m_inspector.m_container_manager;
+	manager.set_cgroup_watch(true, ONE_SECOND_IN_NS);
+
+	const char bpm_cgroups[] = "cpuset=/bpm-web.0\0memory=/bpm-web.0";
+	const char host_cgroups[] = "cpuset=/\0memory=/user.slice";
+	std::vector<std::unique_ptr<sinsp_threadinfo>> threads;
+	auto new_thread = [&](const char* cgroups, size_t len)
+	{
+		threads.emplace_back(m_inspector.build_threadinfo());
+		threads.back()->set_cgroups(cgroups, len);
+		return threads.back().get();
+	};
+
+	// the first thread goes through the engines
+	auto tinfo = new_thread(bpm_cgroups, sizeof(bpm_cgroups));
+	ASSERT_TRUE(manager.resolve_container(tinfo, true));
+	ASSERT_EQ(tinfo->m_container_id, "web.0");
+	ASSERT_EQ(manager.get_num_cgroup_resolutions(), 1);
+	ASSERT_EQ(manager.get_n_cgroup_resolution_hits(), 0);
+
+	// the other ones in the same cgroups don't
+	tinfo = new_thread(bpm_cgroups, sizeof(bpm_cgroups));
+	ASSERT_TRUE(manager.resolve_container(tinfo, true));
+	ASSERT_EQ(tinfo->m_container_id, "web.0");
+	ASSERT_EQ(manager.get_n_cgroup_resolution_hits(), 1);
+
+	// no container is cached as well
+	tinfo = new_thread(host_cgroups, sizeof(host_cgroups));
+	ASSERT_FALSE(manager.resolve_container(tinfo, true));
+	ASSERT_EQ(tinfo->m_container_id, "");
+	tinfo = new_thread(host_cgroups, sizeof(host_cgroups));
+	ASSERT_FALSE(manager.resolve_container(tinfo, true));
+	ASSERT_EQ(tinfo->m_container_id, "");
+	ASSERT_EQ(manager.get_num_cgroup_resolutions(), 2);
+	ASSERT_EQ(manager.get_n_cgroup_resolution_hits(), 2);
+
+	// entries go away with their cgroup sets
+	threads.erase(threads.begin() + 2, threads.end());
+	manager.process_cgroup_events(ONE_SECOND_IN_NS);
+	ASSERT_EQ(manager.get_num_cgroup_resolutions(), 1);
+
+	manager.set_cgroup_watch(false, 0);
+	ASSERT_EQ(manager.get_num_cgroup_resolutions(), 0);
+	ASSERT_TRUE(manager.resolve_container(threads[0].get(), true));
+	ASSERT_EQ(manager.get_n_cgroup_resolution_hits(), 2);
+}
+#endif
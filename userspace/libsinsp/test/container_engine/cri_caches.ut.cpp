@@ -0,0 +1,148 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#if !defined(MINIMAL_BUILD) and !defined(__EMSCRIPTEN__) // MINIMAL_BUILD and emscripten don't support containers at all
+#include <gtest/gtest.h>
+#include <libsinsp/cri.h>
+
+#include <atomic>
+#include <future>
+#include <thread>
+
+using libsinsp::cri::cri_list_cache;
+using libsinsp::cri::cri_ttl_cache;
+
+TEST(cri_list_cache, fetch_on_miss_then_rate_limited)
+{
+	cri_list_cache cache(std::chrono::hours(1));
+	uint32_t fetches = 0;
+	auto fetch = [&](cri_list_cache::map_type& entries)
+	{
+		fetches++;
+		entries["busybox:latest"] = "sha256:1234";
+		return true;
+	};
+
+	std::string value;
+	ASSERT_TRUE(cache.get("busybox:latest", value, fetch));
+	ASSERT_EQ(value, "sha256:1234");
+	ASSERT_EQ(fetches, 1);
+
+	// hits don't fetch
+	ASSERT_TRUE(cache.get("busybox:latest", value, fetch));
+	ASSERT_EQ(fetches, 1);
+
+	// misses within min_refresh don't fetch again either
+	ASSERT_FALSE(cache.get("nginx:latest", value, fetch));
+	ASSERT_EQ(fetches, 1);
+}
+
+TEST(cri_list_cache, failed_fetch_keeps_entries)
+{
+	cri_list_cache cache(std::chrono::seconds(0));
+	bool fail = false;
+	auto fetch = [&](cri_list_cache::map_type& entries)
+	{
+		if(fail)
+		{
+			return false;
+		}
+		entries["busybox:latest"] = "sha256:1234";
+		return true;
+	};
+
+	std::string value;
+	ASSERT_TRUE(cache.get("busybox:latest", value, fetch));
+
+	fail = true;
+	ASSERT_FALSE(cache.get("nginx:latest", value, fetch));
+	ASSERT_TRUE(cache.get("busybox:latest", value, fetch));
+	ASSERT_EQ(value, "sha256:1234");
+}
+
+TEST(cri_list_cache, concurrent_miss_waits_for_fetch)
+{
+	cri_list_cache cache(std::chrono::hours(1));
+	std::promise<void> fetch_started;
+	std::promise<void> release_fetch;
+	std::shared_future<void> released = release_fetch.get_future().share();
+	std::atomic<uint32_t> fetches{0};
+	auto fetch = [&](cri_list_cache::map_type& entries)
+	{
+		fetches++;
+		fetch_started.set_value();
+		released.wait();
+		entries["busybox:latest"] = "sha256:1234";
+		return true;
+	};
+
+	std::string first;
+	std::thread fetcher([&] { ASSERT_TRUE(cache.get("busybox:latest", first, fetch)); });
+	fetch_started.get_future().wait();
+
+	// the fetch is in flight: this lookup doesn't start another one and
+	// gets its result. It can't complete before the fetch is released.
+	std::string second;
+	auto waiter = std::async(std::launch::async, [&] { return cache.get("busybox:latest", second, fetch); });
+	ASSERT_EQ(waiter.wait_for(std::chrono::milliseconds(0)), std::future_status::timeout);
+
+	release_fetch.set_value();
+	fetcher.join();
+	ASSERT_TRUE(waiter.get());
+	ASSERT_EQ(first, "sha256:1234");
+	ASSERT_EQ(second, "sha256:1234");
+	ASSERT_EQ(fetches, 1);
+}
+
+TEST(cri_ttl_cache, expiry)
+{
+	cri_ttl_cache<std::string> cache(std::chrono::seconds(0), 16);
+	std::string value;
+	cache.put("pod", "10.0.0.1");
+	ASSERT_FALSE(cache.get("pod", value));
+
+	cri_ttl_cache<std::string> long_lived(std::chrono::hours(1), 16);
+	long_lived.put("pod", "10.0.0.1");
+	ASSERT_TRUE(long_lived.get("pod", value));
+	ASSERT_EQ(value, "10.0.0.1");
+	ASSERT_FALSE(long_lived.get("other", value));
+}
+
+TEST(cri_ttl_cache, max_entries)
+{
+	// all expired: dropped to make room
+	cri_ttl_cache<std::string> expired(std::chrono::seconds(0), 2);
+	expired.put("a", "1");
+	expired.put("b", "2");
+	expired.put("c", "3");
+	ASSERT_EQ(expired.size(), 1);
+
+	// none expired: all dropped
+	cri_ttl_cache<std::string> live(std::chrono::hours(1), 2);
+	std::string value;
+	live.put("a", "1");
+	live.put("b", "2");
+	ASSERT_EQ(live.size(), 2);
+	live.put("c", "3");
+	ASSERT_EQ(live.size(), 1);
+	ASSERT_FALSE(live.get("a", value));
+	ASSERT_TRUE(live.get("c", value));
+	ASSERT_EQ(value, "3");
+}
+
+#endif
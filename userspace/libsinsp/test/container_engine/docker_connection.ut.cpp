@@ -0,0 +1,250 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#if !defined(MINIMAL_BUILD) && !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+
+#include <gtest/gtest.h>
+#include <libsinsp/container_engine/docker/connection.h>
+
+#include <atomic>
+#include <chrono>
+#include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+using namespace libsinsp::container_engine;
+
+namespace
+{
+
+//
+// Minimal HTTP/1.1 server on a unix socket, answering every request with
+// a JSON object holding the requested path. Paths containing "missing"
+// get a 404, paths containing "slow" are answered after a short delay.
+//
+class stub_docker_server
+{
+public:
+	stub_docker_server():
+		m_path("/tmp/docker_connection_ut." + std::to_string(getpid()) + ".sock")
+	{
+		unlink(m_path.c_str());
+
+		struct sockaddr_un addr = {};
+		addr.sun_family = AF_UNIX;
+		strncpy(addr.sun_path, m_path.c_str(), sizeof(addr.sun_path) - 1);
+
+		m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+		EXPECT_GE(m_fd, 0);
+		EXPECT_EQ(bind(m_fd, (struct sockaddr*)&addr, sizeof(addr)), 0);
+		EXPECT_EQ(listen(m_fd, 16), 0);
+
+		m_accept_thread = std::thread([this]() { accept_loop(); });
+	}
+
+	~stub_docker_server()
+	{
+		m_stop = true;
+		m_accept_thread.join();
+		for(int fd : m_conn_fds)
+		{
+			shutdown(fd, SHUT_RDWR);
+		}
+		for(auto& t : m_conn_threads)
+		{
+			t.join();
+		}
+		for(int fd : m_conn_fds)
+		{
+			close(fd);
+		}
+		close(m_fd);
+		unlink(m_path.c_str());
+	}
+
+	const std::string& path() const { return m_path; }
+
+	std::atomic<uint32_t> m_connections{0};
+	std::atomic<uint32_t> m_requests{0};
+	std::atomic<uint32_t> m_in_flight{0};
+	std::atomic<uint32_t> m_max_in_flight{0};
+
+private:
+	void accept_loop()
+	{
+		while(!m_stop)
+		{
+			struct pollfd pfd = {m_fd, POLLIN, 0};
+			if(poll(&pfd, 1, 10) <= 0)
+			{
+				continue;
+			}
+
+			int fd = accept(m_fd, nullptr, nullptr);
+			if(fd < 0)
+			{
+				continue;
+			}
+			m_connections++;
+			m_conn_fds.push_back(fd);
+			m_conn_threads.emplace_back([this, fd]() { serve(fd); });
+		}
+	}
+
+	void serve(int fd)
+	{
+		std::string buf;
+		char tmp[4096];
+		while(true)
+		{
+			size_t end;
+			while((end = buf.find("\r\n\r\n")) == std::string::npos)
+			{
+				ssize_t n = recv(fd, tmp, sizeof(tmp), 0);
+				if(n <= 0)
+				{
+					return;
+				}
+				buf.append(tmp, n);
+			}
+
+			// "GET <path> HTTP/1.1"
+			size_t start = buf.find(' ') + 1;
+			std::string path = buf.substr(start, buf.find(' ', start) - start);
+			buf.erase(0, end + 4);
+			m_requests++;
+
+			uint32_t in_flight = ++m_in_flight;
+			uint32_t max_in_flight = m_max_in_flight;
+			while(in_flight > max_in_flight && !m_max_in_flight.compare_exchange_weak(max_in_flight, in_flight))
+			{
+			}
+			if(path.find("slow") != std::string::npos)
+			{
+				std::this_thread::sleep_for(std::chrono::milliseconds(50));
+			}
+			m_in_flight--;
+
+			std::string body = "{\"path\":\"" + path + "\"}";
+			std::string status = path.find("missing") != std::string::npos ? "404 Not Found" : "200 OK";
+			std::string resp = "HTTP/1.1 " + status + "\r\n"
+				"Content-Type: application/json\r\n"
+				"Content-Length: " + std::to_string(body.size()) + "\r\n"
+				"\r\n" + body;
+			if(send(fd, resp.data(), resp.size(), MSG_NOSIGNAL) != (ssize_t)resp.size())
+			{
+				return;
+			}
+		}
+	}
+
+	std::string m_path;
+	int m_fd = -1;
+	std::atomic<bool> m_stop{false};
+	std::thread m_accept_thread;
+	std::vector<int> m_conn_fds;
+	std::vector<std::thread> m_conn_threads;
+};
+
+docker_lookup_request make_request(const std::string& socket)
+{
+	return docker_lookup_request("aaaaaaaaaaaa", socket, CT_DOCKER, 0, false);
+}
+
+}
+
+TEST(docker_connection, keep_alive)
+{
+	stub_docker_server server;
+	docker_connection connection;
+	auto request = make_request(server.path());
+
+	for(int i = 0; i < 10; i++)
+	{
+		std::string json;
+		ASSERT_EQ(connection.get_docker(request, "/containers/c" + std::to_string(i) + "/json", json),
+			  docker_connection::RESP_OK);
+		ASSERT_EQ(json, "{\"path\":\"/v1.24/containers/c" + std::to_string(i) + "/json\"}");
+	}
+
+	// errors at the HTTP level do not close the connection either
+	std::string json;
+	ASSERT_EQ(connection.get_docker(request, "/containers/missing/json", json),
+		  docker_connection::RESP_BAD_REQUEST);
+
+	connection.set_api_version("");
+	json.clear();
+	ASSERT_EQ(connection.get_docker(request, "/info", json), docker_connection::RESP_OK);
+	ASSERT_EQ(json, "{\"path\":\"/info\"}");
+
+	ASSERT_EQ(server.m_requests, 12);
+	ASSERT_EQ(server.m_connections, 1);
+}
+
+TEST(docker_connection, concurrent_requests)
+{
+	stub_docker_server server;
+	docker_connection connection;
+	connection.set_max_idle(4);
+	auto request = make_request(server.path());
+
+	std::atomic<uint32_t> n_ok{0};
+	std::vector<std::thread> threads;
+	for(int t = 0; t < 4; t++)
+	{
+		threads.emplace_back([&, t]()
+		{
+			for(int i = 0; i < 5; i++)
+			{
+				std::string url = "/containers/slow" + std::to_string(t) + "_" + std::to_string(i) + "/json";
+				std::string json;
+				if(connection.get_docker(request, url, json) == docker_connection::RESP_OK &&
+				   json == "{\"path\":\"/v1.24" + url + "\"}")
+				{
+					n_ok++;
+				}
+			}
+		});
+	}
+	for(auto& t : threads)
+	{
+		t.join();
+	}
+
+	ASSERT_EQ(n_ok, 20);
+	ASSERT_GE(server.m_max_in_flight, 2);
+	// at most one connection per concurrent request, kept open afterwards
+	ASSERT_LE(server.m_connections, 4);
+}
+
+TEST(docker_connection, no_server)
+{
+	docker_connection connection;
+	auto request = make_request("/tmp/docker_connection_ut.missing.sock");
+
+	std::string json;
+	ASSERT_EQ(connection.get_docker(request, "/containers/c/json", json), docker_connection::RESP_ERROR);
+}
+
+#endif
@@ -18,8 +18,11 @@ limitations under the License.
 
 #if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
 #include <dns_manager.h>
+#include <libsinsp/sinsp.h>
 #include <gtest/gtest.h>
 
+#include <atomic>
+
 TEST(sinsp_dns_manager, simple_dns_manager_invocation)
 {
     // Simple dummy test to assert that sinsp_dns_manager is invocated correctly
@@ -30,4 +33,100 @@ TEST(sinsp_dns_manager, simple_dns_manager_invocation)
     bool result = sinsp_dns_manager::get().match(name, AF_INET, &addr, ts);
     ASSERT_FALSE(result);
 }
+
+static std::string fake_resolver(int af, const void* addr)
+{
+    uint32_t ip;
+    memcpy(&ip, addr, sizeof(ip));
+    return (af == AF_INET && ip == htonl(0x0a000001)) ? "host.example" : "";
+}
+
+TEST(sinsp_dns_manager, reverse_lookups_are_disabled_by_default)
+{
+    auto& manager = sinsp_reverse_dns_manager::get();
+    ASSERT_FALSE(manager.is_enabled());
+
+    uint32_t known = htonl(0x0a000001);
+    ASSERT_EQ(manager.name_of(AF_INET, &known), "");
+    ASSERT_EQ(manager.size(), 0);
+}
+
+TEST(sinsp_dns_manager, reverse_lookups_are_async_and_cached)
+{
+    auto& manager = sinsp_reverse_dns_manager::get();
+    std::atomic<int> lookups{0};
+    manager.set_resolver([&lookups](int af, const void* addr) -> std::string
+    {
+        lookups++;
+        return fake_resolver(af, addr);
+    });
+    manager.set_negative_ttl(3600 * ONE_SECOND_IN_NS);
+    manager.set_enabled(true);
+
+    uint32_t known = htonl(0x0a000001);
+    uint32_t unknown = htonl(0x0a000002);
+    uint64_t generation = manager.generation();
+
+    // the first lookups only queue the resolutions
+    ASSERT_EQ(manager.name_of(AF_INET, &known), "");
+    ASSERT_EQ(manager.name_of(AF_INET, &unknown), "");
+
+    manager.wait_idle();
+    ASSERT_EQ(manager.name_of(AF_INET, &known), "host.example");
+    // only the new name counts as a change
+    ASSERT_EQ(manager.generation(), generation + 1);
+
+    // IPv4-mapped addresses share the IPv4 entry
+    uint8_t mapped[16] = {0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0xff, 0xff, 10, 0, 0, 1};
+    ASSERT_EQ(manager.name_of(AF_INET6, mapped), "host.example");
+
+    // failures are cached too
+    ASSERT_EQ(manager.name_of(AF_INET, &unknown), "");
+    ASSERT_EQ(manager.name_of(AF_INET, &unknown), "");
+    manager.wait_idle();
+    ASSERT_EQ(lookups, 2);
+    ASSERT_EQ(manager.size(), 2);
+
+    manager.cleanup();
+    manager.set_enabled(false);
+    manager.set_resolver(nullptr);
+    manager.set_negative_ttl(60 * ONE_SECOND_IN_NS);
+    ASSERT_EQ(manager.size(), 0);
+}
+
+TEST(sinsp_dns_manager, resolved_names_replace_rendered_fd_names)
+{
+    auto& manager = sinsp_reverse_dns_manager::get();
+    manager.set_resolver(fake_resolver);
+    manager.set_enabled(true);
+
+    sinsp_fdinfo fdinfo;
+    fdinfo.m_type = SCAP_FD_IPV4_SOCK;
+    fdinfo.m_sockinfo.m_ipv4info.m_fields.m_sip = htonl(0x0a000002);
+    fdinfo.m_sockinfo.m_ipv4info.m_fields.m_sport = 40000;
+    fdinfo.m_sockinfo.m_ipv4info.m_fields.m_dip = htonl(0x0a000001);
+    fdinfo.m_sockinfo.m_ipv4info.m_fields.m_dport = 40001;
+    fdinfo.m_sockinfo.m_ipv4info.m_fields.m_l4proto = SCAP_L4_TCP;
+    fdinfo.set_name_from_tuple(true);
+
+    // rendered numerically while the lookups are pending
+    std::string name = fdinfo.get_name();
+    ASSERT_EQ(name.substr(0, name.find(':')), "10.0.0.2");
+    ASSERT_NE(name.find("->10.0.0.1:"), std::string::npos);
+
+    manager.wait_idle();
+    const sinsp_fdinfo& cfdinfo = fdinfo;
+    name = cfdinfo.get_name();
+    ASSERT_NE(name.find("->host.example:"), std::string::npos);
+    name = fdinfo.get_name();
+    ASSERT_NE(name.find("->host.example:"), std::string::npos);
+
+    // names set explicitly are kept as they are
+    fdinfo.set_name("10.0.0.2:40000->10.0.0.1:40001");
+    ASSERT_EQ(fdinfo.get_name(), "10.0.0.2:40000->10.0.0.1:40001");
+
+    manager.cleanup();
+    manager.set_enabled(false);
+    manager.set_resolver(nullptr);
+}
 #endif
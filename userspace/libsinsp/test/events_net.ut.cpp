@@ -20,6 +20,7 @@ limitations under the License.
 
 #include <sinsp_with_test_input.h>
 #include "test_utils.h"
+#include "filter_compiler.h"
 #include <arpa/inet.h>
 #include <netinet/in.h>
 
@@ -398,7 +399,7 @@ TEST_F(sinsp_with_test_input, net_connect_exit_event_fails)
 
 	fdinfo = evt->get_fd_info();
 	ASSERT_NE(fdinfo, nullptr);
-	ASSERT_STREQ(fdinfo->m_name.c_str(), DEFAULT_IPV4_FDNAME);
+	ASSERT_STREQ(fdinfo->get_name().c_str(), DEFAULT_IPV4_FDNAME);
 	ASSERT_EQ(get_field_as_string(evt, "fd.name"), DEFAULT_IPV4_FDNAME);
 
 	/* Second connection with another server but in this case, the connect exit event fails */
@@ -432,7 +433,7 @@ TEST_F(sinsp_with_test_input, net_connect_exit_event_fails)
 	/* The parser is not able to obtain an updated fdname because the syscall fails and the parser flow is truncated */
 	fdinfo = evt->get_fd_info();
 	ASSERT_NE(fdinfo, nullptr);
-	ASSERT_STREQ(fdinfo->m_name.c_str(), DEFAULT_IPV4_FDNAME);
+	ASSERT_STREQ(fdinfo->get_name().c_str(), DEFAULT_IPV4_FDNAME);
 
 	/* There are updated by the enter event */
 	inet_ntop(AF_INET, (uint8_t*)&(fdinfo->m_sockinfo.m_ipv4info.m_fields.m_dip), ipv4_string, 100);
@@ -503,7 +504,7 @@ TEST_F(sinsp_with_test_input, net_connect_enter_event_is_empty)
 	/* The parser is not able to obtain an updated fdname because the syscall fails and the parser flow is truncated */
 	fdinfo = evt->get_fd_info();
 	ASSERT_NE(fdinfo, nullptr);
-	ASSERT_STREQ(fdinfo->m_name.c_str(), DEFAULT_IPV4_FDNAME);
+	ASSERT_STREQ(fdinfo->get_name().c_str(), DEFAULT_IPV4_FDNAME);
 
 	inet_ntop(AF_INET, (uint8_t*)&(fdinfo->m_sockinfo.m_ipv4info.m_fields.m_dip), ipv4_string, 100);
 	ASSERT_STREQ(ipv4_string, DEFAULT_IPV4_SERVER_STRING);
@@ -557,7 +558,7 @@ TEST_F(sinsp_with_test_input, net_connect_enter_event_is_missing)
 
 	fdinfo = evt->get_fd_info();
 	ASSERT_NE(fdinfo, nullptr);
-	ASSERT_STREQ(fdinfo->m_name.c_str(), fdname.c_str());
+	ASSERT_STREQ(fdinfo->get_name().c_str(), fdname.c_str());
 
 	inet_ntop(AF_INET, (uint8_t*)&(fdinfo->m_sockinfo.m_ipv4info.m_fields.m_dip), ipv4_string, 100);
 	ASSERT_STREQ(ipv4_string, ipv4_server.c_str());
@@ -615,3 +616,218 @@ TEST_F(sinsp_with_test_input, net_connect_enter_event_is_missing_wo_fd_param_exi
 	fdinfo = evt->get_fd_info();
 	ASSERT_EQ(fdinfo, nullptr);
 }
+
+TEST_F(sinsp_with_test_input, net_udp_lazy_fdname)
+{
+	add_default_init_thread();
+	open_inspector();
+	sinsp_evt* evt = NULL;
+	sinsp_fdinfo* fdinfo = NULL;
+	int64_t client_fd = 9;
+
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_SOCKET_E, 3, (uint32_t) PPM_AF_INET, (uint32_t) SOCK_DGRAM, (uint32_t) 0);
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_SOCKET_X, 1, client_fd);
+
+	sockaddr_in client = test_utils::fill_sockaddr_in(DEFAULT_CLIENT_PORT, DEFAULT_IPV4_CLIENT_STRING);
+	sockaddr_in server = test_utils::fill_sockaddr_in(DEFAULT_SERVER_PORT, DEFAULT_IPV4_SERVER_STRING);
+	std::vector<uint8_t> socktuple = test_utils::pack_socktuple(reinterpret_cast<sockaddr*>(&client), reinterpret_cast<sockaddr*>(&server));
+	scap_const_sized_buffer null_buf = scap_const_sized_buffer{nullptr, 0};
+
+	/* the name is rendered from the tuple only when it's read */
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_RECVFROM_E, 2, client_fd, (uint32_t) 6);
+	evt = add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_RECVFROM_X, 3, (int64_t) 6, null_buf, scap_const_sized_buffer{socktuple.data(), socktuple.size()});
+	fdinfo = evt->get_fd_info();
+	ASSERT_NE(fdinfo, nullptr);
+	ASSERT_TRUE(fdinfo->is_name_pending());
+	ASSERT_FALSE(fdinfo->is_syslog());
+	ASSERT_EQ(get_field_as_string(evt, "evt.is_syslog"), "false");
+	ASSERT_TRUE(fdinfo->is_name_pending());
+	ASSERT_EQ(get_field_as_string(evt, "fd.name_changed"), "true");
+	std::string fdname = get_field_as_string(evt, "fd.name");
+	ASSERT_FALSE(fdname.empty());
+	ASSERT_FALSE(fdinfo->is_name_pending());
+	ASSERT_EQ(fdinfo->get_name(), fdname);
+
+	/* the same tuple again does not change the name, even if nobody read it */
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_RECVFROM_E, 2, client_fd, (uint32_t) 6);
+	evt = add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_RECVFROM_X, 3, (int64_t) 6, null_buf, scap_const_sized_buffer{socktuple.data(), socktuple.size()});
+	ASSERT_EQ(get_field_as_string(evt, "fd.name_changed"), "false");
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_RECVFROM_E, 2, client_fd, (uint32_t) 6);
+	evt = add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_RECVFROM_X, 3, (int64_t) 6, null_buf, scap_const_sized_buffer{socktuple.data(), socktuple.size()});
+	ASSERT_EQ(get_field_as_string(evt, "fd.name_changed"), "false");
+	ASSERT_EQ(get_field_as_string(evt, "fd.name"), fdname);
+
+	/* a new peer changes it */
+	sockaddr_in server2 = test_utils::fill_sockaddr_in(8, "152.40.111.222");
+	socktuple = test_utils::pack_socktuple(reinterpret_cast<sockaddr*>(&client), reinterpret_cast<sockaddr*>(&server2));
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_RECVFROM_E, 2, client_fd, (uint32_t) 6);
+	evt = add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_RECVFROM_X, 3, (int64_t) 6, null_buf, scap_const_sized_buffer{socktuple.data(), socktuple.size()});
+	ASSERT_EQ(get_field_as_string(evt, "fd.name_changed"), "true");
+	ASSERT_NE(get_field_as_string(evt, "fd.name"), fdname);
+	ASSERT_NE(get_field_as_string(evt, "fd.name").find("152.40.111.222:8"), std::string::npos);
+}
+
+TEST_F(sinsp_with_test_input, net_ipv4_connect_fd_net_in_large_list)
+{
+	add_default_init_thread();
+	open_inspector();
+	sinsp_evt* evt = NULL;
+	int64_t client_fd = 7;
+
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_SOCKET_E, 3, (uint32_t) PPM_AF_INET, (uint32_t) SOCK_STREAM, (uint32_t) 0);
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_SOCKET_X, 1, client_fd);
+
+	sockaddr_in client = test_utils::fill_sockaddr_in(DEFAULT_CLIENT_PORT, DEFAULT_IPV4_CLIENT_STRING);
+	sockaddr_in server = test_utils::fill_sockaddr_in(DEFAULT_SERVER_PORT, DEFAULT_IPV4_SERVER_STRING);
+
+	std::vector<uint8_t> server_sockaddr = test_utils::pack_sockaddr(reinterpret_cast<sockaddr*>(&server));
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_CONNECT_E, 2, client_fd, scap_const_sized_buffer{server_sockaddr.data(), server_sockaddr.size()});
+	std::vector<uint8_t> socktuple = test_utils::pack_socktuple(reinterpret_cast<sockaddr*>(&client), reinterpret_cast<sockaddr*>(&server));
+	evt = add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_CONNECT_X, 3, return_value, scap_const_sized_buffer{socktuple.data(), socktuple.size()}, client_fd);
+
+	/* 512 networks that contain neither the client nor the server address, plus some IPv6 ones */
+	std::string nets = "2001:db8::/32, ::1/128";
+	for(int i = 0; i < 512; i++)
+	{
+		nets += ", 10." + std::to_string(i / 2) + "." + std::to_string((i % 2) * 128) + ".0/17";
+	}
+
+	filter_run(evt, false, "fd.net in (" + nets + ")");
+	filter_run(evt, false, "fd.snet in (" + nets + ")");
+
+	/* the matching network is not the first one of the list */
+	filter_run(evt, true, "fd.net in (" + nets + ", 142.251.0.0/16)");
+	filter_run(evt, true, "fd.snet in (" + nets + ", 142.251.111.147/32)");
+	filter_run(evt, false, "fd.cnet in (" + nets + ", 142.251.0.0/16)");
+	filter_run(evt, true, "fd.cnet in (" + nets + ", 172.32.0.0/11)");
+	filter_run(evt, true, "fd.rnet in (" + nets + ", 142.0.0.0/8)");
+	filter_run(evt, false, "fd.lnet in (" + nets + ", 142.0.0.0/8)");
+}
+
+TEST_F(sinsp_with_test_input, net_flow_accounting)
+{
+	add_default_init_thread();
+	open_inspector();
+	m_inspector.set_flow_accounting(true, 10 * ONE_SECOND_IN_NS);
+	auto table = m_inspector.get_flow_table();
+	ASSERT_EQ(m_inspector.get_table_registry()->get_table<uint64_t>("flows"), table);
+
+	int64_t client_fd = 7;
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_SOCKET_E, 3, (uint32_t) PPM_AF_INET, (uint32_t) SOCK_STREAM, (uint32_t) 0);
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_SOCKET_X, 1, client_fd);
+
+	sockaddr_in client = test_utils::fill_sockaddr_in(DEFAULT_CLIENT_PORT, DEFAULT_IPV4_CLIENT_STRING);
+	sockaddr_in server = test_utils::fill_sockaddr_in(DEFAULT_SERVER_PORT, DEFAULT_IPV4_SERVER_STRING);
+	std::vector<uint8_t> server_sockaddr = test_utils::pack_sockaddr(reinterpret_cast<sockaddr*>(&server));
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_CONNECT_E, 2, client_fd, scap_const_sized_buffer{server_sockaddr.data(), server_sockaddr.size()});
+	std::vector<uint8_t> socktuple = test_utils::pack_socktuple(reinterpret_cast<sockaddr*>(&client), reinterpret_cast<sockaddr*>(&server));
+	add_event_advance_ts(increasing_ts(), 1, PPME_SOCKET_CONNECT_X, 3, return_value, scap_const_sized_buffer{socktuple.data(), socktuple.size()}, client_fd);
+
+	/* a request, a response 50us later in two reads, and a second request 2ms later */
+	scap_const_sized_buffer null_buf = scap_const_sized_buffer{nullptr, 0};
+	uint64_t ts = increasing_ts();
+	add_event_advance_ts(ts, 1, PPME_SYSCALL_WRITE_E, 2, client_fd, (uint32_t) 100);
+	add_event_advance_ts(ts, 1, PPME_SYSCALL_WRITE_X, 2, (int64_t) 100, null_buf);
+	add_event_advance_ts(ts + 50000, 1, PPME_SYSCALL_READ_E, 2, client_fd, (uint32_t) 1000);
+	add_event_advance_ts(ts + 50000, 1, PPME_SYSCALL_READ_X, 2, (int64_t) 300, null_buf);
+	add_event_advance_ts(ts + 60000, 1, PPME_SYSCALL_READ_E, 2, client_fd, (uint32_t) 1000);
+	add_event_advance_ts(ts + 60000, 1, PPME_SYSCALL_READ_X, 2, (int64_t) 200, null_buf);
+	add_event_advance_ts(ts + 2060000, 1, PPME_SYSCALL_WRITE_E, 2, client_fd, (uint32_t) 100);
+	add_event_advance_ts(ts + 2060000, 1, PPME_SYSCALL_WRITE_X, 2, (int64_t) 50, null_buf);
+
+	/* nothing is exported before the snapshot */
+	ASSERT_EQ(table->get_num_flows(), 1);
+	ASSERT_EQ(table->entries_count(), 0);
+	table->snapshot(ts + 3000000);
+	ASSERT_EQ(table->entries_count(), 1);
+
+	auto e = table->get_entry(libsinsp::sinsp_flow_table::flow_key(INIT_PID, client_fd));
+	ASSERT_NE(e, nullptr);
+	auto flow = dynamic_cast<libsinsp::sinsp_flow_info*>(e.get());
+	ASSERT_NE(flow, nullptr);
+	ASSERT_EQ(flow->m_tuple, DEFAULT_IPV4_FDNAME);
+	ASSERT_EQ(flow->m_l4proto, SCAP_L4_TCP);
+	ASSERT_EQ(flow->m_bytes_out, 150);
+	ASSERT_EQ(flow->m_bytes_in, 500);
+	ASSERT_EQ(flow->m_ops_out, 2);
+	ASSERT_EQ(flow->m_ops_in, 2);
+	ASSERT_EQ(flow->m_first_ts, ts);
+	ASSERT_EQ(flow->m_last_ts, ts + 2060000);
+	ASSERT_FALSE(flow->m_closed);
+
+	/* the counters are reachable through the state tables API too */
+	auto gap_100us = table->static_fields().at("gap_100us").new_accessor<uint64_t>();
+	auto gap_10ms = table->static_fields().at("gap_10ms").new_accessor<uint64_t>();
+	auto bytes_in = table->static_fields().at("bytes_in").new_accessor<uint64_t>();
+	ASSERT_EQ(e->get_static_field(gap_100us), 1);
+	ASSERT_EQ(e->get_static_field(gap_10ms), 1);
+	ASSERT_EQ(e->get_static_field(bytes_in), 500);
+
+	/* closed flows are exported by the next snapshot only */
+	add_event_advance_ts(ts + 3000000, 1, PPME_SYSCALL_CLOSE_E, 1, client_fd);
+	add_event_advance_ts(ts + 3000000, 1, PPME_SYSCALL_CLOSE_X, 1, (int64_t) 0);
+	table->snapshot(ts + 4000000);
+	ASSERT_EQ(table->get_num_flows(), 0);
+	ASSERT_EQ(table->entries_count(), 1);
+	ASSERT_TRUE(flow->m_closed);
+	table->snapshot(ts + 5000000);
+	ASSERT_EQ(table->entries_count(), 0);
+
+	m_inspector.set_flow_accounting(false);
+	ASSERT_FALSE(table->is_enabled());
+}
+
+TEST_F(sinsp_with_test_input, net_flow_accounting_process_exit)
+{
+	add_default_init_thread();
+	int64_t pid = 20;
+	add_simple_thread(pid, pid, INIT_TID, "client");
+	open_inspector();
+	m_inspector.set_flow_accounting(true, 10 * ONE_SECOND_IN_NS);
+	auto table = m_inspector.get_flow_table();
+
+	int64_t client_fd = 7;
+	add_event_advance_ts(increasing_ts(), pid, PPME_SOCKET_SOCKET_E, 3, (uint32_t) PPM_AF_INET, (uint32_t) SOCK_STREAM, (uint32_t) 0);
+	add_event_advance_ts(increasing_ts(), pid, PPME_SOCKET_SOCKET_X, 1, client_fd);
+
+	sockaddr_in client = test_utils::fill_sockaddr_in(DEFAULT_CLIENT_PORT, DEFAULT_IPV4_CLIENT_STRING);
+	sockaddr_in server = test_utils::fill_sockaddr_in(DEFAULT_SERVER_PORT, DEFAULT_IPV4_SERVER_STRING);
+	std::vector<uint8_t> server_sockaddr = test_utils::pack_sockaddr(reinterpret_cast<sockaddr*>(&server));
+	add_event_advance_ts(increasing_ts(), pid, PPME_SOCKET_CONNECT_E, 2, client_fd, scap_const_sized_buffer{server_sockaddr.data(), server_sockaddr.size()});
+	std::vector<uint8_t> socktuple = test_utils::pack_socktuple(reinterpret_cast<sockaddr*>(&client), reinterpret_cast<sockaddr*>(&server));
+	add_event_advance_ts(increasing_ts(), pid, PPME_SOCKET_CONNECT_X, 3, return_value, scap_const_sized_buffer{socktuple.data(), socktuple.size()}, client_fd);
+
+	scap_const_sized_buffer null_buf = scap_const_sized_buffer{nullptr, 0};
+	add_event_advance_ts(increasing_ts(), pid, PPME_SYSCALL_WRITE_E, 2, client_fd, (uint32_t) 100);
+	add_event_advance_ts(increasing_ts(), pid, PPME_SYSCALL_WRITE_X, 2, (int64_t) 100, null_buf);
+	ASSERT_EQ(table->get_num_flows(), 1);
+
+	/* the process exits without closing the socket */
+	remove_thread(pid, INIT_TID);
+	ASSERT_EQ(m_inspector.get_thread_ref(pid, false), nullptr);
+	table->snapshot(increasing_ts());
+	ASSERT_EQ(table->get_num_flows(), 0);
+	auto e = table->get_entry(libsinsp::sinsp_flow_table::flow_key(pid, client_fd));
+	ASSERT_NE(e, nullptr);
+	ASSERT_TRUE(dynamic_cast<libsinsp::sinsp_flow_info*>(e.get())->m_closed);
+
+	/* the table is only written by the snapshots */
+	ASSERT_THROW(table->add_entry(1, table->new_entry()), sinsp_exception);
+	ASSERT_THROW(table->erase_entry(libsinsp::sinsp_flow_table::flow_key(pid, client_fd)), sinsp_exception);
+
+	/* a process reusing the pid starts a new flow on the same fd */
+	sinsp_fdinfo fdinfo;
+	fdinfo.m_type = SCAP_FD_IPV4_SOCK;
+	table->on_io(pid, 1000, client_fd, fdinfo, true, 10, 2000);
+	table->on_io(pid, 1000, client_fd, fdinfo, true, 10, 3000);
+	table->on_io(pid, 5000, client_fd, fdinfo, true, 30, 6000);
+	table->snapshot(7000);
+	e = table->get_entry(libsinsp::sinsp_flow_table::flow_key(pid, client_fd));
+	ASSERT_NE(e, nullptr);
+	auto flow = dynamic_cast<libsinsp::sinsp_flow_info*>(e.get());
+	ASSERT_EQ(flow->m_bytes_in, 30);
+	ASSERT_EQ(flow->m_ops_in, 1);
+	ASSERT_EQ(flow->m_first_ts, 6000);
+
+	m_inspector.set_flow_accounting(false);
+}
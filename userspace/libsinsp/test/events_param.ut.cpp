@@ -214,7 +214,7 @@ TEST_F(sinsp_with_test_input, enter_event_retrieval)
 		ASSERT_NE(evt->get_thread_info(), nullptr) << test_context;
 		ASSERT_NE(evt->get_thread_info()->get_fd(new_fd), nullptr) << test_context;
 
-		ASSERT_EQ(evt->get_thread_info()->get_fd(new_fd)->m_name, expected_string) << test_context;
+		ASSERT_EQ(evt->get_thread_info()->get_fd(new_fd)->get_name(), expected_string) << test_context;
 		ASSERT_EQ(get_field_as_string(evt, "fd.name"), expected_string) << test_context;
 
 		dirfd++;
@@ -232,7 +232,7 @@ TEST_F(sinsp_with_test_input, enter_event_retrieval)
 		ASSERT_NE(evt->get_thread_info(), nullptr) << test_context;
 		ASSERT_NE(evt->get_thread_info()->get_fd(new_fd), nullptr) << test_context;
 
-		ASSERT_EQ(evt->get_thread_info()->get_fd(new_fd)->m_name, expected_string) << test_context;
+		ASSERT_EQ(evt->get_thread_info()->get_fd(new_fd)->get_name(), expected_string) << test_context;
 		ASSERT_EQ(get_field_as_string(evt, "fd.name"), expected_string) << test_context;
 
 		dirfd++;
@@ -250,7 +250,7 @@ TEST_F(sinsp_with_test_input, enter_event_retrieval)
 		ASSERT_NE(evt->get_thread_info(), nullptr) << test_context;
 		ASSERT_NE(evt->get_thread_info()->get_fd(new_fd), nullptr) << test_context;
 
-		ASSERT_EQ(evt->get_thread_info()->get_fd(new_fd)->m_name, expected_string) << test_context;
+		ASSERT_EQ(evt->get_thread_info()->get_fd(new_fd)->get_name(), expected_string) << test_context;
 		ASSERT_EQ(get_field_as_string(evt, "fd.name"), expected_string) << test_context;
 
 		new_fd++;
@@ -267,7 +267,7 @@ TEST_F(sinsp_with_test_input, enter_event_retrieval)
 		ASSERT_NE(evt->get_thread_info(), nullptr) << test_context;
 		ASSERT_NE(evt->get_thread_info()->get_fd(new_fd), nullptr) << test_context;
 
-		ASSERT_EQ(evt->get_thread_info()->get_fd(new_fd)->m_name, expected_string) << test_context;
+		ASSERT_EQ(evt->get_thread_info()->get_fd(new_fd)->get_name(), expected_string) << test_context;
 		ASSERT_EQ(get_field_as_string(evt, "fd.name"), expected_string) << test_context;
 
 		new_fd++;
@@ -17,6 +17,7 @@ limitations under the License.
 */
 
 #include <helpers/threads_helpers.h>
+#include <libsinsp/eventformatter.h>
 
 TEST_F(sinsp_with_test_input, PROC_FILTER_nthreads)
 {
@@ -105,3 +106,123 @@ TEST_F(sinsp_with_test_input, PROC_FILTER_pexepath_aexepath)
 	/* this field shouldn't exist */
 	ASSERT_FALSE(field_has_value(evt, "proc.aexepath[6]"));
 }
+
+TEST_F(sinsp_with_test_input, PROC_FILTER_cmdline_exeline_env_memoized)
+{
+	DEFAULT_TREE
+
+	auto p6_t1_tinfo = m_inspector.get_thread_ref(p6_t1_tid, false).get();
+	ASSERT_TRUE(p6_t1_tinfo);
+	p6_t1_tinfo->m_comm = "p6";
+	p6_t1_tinfo->m_exe = "/usr/bin/p6";
+	const char args[] = "-a\0-b";
+	p6_t1_tinfo->set_args(args, sizeof(args));
+	const char env[] = "A=1\0B=2";
+	p6_t1_tinfo->set_env(env, sizeof(env));
+
+	auto evt = generate_random_event(p6_t1_tid);
+	ASSERT_EQ(get_field_as_string(evt, "proc.cmdline"), "p6 -a -b");
+	ASSERT_EQ(get_field_as_string(evt, "proc.exeline"), "/usr/bin/p6 -a -b");
+	ASSERT_EQ(get_field_as_string(evt, "proc.env"), "A=1 B=2");
+	ASSERT_EQ(get_field_as_string(evt, "proc.aenv"), "A=1 B=2");
+
+	/* the strings are built once and then returned from the same storage */
+	std::string storage;
+	const char* cmdline = p6_t1_tinfo->get_cmdline(storage).c_str();
+	ASSERT_EQ(p6_t1_tinfo->get_cmdline(storage).c_str(), cmdline);
+	ASSERT_EQ(p6_t1_tinfo->get_concatenated_env(storage).c_str(), p6_t1_tinfo->get_concatenated_env(storage).c_str());
+	ASSERT_TRUE(storage.empty());
+
+	/* every change of the underlying values is reflected */
+	p6_t1_tinfo->m_comm = "p6-renamed";
+	ASSERT_EQ(get_field_as_string(evt, "proc.cmdline"), "p6-renamed -a -b");
+	const char new_args[] = "-c";
+	p6_t1_tinfo->set_args(new_args, sizeof(new_args));
+	ASSERT_EQ(get_field_as_string(evt, "proc.cmdline"), "p6-renamed -c");
+	ASSERT_EQ(get_field_as_string(evt, "proc.exeline"), "/usr/bin/p6 -c");
+	p6_t1_tinfo->m_env.push_back("C=3");
+	p6_t1_tinfo->update_derived_strings();
+	ASSERT_EQ(get_field_as_string(evt, "proc.env"), "A=1 B=2 C=3");
+
+	/* the execve replaces args and env */
+	evt = generate_execve_enter_and_exit_event(0, p6_t1_tid, p6_t1_tid, p6_t1_pid, p6_t1_ptid, "/good-exe", "good-exe", "/usr/bin/good-exe");
+	ASSERT_EQ(get_field_as_string(evt, "proc.cmdline"), "good-exe");
+	ASSERT_EQ(get_field_as_string(evt, "proc.exeline"), "/good-exe ");
+	ASSERT_EQ(get_field_as_string(evt, "proc.env"), "");
+}
+
+TEST_F(sinsp_with_test_input, PROC_FILTER_cmdline_stale_not_shared)
+{
+	DEFAULT_TREE
+
+	auto p6_t1_tinfo = m_inspector.get_thread_ref(p6_t1_tid, false).get();
+	auto p5_t2_tinfo = m_inspector.get_thread_ref(p6_t1_ptid, false).get();
+	ASSERT_TRUE(p6_t1_tinfo);
+	ASSERT_TRUE(p5_t2_tinfo);
+
+	const char child_args[] = "-a";
+	p6_t1_tinfo->set_args(child_args, sizeof(child_args));
+	const char parent_args[] = "-b";
+	p5_t2_tinfo->set_args(parent_args, sizeof(parent_args));
+
+	/* written without refreshing the cached strings, as the table API does */
+	p6_t1_tinfo->m_comm = "child";
+	p5_t2_tinfo->m_comm = "parent";
+
+	std::string child_storage;
+	std::string parent_storage;
+	const std::string& child = p6_t1_tinfo->get_cmdline(child_storage);
+	const std::string& parent = p5_t2_tinfo->get_cmdline(parent_storage);
+	ASSERT_EQ(child, "child -a");
+	ASSERT_EQ(parent, "parent -b");
+
+	auto evt = generate_random_event(p6_t1_tid);
+	std::string output;
+	sinsp_evt_formatter formatter(&m_inspector, "%proc.cmdline %proc.pcmdline", m_default_filterlist);
+	ASSERT_TRUE(formatter.tostring(evt, output));
+	ASSERT_EQ(output, "child -a parent -b");
+}
+
+/* Benchmark, run it with `--gtest_also_run_disabled_tests` */
+TEST_F(sinsp_with_test_input, DISABLED_PROC_FILTER_cmdline_benchmark)
+{
+	DEFAULT_TREE
+
+	auto tinfo = m_inspector.get_thread_ref(p6_t1_tid, false).get();
+	ASSERT_TRUE(tinfo);
+	std::string args;
+	for(int i = 0; i < 32; i++)
+	{
+		args += "--option-" + std::to_string(i) + '\0';
+	}
+	tinfo->set_args(args.c_str(), args.size());
+
+	const int iterations = 200000;
+	size_t total = 0;
+	std::string storage;
+
+	/* what proc.cmdline used to do on every extraction */
+	auto start = std::chrono::steady_clock::now();
+	for(int i = 0; i < iterations; i++)
+	{
+		std::string cmdline = tinfo->m_comm;
+		for(const auto& arg : tinfo->m_args)
+		{
+			cmdline += " ";
+			cmdline += arg;
+		}
+		total += cmdline.size();
+	}
+	auto rebuilt = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	start = std::chrono::steady_clock::now();
+	for(int i = 0; i < iterations; i++)
+	{
+		total -= tinfo->get_cmdline(storage).size();
+	}
+	auto memoized = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+	ASSERT_EQ(total, 0);
+	printf("[ INFO     ] %d proc.cmdline extractions: rebuilt %" PRId64 " us, memoized %" PRId64 " us\n",
+	       iterations, (int64_t)rebuilt, (int64_t)memoized);
+}
@@ -125,3 +125,22 @@ TEST(sinsp_network_interfaces, infer_defaults_to_first_non_loopback)
 	interfaces.get_ipv4_list()->push_back(make_ipv4_interface("192.168.22.150", "255.255.255.0", "192.168.22.255", "eth1"));
 	EXPECT_ADDR_EQ("192.168.22.149",interfaces.infer_ipv4_address(parse_ipv4_addr("193.168.22.11")));
 }
+
+TEST(sinsp_network_interfaces, ipv4_local_and_subnet)
+{
+	sinsp_network_interfaces interfaces;
+	interfaces.get_ipv4_list()->push_back(make_ipv4_localhost());
+	interfaces.get_ipv4_list()->push_back(make_ipv4_interface("100.64.22.149", "255.255.255.0", "100.64.22.255", "eth0"));
+	EXPECT_TRUE(interfaces.is_ipv4addr_in_subnet(parse_ipv4_addr("100.64.22.11")));
+	EXPECT_TRUE(interfaces.is_ipv4addr_in_subnet(parse_ipv4_addr("127.0.0.53")));
+	EXPECT_TRUE(interfaces.is_ipv4addr_in_subnet(parse_ipv4_addr("10.1.2.3")));
+	EXPECT_FALSE(interfaces.is_ipv4addr_in_subnet(parse_ipv4_addr("100.64.23.11")));
+
+	// the lookups follow the changes to the interface list
+	interfaces.import_ipv4_interface(make_ipv4_interface("100.64.23.1", "255.255.255.128", "100.64.23.127", "eth1"));
+	EXPECT_TRUE(interfaces.is_ipv4addr_in_subnet(parse_ipv4_addr("100.64.23.11")));
+	EXPECT_FALSE(interfaces.is_ipv4addr_in_subnet(parse_ipv4_addr("100.64.23.200")));
+
+	interfaces.clear();
+	EXPECT_FALSE(interfaces.is_ipv4addr_in_subnet(parse_ipv4_addr("100.64.22.11")));
+}
@@ -0,0 +1,290 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/mpsc_ring_queue.h>
+#include <libsinsp/mpsc_priority_queue.h>
+#include <gtest/gtest.h>
+#include <thread>
+#include <chrono>
+#include <cstdio>
+
+namespace
+{
+struct val
+{
+	int v;
+	int order;
+};
+
+struct val_less
+{
+	bool operator()(const val& l, const val& r)
+	{
+		return std::greater_equal<int>{}(l.v, r.v);
+	}
+};
+}
+
+TEST(mpsc_ring_queue, order_consistency)
+{
+	using val_t = std::unique_ptr<val>;
+
+	mpsc_ring_queue<val_t, val_less> q(0, 16384);
+	// push priorities in reverse, the consumer heap must reorder them
+	for (int i = 99; i >= 0; i--)
+	{
+		for (int j = 0; j < 100; j++)
+		{
+			ASSERT_TRUE(q.push(val_t{new val{i,j}}));
+		}
+	}
+
+	val_t cur{nullptr};
+	val_t prev{nullptr};
+	int count = 0;
+	while (!q.empty())
+	{
+		ASSERT_TRUE(q.try_pop(cur));
+		if (prev != nullptr)
+		{
+			ASSERT_GE(cur->v, prev->v);
+			if (cur->v == prev->v)
+			{
+				ASSERT_GT(cur->order, prev->order);
+			}
+		}
+		prev = std::move(cur);
+		count++;
+	}
+	ASSERT_EQ(count, 10000);
+	ASSERT_FALSE(q.try_pop(cur));
+}
+
+TEST(mpsc_ring_queue, try_pop_if)
+{
+	using val_t = std::unique_ptr<int>;
+
+	mpsc_ring_queue<val_t, std::greater_equal<int>> q;
+	q.push(std::make_unique<int>(10));
+	q.push(std::make_unique<int>(5));
+
+	val_t v;
+	ASSERT_FALSE(q.try_pop_if(v, [](const int& n) { return n > 5; }));
+	ASSERT_FALSE(q.empty());
+	ASSERT_TRUE(q.try_pop_if(v, [](const int& n) { return n == 5; }));
+	ASSERT_EQ(*v, 5);
+	ASSERT_TRUE(q.try_pop_if(v, [](const int& n) { return n > 5; }));
+	ASSERT_EQ(*v, 10);
+	ASSERT_TRUE(q.empty());
+	ASSERT_FALSE(q.try_pop_if(v, [](const int&) { return true; }));
+}
+
+TEST(mpsc_ring_queue, capacity)
+{
+	using val_t = std::unique_ptr<int>;
+
+	// consumer-side capacity of 2, rings of 4 elements
+	mpsc_ring_queue<val_t, std::greater_equal<int>> q(2, 4);
+	for (int i = 0; i < 4; i++)
+	{
+		ASSERT_TRUE(q.push(std::make_unique<int>(i)));
+	}
+	ASSERT_FALSE(q.push(std::make_unique<int>(4)));
+	ASSERT_EQ(q.get_num_drops(), 1);
+
+	// draining makes room in the ring
+	val_t v;
+	ASSERT_TRUE(q.try_pop(v));
+	ASSERT_EQ(*v, 0);
+	ASSERT_TRUE(q.push(std::make_unique<int>(5)));
+	ASSERT_TRUE(q.push(std::make_unique<int>(6)));
+	ASSERT_FALSE(q.push(std::make_unique<int>(7)));
+	ASSERT_EQ(q.get_num_drops(), 2);
+
+	int expected[] = {1, 2, 3, 5, 6};
+	for (int e : expected)
+	{
+		ASSERT_TRUE(q.try_pop(v));
+		ASSERT_EQ(*v, e);
+	}
+	ASSERT_TRUE(q.empty());
+}
+
+// note: emscripten does not support launching threads
+#ifndef __EMSCRIPTEN__
+
+TEST(mpsc_ring_queue, producer_slots_reuse)
+{
+	using val_t = std::unique_ptr<int>;
+
+	// a single producer slot, released when its thread exits
+	mpsc_ring_queue<val_t, std::greater_equal<int>> q(0, 8, 1);
+	for (int i = 0; i < 3; i++)
+	{
+		bool pushed = false;
+		std::thread([&]() { pushed = q.push(std::make_unique<int>(i)); }).join();
+		ASSERT_TRUE(pushed);
+	}
+
+	// while a thread owns the slot, others can't push
+	std::atomic<bool> owned{false};
+	std::atomic<bool> done{false};
+	std::thread t([&]() {
+		q.push(std::make_unique<int>(3));
+		owned = true;
+		while (!done)
+		{
+			std::this_thread::yield();
+		}
+	});
+	while (!owned)
+	{
+		std::this_thread::yield();
+	}
+	ASSERT_FALSE(q.push(std::make_unique<int>(4)));
+	ASSERT_EQ(q.get_num_drops(), 1);
+	done = true;
+	t.join();
+
+	val_t v;
+	for (int i = 0; i < 4; i++)
+	{
+		ASSERT_TRUE(q.try_pop(v));
+		ASSERT_EQ(*v, i);
+	}
+	ASSERT_TRUE(q.empty());
+}
+
+TEST(mpsc_ring_queue, multi_concurrent_producers)
+{
+	using val_t = std::unique_ptr<val>;
+	const constexpr int num_values = 10000;
+	const constexpr int num_producers = 8;
+
+	mpsc_ring_queue<val_t, val_less> q;
+
+	// every producer pushes increasing values, the consumer must receive
+	// the values of every single producer in order
+	std::vector<std::thread> producers;
+	for (int p = 0; p < num_producers; p++)
+	{
+		producers.emplace_back([&q, p]() {
+			for (int i = 0; i < num_values;)
+			{
+				if (q.push(std::make_unique<val>(val{i, p})))
+				{
+					i++;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::vector<int> last(num_producers, -1);
+	int received = 0;
+	int failed = 0;
+	val_t v;
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(30);
+	while (received < num_values * num_producers && std::chrono::steady_clock::now() < deadline)
+	{
+		if (q.empty() || !q.try_pop(v))
+		{
+			continue;
+		}
+		failed += (v->v <= last[v->order]) ? 1 : 0;
+		last[v->order] = v->v;
+		received++;
+	}
+
+	for (auto& p : producers)
+	{
+		p.join();
+	}
+
+	ASSERT_EQ(received, num_values * num_producers);
+	ASSERT_EQ(failed, 0) << "received " << failed << " elements out of order";
+}
+
+// compare the lock-free queue with the mutex-guarded one under producer
+// contention, the consumer probes the queue with try_pop_if like sinsp::next
+template<typename Queue>
+static double contention_bench(Queue& q, int num_producers, int num_values)
+{
+	std::atomic<bool> start{false};
+	std::vector<std::thread> producers;
+	for (int p = 0; p < num_producers; p++)
+	{
+		producers.emplace_back([&]() {
+			while (!start)
+			{
+				std::this_thread::yield();
+			}
+			for (int i = 0; i < num_values;)
+			{
+				if (q.push(std::make_unique<int>(i)))
+				{
+					i++;
+				}
+				else
+				{
+					std::this_thread::yield();
+				}
+			}
+		});
+	}
+
+	std::unique_ptr<int> v;
+	int received = 0;
+	auto begin = std::chrono::steady_clock::now();
+	start = true;
+	while (received < num_values * num_producers)
+	{
+		if (!q.empty() && q.try_pop_if(v, [](const int&) { return true; }))
+		{
+			received++;
+		}
+	}
+	auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - begin).count();
+
+	for (auto& p : producers)
+	{
+		p.join();
+	}
+	return elapsed > 0 ? (double)received / elapsed : 0;
+}
+
+/* Benchmark, run it with `--gtest_also_run_disabled_tests` */
+TEST(mpsc_ring_queue, DISABLED_contention_benchmark)
+{
+	const int num_producers = 4;
+	const int num_values = 20000;
+
+	mpsc_priority_queue<std::unique_ptr<int>, std::greater_equal<int>> locked(1000);
+	mpsc_ring_queue<std::unique_ptr<int>, std::greater_equal<int>> lockfree(1000);
+
+	double locked_rate = contention_bench(locked, num_producers, num_values);
+	double lockfree_rate = contention_bench(lockfree, num_producers, num_values);
+
+	printf("[ INFO     ] %d producers: mpsc_priority_queue %.2f Melem/s, mpsc_ring_queue %.2f Melem/s\n",
+	       num_producers, locked_rate, lockfree_rate);
+}
+
+#endif // __EMSCRIPTEN__
@@ -375,6 +375,41 @@ TEST_F(sinsp_with_test_input, CLONE_CALLER_comm_update)
 	ASSERT_THREAD_INFO_COMM(p2_t1_tid, "new-name");
 }
 
+TEST_F(sinsp_with_test_input, CLONE_CALLER_shared_fdtable)
+{
+	add_default_init_thread();
+	open_inspector();
+
+	/* Init opens a file before creating p1 */
+	add_event_advance_ts(increasing_ts(), INIT_TID, PPME_SYSCALL_OPEN_X, 6, (uint64_t)3, "/tmp/init_file",
+			     (uint32_t)PPM_O_RDWR, (uint32_t)0, (uint32_t)5, (uint64_t)123);
+
+	int64_t p1_t1_tid = 24;
+	generate_clone_x_event(p1_t1_tid, INIT_TID, INIT_PID, INIT_PTID);
+
+	sinsp_threadinfo* init_tinfo = m_inspector.get_thread_ref(INIT_TID, false).get();
+	sinsp_threadinfo* p1_t1_tinfo = m_inspector.get_thread_ref(p1_t1_tid, false).get();
+	ASSERT_TRUE(init_tinfo);
+	ASSERT_TRUE(p1_t1_tinfo);
+
+	/* The child inherits the fds of the parent */
+	ASSERT_EQ(p1_t1_tinfo->get_fdtable().size(), init_tinfo->get_fdtable().size());
+	ASSERT_TRUE(p1_t1_tinfo->get_fd(3));
+	ASSERT_EQ(p1_t1_tinfo->get_fd(3)->get_name(), "/tmp/init_file");
+	ASSERT_TRUE(p1_t1_tinfo->get_fd(3)->is_cloned());
+	ASSERT_FALSE(init_tinfo->get_fd(3)->is_cloned());
+
+	/* The fds opened after the fork are not shared */
+	add_event_advance_ts(increasing_ts(), p1_t1_tid, PPME_SYSCALL_OPEN_X, 6, (uint64_t)3, "/tmp/p1_file",
+			     (uint32_t)PPM_O_RDWR, (uint32_t)0, (uint32_t)5, (uint64_t)124);
+	add_event_advance_ts(increasing_ts(), p1_t1_tid, PPME_SYSCALL_OPEN_X, 6, (uint64_t)4, "/tmp/p1_other_file",
+			     (uint32_t)PPM_O_RDWR, (uint32_t)0, (uint32_t)5, (uint64_t)125);
+	ASSERT_EQ(p1_t1_tinfo->get_fd(3)->get_name(), "/tmp/p1_file");
+	ASSERT_EQ(init_tinfo->get_fd(3)->get_name(), "/tmp/init_file");
+	ASSERT_TRUE(p1_t1_tinfo->get_fd(4));
+	ASSERT_FALSE(init_tinfo->get_fd(4));
+}
+
 /*=============================== CLONE CALLER EXIT EVENT ===========================*/
 
 /*=============================== CLONE CHILD EXIT EVENT ===========================*/
@@ -17,7 +17,10 @@ limitations under the License.
 */
 
 #include <gtest/gtest.h>
+#include <set>
 #include <libsinsp/plugin.h>
+#include <libsinsp/plugin_filtercheck.h>
+#include <libsinsp/eventformatter.h>
 
 #include <sinsp_with_test_input.h>
 #include "test_utils.h"
@@ -229,6 +232,145 @@ TEST_F(sinsp_with_test_input, plugin_syscall_extract)
 	ASSERT_FALSE(field_has_value(evt, "sample.tick", pl_flist));
 }
 
+// scenario: the fields of a plugin used by a filter or a formatter should be
+// extracted in a single batch per event and served to all of its checks, and
+// a field failing the batch should not affect the extraction of the others
+TEST_F(sinsp_with_test_input, plugin_syscall_extract_batch)
+{
+	filter_check_list pl_flist;
+	auto pl = register_plugin(&m_inspector, get_plugin_api_sample_syscall_extract);
+	add_plugin_filterchecks(&m_inspector, pl, sinsp_syscall_event_source_name, pl_flist);
+	add_default_init_thread();
+	open_inspector();
+
+	auto factory = std::make_shared<sinsp_filter_factory>(&m_inspector, pl_flist);
+	auto filter = sinsp_filter_compiler(factory, "sample.is_open=1 and sample.proc_name=init and sample.is_open!=0").compile();
+	sinsp_evt_formatter formatter(&m_inspector, "%sample.is_open %sample.proc_name %sample.tick", pl_flist);
+
+	std::string output;
+	auto evt = add_event_advance_ts(increasing_ts(), 1, PPME_SYSCALL_OPEN_X, 6, (uint64_t)3, "/tmp/the_file", PPM_O_RDWR, 0, 5, (uint64_t)123);
+	uint64_t calls = pl->num_extract_calls();
+	ASSERT_TRUE(filter->run(evt));
+	// one call for the filter, one for the formatter
+	ASSERT_EQ(pl->num_extract_calls(), calls + 1);
+	ASSERT_TRUE(formatter.tostring(evt, output));
+	ASSERT_EQ(output, "1 init false");
+	ASSERT_EQ(pl->num_extract_calls(), calls + 2);
+
+	// the results of the previous event are not reused
+	evt = add_event_advance_ts(increasing_ts(), 1, PPME_SYSCALL_INOTIFY_INIT1_X, 2, (int64_t)12, (uint16_t)32);
+	ASSERT_FALSE(filter->run(evt));
+	ASSERT_TRUE(formatter.tostring(evt, output));
+	ASSERT_EQ(output, "0 init false");
+
+	// the same filter run again on an event extracts its batch again,
+	// since the formatter extraction may have overwritten the results
+	calls = pl->num_extract_calls();
+	ASSERT_FALSE(filter->run(evt));
+	ASSERT_EQ(pl->num_extract_calls(), calls + 1);
+
+	// sample.open_count fails without the parsing plugin, making the batch
+	// of this formatter fail: its other fields are extracted alone, and the
+	// batches of the other filters and formatters are not affected
+	sinsp_evt_formatter failing(&m_inspector, "*%sample.open_count %sample.is_open %sample.proc_name", pl_flist);
+	evt = add_event_advance_ts(increasing_ts(), 1, PPME_SYSCALL_OPEN_X, 6, (uint64_t)3, "/tmp/the_file", PPM_O_RDWR, 0, 5, (uint64_t)123);
+	calls = pl->num_extract_calls();
+	ASSERT_TRUE(failing.tostring(evt, output));
+	ASSERT_EQ(output, "<NA> 1 init");
+	ASSERT_EQ(pl->num_extract_calls(), calls + 4);
+	calls = pl->num_extract_calls();
+	ASSERT_TRUE(filter->run(evt));
+	ASSERT_EQ(pl->num_extract_calls(), calls + 1);
+}
+
+// scenario: plugins that don't declare multi-field extraction support should
+// only be asked for one field per call
+TEST_F(sinsp_with_test_input, plugin_syscall_extract_batch_opt_in)
+{
+	filter_check_list pl_flist;
+	auto pl = register_plugin(&m_inspector, [](plugin_api& api)
+	{
+		get_plugin_api_sample_syscall_extract(api);
+		api.get_extract_batch_support = NULL;
+	});
+	ASSERT_FALSE(pl->extract_batch_support());
+	add_plugin_filterchecks(&m_inspector, pl, sinsp_syscall_event_source_name, pl_flist);
+	add_default_init_thread();
+	open_inspector();
+
+	auto factory = std::make_shared<sinsp_filter_factory>(&m_inspector, pl_flist);
+	auto filter = sinsp_filter_compiler(factory, "sample.is_open=1 and sample.proc_name=init").compile();
+	sinsp_evt_formatter formatter(&m_inspector, "%sample.is_open %sample.proc_name %sample.tick", pl_flist);
+
+	std::string output;
+	auto evt = add_event_advance_ts(increasing_ts(), 1, PPME_SYSCALL_OPEN_X, 6, (uint64_t)3, "/tmp/the_file", PPM_O_RDWR, 0, 5, (uint64_t)123);
+	uint64_t calls = pl->num_extract_calls();
+	ASSERT_TRUE(filter->run(evt));
+	ASSERT_EQ(pl->num_extract_calls(), calls + 2);
+	ASSERT_TRUE(formatter.tostring(evt, output));
+	ASSERT_EQ(output, "1 init false");
+	ASSERT_EQ(pl->num_extract_calls(), calls + 5);
+}
+
+// compare the extraction of a few fields of the same plugin for every event
+// with one plugin call per field against the batched filterchecks
+/* Benchmark, run it with `--gtest_also_run_disabled_tests` */
+TEST_F(sinsp_with_test_input, DISABLED_plugin_syscall_extract_batch_benchmark)
+{
+	filter_check_list pl_flist;
+	auto pl = register_plugin(&m_inspector, get_plugin_api_sample_syscall_extract);
+	add_plugin_filterchecks(&m_inspector, pl, sinsp_syscall_event_source_name, pl_flist);
+	add_default_init_thread();
+	open_inspector();
+
+	std::vector<std::string> names = {"sample.is_open", "sample.proc_name", "sample.tick", "sample.is_open", "sample.proc_name"};
+	std::vector<std::unique_ptr<sinsp_filter_check>> checks;
+	std::vector<sinsp_filter_check*> group;
+	std::vector<ss_plugin_extract_field> single(names.size());
+	for (size_t i = 0; i < names.size(); i++)
+	{
+		checks.push_back(pl_flist.new_filter_check_from_fldname(names[i], &m_inspector, false));
+		checks.back()->parse_field_name(names[i].c_str(), true, false);
+		group.push_back(checks.back().get());
+		uint32_t field_id = 0;
+		while (pl->fields()[field_id].m_name != names[i])
+		{
+			field_id++;
+		}
+		single[i] = {};
+		single[i].field_id = field_id;
+		single[i].field = pl->fields()[field_id].m_name;
+		single[i].ftype = pl->fields()[field_id].m_type;
+	}
+	sinsp_filter_check_plugin::group_batch_fields(group);
+
+	const int num_events = 20000;
+	std::chrono::nanoseconds single_time{0}, batch_time{0};
+	std::vector<extract_value_t> values;
+	for (int n = 0; n < num_events; n++)
+	{
+		auto evt = add_event_advance_ts(increasing_ts(), 1, PPME_SYSCALL_OPEN_X, 6, (uint64_t)3, "/tmp/the_file", PPM_O_RDWR, 0, 5, (uint64_t)123);
+
+		auto start = std::chrono::steady_clock::now();
+		for (auto& f : single)
+		{
+			ASSERT_TRUE(pl->extract_fields(evt, 1, &f));
+		}
+		single_time += std::chrono::steady_clock::now() - start;
+
+		start = std::chrono::steady_clock::now();
+		for (auto& chk : checks)
+		{
+			ASSERT_TRUE(chk->extract(evt, values));
+		}
+		batch_time += std::chrono::steady_clock::now() - start;
+	}
+
+	auto rate = [&](std::chrono::nanoseconds t) { return t.count() > 0 ? (double)num_events * 1000 / t.count() : 0; };
+	printf("[ INFO     ] %zu fields per event: single extraction %.2f Mevt/s, batched extraction %.2f Mevt/s\n",
+	       names.size(), rate(single_time), rate(batch_time));
+}
+
 // scenario: an event sourcing plugin should produce events of "syscall"
 // event source and we should be able to extract filter values implemented
 // by both libsinsp and another plugin with field extraction capability
@@ -295,6 +437,132 @@ TEST_F(sinsp_with_test_input, plugin_custom_source)
 	ASSERT_EQ(next_event(), nullptr); // EOF is expected
 }
 
+// scenario: events read through sinsp::next_batch should be the same
+// returned by sinsp::next, in the same order
+TEST_F(sinsp_with_test_input, plugin_custom_source_next_batch)
+{
+	auto src_pl = register_plugin(&m_inspector, get_plugin_api_sample_plugin_source);
+	m_inspector.open_plugin(src_pl->name(), "10");
+
+	uint64_t last_num = 0;
+	uint32_t total = 0;
+	uint32_t nevts = 0;
+	int32_t res = SCAP_SUCCESS;
+	while(res == SCAP_SUCCESS || res == SCAP_TIMEOUT)
+	{
+		res = m_inspector.next_batch(4, [&](sinsp_evt* evt)
+		{
+			ASSERT_EQ(evt->get_type(), PPME_PLUGINEVENT_E);
+			ASSERT_EQ(std::string(evt->get_source_name()), src_pl->event_source());
+			ASSERT_GT(evt->get_num(), last_num);
+			last_num = evt->get_num();
+			total++;
+		}, &nevts);
+		ASSERT_LE(nevts, 4);
+		if(res != SCAP_SUCCESS)
+		{
+			ASSERT_EQ(nevts, 0);
+		}
+	}
+	ASSERT_EQ(res, SCAP_EOF);
+	ASSERT_EQ(total, 10);
+}
+
+// note: parallel instances are read by worker threads
+#if !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+// scenario: more instances of a source plugin opened in parallel should
+// produce all their events in the same stream, merged by timestamp
+TEST_F(sinsp_with_test_input, plugin_custom_source_parallel_instances)
+{
+	auto src_pl = register_plugin(&m_inspector, get_plugin_api_sample_plugin_source);
+
+	// every instance produces timestamps of a distinct residue class
+	const uint64_t ninstances = 4;
+	const uint64_t count = 1000;
+	const uint64_t base_ts = 1566230400000000000;
+	std::vector<std::string> params;
+	for (uint64_t i = 0; i < ninstances; i++)
+	{
+		params.push_back(std::to_string(count) + ":" + std::to_string(base_ts + i) + ":" + std::to_string(ninstances));
+	}
+	m_inspector.open_plugin(src_pl->name(), params);
+
+	uint64_t last_ts = 0;
+	std::set<uint64_t> seen;
+	sinsp_evt* evt = nullptr;
+	int32_t res = SCAP_SUCCESS;
+	while ((res = m_inspector.next(&evt)) != SCAP_EOF)
+	{
+		if (res == SCAP_TIMEOUT)
+		{
+			continue;
+		}
+		ASSERT_EQ(res, SCAP_SUCCESS);
+		ASSERT_EQ(evt->get_type(), PPME_PLUGINEVENT_E);
+		ASSERT_EQ(std::string(evt->get_source_name()), src_pl->event_source());
+
+		// the instances interleave, so the merged stream is fully ordered
+		ASSERT_GT(evt->get_ts(), last_ts);
+		last_ts = evt->get_ts();
+		seen.insert(evt->get_ts());
+	}
+	ASSERT_EQ(seen.size(), ninstances * count);
+
+	uint32_t nstats = 0;
+	int32_t rc = SCAP_FAILURE;
+	auto stats = m_inspector.get_capture_stats_v2(0, &nstats, &rc);
+	ASSERT_EQ(rc, SCAP_SUCCESS);
+	uint64_t instances_evts = 0;
+	for (uint32_t i = 0; i < nstats; i++)
+	{
+		std::string name = stats[i].name;
+		if (name.find("instance") == 0 && name.find(".n_evts") != std::string::npos)
+		{
+			ASSERT_EQ(stats[i].value.u64, count);
+			instances_evts += stats[i].value.u64;
+		}
+	}
+	ASSERT_EQ(instances_evts, ninstances * count);
+}
+
+// scenario: an instance that never has events to read should not hold
+// back the events of the other instances
+TEST_F(sinsp_with_test_input, plugin_custom_source_parallel_instances_idle)
+{
+	auto src_pl = register_plugin(&m_inspector, get_plugin_api_sample_plugin_source);
+	m_inspector.open_plugin(src_pl->name(), std::vector<std::string>{"10", "idle"});
+
+	// the idle instance never reaches EOF
+	uint64_t nevts = 0;
+	sinsp_evt* evt = nullptr;
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+	while (nevts < 10 && std::chrono::steady_clock::now() < deadline)
+	{
+		int32_t res = m_inspector.next(&evt);
+		if (res == SCAP_TIMEOUT)
+		{
+			continue;
+		}
+		ASSERT_EQ(res, SCAP_SUCCESS);
+		ASSERT_EQ(evt->get_type(), PPME_PLUGINEVENT_E);
+		nevts++;
+	}
+	ASSERT_EQ(nevts, 10);
+}
+
+// scenario: a source plugin that doesn't allow concurrent instances
+// can't be opened more than once in parallel
+TEST_F(sinsp_with_test_input, plugin_custom_source_parallel_instances_not_supported)
+{
+	plugin_api api;
+	get_plugin_api_sample_plugin_source(api);
+	api.get_max_concurrent_instances = NULL;
+	auto src_pl = register_plugin_api(&m_inspector, api);
+
+	ASSERT_ANY_THROW(m_inspector.open_plugin(src_pl->name(), std::vector<std::string>{"10", "10"}));
+}
+#endif // !defined(__EMSCRIPTEN__) && !defined(_WIN32)
+
 TEST(sinsp_plugin, plugin_extract_compatibility)
 {
 	std::string tmp;
@@ -641,6 +909,90 @@ TEST_F(sinsp_with_test_input, plugin_tables)
 	ASSERT_EQ(table->entries_count(), 0);
 }
 
+// Scenario: a plugin reads the same fields from all the entries of the thread
+// table both one entry at a time and in bulk, and the results must match.
+TEST_F(sinsp_with_test_input, plugin_tables_bulk)
+{
+	const int64_t num_threads = 5000;
+	add_default_init_thread();
+	for (int64_t tid = 2; tid <= num_threads; tid++)
+	{
+		add_simple_thread(tid, tid, 1, "thread" + std::to_string(tid));
+	}
+
+	filter_check_list pl_flist;
+	auto pl = register_plugin(&m_inspector, get_plugin_api_sample_tables_bulk);
+	add_plugin_filterchecks(&m_inspector, pl, sinsp_syscall_event_source_name, pl_flist);
+	open_inspector();
+
+	uint64_t expected = 0;
+	m_inspector.m_thread_manager->get_threads()->loop([&expected](sinsp_threadinfo& tinfo)
+	{
+		expected += (uint64_t) tinfo.m_tid + (uint64_t) tinfo.m_pid + (uint64_t) tinfo.m_ptid
+			+ tinfo.m_comm.size() + tinfo.m_exe.size();
+		return true;
+	});
+	ASSERT_EQ(m_inspector.m_thread_manager->get_thread_count(), num_threads);
+
+	auto evt = add_event_advance_ts(increasing_ts(), 1, PPME_SYSCALL_GETUID_X, 1, (uint32_t) 0);
+	ASSERT_EQ(get_field_as_string(evt, "bulk.sum_single", pl_flist), std::to_string(expected));
+	ASSERT_EQ(get_field_as_string(evt, "bulk.sum_batch", pl_flist), std::to_string(expected));
+}
+
+// compare the time spent by a plugin reading the thread table one entry at
+// a time and in bulk
+/* Benchmark, run it with `--gtest_also_run_disabled_tests` */
+TEST_F(sinsp_with_test_input, DISABLED_plugin_tables_bulk_benchmark)
+{
+	const int64_t num_threads = 5000;
+	add_default_init_thread();
+	for (int64_t tid = 2; tid <= num_threads; tid++)
+	{
+		add_simple_thread(tid, tid, 1, "thread" + std::to_string(tid));
+	}
+
+	filter_check_list pl_flist;
+	auto pl = register_plugin(&m_inspector, get_plugin_api_sample_tables_bulk);
+	add_plugin_filterchecks(&m_inspector, pl, sinsp_syscall_event_source_name, pl_flist);
+	open_inspector();
+
+	uint64_t expected = 0;
+	m_inspector.m_thread_manager->get_threads()->loop([&expected](sinsp_threadinfo& tinfo)
+	{
+		expected += (uint64_t) tinfo.m_tid + (uint64_t) tinfo.m_pid + (uint64_t) tinfo.m_ptid
+			+ tinfo.m_comm.size() + tinfo.m_exe.size();
+		return true;
+	});
+	ASSERT_EQ(m_inspector.m_thread_manager->get_thread_count(), num_threads);
+
+	auto evt = add_event_advance_ts(increasing_ts(), 1, PPME_SYSCALL_GETUID_X, 1, (uint32_t) 0);
+
+	ss_plugin_extract_field fields[2] = {};
+	for (uint32_t i = 0; i < 2; i++)
+	{
+		fields[i].field_id = i;
+		fields[i].field = pl->fields()[i].m_name;
+		fields[i].ftype = pl->fields()[i].m_type;
+	}
+
+	const int num_scans = 200;
+	std::chrono::nanoseconds times[2] = {};
+	for (int n = 0; n < num_scans; n++)
+	{
+		for (uint32_t i = 0; i < 2; i++)
+		{
+			auto start = std::chrono::steady_clock::now();
+			ASSERT_TRUE(pl->extract_fields(evt, 1, &fields[i]));
+			times[i] += std::chrono::steady_clock::now() - start;
+			ASSERT_EQ(fields[i].res.u64[0], expected);
+		}
+	}
+
+	auto rate = [&](std::chrono::nanoseconds t) { return t.count() > 0 ? (double)num_scans * num_threads * 1000 / t.count() : 0; };
+	printf("[ INFO     ] %" PRId64 " threads: per-entry reads %.2f Mentries/s, bulk reads %.2f Mentries/s\n",
+	       num_threads, rate(times[0]), rate(times[1]));
+}
+
 // Scenario: we load a plugin expecting it to log
 // when it's initialized and destroyed.
 // We use a callback attached to the logger to assert the message.
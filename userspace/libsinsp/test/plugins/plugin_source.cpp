@@ -42,6 +42,9 @@ struct plugin_state
 struct instance_state
 {
     uint64_t count;
+    uint64_t ts;
+    uint64_t ts_step;
+    bool idle;
     uint8_t evt_buf[2048];
     ss_plugin_event* evt;
 };
@@ -113,11 +116,22 @@ static ss_instance_t* plugin_open(ss_plugin_t* s, const char* params, ss_plugin_
     instance_state *ret = new instance_state();
     ret->evt = (ss_plugin_event*) &ret->evt_buf;
     ret->count = 10000;
+    ret->ts = UINT64_MAX;
+    ret->ts_step = 0;
+    // "idle" opens an instance that never has events to read
+    ret->idle = strcmp(params, "idle") == 0;
+    // params format: "<count>[:<first_ts>:<ts_step>]"
     auto count = atoi(params);
     if (count > 0)
     {
         ret->count = (uint64_t) count;
     }
+    unsigned long long first_ts = 0, ts_step = 0;
+    if (sscanf(params, "%*d:%llu:%llu", &first_ts, &ts_step) == 2)
+    {
+        ret->ts = (uint64_t) first_ts;
+        ret->ts_step = (uint64_t) ts_step;
+    }
 
     *rc = SS_PLUGIN_SUCCESS;
     return ret;
@@ -132,6 +146,12 @@ static ss_plugin_rc plugin_next_batch(ss_plugin_t* s, ss_instance_t* i, uint32_t
 {
     instance_state *istate = (instance_state *) i;
 
+    if (istate->idle)
+    {
+        *nevts = 0;
+        return SS_PLUGIN_TIMEOUT;
+    }
+
     if (istate->count == 0)
     {
         *nevts = 0;
@@ -153,12 +173,22 @@ static ss_plugin_rc plugin_next_batch(ss_plugin_t* s, ss_instance_t* i, uint32_t
     }
 
     istate->evt->tid = -1;
-    istate->evt->ts = UINT64_MAX;
+    istate->evt->ts = istate->ts;
+    if (istate->ts != UINT64_MAX)
+    {
+        istate->ts += istate->ts_step;
+    }
 
     istate->count--;
     return SS_PLUGIN_SUCCESS;
 }
 
+// next_batch only touches the state of its instance
+static uint32_t plugin_get_max_concurrent_instances(ss_plugin_t* s)
+{
+    return 16;
+}
+
 void get_plugin_api_sample_plugin_source(plugin_api& out)
 {
     memset(&out, 0, sizeof(plugin_api));
@@ -175,4 +205,5 @@ void get_plugin_api_sample_plugin_source(plugin_api& out)
     out.open = plugin_open;
     out.close = plugin_close;
     out.next_batch = plugin_next_batch;
+    out.get_max_concurrent_instances = plugin_get_max_concurrent_instances;
 }
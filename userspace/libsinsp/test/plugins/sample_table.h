@@ -282,6 +282,10 @@ public:
         ret->reader_ext->read_entry_field = read_entry_field;
         ret->reader_ext->release_table_entry = release_table_entry;
         ret->reader_ext->iterate_entries = iterate_entries;
+        // the bulk read functions are optional, and libsinsp falls back
+        // to the per-entry ones when they are not implemented
+        ret->reader_ext->read_entries_fields = NULL;
+        ret->reader_ext->iterate_entries_batch = NULL;
         ret->reader.get_table_name = ret->reader_ext->get_table_name;
         ret->reader.get_table_size = ret->reader_ext->get_table_size;
         ret->reader.get_table_entry = ret->reader_ext->get_table_entry;
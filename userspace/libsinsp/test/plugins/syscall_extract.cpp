@@ -19,6 +19,8 @@ limitations under the License.
 #include <cstdio>
 #include <cstdlib>
 #include <sstream>
+#include <string>
+#include <vector>
 
 #include <driver/ppm_events_public.h>
 
@@ -35,9 +37,10 @@ limitations under the License.
 struct plugin_state
 {
     std::string lasterr;
-    uint64_t u64storage;
-    std::string strstorage;
-    const char* strptrstorage;
+    // every field extracted in the same call has its own storage
+    std::vector<uint64_t> u64storage;
+    std::vector<std::string> strstorage;
+    std::vector<const char*> strptrstorage;
     ss_plugin_table_t* thread_table;
     ss_plugin_table_field_t* thread_comm_field;
     ss_plugin_table_field_t* thread_opencount_field;
@@ -250,13 +253,16 @@ static ss_plugin_rc plugin_extract_fields(ss_plugin_t *s, const ss_plugin_event_
     ss_plugin_table_entry_t* thread = NULL;
     ss_plugin_table_entry_t* evtcount = NULL;
     plugin_state *ps = (plugin_state *) s;
+    ps->u64storage.resize(in->num_fields);
+    ps->strstorage.resize(in->num_fields);
+    ps->strptrstorage.resize(in->num_fields);
     for (uint32_t i = 0; i < in->num_fields; i++)
     {
         switch(in->fields[i].field_id)
         {
             case 0: // sample.is_open
-                ps->u64storage = evt_type_is_open(ev->evt->type);
-                in->fields[i].res.u64 = &ps->u64storage;
+                ps->u64storage[i] = evt_type_is_open(ev->evt->type);
+                in->fields[i].res.u64 = &ps->u64storage[i];
                 in->fields[i].res_len = 1;
                 break;
             case 1: // sample.open_count
@@ -282,8 +288,8 @@ static ss_plugin_rc plugin_extract_fields(ss_plugin_t *s, const ss_plugin_event_
                     in->table_reader_ext->release_table_entry(ps->thread_table, thread);
                     return SS_PLUGIN_FAILURE;
                 }
-                ps->u64storage = tmp.u64;
-                in->fields[i].res.u64 = &ps->u64storage;
+                ps->u64storage[i] = tmp.u64;
+                in->fields[i].res.u64 = &ps->u64storage[i];
                 in->fields[i].res_len = 1;
                 in->table_reader_ext->release_table_entry(ps->thread_table, thread);
                 break;
@@ -317,10 +323,10 @@ static ss_plugin_rc plugin_extract_fields(ss_plugin_t *s, const ss_plugin_event_
                 if (!evtcount)
                 {
                     // stubbing the counter to 0 if no entry exists
-                    ps->u64storage = 0;
-                    in->fields[i].res.u64 = &ps->u64storage;
+                    ps->u64storage[i] = 0;
+                    in->fields[i].res.u64 = &ps->u64storage[i];
                     in->fields[i].res_len = 1;
-                    return SS_PLUGIN_SUCCESS;
+                    break;
                 }
                 rc = in->table_reader.read_entry_field(ps->evtcount_table, evtcount, ps->evtcount_count_field, &tmp);
                 if (rc != SS_PLUGIN_SUCCESS)
@@ -330,8 +336,8 @@ static ss_plugin_rc plugin_extract_fields(ss_plugin_t *s, const ss_plugin_event_
                     in->table_reader_ext->release_table_entry(ps->evtcount_table, evtcount);
                     return SS_PLUGIN_FAILURE;
                 }
-                ps->u64storage = tmp.u64;
-                in->fields[i].res.u64 = &ps->u64storage;
+                ps->u64storage[i] = tmp.u64;
+                in->fields[i].res.u64 = &ps->u64storage[i];
                 in->fields[i].res_len = 1;
                 in->table_reader_ext->release_table_entry(ps->evtcount_table, evtcount);
                 break;
@@ -352,9 +358,9 @@ static ss_plugin_rc plugin_extract_fields(ss_plugin_t *s, const ss_plugin_event_
                     in->table_reader_ext->release_table_entry(ps->thread_table, thread);
                     return SS_PLUGIN_FAILURE;
                 }
-                ps->strstorage = std::string(tmp.str);
-                ps->strptrstorage = ps->strstorage.c_str();
-                in->fields[i].res.str = &ps->strptrstorage;
+                ps->strstorage[i] = std::string(tmp.str);
+                ps->strptrstorage[i] = ps->strstorage[i].c_str();
+                in->fields[i].res.str = &ps->strptrstorage[i];
                 in->fields[i].res_len = 1;
                 in->table_reader_ext->release_table_entry(ps->thread_table, thread);
                 break;
@@ -362,14 +368,14 @@ static ss_plugin_rc plugin_extract_fields(ss_plugin_t *s, const ss_plugin_event_
                 if (ev->evt->type == PPME_ASYNCEVENT_E
                     && strcmp("sampleticker", get_async_event_name(ev->evt)) == 0)
                 {
-                    ps->strstorage = "true";
+                    ps->strstorage[i] = "true";
                 }
                 else
                 {
-                    ps->strstorage = "false";
+                    ps->strstorage[i] = "false";
                 }
-                ps->strptrstorage = ps->strstorage.c_str();
-                in->fields[i].res.str = &ps->strptrstorage;
+                ps->strptrstorage[i] = ps->strstorage[i].c_str();
+                in->fields[i].res.str = &ps->strptrstorage[i];
                 in->fields[i].res_len = 1;
                 break;
             default:
@@ -380,6 +386,12 @@ static ss_plugin_rc plugin_extract_fields(ss_plugin_t *s, const ss_plugin_event_
     return SS_PLUGIN_SUCCESS;
 }
 
+// every field has its own result storage
+static ss_plugin_bool plugin_get_extract_batch_support(ss_plugin_t* s)
+{
+    return true;
+}
+
 void get_plugin_api_sample_syscall_extract(plugin_api& out)
 {
     memset(&out, 0, sizeof(plugin_api));
@@ -395,4 +407,5 @@ void get_plugin_api_sample_syscall_extract(plugin_api& out)
     out.get_extract_event_sources = plugin_get_extract_event_sources;
     out.get_extract_event_types = plugin_get_extract_event_types;
     out.extract_fields = plugin_extract_fields;
+    out.get_extract_batch_support = plugin_get_extract_batch_support;
 }
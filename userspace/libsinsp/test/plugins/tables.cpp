@@ -488,6 +488,97 @@ static ss_plugin_rc plugin_parse_event(ss_plugin_t *s, const ss_plugin_event_inp
 		}
 	}
 
+	// loop over all threads in chunks and read their fields in bulk
+	step++;
+	{
+		struct iterate_batch_state
+		{
+			int* step = nullptr;
+			uint64_t count = 0;
+			uint64_t chunks = 0;
+			const ss_plugin_event_parse_input *in = nullptr;
+			plugin_state* ps = nullptr;
+		};
+
+		auto it1 = [](ss_plugin_table_iterator_state_t* s, ss_plugin_table_entry_t** e, uint32_t n) -> ss_plugin_bool
+		{
+			auto st = (iterate_batch_state*) s;
+			st->count += n;
+			st->chunks++;
+
+			const uint32_t nfields = 2;
+			const ss_plugin_table_field_t* fields[nfields] = {st->ps->thread_static_field, st->ps->thread_dynamic_field};
+			ss_plugin_state_data vals[16 * nfields];
+			if (n == 0 || n > 16)
+			{
+				fprintf(stderr, "table_reader.iterate_entries_batch (%d) unexpected chunk size: %u\n", (*st->step), n);
+				exit(1);
+			}
+			if (SS_PLUGIN_SUCCESS != st->in->table_reader_ext->read_entries_fields(st->ps->thread_table, e, n, fields, nfields, vals))
+			{
+				fprintf(stderr, "table_reader.read_entries_fields (%d) failure: %s\n", (*st->step), st->in->get_owner_last_error(st->in->owner));
+				exit(1);
+			}
+			for (uint32_t i = 0; i < n; i++)
+			{
+				if (strcmp(vals[i * nfields].str, "init") != 0 && strcmp(vals[i * nfields].str, "hello") != 0)
+				{
+					fprintf(stderr, "table_reader.read_entries_fields (%d) unexpected value: %s\n", (*st->step), vals[i * nfields].str);
+					exit(1);
+				}
+				if (vals[i * nfields + 1].u64 != 5)
+				{
+					fprintf(stderr, "table_reader.read_entries_fields (%d) inconsistency\n", (*st->step));
+					exit(1);
+				}
+			}
+			return 1;
+		};
+
+		// one entry per chunk
+		iterate_batch_state its1;
+		its1.in = in;
+		its1.ps = ps;
+		its1.step = &step;
+		if (in->table_reader_ext->iterate_entries_batch(ps->thread_table, it1, 1, (ss_plugin_table_iterator_state_t*) &its1) != 1)
+		{
+			fprintf(stderr, "table_reader.iterate_entries_batch (%d) unexpected break-out\n", step);
+			exit(1);
+		}
+		if (its1.count != 2 || its1.chunks != 2)
+		{
+			fprintf(stderr, "table_reader.iterate_entries_batch (%d) unexpected count result\n", step);
+			exit(1);
+		}
+
+		// all entries in a single chunk
+		iterate_batch_state its2;
+		its2.in = in;
+		its2.ps = ps;
+		its2.step = &step;
+		if (in->table_reader_ext->iterate_entries_batch(ps->thread_table, it1, 16, (ss_plugin_table_iterator_state_t*) &its2) != 1)
+		{
+			fprintf(stderr, "table_reader.iterate_entries_batch (%d) unexpected break-out\n", step);
+			exit(1);
+		}
+		if (its2.count != 2 || its2.chunks != 1)
+		{
+			fprintf(stderr, "table_reader.iterate_entries_batch (%d) unexpected count result\n", step);
+			exit(1);
+		}
+
+		// iteration with break-out
+		auto it2 = [](ss_plugin_table_iterator_state_t* s, ss_plugin_table_entry_t** e, uint32_t n) -> ss_plugin_bool
+		{
+			return false;
+		};
+		if (in->table_reader_ext->iterate_entries_batch(ps->thread_table, it2, 1, (ss_plugin_table_iterator_state_t*) &its1) != 0)
+		{
+			fprintf(stderr, "table_reader.iterate_entries_batch (%d) break-out was expected\n", step);
+			exit(1);
+		}
+	}
+
 	// erase newly-created thread
 	step++;
 	{
@@ -0,0 +1,236 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2023 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+*/
+
+#include <cstring>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#include <driver/ppm_events_public.h>
+#include "test_plugins.h"
+
+/**
+ * Example of plugin that implements the field extraction capability and that
+ * scans the whole thread table to compute its fields. The same fields are
+ * read both one entry at a time and in bulk, so that the two access
+ * patterns of the table API can be compared against each other.
+ */
+#define BULK_MAX_BATCH 64
+#define BULK_NUM_FIELDS 5
+
+struct plugin_state
+{
+	std::string lasterr;
+	ss_plugin_table_t* thread_table;
+	const ss_plugin_table_field_t* fields[BULK_NUM_FIELDS];
+	uint64_t u64storage;
+};
+
+static const char* plugin_get_required_api_version()
+{
+	return PLUGIN_API_VERSION_STR;
+}
+
+static const char* plugin_get_version()
+{
+	return "0.1.0";
+}
+
+static const char* plugin_get_name()
+{
+	return "sample_tables_bulk";
+}
+
+static const char* plugin_get_description()
+{
+	return "some desc";
+}
+
+static const char* plugin_get_contact()
+{
+	return "some contact";
+}
+
+static const char* plugin_get_fields()
+{
+	return R"(
+[
+	{
+		"type": "uint64",
+		"name": "bulk.sum_single",
+		"desc": "Checksum of some fields of all threads, reading one entry at a time"
+	},
+	{
+		"type": "uint64",
+		"name": "bulk.sum_batch",
+		"desc": "Checksum of some fields of all threads, reading entries in bulk"
+	}
+])";
+}
+
+static const char* plugin_get_extract_event_sources()
+{
+	return "[\"syscall\"]";
+}
+
+static ss_plugin_t* plugin_init(const ss_plugin_init_input* in, ss_plugin_rc* rc)
+{
+	*rc = SS_PLUGIN_SUCCESS;
+	plugin_state *ret = new plugin_state();
+
+	if (!in || !in->tables)
+	{
+		*rc = SS_PLUGIN_FAILURE;
+		ret->lasterr = "invalid config input";
+		return ret;
+	}
+
+	ret->thread_table = in->tables->get_table(
+		in->owner, "threads", ss_plugin_state_type::SS_PLUGIN_ST_INT64);
+	if (!ret->thread_table)
+	{
+		*rc = SS_PLUGIN_FAILURE;
+		auto err = in->get_owner_last_error(in->owner);
+		ret->lasterr = err ? err : "can't access thread table";
+		return ret;
+	}
+
+	const char* names[BULK_NUM_FIELDS] = {"tid", "pid", "ptid", "comm", "exe"};
+	ss_plugin_state_type types[BULK_NUM_FIELDS] = {
+		ss_plugin_state_type::SS_PLUGIN_ST_INT64,
+		ss_plugin_state_type::SS_PLUGIN_ST_INT64,
+		ss_plugin_state_type::SS_PLUGIN_ST_INT64,
+		ss_plugin_state_type::SS_PLUGIN_ST_STRING,
+		ss_plugin_state_type::SS_PLUGIN_ST_STRING,
+	};
+	for (int i = 0; i < BULK_NUM_FIELDS; i++)
+	{
+		ret->fields[i] = in->tables->fields_ext->get_table_field(ret->thread_table, names[i], types[i]);
+		if (!ret->fields[i])
+		{
+			*rc = SS_PLUGIN_FAILURE;
+			auto err = in->get_owner_last_error(in->owner);
+			ret->lasterr = err ? err : ("can't get field in thread table: " + std::string(names[i]));
+			return ret;
+		}
+	}
+	return ret;
+}
+
+static void plugin_destroy(ss_plugin_t* s)
+{
+	delete ((plugin_state *) s);
+}
+
+static const char* plugin_get_last_error(ss_plugin_t* s)
+{
+	return ((plugin_state *) s)->lasterr.c_str();
+}
+
+struct checksum_state
+{
+	plugin_state* ps;
+	const ss_plugin_field_extract_input* in;
+	uint64_t sum;
+	bool failed;
+};
+
+static inline uint64_t checksum_add(const ss_plugin_state_data* vals)
+{
+	return (uint64_t) vals[0].s64 + (uint64_t) vals[1].s64 + (uint64_t) vals[2].s64
+		+ strlen(vals[3].str) + strlen(vals[4].str);
+}
+
+static ss_plugin_bool checksum_single(ss_plugin_table_iterator_state_t* s, ss_plugin_table_entry_t* e)
+{
+	auto st = (checksum_state*) s;
+	ss_plugin_state_data vals[BULK_NUM_FIELDS];
+	for (int i = 0; i < BULK_NUM_FIELDS; i++)
+	{
+		if (SS_PLUGIN_SUCCESS != st->in->table_reader_ext->read_entry_field(st->ps->thread_table, e, st->ps->fields[i], &vals[i]))
+		{
+			st->failed = true;
+			return 0;
+		}
+	}
+	st->sum += checksum_add(vals);
+	return 1;
+}
+
+static ss_plugin_bool checksum_batch(ss_plugin_table_iterator_state_t* s, ss_plugin_table_entry_t** e, uint32_t n)
+{
+	auto st = (checksum_state*) s;
+	ss_plugin_state_data vals[BULK_MAX_BATCH * BULK_NUM_FIELDS];
+	if (SS_PLUGIN_SUCCESS != st->in->table_reader_ext->read_entries_fields(st->ps->thread_table, e, n, st->ps->fields, BULK_NUM_FIELDS, vals))
+	{
+		st->failed = true;
+		return 0;
+	}
+	for (uint32_t i = 0; i < n; i++)
+	{
+		st->sum += checksum_add(&vals[i * BULK_NUM_FIELDS]);
+	}
+	return 1;
+}
+
+static ss_plugin_rc plugin_extract_fields(ss_plugin_t *s, const ss_plugin_event_input *ev, const ss_plugin_field_extract_input* in)
+{
+	plugin_state *ps = (plugin_state *) s;
+	for (uint32_t i = 0; i < in->num_fields; i++)
+	{
+		checksum_state st{ps, in, 0, false};
+		switch(in->fields[i].field_id)
+		{
+			case 0: // bulk.sum_single
+				in->table_reader_ext->iterate_entries(ps->thread_table, checksum_single, &st);
+				break;
+			case 1: // bulk.sum_batch
+				in->table_reader_ext->iterate_entries_batch(ps->thread_table, checksum_batch, BULK_MAX_BATCH, &st);
+				break;
+			default:
+				in->fields[i].res_len = 0;
+				return SS_PLUGIN_FAILURE;
+		}
+		if (st.failed)
+		{
+			auto err = in->get_owner_last_error(in->owner);
+			ps->lasterr = err ? err : "can't read fields from thread table";
+			in->fields[i].res_len = 0;
+			return SS_PLUGIN_FAILURE;
+		}
+		ps->u64storage = st.sum;
+		in->fields[i].res.u64 = &ps->u64storage;
+		in->fields[i].res_len = 1;
+	}
+	return SS_PLUGIN_SUCCESS;
+}
+
+void get_plugin_api_sample_tables_bulk(plugin_api& out)
+{
+	memset(&out, 0, sizeof(plugin_api));
+	out.get_required_api_version = plugin_get_required_api_version;
+	out.get_version = plugin_get_version;
+	out.get_description = plugin_get_description;
+	out.get_contact = plugin_get_contact;
+	out.get_name = plugin_get_name;
+	out.get_last_error = plugin_get_last_error;
+	out.init = plugin_init;
+	out.destroy = plugin_destroy;
+	out.get_fields = plugin_get_fields;
+	out.get_extract_event_sources = plugin_get_extract_event_sources;
+	out.extract_fields = plugin_extract_fields;
+}
@@ -21,6 +21,9 @@ limitations under the License.
 
 #include <gtest/gtest.h>
 
+#include <chrono>
+#include <vector>
+
 using namespace std;
 
 #ifdef __x86_64__
@@ -181,4 +184,145 @@ TEST(savefile, cycledumper_seconds)
 
 	unlink(capture_scap);
 }
+
+struct read_evt
+{
+	uint64_t num;
+	uint16_t type;
+	uint64_t ts;
+	int64_t tid;
+
+	bool operator==(const read_evt& o) const
+	{
+		return num == o.num && type == o.type && ts == o.ts && tid == o.tid;
+	}
+};
+
+static std::vector<read_evt> read_sample(uint32_t batch_size)
+{
+	std::vector<read_evt> evts;
+	sinsp inspector;
+	inspector.open_savefile(RESOURCE_DIR "/sample.scap");
+
+	auto on_evt = [&](sinsp_evt* evt)
+	{
+		evts.push_back({evt->get_num(), evt->get_type(), evt->get_ts(), evt->get_tid()});
+	};
+
+	int32_t res;
+	do
+	{
+		if(batch_size == 0)
+		{
+			sinsp_evt* evt = nullptr;
+			res = inspector.next(&evt);
+			if(res == SCAP_SUCCESS)
+			{
+				on_evt(evt);
+			}
+		}
+		else
+		{
+			uint32_t n = 0;
+			res = inspector.next_batch(batch_size, on_evt, &n);
+			EXPECT_LE(n, batch_size);
+			if(res != SCAP_SUCCESS)
+			{
+				EXPECT_EQ(n, 0);
+			}
+		}
+		EXPECT_NE(res, SCAP_FAILURE);
+	}
+	while(res != SCAP_EOF && res != SCAP_FAILURE);
+
+	inspector.close();
+	return evts;
+}
+
+TEST(savefile, next_batch)
+{
+	std::vector<read_evt> expected = read_sample(0);
+	ASSERT_GT(expected.size(), 0);
+
+	for(uint32_t batch_size : {1, 7, 256})
+	{
+		ASSERT_EQ(read_sample(batch_size), expected) << "batch size " << batch_size;
+	}
+}
+
+// read the sample capture in batches with a given number of pre-parse
+// workers, and return a digest of the parsed events params
+static uint64_t preparse_read(uint32_t nworkers, uint32_t passes, uint64_t& nevts, double& rate)
+{
+	uint64_t digest = 0;
+	nevts = 0;
+	uint64_t elapsed = 0;
+	for(uint32_t p = 0; p < passes; p++)
+	{
+		sinsp inspector;
+		inspector.set_preparse_workers(nworkers);
+		inspector.open_savefile(RESOURCE_DIR "/sample.scap");
+
+		auto start = std::chrono::steady_clock::now();
+		int32_t res;
+		do
+		{
+			uint32_t n = 0;
+			res = inspector.next_batch(256, [&](sinsp_evt* evt)
+			{
+				digest = digest * 31 + evt->get_type();
+				for(uint32_t i = 0; i < evt->get_num_params(); i++)
+				{
+					const sinsp_evt_param* param = evt->get_param(i);
+					digest = digest * 31 + std::hash<std::string_view>{}(std::string_view(param->m_val, param->m_len));
+				}
+				nevts++;
+			}, &n);
+			EXPECT_NE(res, SCAP_FAILURE);
+		}
+		while(res != SCAP_EOF);
+		elapsed += std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+
+		EXPECT_EQ(inspector.get_preparse_workers(), nworkers);
+		inspector.close();
+	}
+	rate = elapsed > 0 ? (double)nevts / elapsed : 0;
+	return digest;
+}
+
+TEST(savefile, preparse_pipeline)
+{
+	uint64_t base_nevts = 0;
+	double base_rate = 0;
+	uint64_t base_digest = preparse_read(0, 1, base_nevts, base_rate);
+	ASSERT_GT(base_nevts, 0);
+
+	for(uint32_t nworkers : {1, 2, 4})
+	{
+		uint64_t nevts = 0;
+		double rate = 0;
+		ASSERT_EQ(preparse_read(nworkers, 1, nevts, rate), base_digest);
+		ASSERT_EQ(nevts, base_nevts);
+	}
+}
+
+/* Benchmark, run it with `--gtest_also_run_disabled_tests` */
+TEST(savefile, DISABLED_preparse_pipeline_scaling)
+{
+	const uint32_t passes = 10;
+	uint64_t base_nevts = 0;
+	double base_rate = 0;
+	uint64_t base_digest = preparse_read(0, passes, base_nevts, base_rate);
+	ASSERT_GT(base_nevts, 0);
+	printf("[ INFO     ] pre-parse workers: 0, %.2f Mevt/s\n", base_rate);
+
+	for(uint32_t nworkers : {1, 2, 4})
+	{
+		uint64_t nevts = 0;
+		double rate = 0;
+		ASSERT_EQ(preparse_read(nworkers, passes, nevts, rate), base_digest);
+		ASSERT_EQ(nevts, base_nevts);
+		printf("[ INFO     ] pre-parse workers: %u, %.2f Mevt/s\n", nworkers, rate);
+	}
+}
 #endif
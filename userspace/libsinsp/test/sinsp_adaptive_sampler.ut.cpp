@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/sinsp_adaptive_sampler.h>
+#include <libsinsp/events/sinsp_events.h>
+#include <gtest/gtest.h>
+
+#include <map>
+
+using sampler = libsinsp::sinsp_adaptive_sampler;
+
+static constexpr uint64_t interval = 1000000000;
+
+TEST(sinsp_adaptive_sampler, categories)
+{
+	sampler s([](ppm_sc_code, uint32_t) {}, {});
+
+	auto state_sc = libsinsp::events::sinsp_state_sc_set();
+	for(uint32_t c = 0; c < sampler::CATEGORY_MAX; c++)
+	{
+		ASSERT_FALSE(s.get_category_sc((sampler::category)c).empty());
+		for(auto sc : s.get_category_sc((sampler::category)c))
+		{
+			// state syscalls must never be sampled
+			ASSERT_FALSE(state_sc.contains(sc));
+		}
+		ASSERT_EQ(s.get_ratio((sampler::category)c), 1);
+	}
+}
+
+TEST(sinsp_adaptive_sampler, increase_on_drops)
+{
+	std::map<ppm_sc_code, uint32_t> applied;
+	sampler s([&](ppm_sc_code sc, uint32_t ratio) { applied[sc] = ratio; }, {});
+
+	// first update only records the baseline drop counter
+	ASSERT_FALSE(s.update(0, 100, 0));
+	ASSERT_TRUE(applied.empty());
+
+	// write events dominate, drops increased
+	s.count_event(PPME_SYSCALL_WRITE_X);
+	s.count_event(PPME_SYSCALL_WRITE_X);
+	s.count_event(PPME_SYSCALL_READ_X);
+	ASSERT_TRUE(s.is_update_due(interval));
+	ASSERT_TRUE(s.update(interval, 200, 0));
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_WRITE), 2);
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_READ), 1);
+	ASSERT_EQ(applied[PPM_SC_WRITE], 2);
+	ASSERT_EQ(applied.count(PPM_SC_READ), 0);
+	ASSERT_EQ(s.get_n_adjustments(), 1);
+	ASSERT_FALSE(s.is_update_due(interval + 1));
+}
+
+TEST(sinsp_adaptive_sampler, watermarks)
+{
+	sampler::config cfg;
+	cfg.buffer_bytes_dim = 1000;
+	cfg.max_ratio = 4;
+	cfg.relax_intervals = 2;
+	sampler s([](ppm_sc_code, uint32_t) {}, cfg);
+
+	// buffer above the high watermark, no drops
+	s.count_event(PPME_SYSCALL_READ_X);
+	ASSERT_TRUE(s.update(0, 0, 800));
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_READ), 2);
+	s.count_event(PPME_SYSCALL_READ_X);
+	ASSERT_TRUE(s.update(interval, 0, 800));
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_READ), 4);
+
+	// read is at max ratio, the write category is thinned next
+	s.count_event(PPME_SYSCALL_READ_X);
+	ASSERT_TRUE(s.update(2 * interval, 0, 800));
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_READ), 4);
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_WRITE), 2);
+
+	// between the watermarks nothing changes
+	ASSERT_FALSE(s.update(3 * interval, 0, 500));
+	ASSERT_FALSE(s.update(4 * interval, 0, 500));
+
+	// below the low watermark ratios are relaxed every relax_intervals
+	ASSERT_FALSE(s.update(5 * interval, 0, 100));
+	ASSERT_TRUE(s.update(6 * interval, 0, 100));
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_READ), 2);
+	ASSERT_FALSE(s.update(7 * interval, 0, 100));
+	ASSERT_TRUE(s.update(8 * interval, 0, 100));
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_READ), 1);
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_WRITE), 2);
+
+	s.reset();
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_READ), 1);
+	ASSERT_EQ(s.get_ratio(sampler::CATEGORY_IO_WRITE), 1);
+}
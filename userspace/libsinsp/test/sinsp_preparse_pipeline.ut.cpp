@@ -0,0 +1,161 @@
+// SPDX-License-Identifier: Apache-2.0
+/*
+Copyright (C) 2024 The Khulnasoft Authors.
+
+Licensed under the Apache License, Version 2.0 (the "License");
+you may not use this file except in compliance with the License.
+You may obtain a copy of the License at
+
+    http://www.apache.org/licenses/LICENSE-2.0
+
+Unless required by applicable law or agreed to in writing, software
+distributed under the License is distributed on an "AS IS" BASIS,
+WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+See the License for the specific language governing permissions and
+limitations under the License.
+
+*/
+
+#include <libsinsp/sinsp_preparse_pipeline.h>
+#include <libsinsp/sinsp.h>
+#include <gtest/gtest.h>
+
+#include <memory>
+#include <vector>
+
+// note: emscripten does not support launching threads
+#ifndef __EMSCRIPTEN__
+
+namespace
+{
+using scap_evt_buf = std::unique_ptr<uint8_t[]>;
+
+scap_evt_buf encode_open_x(int64_t fd, const char* name, uint32_t flags)
+{
+	char error[SCAP_LASTERR_SIZE];
+	size_t size = 0;
+	scap_event_encode_params(scap_sized_buffer{nullptr, 0}, &size, error,
+		PPME_SYSCALL_OPEN_X, 6, fd, name, flags, (uint32_t)0755, (uint32_t)0, (uint64_t)fd);
+	scap_evt_buf buf(new uint8_t[size]);
+	EXPECT_EQ(scap_event_encode_params(scap_sized_buffer{buf.get(), size}, &size, error,
+		PPME_SYSCALL_OPEN_X, 6, fd, name, flags, (uint32_t)0755, (uint32_t)0, (uint64_t)fd), SCAP_SUCCESS) << error;
+	return buf;
+}
+
+std::vector<scap_batch_evt> make_batch(const std::vector<scap_evt_buf>& bufs)
+{
+	std::vector<scap_batch_evt> batch;
+	for(const auto& b : bufs)
+	{
+		batch.push_back(scap_batch_evt{(scap_evt*)b.get(), 0, 0});
+	}
+	return batch;
+}
+
+// load an event the way the parser does and check that its params are the
+// ones of the scap event, no matter if they were decoded ahead of time
+void check_event_params(sinsp_evt& evt, int64_t fd, const char* name)
+{
+	evt.init();
+	ASSERT_EQ(evt.get_num_params(), 6);
+	ASSERT_EQ(evt.get_param(0)->m_evt, &evt);
+	ASSERT_EQ(evt.get_param(0)->as<int64_t>(), fd);
+	ASSERT_STREQ(evt.get_param(1)->as<std::string_view>().data(), name);
+	ASSERT_EQ(evt.get_param(5)->as<uint64_t>(), (uint64_t)fd);
+}
+}
+
+TEST(sinsp_preparse_pipeline, params_match_lazy_loading)
+{
+	const uint32_t nevts = 512;
+	std::vector<scap_evt_buf> bufs;
+	for(uint32_t i = 0; i < nevts; i++)
+	{
+		// empty paths must be normalized to <NA> on the workers too
+		bufs.push_back(encode_open_x(i, (i % 3) ? "/etc/passwd" : nullptr, 0));
+	}
+	auto batch = make_batch(bufs);
+
+	sinsp_evt evt;
+	libsinsp::sinsp_preparse_pipeline p(&evt, 4);
+	ASSERT_EQ(p.get_num_workers(), 4);
+
+	for(int round = 0; round < 2; round++)
+	{
+		p.begin_batch(batch.data(), nevts);
+
+		// in the first round the workers decode the whole batch,
+		// the second one races with them
+		if(round == 0)
+		{
+			p.wait_batch_preparsed();
+		}
+
+		for(uint32_t i = 0; i < nevts; i++)
+		{
+			evt.set_scap_evt(batch[i].evt);
+			p.consume(i, &evt);
+			check_event_params(evt, i, (i % 3) ? "/etc/passwd" : "<NA>");
+		}
+		p.end_batch();
+	}
+
+	ASSERT_GE(p.get_n_preparsed(), nevts);
+	ASSERT_LE(p.get_n_preparsed() + p.get_n_inline(), 2 * nevts);
+}
+
+TEST(sinsp_preparse_pipeline, stale_params_not_adopted)
+{
+	std::vector<scap_evt_buf> bufs;
+	bufs.push_back(encode_open_x(3, "/tmp/a", 0));
+	bufs.push_back(encode_open_x(4, "/tmp/b", 0));
+	auto batch = make_batch(bufs);
+
+	auto other = encode_open_x(5, "/tmp/c", 0);
+
+	sinsp_evt evt;
+	libsinsp::sinsp_preparse_pipeline p(&evt, 1);
+	p.begin_batch(batch.data(), (uint32_t)batch.size());
+	p.wait_batch_preparsed();
+
+	// the params handed over for an event that is never parsed
+	// must not leak into the next one
+	evt.set_scap_evt(batch[0].evt);
+	p.consume(0, &evt);
+	ASSERT_EQ(p.get_n_preparsed(), 1);
+	evt.set_scap_evt((scap_evt*)other.get());
+	check_event_params(evt, 5, "/tmp/c");
+
+	// events outside of the batch are loaded lazily
+	evt.set_scap_evt(batch[1].evt);
+	p.consume(1, &evt);
+	p.end_batch();
+	evt.set_scap_evt((scap_evt*)other.get());
+	p.consume(0, &evt);
+	check_event_params(evt, 5, "/tmp/c");
+}
+
+TEST(sinsp_preparse_pipeline, end_batch_without_consuming)
+{
+	const uint32_t nevts = 4096;
+	std::vector<scap_evt_buf> bufs;
+	for(uint32_t i = 0; i < nevts; i++)
+	{
+		bufs.push_back(encode_open_x(i, "/tmp/file", 0));
+	}
+	auto batch = make_batch(bufs);
+
+	sinsp_evt evt;
+	for(uint32_t nworkers = 1; nworkers <= 4; nworkers++)
+	{
+		libsinsp::sinsp_preparse_pipeline p(&evt, nworkers);
+		p.begin_batch(batch.data(), nevts);
+		evt.set_scap_evt(batch[0].evt);
+		p.consume(0, &evt);
+		// the workers must be done with the batch once this returns
+		p.end_batch();
+		p.begin_batch(batch.data(), nevts / 2);
+	}
+}
+
+#endif // __EMSCRIPTEN__
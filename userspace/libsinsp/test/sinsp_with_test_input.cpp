@@ -24,6 +24,8 @@ sinsp_with_test_input::sinsp_with_test_input()
 	m_test_data.events = nullptr;
 	m_test_data.thread_count = 0;
 	m_test_data.threads = nullptr;
+	m_test_data.proc_thread_count = 0;
+	m_test_data.proc_threads = nullptr;
 }
 
 sinsp_with_test_input::~sinsp_with_test_input()
@@ -277,6 +279,13 @@ void sinsp_with_test_input::add_thread(const scap_threadinfo& tinfo, const std::
 	m_test_data.fdinfo_data = m_test_fdinfo_data.data();
 }
 
+void sinsp_with_test_input::add_proc_thread(const scap_threadinfo& tinfo)
+{
+	m_proc_threads.push_back(tinfo);
+	m_test_data.proc_threads = m_proc_threads.data();
+	m_test_data.proc_thread_count = m_proc_threads.size();
+}
+
 void sinsp_with_test_input::set_threadinfo_last_access_time(int64_t tid, uint64_t access_time_ns)
 {
 	auto tinfo = m_inspector.get_thread_ref(tid, false).get();
@@ -71,6 +71,8 @@ protected:
 	//=============================== PROCESS GENERATION ===========================
 
 	void add_thread(const scap_threadinfo&, const std::vector<scap_fdinfo>&);
+	// A thread only found when looked up in /proc, not by the initial scan
+	void add_proc_thread(const scap_threadinfo&);
 	void set_threadinfo_last_access_time(int64_t tid, uint64_t access_time_ns);
 	void remove_inactive_threads(uint64_t m_lastevent_ts, uint64_t thread_timeout);
 
@@ -102,6 +104,7 @@ protected:
 	std::vector<scap_evt*> m_async_events;
 
 	std::vector<scap_threadinfo> m_threads;
+	std::vector<scap_threadinfo> m_proc_threads;
 	std::vector<std::vector<scap_fdinfo>> m_fdinfos;
 	std::vector<scap_test_fdinfo_data> m_test_fdinfo_data;
 	sinsp_filter_check_list m_default_filterlist;
@@ -224,6 +224,146 @@ TEST(dynamic_struct, defs_and_access)
     ASSERT_ANY_THROW(s.get_dynamic_field(acc_num2, tmp));
 }
 
+TEST(dynamic_struct, columnar_storage)
+{
+    using columnar_field_infos = libsinsp::state::dynamic_struct::columnar_field_infos;
+    auto fields = std::make_shared<columnar_field_infos>();
+    ASSERT_EQ(fields->columnar(), fields.get());
+
+    struct sample_struct: public libsinsp::state::dynamic_struct
+    {
+    public:
+        sample_struct(const std::shared_ptr<field_infos>& i): dynamic_struct(i) { }
+    };
+
+    auto acc_num = fields->add_field<uint64_t>("num").new_accessor<uint64_t>();
+    auto acc_flag = fields->add_field<bool>("flag").new_accessor<bool>();
+    auto acc_str = fields->add_field<std::string>("str").new_accessor<std::string>();
+
+    // slots are assigned at the first write, reading never changes them
+    uint64_t tmp = 1;
+    std::string tmpstr = "x";
+    auto s = std::make_unique<sample_struct>(fields);
+    ASSERT_EQ(fields->used_slots(), 0);
+    s->get_dynamic_field(acc_num, tmp);
+    ASSERT_EQ(tmp, 0);
+    s->get_dynamic_field(acc_str, tmpstr);
+    ASSERT_EQ(tmpstr, "");
+    ASSERT_EQ(fields->used_slots(), 0);
+    s->set_dynamic_field(acc_num, (uint64_t) 6);
+    ASSERT_EQ(fields->used_slots(), 1);
+    s->set_dynamic_field(acc_flag, true);
+    s->set_dynamic_field(acc_str, std::string("hello"));
+
+    // the values of many structs stay independent and stable while the
+    // columns grow
+    const char* hello = nullptr;
+    s->get_dynamic_field(acc_str, hello);
+    std::vector<std::unique_ptr<sample_struct>> others;
+    for (uint64_t i = 0; i < 1000; i++)
+    {
+        others.push_back(std::make_unique<sample_struct>(fields));
+        others.back()->set_dynamic_field(acc_num, i);
+    }
+    ASSERT_EQ(fields->used_slots(), 1001);
+    const char* hello2 = nullptr;
+    s->get_dynamic_field(acc_str, hello2);
+    ASSERT_EQ(hello, hello2);
+    ASSERT_STREQ(hello, "hello");
+    for (uint64_t i = 0; i < 1000; i++)
+    {
+        others[i]->get_dynamic_field(acc_num, tmp);
+        ASSERT_EQ(tmp, i);
+    }
+
+    // fields added after the structs are available to all of them
+    auto acc_late = fields->add_field<int32_t>("late").new_accessor<int32_t>();
+    int32_t tmp32 = 1;
+    others[999]->get_dynamic_field(acc_late, tmp32);
+    ASSERT_EQ(tmp32, 0);
+    others[999]->set_dynamic_field(acc_late, (int32_t) -5);
+    others[999]->get_dynamic_field(acc_late, tmp32);
+    ASSERT_EQ(tmp32, -5);
+
+    // copies get their own slot, moves keep the same one
+    sample_struct copy(*s);
+    ASSERT_EQ(fields->used_slots(), 1002);
+    copy.set_dynamic_field(acc_num, (uint64_t) 7);
+    s->get_dynamic_field(acc_num, tmp);
+    ASSERT_EQ(tmp, 6);
+    copy.get_dynamic_field(acc_str, tmpstr);
+    ASSERT_EQ(tmpstr, "hello");
+    sample_struct moved(std::move(copy));
+    ASSERT_EQ(fields->used_slots(), 1002);
+    moved.get_dynamic_field(acc_num, tmp);
+    ASSERT_EQ(tmp, 7);
+
+    // released slots are reused with default values
+    s.reset();
+    others.clear();
+    ASSERT_EQ(fields->used_slots(), 1);
+    sample_struct reused(fields);
+    reused.set_dynamic_field(acc_num, (uint64_t) 8);
+    ASSERT_EQ(fields->used_slots(), 2);
+    bool flag = true;
+    reused.get_dynamic_field(acc_flag, flag);
+    ASSERT_FALSE(flag);
+    reused.get_dynamic_field(acc_str, tmpstr);
+    ASSERT_EQ(tmpstr, "");
+
+    // a copy of a struct never written has no slot either
+    sample_struct empty(fields);
+    sample_struct empty_copy(empty);
+    ASSERT_EQ(fields->used_slots(), 2);
+}
+
+// compare reading a dynamic field from many structs between the per-struct
+// storage and the columnar one
+/* Benchmark, run it with `--gtest_also_run_disabled_tests` */
+TEST(dynamic_struct, DISABLED_columnar_storage_benchmark)
+{
+    struct sample_struct: public libsinsp::state::dynamic_struct
+    {
+    public:
+        sample_struct(const std::shared_ptr<field_infos>& i): dynamic_struct(i) { }
+    };
+
+    const size_t num_structs = 200000;
+    auto bench = [&](const std::shared_ptr<libsinsp::state::dynamic_struct::field_infos>& fields)
+    {
+        std::vector<libsinsp::state::dynamic_struct::field_accessor<uint64_t>> accs;
+        for (int f = 0; f < 4; f++)
+        {
+            accs.push_back(fields->add_field<uint64_t>("f" + std::to_string(f)).new_accessor<uint64_t>());
+        }
+        std::vector<std::unique_ptr<sample_struct>> structs;
+        for (size_t i = 0; i < num_structs; i++)
+        {
+            structs.push_back(std::make_unique<sample_struct>(fields));
+            for (auto& a : accs)
+            {
+                structs.back()->set_dynamic_field(a, (uint64_t) i);
+            }
+        }
+
+        uint64_t sum = 0, tmp = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (auto& s : structs)
+        {
+            s->get_dynamic_field(accs[2], tmp);
+            sum += tmp;
+        }
+        auto elapsed = std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start).count();
+        EXPECT_EQ(sum, (uint64_t) num_structs * (num_structs - 1) / 2);
+        return elapsed;
+    };
+
+    auto per_struct = bench(std::make_shared<libsinsp::state::dynamic_struct::field_infos>());
+    auto columnar = bench(std::make_shared<libsinsp::state::dynamic_struct::columnar_field_infos>());
+    printf("[ INFO     ] reading a field of %zu structs: per-struct storage %" PRId64 " us, columnar storage %" PRId64 " us\n",
+           num_structs, (int64_t) per_struct, (int64_t) columnar);
+}
+
 TEST(table_registry, defs_and_access)
 {
     class sample_table: public libsinsp::state::table<uint64_t>
@@ -379,3 +519,50 @@ TEST(thread_manager, table_access)
     table->clear_entries();
     ASSERT_EQ(table->entries_count(), 0);
 }
+
+TEST(thread_manager, bulk_dynamic_field_access)
+{
+    sinsp inspector;
+    auto table = static_cast<libsinsp::state::table<int64_t>*>(inspector.m_thread_manager.get());
+    ASSERT_NE(table->dynamic_fields()->columnar(), nullptr);
+
+    auto tid_acc = table->static_fields().at("tid").new_accessor<int64_t>();
+    for (int64_t tid = 1; tid <= 100; tid++)
+    {
+        auto newt = table->new_entry();
+        newt->set_static_field(tid_acc, tid);
+        table->add_entry(tid, std::move(newt));
+    }
+
+    auto num_field = table->dynamic_fields()->add_field<uint64_t>("num");
+    auto str_field = table->dynamic_fields()->add_field<std::string>("str");
+    std::vector<int64_t> keys = {1, 50, 100, 999};
+    std::vector<uint64_t> nums = {10, 500, 1000, 9999};
+    std::vector<const char*> strs = {"a", "b", "c", "d"};
+    ASSERT_EQ(table->write_entries_dynamic_field(num_field, keys.data(), keys.size(), nums.data()), 3);
+    ASSERT_EQ(table->write_entries_dynamic_field(str_field, keys.data(), keys.size(), strs.data()), 3);
+
+    std::vector<uint64_t> nums_out(keys.size(), 42);
+    std::vector<const char*> strs_out(keys.size(), nullptr);
+    ASSERT_EQ(table->read_entries_dynamic_field(num_field, keys.data(), keys.size(), nums_out.data()), 3);
+    ASSERT_EQ(table->read_entries_dynamic_field(str_field, keys.data(), keys.size(), strs_out.data()), 3);
+    for (size_t i = 0; i < 3; i++)
+    {
+        ASSERT_EQ(nums_out[i], nums[i]);
+        ASSERT_STREQ(strs_out[i], strs[i]);
+    }
+    // missing entries are left untouched
+    ASSERT_EQ(nums_out[3], 42);
+    ASSERT_EQ(strs_out[3], nullptr);
+
+    // the other entries have default values
+    uint64_t tmp = 1;
+    int64_t key = 2;
+    ASSERT_EQ(table->read_entries_dynamic_field(num_field, &key, 1, &tmp), 1);
+    ASSERT_EQ(tmp, 0);
+
+    // fields of other tables are rejected
+    auto other_fields = std::make_shared<libsinsp::state::dynamic_struct::field_infos>();
+    auto other_field = other_fields->add_field<uint64_t>("num");
+    ASSERT_ANY_THROW(table->read_entries_dynamic_field(other_field, keys.data(), keys.size(), nums_out.data()));
+}
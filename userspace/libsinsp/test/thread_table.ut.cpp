@@ -18,6 +18,9 @@ limitations under the License.
 
 #include <helpers/threads_helpers.h>
 
+#include <atomic>
+#include <thread>
+
 /* These are a sort of e2e for the sinsp state, they assert some flows in sinsp */
 
 TEST_F(sinsp_with_test_input, THRD_TABLE_check_default_tree)
@@ -334,6 +337,48 @@ TEST_F(sinsp_with_test_input, THRD_TABLE_traverse_default_tree)
 	/*=============================== p6_t1 traverse ===========================*/
 }
 
+TEST_F(sinsp_with_test_input, THRD_TABLE_cached_ancestors)
+{
+	/* Instantiate the default tree */
+	DEFAULT_TREE
+
+	auto traversed = [](sinsp_threadinfo* tinfo)
+	{
+		std::vector<sinsp_threadinfo*> parents;
+		sinsp_threadinfo::visitor_func_t visitor = [&parents](sinsp_threadinfo* pt)
+		{
+			parents.push_back(pt);
+			return true;
+		};
+		tinfo->traverse_parent_state(visitor);
+		return parents;
+	};
+
+	sinsp_threadinfo* tinfo = m_inspector.get_thread_ref(p6_t1_tid, false).get();
+	ASSERT_TRUE(tinfo);
+
+	/* The cached lineage is the same one visited by the traversal */
+	ASSERT_EQ(tinfo->get_ancestors(), traversed(tinfo));
+	ASSERT_EQ(tinfo->get_ancestor(0), tinfo);
+	ASSERT_EQ(tinfo->get_ancestor(1)->m_tid, p5_t2_tid);
+	ASSERT_EQ(tinfo->get_ancestors().back()->m_tid, INIT_TID);
+	ASSERT_EQ(tinfo->get_ancestor(tinfo->get_ancestors().size() + 1), nullptr);
+
+	/* Reparenting an ancestor invalidates the lineage */
+	remove_thread(p5_t2_tid, p5_t1_tid);
+	remove_thread(p5_t1_tid, p4_t1_tid);
+	ASSERT_EQ(tinfo->get_ancestor(1)->m_tid, p4_t1_tid);
+	ASSERT_EQ(tinfo->get_ancestors(), traversed(tinfo));
+
+	/* An exec in the lineage changes the names seen through the cache */
+	sinsp_threadinfo* p4_t1_tinfo = m_inspector.get_thread_ref(p4_t1_tid, false).get();
+	ASSERT_TRUE(p4_t1_tinfo);
+	p4_t1_tinfo->m_comm = "renamed";
+	p4_t1_tinfo->invalidate_lineage();
+	ASSERT_EQ(tinfo->get_ancestor(1)->m_comm, "renamed");
+	ASSERT_EQ(tinfo->get_ancestors(), traversed(tinfo));
+}
+
 TEST_F(sinsp_with_test_input, THRD_TABLE_remove_thread_group_main_thread_first)
 {
 	DEFAULT_TREE
@@ -456,6 +501,191 @@ TEST_F(sinsp_with_test_input, THRD_TABLE_max_table_size)
 	ASSERT_THREAD_GROUP_INFO(pid, thread_group_size, false, thread_group_size, thread_group_size);
 }
 
+/* Waits for the pending /proc lookups and parses up to the asyncevent of the first one */
+static sinsp_evt* next_proc_lookup_event(sinsp& inspector)
+{
+	inspector.m_thread_manager->wait_proc_lookups();
+	sinsp_evt* evt = nullptr;
+	for(int i = 0; i < 10; i++)
+	{
+		if(inspector.next(&evt) == SCAP_SUCCESS && evt->get_type() == PPME_ASYNCEVENT_E)
+		{
+			return evt;
+		}
+	}
+	return nullptr;
+}
+
+TEST_F(sinsp_with_test_input, THRD_TABLE_async_proc_lookups)
+{
+	add_default_init_thread();
+	open_inspector();
+	m_inspector.set_sinsp_stats_v2_enabled();
+	m_inspector.set_async_proc_lookups(true, 1);
+	auto stats = m_inspector.get_sinsp_stats_v2();
+	auto& thread_manager = m_inspector.m_thread_manager;
+
+	/* The event goes on with a placeholder while /proc is read */
+	int64_t unknown_tid = 3000;
+	generate_random_event(unknown_tid);
+	auto tinfo = m_inspector.get_thread_ref(unknown_tid, false);
+	ASSERT_TRUE(tinfo);
+	ASSERT_TRUE(tinfo->is_invalid());
+	ASSERT_EQ(thread_manager->get_n_pending_proc_lookups(), 1);
+	ASSERT_EQ(stats->m_n_async_proc_lookups, 1);
+
+	/* No room for a second lookup */
+	generate_random_event(unknown_tid + 1);
+	ASSERT_TRUE(m_inspector.get_thread_ref(unknown_tid + 1, false));
+	ASSERT_EQ(thread_manager->get_n_pending_proc_lookups(), 1);
+	ASSERT_EQ(stats->m_n_drops_async_proc_lookups, 1);
+
+	/* The result comes back as an async event */
+	sinsp_evt* evt = next_proc_lookup_event(m_inspector);
+	ASSERT_TRUE(evt);
+	ASSERT_EQ(evt->get_scap_evt()->tid, (uint64_t)unknown_tid);
+	ASSERT_EQ(thread_manager->get_n_pending_proc_lookups(), 0);
+	ASSERT_EQ(stats->m_n_merged_async_proc_lookups, 1);
+
+	/* Not found in /proc, so the placeholder stays */
+	tinfo = m_inspector.get_thread_ref(unknown_tid, false);
+	ASSERT_TRUE(tinfo);
+	ASSERT_TRUE(tinfo->is_invalid());
+
+	/* The slot is free again */
+	generate_random_event(unknown_tid + 2);
+	ASSERT_EQ(thread_manager->get_n_pending_proc_lookups(), 1);
+	ASSERT_EQ(stats->m_n_async_proc_lookups, 2);
+}
+
+TEST_F(sinsp_with_test_input, THRD_TABLE_async_proc_lookup_replaces_placeholder)
+{
+	add_default_init_thread();
+	int64_t tid = 3000;
+	add_proc_thread(create_threadinfo(tid, tid, INIT_TID, tid, tid, tid, "found", "/bin/found", "/bin/found",
+					  increasing_ts(), 0, 0, {}, 0, {}, "/root/"));
+	open_inspector();
+	m_inspector.set_async_proc_lookups(true);
+
+	{
+		/* /proc is read once the events below are parsed */
+		auto platform_lock = m_inspector.m_thread_manager->lock_scap_platform();
+		generate_random_event(tid);
+		ASSERT_TRUE(m_inspector.get_thread_ref(tid, false)->is_invalid());
+
+		/* An fd opened while the lookup is pending */
+		add_event_advance_ts(increasing_ts(), tid, PPME_SYSCALL_OPEN_X, 6, (uint64_t)5, "/tmp/pending", (uint32_t)PPM_O_RDWR, (uint32_t)0, (uint32_t)0, (uint64_t)0);
+	}
+
+	ASSERT_TRUE(next_proc_lookup_event(m_inspector));
+	auto tinfo = m_inspector.get_thread_ref(tid, false);
+	ASSERT_TRUE(tinfo);
+	ASSERT_FALSE(tinfo->is_invalid());
+	ASSERT_EQ(tinfo->m_comm, "found");
+	ASSERT_EQ(tinfo->m_ptid, INIT_TID);
+
+	/* The fd is kept */
+	auto fdinfo = tinfo->get_fd(5);
+	ASSERT_TRUE(fdinfo);
+	ASSERT_EQ(fdinfo->get_name(), "/tmp/pending");
+}
+
+TEST_F(sinsp_with_test_input, THRD_TABLE_async_proc_lookup_thread_recovered)
+{
+	add_default_init_thread();
+	int64_t tid = 3000;
+	add_proc_thread(create_threadinfo(tid, tid, INIT_TID, tid, tid, tid, "found", "/bin/found", "/bin/found",
+					  increasing_ts(), 0, 0, {}, 0, {}, "/root/"));
+	open_inspector();
+	m_inspector.set_async_proc_lookups(true);
+
+	{
+		auto platform_lock = m_inspector.m_thread_manager->lock_scap_platform();
+		generate_random_event(tid);
+		ASSERT_TRUE(m_inspector.get_thread_ref(tid, false)->is_invalid());
+
+		/* The child side of its clone comes in the meantime */
+		generate_clone_x_event(0, tid, tid, INIT_TID);
+		ASSERT_FALSE(m_inspector.get_thread_ref(tid, false)->is_invalid());
+	}
+
+	ASSERT_TRUE(next_proc_lookup_event(m_inspector));
+	auto tinfo = m_inspector.get_thread_ref(tid, false);
+	ASSERT_TRUE(tinfo);
+	ASSERT_EQ(tinfo->m_comm, "bash");
+}
+
+TEST_F(sinsp_with_test_input, THRD_TABLE_async_proc_lookup_thread_exited)
+{
+	add_default_init_thread();
+	int64_t tid = 3000;
+	add_proc_thread(create_threadinfo(tid, tid, INIT_TID, tid, tid, tid, "found", "/bin/found", "/bin/found",
+					  increasing_ts(), 0, 0, {}, 0, {}, "/root/"));
+	open_inspector();
+	m_inspector.set_async_proc_lookups(true);
+
+	{
+		auto platform_lock = m_inspector.m_thread_manager->lock_scap_platform();
+		generate_random_event(tid);
+		remove_thread(tid, INIT_TID);
+		ASSERT_FALSE(m_inspector.get_thread_ref(tid, false));
+	}
+
+	/* The exited thread is not brought back */
+	ASSERT_TRUE(next_proc_lookup_event(m_inspector));
+	ASSERT_FALSE(m_inspector.get_thread_ref(tid, false));
+}
+
+TEST_F(sinsp_with_test_input, THRD_TABLE_async_proc_lookup_newer_events)
+{
+	add_default_init_thread();
+	int64_t tid = 3000;
+	add_proc_thread(create_threadinfo(tid, tid, INIT_TID, tid, tid, tid, "found", "/bin/found", "/bin/found",
+					  increasing_ts(), 0, 0, {}, 0, {}, "/root/"));
+	open_inspector();
+	/* The clock jumps ahead below, the placeholder must not be purged */
+	m_inspector.set_auto_threads_purging(false);
+	m_inspector.set_async_proc_lookups(true);
+
+	{
+		auto platform_lock = m_inspector.m_thread_manager->lock_scap_platform();
+		generate_random_event(tid);
+		ASSERT_TRUE(m_inspector.get_thread_ref(tid, false)->is_invalid());
+
+		/* Events of the thread, newer than the read of /proc, come
+		 * between the queue and the merge */
+		m_test_timestamp = sinsp_utils::get_current_time_ns() + 3600 * ONE_SECOND_IN_NS;
+		add_event_advance_ts(increasing_ts(), tid, PPME_SYSCALL_OPEN_X, 6, (uint64_t)5, "/tmp/pending", (uint32_t)PPM_O_RDWR, (uint32_t)0, (uint32_t)0, (uint64_t)0);
+		add_event_advance_ts(increasing_ts(), tid, PPME_SYSCALL_CHDIR_X, 2, (int64_t)0, "/newer");
+		add_event_advance_ts(increasing_ts(), tid, PPME_SYSCALL_SETUID_E, 1, (uint32_t)500);
+		add_event_advance_ts(increasing_ts(), tid, PPME_SYSCALL_SETUID_X, 1, (int64_t)0);
+		generate_random_event(tid);
+		ASSERT_TRUE(m_inspector.get_thread_ref(tid, false)->is_invalid());
+	}
+
+	/* The /proc fields are applied anyway */
+	ASSERT_TRUE(next_proc_lookup_event(m_inspector));
+	auto tinfo = m_inspector.get_thread_ref(tid, false);
+	ASSERT_TRUE(tinfo);
+	ASSERT_FALSE(tinfo->is_invalid());
+	ASSERT_EQ(tinfo->m_pid, tid);
+	ASSERT_EQ(tinfo->m_ptid, INIT_TID);
+	ASSERT_EQ(tinfo->m_comm, "found");
+	ASSERT_EQ(tinfo->m_exe, "/bin/found");
+	ASSERT_EQ(m_inspector.m_thread_manager->get_n_pending_proc_lookups(), 0);
+
+	/* The state changed by the events is kept */
+	ASSERT_EQ(tinfo->get_cwd(), "/newer/");
+	ASSERT_EQ(tinfo->m_user.uid, (uint32_t)500);
+	auto fdinfo = tinfo->get_fd(5);
+	ASSERT_TRUE(fdinfo);
+	ASSERT_EQ(fdinfo->get_name(), "/tmp/pending");
+
+	/* and the next events see the merged thread */
+	auto evt = generate_random_event(tid);
+	ASSERT_EQ(get_field_as_string(evt, "proc.name"), "found");
+}
+
 TEST_F(sinsp_with_test_input, THRD_TABLE_many_threads_in_a_group)
 {
 	add_default_init_thread();
@@ -630,3 +860,183 @@ TEST_F(sinsp_with_test_input, THRD_TABLE_add_and_remove_many_children)
 	/* Only init process */
 	ASSERT_EQ(m_inspector.m_thread_manager->get_thread_count(), 1);
 }
+
+TEST_F(sinsp_with_test_input, THRD_TABLE_concurrent_reads)
+{
+	DEFAULT_TREE
+
+	/* Enabling the concurrent reads publishes the whole table */
+	m_inspector.set_concurrent_thread_reads(true);
+	ASSERT_TRUE(m_inspector.get_concurrent_thread_reads());
+	auto threads = m_inspector.m_thread_manager->get_threads();
+	ASSERT_EQ(threads->concurrent_size(), threads->size());
+
+	size_t count = 0;
+	threads->concurrent_loop([&](const threadinfo_map_t::thread_view&) {
+		count++;
+		return true;
+	});
+	ASSERT_EQ(count, threads->size());
+
+	int64_t pid = 0;
+	ASSERT_TRUE(threads->concurrent_visit(p6_t1_tid, [&](const threadinfo_map_t::thread_view& view) {
+		pid = view.m_pid;
+		return true;
+	}));
+	ASSERT_EQ(pid, p6_t1_pid);
+
+	/* Fields changed in place by the parser are copied once the event is parsed */
+	generate_execve_enter_and_exit_event(0, p5_t1_tid, p5_t1_tid, p5_t1_pid, p5_t1_ptid, "/bin/new-exe", "new-exe", "/bin/new-exe");
+	std::string comm;
+	std::string exepath;
+	ASSERT_TRUE(threads->concurrent_visit(p5_t1_tid, [&](const threadinfo_map_t::thread_view& view) {
+		comm = view.m_comm;
+		exepath = view.m_exepath;
+		return true;
+	}));
+	ASSERT_EQ(comm, "new-exe");
+	ASSERT_EQ(exepath, "/bin/new-exe");
+
+	/* Events that don't change the copied fields don't copy the thread again */
+	const threadinfo_map_t::thread_view* view_before = nullptr;
+	const threadinfo_map_t::thread_view* view_after = nullptr;
+	ASSERT_TRUE(threads->concurrent_visit(p5_t1_tid, [&](const threadinfo_map_t::thread_view& view) {
+		view_before = &view;
+		return true;
+	}));
+	add_event_advance_ts(increasing_ts(), p5_t1_tid, PPME_SYSCALL_OPEN_X, 6, (uint64_t)5, "/tmp/the_file", (uint32_t)PPM_O_RDWR, (uint32_t)0, (uint32_t)5, (uint64_t)123);
+	generate_random_event(p5_t1_tid);
+	ASSERT_TRUE(threads->concurrent_visit(p5_t1_tid, [&](const threadinfo_map_t::thread_view& view) {
+		view_after = &view;
+		return true;
+	}));
+	ASSERT_EQ(view_before, view_after);
+
+	add_event_advance_ts(increasing_ts(), p5_t1_tid, PPME_SYSCALL_CHDIR_X, 2, (int64_t)0, "/new-cwd");
+	std::string cwd;
+	ASSERT_TRUE(threads->concurrent_visit(p5_t1_tid, [&](const threadinfo_map_t::thread_view& view) {
+		cwd = view.m_cwd;
+		return true;
+	}));
+	ASSERT_EQ(cwd, "/new-cwd/");
+
+	/* Removed threads still expire right away for the owner thread */
+	std::weak_ptr<sinsp_threadinfo> p6_t1_weak = m_inspector.get_thread_ref(p6_t1_tid, false);
+	ASSERT_FALSE(p6_t1_weak.expired());
+	remove_thread(p6_t1_tid, p5_t2_tid);
+	ASSERT_TRUE(p6_t1_weak.expired());
+	ASSERT_FALSE(threads->concurrent_visit(p6_t1_tid, [](const threadinfo_map_t::thread_view&) { return true; }));
+	ASSERT_EQ(threads->concurrent_size(), threads->size());
+
+	/* New threads are visible once their event is parsed */
+	int64_t p7_t1_tid = 100;
+	generate_clone_x_event(0, p7_t1_tid, p7_t1_tid, INIT_TID);
+	ASSERT_TRUE(threads->concurrent_visit(p7_t1_tid, [](const threadinfo_map_t::thread_view&) { return true; }));
+	ASSERT_EQ(threads->concurrent_size(), threads->size());
+
+	m_inspector.set_concurrent_thread_reads(false);
+	ASSERT_FALSE(threads->concurrent_visit(p7_t1_tid, [](const threadinfo_map_t::thread_view&) { return true; }));
+	ASSERT_EQ(threads->concurrent_size(), 0);
+}
+
+// note: emscripten does not support launching threads
+#ifndef __EMSCRIPTEN__
+
+TEST(threadinfo_map_t, concurrent_reads_while_mutating)
+{
+	const int64_t ntids = 2048;
+	const int nreaders = 4;
+
+	threadinfo_map_t table;
+	table.set_concurrent_reads(true, 16);
+
+	auto new_thread = [&](int64_t tid, int64_t gen) {
+		auto tinfo = std::make_shared<sinsp_threadinfo>();
+		tinfo->m_tid = tid;
+		tinfo->m_pid = tid;
+		tinfo->m_ptid = gen;
+		tinfo->m_comm = std::to_string(gen);
+		table.put(tinfo);
+	};
+
+	for(int64_t tid = 1; tid <= ntids; tid++)
+	{
+		new_thread(tid, 0);
+	}
+	table.publish();
+
+	std::atomic<bool> stop{false};
+	std::atomic<uint64_t> nfound{0};
+	std::atomic<bool> failed{false};
+	std::vector<std::thread> readers;
+	for(int r = 0; r < nreaders; r++)
+	{
+		readers.emplace_back([&, r]() {
+			uint64_t found = 0;
+			int64_t tid = 1 + r;
+			while(!stop.load(std::memory_order_relaxed))
+			{
+				table.concurrent_visit(tid, [&](const threadinfo_map_t::thread_view& view) {
+					// a reclaimed view would show up here under ASan, and
+					// a view changed while visited under TSan
+					if(view.m_tid != tid || view.m_pid != tid || view.m_comm != std::to_string(view.m_ptid))
+					{
+						failed = true;
+					}
+					found++;
+					return true;
+				});
+				tid = tid % ntids + 1;
+			}
+			nfound += found;
+		});
+	}
+
+	// replace, remove, re-add and change threads in place while the
+	// readers are running
+	for(int64_t gen = 1; gen <= 200; gen++)
+	{
+		for(int64_t tid = 1 + (gen % 7); tid <= ntids; tid += 7)
+		{
+			if(gen % 2)
+			{
+				table.erase(tid);
+			}
+			else
+			{
+				new_thread(tid, gen);
+			}
+		}
+		for(int64_t tid = 1 + ((gen + 3) % 7); tid <= ntids; tid += 7)
+		{
+			sinsp_threadinfo* tinfo = table.get(tid);
+			if(tinfo != nullptr)
+			{
+				tinfo->m_ptid = gen;
+				tinfo->m_comm = std::to_string(gen);
+				table.touch(tid);
+			}
+		}
+		table.publish();
+	}
+
+	stop = true;
+	for(auto& t : readers)
+	{
+		t.join();
+	}
+
+	ASSERT_FALSE(failed);
+	ASSERT_GT(nfound, 0);
+	ASSERT_EQ(table.concurrent_size(), table.size());
+
+	size_t count = 0;
+	table.concurrent_loop([&](const threadinfo_map_t::thread_view& view) {
+		count++;
+		auto tinfo = table.get_ref(view.m_tid);
+		return tinfo != nullptr && tinfo->m_comm == view.m_comm && tinfo->m_ptid == view.m_ptid;
+	});
+	ASSERT_EQ(count, table.size());
+}
+
+#endif // __EMSCRIPTEN__
@@ -29,10 +29,12 @@ limitations under the License.
 #include <libscap/scap-int.h>
 
 constexpr static const char* s_thread_table_name = "threads";
+// after this, a /proc lookup whose event was never parsed is forgotten
+constexpr static uint64_t s_proc_lookup_ttl_ns = 60 * ONE_SECOND_IN_NS;
 
 extern sinsp_evttables g_infotables;
 
-static void copy_ipv6_address(uint32_t* dest, uint32_t* src)
+static void copy_ipv6_address(uint32_t* dest, const uint32_t* src)
 {
 	dest[0] = src[0];
 	dest[1] = src[1];
@@ -46,7 +48,6 @@ static void copy_ipv6_address(uint32_t* dest, uint32_t* src)
 
 sinsp_threadinfo::sinsp_threadinfo(sinsp* inspector, std::shared_ptr<libsinsp::state::dynamic_struct::field_infos> dyn_fields):
 	table_entry(dyn_fields),
-	m_cgroups(new cgroups_t),
 	m_inspector(inspector),
 	m_fdtable(inspector)
 {
@@ -181,7 +182,7 @@ void sinsp_threadinfo::fix_sockets_coming_from_proc()
 				fdi.m_sockinfo.m_ipv4info.m_fields.m_sport = fdi.m_sockinfo.m_ipv4info.m_fields.m_dport;
 				fdi.m_sockinfo.m_ipv4info.m_fields.m_dport = tport;
 
-				fdi.m_name = ipv4tuple_to_string(&fdi.m_sockinfo.m_ipv4info, m_inspector->is_hostname_and_port_resolution_enabled());
+				fdi.set_name(ipv4tuple_to_string(&fdi.m_sockinfo.m_ipv4info, m_inspector->is_hostname_and_port_resolution_enabled()));
 
 				fdi.set_role_server();
 			}
@@ -276,13 +277,13 @@ void sinsp_threadinfo::add_fd_from_scap(scap_fdinfo *fdi)
 			newfdi->m_flags |= sinsp_fdinfo::FLAGS_SOCKET_CONNECTED;
 		}
 		m_inspector->get_ifaddr_list().update_fd(*(newfdi.get()));
-		newfdi->m_name = ipv4tuple_to_string(&newfdi->m_sockinfo.m_ipv4info, m_inspector->is_hostname_and_port_resolution_enabled());
+		newfdi->set_name(ipv4tuple_to_string(&newfdi->m_sockinfo.m_ipv4info, m_inspector->is_hostname_and_port_resolution_enabled()));
 		break;
 	case SCAP_FD_IPV4_SERVSOCK:
 		newfdi->m_sockinfo.m_ipv4serverinfo.m_ip = fdi->info.ipv4serverinfo.ip;
 		newfdi->m_sockinfo.m_ipv4serverinfo.m_port = fdi->info.ipv4serverinfo.port;
 		newfdi->m_sockinfo.m_ipv4serverinfo.m_l4proto = fdi->info.ipv4serverinfo.l4proto;
-		newfdi->m_name = ipv4serveraddr_to_string(&newfdi->m_sockinfo.m_ipv4serverinfo, m_inspector->is_hostname_and_port_resolution_enabled());
+		newfdi->set_name(ipv4serveraddr_to_string(&newfdi->m_sockinfo.m_ipv4serverinfo, m_inspector->is_hostname_and_port_resolution_enabled()));
 
 		//
 		// We keep note of all the host bound server ports.
@@ -310,7 +311,7 @@ void sinsp_threadinfo::add_fd_from_scap(scap_fdinfo *fdi)
 				newfdi->m_flags |= sinsp_fdinfo::FLAGS_SOCKET_CONNECTED;
 			}
 			m_inspector->get_ifaddr_list().update_fd((*(newfdi.get())));
-			newfdi->m_name = ipv4tuple_to_string(&newfdi->m_sockinfo.m_ipv4info, m_inspector->is_hostname_and_port_resolution_enabled());
+			newfdi->set_name(ipv4tuple_to_string(&newfdi->m_sockinfo.m_ipv4info, m_inspector->is_hostname_and_port_resolution_enabled()));
 		}
 		else
 		{
@@ -323,14 +324,14 @@ void sinsp_threadinfo::add_fd_from_scap(scap_fdinfo *fdi)
 			{
 				newfdi->m_flags |= sinsp_fdinfo::FLAGS_SOCKET_CONNECTED;
 			}
-			newfdi->m_name = ipv6tuple_to_string(&newfdi->m_sockinfo.m_ipv6info, m_inspector->is_hostname_and_port_resolution_enabled());
+			newfdi->set_name(ipv6tuple_to_string(&newfdi->m_sockinfo.m_ipv6info, m_inspector->is_hostname_and_port_resolution_enabled()));
 		}
 		break;
 	case SCAP_FD_IPV6_SERVSOCK:
 		copy_ipv6_address(newfdi->m_sockinfo.m_ipv6serverinfo.m_ip.m_b, fdi->info.ipv6serverinfo.ip);
 		newfdi->m_sockinfo.m_ipv6serverinfo.m_port = fdi->info.ipv6serverinfo.port;
 		newfdi->m_sockinfo.m_ipv6serverinfo.m_l4proto = fdi->info.ipv6serverinfo.l4proto;
-		newfdi->m_name = ipv6serveraddr_to_string(&newfdi->m_sockinfo.m_ipv6serverinfo, m_inspector->is_hostname_and_port_resolution_enabled());
+		newfdi->set_name(ipv6serveraddr_to_string(&newfdi->m_sockinfo.m_ipv6serverinfo, m_inspector->is_hostname_and_port_resolution_enabled()));
 
 		//
 		// We keep note of all the host bound server ports.
@@ -342,8 +343,8 @@ void sinsp_threadinfo::add_fd_from_scap(scap_fdinfo *fdi)
 	case SCAP_FD_UNIX_SOCK:
 		newfdi->m_sockinfo.m_unixinfo.m_fields.m_source = fdi->info.unix_socket_info.source;
 		newfdi->m_sockinfo.m_unixinfo.m_fields.m_dest = fdi->info.unix_socket_info.destination;
-		newfdi->m_name = fdi->info.unix_socket_info.fname;
-		if(newfdi->m_name.empty())
+		newfdi->set_name(fdi->info.unix_socket_info.fname);
+		if(newfdi->get_name().empty())
 		{
 			newfdi->set_role_client();
 		}
@@ -354,7 +355,7 @@ void sinsp_threadinfo::add_fd_from_scap(scap_fdinfo *fdi)
 		break;
 	case SCAP_FD_FILE_V2:
 		newfdi->m_openflags = fdi->info.regularinfo.open_flags;
-		newfdi->m_name = fdi->info.regularinfo.fname;
+		newfdi->set_name(fdi->info.regularinfo.fname);
 		newfdi->m_dev = fdi->info.regularinfo.dev;
 		newfdi->m_mount_id = fdi->info.regularinfo.mount_id;
 		break;
@@ -373,7 +374,7 @@ void sinsp_threadinfo::add_fd_from_scap(scap_fdinfo *fdi)
 	case SCAP_FD_IOURING:
 	case SCAP_FD_MEMFD:
 	case SCAP_FD_PIDFD:
-		newfdi->m_name = fdi->info.fname;
+		newfdi->set_name(fdi->info.fname);
 		break;
 	default:
 		ASSERT(false);
@@ -569,7 +570,7 @@ void sinsp_threadinfo::set_loginuser(uint32_t loginuid)
 	}
 }
 
-sinsp_threadinfo::cgroups_t& sinsp_threadinfo::cgroups() const
+const sinsp_threadinfo::cgroups_t& sinsp_threadinfo::cgroups() const
 {
 	if(m_cgroups)
 	{
@@ -598,6 +599,7 @@ std::string sinsp_threadinfo::get_exepath() const
 void sinsp_threadinfo::set_args(const char* args, size_t len)
 {
 	m_args.clear();
+	m_args_gen++;
 
 	size_t offset = 0;
 	while(offset < len)
@@ -605,10 +607,14 @@ void sinsp_threadinfo::set_args(const char* args, size_t len)
 		m_args.push_back(args + offset);
 		offset += m_args.back().length() + 1;
 	}
+
+	update_args_strings();
 }
 
 void sinsp_threadinfo::set_env(const char* env, size_t len)
 {
+	m_env_gen++;
+
 	if (len == SCAP_MAX_ENV_SIZE && m_inspector->large_envs_enabled())
 	{
 		// the environment is possibly truncated, try to read from /proc
@@ -616,6 +622,7 @@ void sinsp_threadinfo::set_env(const char* env, size_t len)
 		if (set_env_from_proc())
 		{
 			libsinsp_logger()->format(sinsp_logger::SEV_DEBUG, "Large environment for process %lu [%s], loaded from /proc", m_pid, m_comm.c_str());
+			update_env_string();
 			return;
 		} else {
 			libsinsp_logger()->format(sinsp_logger::SEV_INFO, "Failed to load environment for process %lu [%s] from /proc, using first %d bytes", m_pid, m_comm.c_str(), SCAP_MAX_ENV_SIZE);
@@ -640,7 +647,7 @@ void sinsp_threadinfo::set_env(const char* env, size_t len)
 			if(!memcmp(left, zero, sz))
 			{
 				free(zero);
-				return;
+				break;
 			}
 			free(zero);
 		}
@@ -648,6 +655,8 @@ void sinsp_threadinfo::set_env(const char* env, size_t len)
 
 		offset += m_env.back().length() + 1;
 	}
+
+	update_env_string();
 }
 
 bool sinsp_threadinfo::set_env_from_proc() {
@@ -661,6 +670,7 @@ bool sinsp_threadinfo::set_env_from_proc() {
 	}
 
 	m_env.clear();
+	m_env_gen++;
 	while (environment) {
 		std::string env;
 		getline(environment, env, '\0');
@@ -720,69 +730,146 @@ std::string sinsp_threadinfo::get_env(const std::string& name)
 
 std::string sinsp_threadinfo::concatenate_all_env()
 {
-	auto all_env = get_env();
-	if(all_env.size() == 0)
+	return get_concatenated_env();
+}
+
+void sinsp_threadinfo::build_cmdline(std::string& cmdline) const
+{
+	cmdline = m_comm;
+	for(const auto& arg : m_args)
 	{
-		return "";
+		cmdline += ' ';
+		cmdline += arg;
 	}
+}
 
-	// Here we have at least one env so we can pop the last character at the end of the loop.
-	std::string concatenate_env;
-	for(const auto& env_var : all_env)
+void sinsp_threadinfo::build_exeline(std::string& exeline) const
+{
+	exeline = m_exe;
+	exeline += ' ';
+	for(size_t j = 0; j < m_args.size(); j++)
 	{
-		concatenate_env += env_var;
-		concatenate_env += ' ';
+		if(j > 0)
+		{
+			exeline += ' ';
+		}
+		exeline += m_args[j];
 	}
-	concatenate_env.pop_back();
-	return concatenate_env;
 }
 
-void sinsp_threadinfo::set_cgroups(const char* cgroups, size_t len)
+void sinsp_threadinfo::build_concatenated_env(std::string& env) const
 {
-	decltype(m_cgroups) tmp_cgroups(new cgroups_t);
+	env.clear();
+	for(const auto& env_var : m_env)
+	{
+		env += env_var;
+		env += ' ';
+	}
+	if(!env.empty())
+	{
+		env.pop_back();
+	}
+}
 
-	size_t offset = 0;
-	while(offset < len)
+void sinsp_threadinfo::update_args_strings()
+{
+	build_cmdline(m_cmdline_cache.value);
+	m_cmdline_cache.key = m_comm;
+	m_cmdline_cache.gen = m_args_gen;
+
+	build_exeline(m_exeline_cache.value);
+	m_exeline_cache.key = m_exe;
+	m_exeline_cache.gen = m_args_gen;
+}
+
+void sinsp_threadinfo::update_env_string()
+{
+	build_concatenated_env(m_env_cache.value);
+	m_env_cache.gen = m_env_gen;
+}
+
+void sinsp_threadinfo::update_derived_strings()
+{
+	update_args_strings();
+	update_env_string();
+}
+
+//
+// The getters below never write: when the values were modified without
+// update_derived_strings() they build a copy into the caller's storage.
+//
+const std::string& sinsp_threadinfo::get_concatenated_env(std::string& storage) const
+{
+	// the environment belongs to the main thread, see get_env()
+	const sinsp_threadinfo* owner = this;
+	if(!is_main_thread())
 	{
-		const char* str = cgroups + offset;
-		const char* sep = strrchr(str, '=');
-		if(sep == NULL)
+		auto mtinfo = get_main_thread();
+		if(mtinfo != nullptr)
 		{
-			ASSERT(false);
-			return;
+			owner = mtinfo;
 		}
+	}
 
-		std::string subsys(str, sep - str);
-		std::string cgroup(sep + 1);
+	if(owner->m_env_cache.gen == owner->m_env_gen)
+	{
+		return owner->m_env_cache.value;
+	}
 
-		size_t subsys_length = subsys.length();
-		size_t pos = subsys.find("_cgroup");
-		if(pos != std::string::npos)
-		{
-			subsys.erase(pos, sizeof("_cgroup") - 1);
-		}
+	owner->build_concatenated_env(storage);
+	return storage;
+}
 
-		if(subsys == "perf")
-		{
-			subsys = "perf_event";
-		}
-		else if(subsys == "mem")
-		{
-			subsys = "memory";
-		}
-		else if(subsys == "io")
-		{
-			// blkio has been renamed just `io`
-			// in kernel space:
-			// https://github.com/torvalds/linux/commit/c165b3e3c7bb68c2ed55a5ac2623f030d01d9567
-			subsys = "blkio";
-		}
+std::string sinsp_threadinfo::get_concatenated_env() const
+{
+	std::string storage;
+	return get_concatenated_env(storage);
+}
 
-		tmp_cgroups->push_back(std::make_pair(subsys, cgroup));
-		offset += subsys_length + 1 + cgroup.length() + 1;
+const std::string& sinsp_threadinfo::get_cmdline(std::string& storage) const
+{
+	if(m_cmdline_cache.gen == m_args_gen && m_cmdline_cache.key == m_comm)
+	{
+		return m_cmdline_cache.value;
 	}
 
-	m_cgroups.swap(tmp_cgroups);
+	build_cmdline(storage);
+	return storage;
+}
+
+std::string sinsp_threadinfo::get_cmdline() const
+{
+	std::string storage;
+	return get_cmdline(storage);
+}
+
+const std::string& sinsp_threadinfo::get_exeline(std::string& storage) const
+{
+	if(m_exeline_cache.gen == m_args_gen && m_exeline_cache.key == m_exe)
+	{
+		return m_exeline_cache.value;
+	}
+
+	build_exeline(storage);
+	return storage;
+}
+
+std::string sinsp_threadinfo::get_exeline() const
+{
+	std::string storage;
+	return get_exeline(storage);
+}
+
+void sinsp_threadinfo::set_cgroups(const char* cgroups, size_t len)
+{
+	auto set = libsinsp::sinsp_cgroup_set_pool::instance().intern(cgroups, len);
+	if(set == nullptr)
+	{
+		ASSERT(false);
+		return;
+	}
+
+	m_cgroups = std::move(set);
 }
 
 sinsp_threadinfo* sinsp_threadinfo::get_parent_thread()
@@ -911,6 +998,13 @@ sinsp_threadinfo* sinsp_threadinfo::get_cwd_root()
 
 std::string sinsp_threadinfo::get_cwd()
 {
+	return get_cwd_ref();
+}
+
+const std::string& sinsp_threadinfo::get_cwd_ref()
+{
+	static const std::string default_cwd = "./";
+
 	// Ideally we should use get_cwd_root()
 	// but scap does not read CLONE_FS from /proc
 	// Also glibc and muslc use always
@@ -925,7 +1019,7 @@ std::string sinsp_threadinfo::get_cwd()
 	else
 	{
 		///todo(@Andreagit97) not sure we want to return "./" it seems like a valid path
-		return "./";
+		return default_cwd;
 	}
 }
 
@@ -933,6 +1027,12 @@ void sinsp_threadinfo::update_cwd(std::string_view cwd)
 {
 	sinsp_threadinfo* tinfo = get_main_thread();
 
+	// a placeholder keeps its cwd until its /proc lookup is merged
+	if (tinfo == nullptr && is_invalid())
+	{
+		tinfo = this;
+	}
+
 	if (tinfo == nullptr)
 	{
 		ASSERT(false);
@@ -1089,6 +1189,70 @@ void sinsp_threadinfo::traverse_parent_state(visitor_func_t &visitor)
 	}
 }
 
+bool sinsp_threadinfo::is_lineage_valid()
+{
+	if(!m_lineage_cached || m_lineage_ptid != m_ptid || m_lineage_self_gen != m_lineage_gen)
+	{
+		return false;
+	}
+
+	for(size_t i = 0; i < m_lineage.size(); i++)
+	{
+		const auto& stamp = m_lineage_stamps[i];
+		if(stamp.ref.expired() ||
+		   m_lineage[i]->m_ptid != stamp.ptid ||
+		   m_lineage[i]->m_lineage_gen != stamp.gen)
+		{
+			return false;
+		}
+	}
+
+	// the missing parent may have been added to the table in the meantime
+	if(m_lineage_truncated)
+	{
+		sinsp_threadinfo* top = m_lineage.empty() ? this : m_lineage.back();
+		if(top->get_parent_thread() != nullptr)
+		{
+			return false;
+		}
+	}
+
+	return true;
+}
+
+const std::vector<sinsp_threadinfo*>& sinsp_threadinfo::get_ancestors()
+{
+	if(is_lineage_valid())
+	{
+		return m_lineage;
+	}
+
+	m_lineage.clear();
+	m_lineage_stamps.clear();
+
+	sinsp_threadinfo::visitor_func_t visitor = [this] (sinsp_threadinfo *pt)
+	{
+		m_lineage.push_back(pt);
+		return true;
+	};
+	traverse_parent_state(visitor);
+
+	for(auto pt : m_lineage)
+	{
+		m_lineage_stamps.push_back(lineage_stamp{
+			m_inspector->get_thread_ref(pt->m_tid, false),
+			pt->m_ptid,
+			pt->m_lineage_gen});
+	}
+
+	sinsp_threadinfo* top = m_lineage.empty() ? this : m_lineage.back();
+	m_lineage_truncated = top->m_ptid > 0 && top->get_parent_thread() == nullptr;
+	m_lineage_ptid = m_ptid;
+	m_lineage_self_gen = m_lineage_gen;
+	m_lineage_cached = true;
+	return m_lineage;
+}
+
 /* We should never call this method if we don't have children to reparent
  * if we want to save some clock cycles
  */
@@ -1113,6 +1277,7 @@ void sinsp_threadinfo::assign_children_to_reaper(sinsp_threadinfo* reaper)
 		 */
 		if(!child->expired())
 		{
+			child->lock()->invalidate_lineage();
 			if(reaper == nullptr)
 			{
 				/* we set `0` as the parent for all children */
@@ -1123,6 +1288,8 @@ void sinsp_threadinfo::assign_children_to_reaper(sinsp_threadinfo* reaper)
 				/* Add the child to the reaper list */
 				reaper->add_child(child->lock());
 			}
+			/* its copy seen by the concurrent readers has the old ptid */
+			m_inspector->m_thread_manager->get_threads()->touch(child->lock()->m_tid);
 		}
 
 		/* In any case (expired or not) we remove the child
@@ -1135,13 +1302,7 @@ void sinsp_threadinfo::assign_children_to_reaper(sinsp_threadinfo* reaper)
 
 void sinsp_threadinfo::populate_cmdline(std::string &cmdline, const sinsp_threadinfo *tinfo)
 {
-	cmdline = tinfo->get_comm();
-
-	for (const auto& arg : tinfo->m_args)
-	{
-		cmdline += " ";
-		cmdline += arg;
-	}
+	cmdline = tinfo->get_cmdline();
 }
 
 bool sinsp_threadinfo::is_health_probe() const
@@ -1153,8 +1314,8 @@ bool sinsp_threadinfo::is_health_probe() const
 
 std::string sinsp_threadinfo::get_path_for_dir_fd(int64_t dir_fd)
 {
-	sinsp_fdinfo* dir_fdinfo = get_fd(dir_fd);
-	if (!dir_fdinfo || dir_fdinfo->m_name.empty())
+	const sinsp_fdinfo* dir_fdinfo = const_get_fd(dir_fd);
+	if (!dir_fdinfo || dir_fdinfo->get_name().empty())
 	{
 #ifndef _WIN32 // we will have to implement this for Windows
 		// Sad day; we don't have the directory in the tinfo's fd cache.
@@ -1184,7 +1345,7 @@ std::string sinsp_threadinfo::get_path_for_dir_fd(int64_t dir_fd)
 		return rel_path_base;
 #endif // _WIN32
 	}
-	return dir_fdinfo->m_name;
+	return dir_fdinfo->get_name();
 }
 
 size_t sinsp_threadinfo::args_len() const
@@ -1312,7 +1473,7 @@ void sinsp_threadinfo::strvec_to_iovec(const std::vector<std::string> &strs,
 	}
 }
 
-static void fd_to_scap(scap_fdinfo *dst, sinsp_fdinfo* src)
+static void fd_to_scap(scap_fdinfo *dst, const sinsp_fdinfo* src)
 {
 	dst->type = src->m_type;
 	dst->ino = src->m_ino;
@@ -1346,11 +1507,11 @@ static void fd_to_scap(scap_fdinfo *dst, sinsp_fdinfo* src)
 	case SCAP_FD_UNIX_SOCK:
 		dst->info.unix_socket_info.source = src->m_sockinfo.m_unixinfo.m_fields.m_source;
 		dst->info.unix_socket_info.destination = src->m_sockinfo.m_unixinfo.m_fields.m_dest;
-		strlcpy(dst->info.unix_socket_info.fname, src->m_name.c_str(), sizeof(dst->info.unix_socket_info.fname));
+		strlcpy(dst->info.unix_socket_info.fname, src->get_name().c_str(), sizeof(dst->info.unix_socket_info.fname));
 		break;
 	case SCAP_FD_FILE_V2:
 		dst->info.regularinfo.open_flags = src->m_openflags;
-		strlcpy(dst->info.regularinfo.fname, src->m_name.c_str(), sizeof(dst->info.regularinfo.fname));
+		strlcpy(dst->info.regularinfo.fname, src->get_name().c_str(), sizeof(dst->info.regularinfo.fname));
 		dst->info.regularinfo.dev = src->m_dev;
 		dst->info.regularinfo.mount_id = src->m_mount_id;
 		break;
@@ -1369,7 +1530,7 @@ static void fd_to_scap(scap_fdinfo *dst, sinsp_fdinfo* src)
 	case SCAP_FD_IOURING:
 	case SCAP_FD_MEMFD:
 	case SCAP_FD_PIDFD:
-		strlcpy(dst->info.fname, src->m_name.c_str(), sizeof(dst->info.fname));
+		strlcpy(dst->info.fname, src->get_name().c_str(), sizeof(dst->info.fname));
 		break;
 	default:
 		ASSERT(false);
@@ -1377,11 +1538,241 @@ static void fd_to_scap(scap_fdinfo *dst, sinsp_fdinfo* src)
 	}
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// threadinfo_map_t implementation
+///////////////////////////////////////////////////////////////////////////////
+threadinfo_map_t::thread_view::thread_view(sinsp_threadinfo& tinfo):
+	m_tid(tinfo.m_tid),
+	m_pid(tinfo.m_pid),
+	m_ptid(tinfo.m_ptid),
+	m_sid(tinfo.m_sid),
+	m_vtid(tinfo.m_vtid),
+	m_vpid(tinfo.m_vpid),
+	m_vpgid(tinfo.m_vpgid),
+	m_uid(tinfo.m_user.uid),
+	m_gid(tinfo.m_group.gid),
+	m_loginuid(tinfo.m_loginuser.uid),
+	m_flags(tinfo.m_flags),
+	m_tty(tinfo.m_tty),
+	m_clone_ts(tinfo.m_clone_ts),
+	m_lastexec_ts(tinfo.m_lastexec_ts),
+	m_comm(tinfo.m_comm),
+	m_exe(tinfo.m_exe),
+	m_exepath(tinfo.m_exepath),
+	m_args(tinfo.m_args),
+	m_cwd(tinfo.get_cwd()),
+	m_root(tinfo.m_root),
+	m_container_id(tinfo.m_container_id)
+{
+}
+
+bool threadinfo_map_t::thread_view::matches(sinsp_threadinfo& tinfo) const
+{
+	return m_tid == tinfo.m_tid &&
+		m_pid == tinfo.m_pid &&
+		m_ptid == tinfo.m_ptid &&
+		m_sid == tinfo.m_sid &&
+		m_vtid == tinfo.m_vtid &&
+		m_vpid == tinfo.m_vpid &&
+		m_vpgid == tinfo.m_vpgid &&
+		m_uid == tinfo.m_user.uid &&
+		m_gid == tinfo.m_group.gid &&
+		m_loginuid == tinfo.m_loginuser.uid &&
+		m_flags == tinfo.m_flags &&
+		m_tty == tinfo.m_tty &&
+		m_clone_ts == tinfo.m_clone_ts &&
+		m_lastexec_ts == tinfo.m_lastexec_ts &&
+		m_comm == tinfo.m_comm &&
+		m_exe == tinfo.m_exe &&
+		m_exepath == tinfo.m_exepath &&
+		m_args == tinfo.m_args &&
+		m_cwd == tinfo.get_cwd_ref() &&
+		m_root == tinfo.m_root &&
+		m_container_id == tinfo.m_container_id;
+}
+
+void threadinfo_map_t::set_concurrent_reads(bool enable, uint32_t nshards)
+{
+	// no reader is left, everything can go right away
+	m_shards.reset();
+	if(!enable)
+	{
+		return;
+	}
+
+	m_shards = std::make_unique<sharded_snapshot>(nshards);
+	for(const auto& it : m_threads)
+	{
+		m_shards->touch(it.first);
+	}
+	m_shards->publish(m_threads);
+}
+
+threadinfo_map_t::sharded_snapshot::sharded_snapshot(uint32_t nshards)
+{
+	// the number of shards is rounded up to a power of 2, at least 2
+	uint32_t bits = 1;
+	while(bits < 16 && (1U << bits) < nshards)
+	{
+		bits++;
+	}
+	m_nshards = 1U << bits;
+	m_shift = 64 - bits;
+	m_shards = std::make_unique<shard[]>(m_nshards);
+}
+
+threadinfo_map_t::sharded_snapshot::~sharded_snapshot()
+{
+	for(uint32_t i = 0; i < m_nshards; i++)
+	{
+		delete m_shards[i].published.load();
+		for(const auto& it : m_shards[i].staged)
+		{
+			delete it.second;
+		}
+	}
+	for(const auto* view : m_unlinked)
+	{
+		delete view;
+	}
+}
+
+void threadinfo_map_t::sharded_snapshot::clear()
+{
+	for(uint32_t i = 0; i < m_nshards; i++)
+	{
+		for(const auto& it : m_shards[i].staged)
+		{
+			m_unlinked.push_back(it.second);
+		}
+		m_shards[i].staged.clear();
+		mark_dirty(m_shards[i]);
+	}
+	m_touched.clear();
+}
+
+void threadinfo_map_t::sharded_snapshot::publish(const std::unordered_map<int64_t, ptr_t>& threads)
+{
+	std::vector<const thread_view*> retired = std::move(m_unlinked);
+	m_unlinked.clear();
+
+	// copy the touched threads, the new views are swapped in place in the
+	// shards that are not rebuilt
+	std::sort(m_touched.begin(), m_touched.end());
+	m_touched.erase(std::unique(m_touched.begin(), m_touched.end()), m_touched.end());
+	for(int64_t tid : m_touched)
+	{
+		auto it = threads.find(tid);
+		if(it == threads.end())
+		{
+			continue;
+		}
+
+		shard& s = shard_of(tid);
+		const thread_view*& staged = s.staged[tid];
+		if(staged != nullptr)
+		{
+			// most touched threads didn't change any of the copied fields
+			if(staged->matches(*it->second))
+			{
+				continue;
+			}
+			retired.push_back(staged);
+		}
+		const thread_view* view = new thread_view(*it->second);
+		staged = view;
+
+		if(!s.dirty)
+		{
+			const snapshot* snap = s.published.load(std::memory_order_relaxed);
+			entry* e = snap != nullptr ? snap->find(tid) : nullptr;
+			if(e != nullptr)
+			{
+				e->view.store(view, std::memory_order_release);
+			}
+			else
+			{
+				mark_dirty(s);
+			}
+		}
+	}
+	m_touched.clear();
+
+	std::vector<std::pair<int64_t, const thread_view*>> sorted;
+	for(shard* s : m_dirty)
+	{
+		snapshot* snap = nullptr;
+		if(!s->staged.empty())
+		{
+			sorted.assign(s->staged.begin(), s->staged.end());
+			std::sort(sorted.begin(), sorted.end(),
+				[](const std::pair<int64_t, const thread_view*>& l, const std::pair<int64_t, const thread_view*>& r)
+				{ return l.first < r.first; });
+
+			snap = new snapshot(sorted.size());
+			for(size_t i = 0; i < sorted.size(); i++)
+			{
+				snap->entries[i].tid = sorted[i].first;
+				snap->entries[i].view.store(sorted[i].second, std::memory_order_relaxed);
+			}
+		}
+
+		const snapshot* old = s->published.exchange(snap, std::memory_order_seq_cst);
+		size_t old_size = old ? old->size : 0;
+		size_t new_size = snap ? snap->size : 0;
+		m_size.store(m_size.load(std::memory_order_relaxed) + new_size - old_size, std::memory_order_relaxed);
+		if(old != nullptr)
+		{
+			// the views it points to are owned by the shard, or retired below
+			m_reclaimer.retire([old]() { delete old; });
+		}
+		s->dirty = false;
+	}
+	m_dirty.clear();
+
+	// the replaced and removed views are not reachable from the shards
+	// anymore, once the readers are done with them they can be deleted
+	if(!retired.empty())
+	{
+		m_reclaimer.retire([views = std::move(retired)]()
+		{
+			for(const auto* view : views)
+			{
+				delete view;
+			}
+		});
+	}
+	m_reclaimer.collect();
+}
+
+bool threadinfo_map_t::sharded_snapshot::loop(const const_view_visitor_t& callback) const
+{
+	for(uint32_t i = 0; i < m_nshards; i++)
+	{
+		auto g = m_reclaimer.enter();
+		const snapshot* snap = m_shards[i].published.load(std::memory_order_seq_cst);
+		if(snap == nullptr)
+		{
+			continue;
+		}
+		for(size_t j = 0; j < snap->size; j++)
+		{
+			if(!callback(*snap->entries[j].view.load(std::memory_order_acquire)))
+			{
+				return false;
+			}
+		}
+	}
+	return true;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // sinsp_thread_manager implementation
 ///////////////////////////////////////////////////////////////////////////////
 sinsp_thread_manager::sinsp_thread_manager(sinsp* inspector)
-	: table(s_thread_table_name, sinsp_threadinfo().static_fields()),
+	: table(s_thread_table_name,
+		sinsp_threadinfo().static_fields(),
+		std::make_shared<libsinsp::state::dynamic_struct::columnar_field_infos>()),
 	  m_max_thread_table_size(m_thread_table_default_size)
 {
 	m_inspector = inspector;
@@ -1635,6 +2026,14 @@ void sinsp_thread_manager::remove_main_thread_fdtable(sinsp_threadinfo* main_thr
 		return;
 	}
 
+	/* The `on_erase` callback and closing the flows of the process are
+	 * the only things done here.
+	 */
+	if(m_inspector->get_observer() == nullptr && !m_inspector->get_flow_table()->is_enabled())
+	{
+		return;
+	}
+
 	sinsp_fdtable* fd_table_ptr = main_thread->get_fd_table();
 	if(fd_table_ptr == nullptr)
 	{
@@ -1646,7 +2045,9 @@ void sinsp_thread_manager::remove_main_thread_fdtable(sinsp_threadinfo* main_thr
 	eparams.m_tinfo = main_thread;
 	eparams.m_ts = m_inspector->get_lastevent_ts();
 
-	fd_table_ptr->loop([&](int64_t fd, sinsp_fdinfo& fdinfo) {
+	// the fds may still be shared with other tables after a fork, they
+	// are only read by the callbacks
+	fd_table_ptr->const_loop([&](int64_t fd, const sinsp_fdinfo& fdinfo) {
 		eparams.m_fd = fd;
 
 		//
@@ -1654,7 +2055,7 @@ void sinsp_thread_manager::remove_main_thread_fdtable(sinsp_threadinfo* main_thr
 		// here it means we have a problem.
 		//
 		ASSERT(eparams.m_fd != CANCELED_FD_NUMBER);
-		eparams.m_fdinfo = &fdinfo;
+		eparams.m_fdinfo = const_cast<sinsp_fdinfo*>(&fdinfo);
 
 		/* Here we are just calling the `on_erase` callback */
 		m_inspector->get_parser()->erase_fd(&eparams);
@@ -1908,7 +2309,7 @@ void sinsp_thread_manager::dump_threads_to_file(scap_dumper_t* dumper)
 		int argscnt, envscnt, cgroupscnt;
 		std::string argsrem, envsrem, cgroupsrem;
 		uint32_t entrylen = 0;
-		auto cg = tinfo.cgroups();
+		const auto& cg = tinfo.cgroups();
 
 		memset(&sctinfo, 0, sizeof(scap_threadinfo));
 
@@ -1977,7 +2378,7 @@ void sinsp_thread_manager::dump_threads_to_file(scap_dumper_t* dumper)
 			}
 
 			bool should_exit = false;
-			fd_table_ptr->loop([&](int64_t fd, sinsp_fdinfo& info) {
+			fd_table_ptr->const_loop([&](int64_t fd, const sinsp_fdinfo& info) {
 				//
 				// Allocate the scap fd info
 				//
@@ -2086,12 +2487,21 @@ threadinfo_map_t::ptr_t sinsp_thread_manager::get_thread_ref(int64_t tid, bool q
                 }
             }
 
-            uint64_t ts = sinsp_utils::get_current_time_ns();
-            if(scap_proc_get(m_inspector->get_scap_platform(), tid, &scap_proc, scan_sockets) == SCAP_SUCCESS)
+            if(m_async_proc_lookups && m_inspector->m_inited && !m_inspector->is_capture())
             {
-                have_scap_proc = true;
+                // the fake entry below stands in until the result is merged
+                queue_proc_lookup(tid, scan_sockets);
+            }
+            else
+            {
+                auto platform_lock = lock_scap_platform();
+                uint64_t ts = sinsp_utils::get_current_time_ns();
+                if(scap_proc_get(m_inspector->get_scap_platform(), tid, &scap_proc, scan_sockets) == SCAP_SUCCESS)
+                {
+                    have_scap_proc = true;
+                }
+                m_n_proc_lookups_duration_ns += sinsp_utils::get_current_time_ns() - ts;
             }
-            m_n_proc_lookups_duration_ns += sinsp_utils::get_current_time_ns() - ts;
         }
 
         if(have_scap_proc)
@@ -2110,6 +2520,7 @@ threadinfo_map_t::ptr_t sinsp_thread_manager::get_thread_ref(int64_t tid, bool q
             newti->m_not_expired_children = 0;
             newti->m_comm = "<NA>";
             newti->m_exe = "<NA>";
+            newti->update_derived_strings();
             newti->m_user.uid = 0xffffffff;
             newti->m_group.gid = 0xffffffff;
             newti->m_loginuser.uid = 0xffffffff;
@@ -2125,6 +2536,206 @@ threadinfo_map_t::ptr_t sinsp_thread_manager::get_thread_ref(int64_t tid, bool q
     return sinsp_proc;
 }
 
+void sinsp_thread_manager::set_async_proc_lookups(bool enabled, uint32_t max_pending)
+{
+	m_async_proc_lookups = enabled;
+	m_max_pending_proc_lookups = max_pending;
+	if(!enabled)
+	{
+		stop_proc_lookups();
+	}
+}
+
+void sinsp_thread_manager::queue_proc_lookup(int64_t tid, bool scan_sockets)
+{
+	// a placeholder of a thread removed and missing again in the meantime,
+	// the pending lookup fills the new one
+	if(m_pending_proc_lookups.find(tid) != m_pending_proc_lookups.end())
+	{
+		return;
+	}
+
+	if(m_pending_proc_lookups.size() >= m_max_pending_proc_lookups)
+	{
+		if (m_inspector->get_sinsp_stats_v2())
+		{
+			m_inspector->get_sinsp_stats_v2()->m_n_drops_async_proc_lookups++;
+		}
+		return;
+	}
+
+	if(!m_proc_lookup_source)
+	{
+		sinsp* inspector = m_inspector;
+		m_proc_lookup_source = std::make_unique<libsinsp::proc_lookup_source>(
+			m_inspector->get_scap_platform(),
+			m_scap_platform_mtx,
+			s_proc_lookup_ttl_ns / 1000000,
+			[inspector](int64_t tid, const libsinsp::proc_lookup& lookup)
+		{
+			// the event only tells the event thread when to merge,
+			// the result is collected from the source
+			char error[SCAP_LASTERR_SIZE];
+			scap_const_sized_buffer data = {nullptr, 0};
+			size_t evlen = 0;
+			scap_event_encode_params(scap_sized_buffer{nullptr, 0}, &evlen, error,
+				PPME_ASYNCEVENT_E, 3, (uint32_t)0, s_proc_lookup_event_name, data);
+
+			auto evt_buf = std::unique_ptr<uint8_t, std::default_delete<uint8_t[]>>(new uint8_t[evlen]);
+			if(scap_event_encode_params(scap_sized_buffer{evt_buf.get(), evlen}, &evlen, error,
+				PPME_ASYNCEVENT_E, 3, (uint32_t)0, s_proc_lookup_event_name, data) != SCAP_SUCCESS)
+			{
+				libsinsp_logger()->format(sinsp_logger::SEV_ERROR,
+					"could not encode proc lookup event for tid %" PRId64 ": %s", tid, error);
+				return;
+			}
+
+			auto hdr = (scap_evt*)evt_buf.get();
+			hdr->tid = tid;
+			hdr->ts = lookup.m_ts;
+			inspector->handle_async_event(sinsp_evt::from_scap_evt(std::move(evt_buf)));
+		});
+	}
+
+	m_pending_proc_lookups[tid] = sinsp_utils::get_current_time_ns();
+	m_proc_lookup_source->queue(tid, scan_sockets);
+	if (m_inspector->get_sinsp_stats_v2())
+	{
+		m_inspector->get_sinsp_stats_v2()->m_n_async_proc_lookups++;
+	}
+}
+
+void sinsp_thread_manager::merge_proc_lookup(int64_t tid)
+{
+	auto pending = m_pending_proc_lookups.find(tid);
+	if(pending == m_pending_proc_lookups.end() || !m_proc_lookup_source)
+	{
+		return;
+	}
+
+	auto res = m_proc_lookup_results.find(tid);
+	if(res == m_proc_lookup_results.end())
+	{
+		// the other results are kept until their own event comes
+		for(auto& r : m_proc_lookup_source->get_complete_results())
+		{
+			m_proc_lookup_results[r.first] = std::move(r.second);
+		}
+		res = m_proc_lookup_results.find(tid);
+	}
+
+	uint64_t queued_ts = pending->second;
+	m_pending_proc_lookups.erase(pending);
+	if(res == m_proc_lookup_results.end())
+	{
+		// the result was pruned before its event came, read /proc again
+		// rather than leaving the placeholder as it is
+		auto placeholder = find_thread(tid, true);
+		if(placeholder && placeholder->is_invalid())
+		{
+			queue_proc_lookup(tid, m_max_n_proc_socket_lookups < 0 ||
+				m_n_proc_lookups <= m_max_n_proc_socket_lookups);
+		}
+		return;
+	}
+
+	libsinsp::proc_lookup lookup = std::move(res->second);
+	m_proc_lookup_results.erase(res);
+
+	m_n_proc_lookups_duration_ns += lookup.m_duration_ns;
+	if (m_inspector->get_sinsp_stats_v2())
+	{
+		m_inspector->get_sinsp_stats_v2()->m_n_merged_async_proc_lookups++;
+		m_inspector->get_sinsp_stats_v2()->m_async_proc_lookups_merge_latency_ns +=
+			sinsp_utils::get_current_time_ns() - queued_ts;
+	}
+
+	if(!lookup.m_found)
+	{
+		return;
+	}
+
+	// Events of the thread can be parsed before the result: it may have
+	// exited (don't bring it back) or been recovered, e.g. by a clone or
+	// an execve, with info fresher than /proc.
+	auto placeholder = find_thread(tid, true);
+	if(!placeholder || !placeholder->is_invalid())
+	{
+		return;
+	}
+
+	auto newti = m_inspector->build_threadinfo();
+	newti->init(&lookup.m_proc);
+	auto tinfo = add_thread(std::move(newti), false);
+	m_last_tid = -1;
+	if(!tinfo)
+	{
+		return;
+	}
+
+	// The /proc fields above are always applied, only the state changed
+	// by the events parsed while the lookup was pending is kept: those
+	// can come after the read.
+	sinsp_fdtable* fdtable = tinfo->get_fd_table();
+	if(fdtable != nullptr)
+	{
+		placeholder->get_fdtable().const_loop([fdtable](int64_t fd, const sinsp_fdinfo& fdinfo)
+		{
+			fdtable->add(fd, fdinfo.clone());
+			return true;
+		});
+	}
+
+	if(!placeholder->get_own_cwd().empty())
+	{
+		tinfo->update_cwd(placeholder->get_own_cwd());
+	}
+
+	if(placeholder->m_user.uid != 0xffffffff)
+	{
+		tinfo->set_user(placeholder->m_user.uid);
+	}
+
+	if(placeholder->m_group.gid != 0xffffffff)
+	{
+		tinfo->set_group(placeholder->m_group.gid);
+	}
+}
+
+void sinsp_thread_manager::wait_proc_lookups()
+{
+	if(m_proc_lookup_source)
+	{
+		m_proc_lookup_source->wait_idle();
+	}
+}
+
+void sinsp_thread_manager::remove_stale_proc_lookups()
+{
+	// the event of a lookup can be dropped if the async queue is full, and
+	// its result pruned by the source after the same delay
+	uint64_t now = sinsp_utils::get_current_time_ns();
+	for(auto it = m_pending_proc_lookups.begin(); it != m_pending_proc_lookups.end();)
+	{
+		if(now > it->second + s_proc_lookup_ttl_ns)
+		{
+			m_proc_lookup_results.erase(it->first);
+			it = m_pending_proc_lookups.erase(it);
+		}
+		else
+		{
+			++it;
+		}
+	}
+}
+
+void sinsp_thread_manager::stop_proc_lookups()
+{
+	m_proc_lookup_source.reset();
+	m_pending_proc_lookups.clear();
+	m_proc_lookup_results.clear();
+}
+
 /* `lookup_only==true` means that we don't fill the `m_last_tinfo` field */
 threadinfo_map_t::ptr_t sinsp_thread_manager::find_thread(int64_t tid, bool lookup_only)
 {
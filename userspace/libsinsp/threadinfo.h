@@ -29,11 +29,17 @@ struct iovec {
 #include <sys/uio.h>
 #endif
 
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <set>
+#include <libsinsp/epoch_reclaimer.h>
 #include <libsinsp/fdinfo.h>
+#include <libsinsp/proc_lookup_source.h>
 #include <libsinsp/state/table.h>
+#include <libsinsp/sinsp_cgroup_set.h>
 #include <libsinsp/thread_group_info.h>
 
 class blprogram;
@@ -90,6 +96,22 @@ public:
 	*/
 	std::string get_cwd();
 
+	/*!
+	  \brief Same as get_cwd(), without copying the string. The reference is
+	  valid until the working directory or the thread table changes.
+	*/
+	const std::string& get_cwd_ref();
+
+	/*!
+	  \brief Return the working directory kept on this thread itself: the
+	  one of the process on main threads, the one set by events on a
+	  placeholder waiting for its /proc lookup, empty otherwise.
+	*/
+	inline const std::string& get_own_cwd() const
+	{
+		return m_cwd;
+	}
+
 	inline void set_cwd(const std::string& v)
 	{
 		m_cwd = v;
@@ -112,6 +134,38 @@ public:
 	*/
 	std::string concatenate_all_env();
 
+	/*!
+	  \brief Same as concatenate_all_env(), but the string is built by the
+	  process main thread when its environment is set. If the environment
+	  changed since, it's built into `storage`, which is returned instead.
+	*/
+	const std::string& get_concatenated_env(std::string& storage) const;
+	std::string get_concatenated_env() const;
+
+	/*!
+	  \brief Return the command line of this thread (comm followed by the
+	  arguments). The string is built when the arguments are set. If comm
+	  or the arguments changed since, it's built into `storage`, which is
+	  returned instead.
+	*/
+	const std::string& get_cmdline(std::string& storage) const;
+	std::string get_cmdline() const;
+
+	/*!
+	  \brief Return the exe followed by the arguments. The string is built
+	  when the arguments are set. If exe or the arguments changed since,
+	  it's built into `storage`, which is returned instead.
+	*/
+	const std::string& get_exeline(std::string& storage) const;
+	std::string get_exeline() const;
+
+	/*!
+	  \brief Rebuild the cached command line and environment strings, to be
+	  called when m_comm, m_exe, m_args or m_env are modified directly.
+	  Until then the getters above build a copy on every call.
+	*/
+	void update_derived_strings();
+
 	/*!
 	  \brief Return true if this is a process' main thread.
 	*/
@@ -255,6 +309,38 @@ public:
 	*/
 	sinsp_threadinfo* get_parent_thread();
 
+	/*!
+	  \brief Get the ancestors of this thread, starting from its parent, in
+	  the same order traverse_parent_state() visits them.
+	  The list is cached and rebuilt only when the lineage changed, so
+	  repeated ancestor lookups don't go through the thread table.
+	  The returned pointers are valid until the thread table changes.
+	*/
+	const std::vector<sinsp_threadinfo*>& get_ancestors();
+
+	/*!
+	  \brief Get the n-th ancestor of this thread, 0 being the thread itself
+	  and 1 its parent. Returns NULL if the lineage is shorter than n.
+	*/
+	inline sinsp_threadinfo* get_ancestor(uint32_t n)
+	{
+		if(n == 0)
+		{
+			return this;
+		}
+		auto& ancestors = get_ancestors();
+		return n <= ancestors.size() ? ancestors[n - 1] : nullptr;
+	}
+
+	/*!
+	  \brief Drop the cached ancestors of this thread and of its
+	  descendants, to be called when the thread execs or is reparented.
+	*/
+	inline void invalidate_lineage()
+	{
+		m_lineage_gen++;
+	}
+
 	/*!
 	  \brief Retrieve information about one of this thread/process FDs.
 
@@ -279,8 +365,10 @@ public:
 			{
 				// Its current name is now its old
 				// name. The name might change as a
-				// result of parsing.
-				fdinfo->m_oldname = fdinfo->m_name;
+				// result of parsing. Don't render a
+				// name still pending from the tuple
+				// just to remember it.
+				fdinfo->m_oldname = fdinfo->is_name_pending() ? libsinsp::interned_string() : fdinfo->get_name();
 				return fdinfo;
 			}
 		}
@@ -288,6 +376,21 @@ public:
 		return NULL;
 	}
 
+	/*!
+	  \brief Same as get_fd(), for the callers that don't modify the FD:
+	   an FD shared with the parent process after a fork is not copied.
+	*/
+	inline const sinsp_fdinfo* const_get_fd(int64_t fd) const
+	{
+		if(fd < 0)
+		{
+			return NULL;
+		}
+
+		const sinsp_fdtable* fdt = get_fd_table();
+		return fdt != NULL ? fdt->const_find(fd) : NULL;
+	}
+
 	/*!
 	  \brief Iterate over open file descriptors in the process.
 
@@ -408,8 +511,18 @@ public:
 	void set_group(uint32_t gid);
 	void set_loginuser(uint32_t loginuid);
 
-	using cgroups_t = std::vector<std::pair<std::string, std::string>>;
-	cgroups_t& cgroups() const;
+	using cgroups_t = libsinsp::sinsp_cgroup_set_pool::cgroups_t;
+	const cgroups_t& cgroups() const;
+
+	/*!
+	  \brief Return the cgroup set shared by all the threads with the
+	  same cgroup membership, two threads are in the same cgroups if and
+	  only if their sets are the same object. Can be nullptr.
+	 */
+	inline const libsinsp::sinsp_cgroup_set_pool::set_ptr_t& get_cgroup_set() const
+	{
+		return m_cgroups;
+	}
 
 	//
 	// Core state
@@ -427,7 +540,7 @@ public:
 	bool m_exe_from_memfd;	///< True if the executable is stored in fileless memory referenced by memfd
 	std::vector<std::string> m_args; ///< Command line arguments (e.g. "-d1")
 	std::vector<std::string> m_env; ///< Environment variables
-	std::unique_ptr<cgroups_t> m_cgroups; ///< subsystem-cgroup pairs
+	libsinsp::sinsp_cgroup_set_pool::set_ptr_t m_cgroups; ///< subsystem-cgroup pairs, shared with the threads in the same cgroups
 	std::string m_container_id; ///< heuristic-based container id
 	uint32_t m_flags; ///< The thread flags. See the PPM_CL_* declarations in ppm_events_public.h.
 	int64_t m_fdlimit;  ///< The maximum number of FDs this thread can open
@@ -655,7 +768,13 @@ public:
 
 private:
 	sinsp_threadinfo* get_cwd_root();
+	bool is_lineage_valid();
 	bool set_env_from_proc();
+	void build_cmdline(std::string& cmdline) const;
+	void build_exeline(std::string& exeline) const;
+	void build_concatenated_env(std::string& env) const;
+	void update_args_strings();
+	void update_env_string();
 	size_t strvec_len(const std::vector<std::string> &strs) const;
 	void strvec_to_iovec(const std::vector<std::string> &strs,
 			     struct iovec **iov, int *iovcnt,
@@ -680,6 +799,41 @@ private:
 	sinsp_evt::category m_lastevent_category;
 	bool m_parent_loop_detected;
 	blprogram* m_blprogram;
+
+	//
+	// Cached lineage, see get_ancestors(). Every ancestor is stamped with
+	// its parent tid and lineage generation at the time of the snapshot.
+	//
+	struct lineage_stamp
+	{
+		std::weak_ptr<sinsp_threadinfo> ref;
+		int64_t ptid;
+		uint64_t gen;
+	};
+	std::vector<sinsp_threadinfo*> m_lineage;
+	std::vector<lineage_stamp> m_lineage_stamps;
+	bool m_lineage_cached = false;
+	bool m_lineage_truncated = false; // the topmost parent was not in the thread table
+	int64_t m_lineage_ptid = -1;
+	uint64_t m_lineage_self_gen = 0;
+	uint64_t m_lineage_gen = 0;
+
+	//
+	// Strings derived from the args and env, built when they are set so
+	// that the getters never write. Each one remembers the generation and
+	// the comm/exe it was built from.
+	//
+	struct derived_string
+	{
+		std::string value;
+		std::string key;
+		uint64_t gen = UINT64_MAX;
+	};
+	derived_string m_cmdline_cache;
+	derived_string m_exeline_cache;
+	derived_string m_env_cache;
+	uint64_t m_args_gen = 0;
+	uint64_t m_env_gen = 0;
 };
 
 /*@}*/
@@ -692,8 +846,14 @@ public:
 	typedef std::function<bool(sinsp_threadinfo&)> visitor_t;
 	typedef std::shared_ptr<sinsp_threadinfo> ptr_t;
 
+	static constexpr uint32_t default_concurrent_shards = 64;
+
 	inline void put(ptr_t tinfo)
 	{
+		if (m_shards)
+		{
+			m_shards->touch(tinfo->m_tid);
+		}
 		m_threads[tinfo->m_tid] = tinfo;
 	}
 
@@ -719,11 +879,19 @@ public:
 
 	inline void erase(uint64_t tid)
 	{
+		if (m_shards)
+		{
+			m_shards->erase(tid);
+		}
 		m_threads.erase(tid);
 	}
 
 	inline void clear()
 	{
+		if (m_shards)
+		{
+			m_shards->clear();
+		}
 		m_threads.clear();
 	}
 
@@ -768,8 +936,244 @@ public:
 		return m_threads.size();
 	}
 
+	// ---- concurrent reads ----
+	//
+	// When enabled, the table also keeps a sharded copy of itself, which
+	// other threads can look up without locks while the owner thread keeps
+	// mutating the table. Readers never see the live threadinfos: every
+	// thread is published as an immutable thread_view, a copy of its most
+	// used fields. The owner makes its changes visible by calling
+	// publish(), which copies the threads that were put in the table or
+	// marked with touch() since the previous call and actually changed,
+	// and only rebuilds the
+	// shards whose set of threads changed. Old shards and views are
+	// reclaimed on the owner thread, once no reader can see them anymore.
+	//
+
+	/*!
+	  \brief Immutable copy of the fields of a thread, as seen by the
+	  concurrent readers.
+	*/
+	struct thread_view
+	{
+		explicit thread_view(sinsp_threadinfo& tinfo);
+
+		// whether the copy is still up to date, without allocating
+		bool matches(sinsp_threadinfo& tinfo) const;
+
+		int64_t m_tid;
+		int64_t m_pid;
+		int64_t m_ptid;
+		int64_t m_sid;
+		int64_t m_vtid;
+		int64_t m_vpid;
+		int64_t m_vpgid;
+		uint32_t m_uid;
+		uint32_t m_gid;
+		uint32_t m_loginuid;
+		uint32_t m_flags;
+		uint32_t m_tty;
+		uint64_t m_clone_ts;
+		uint64_t m_lastexec_ts;
+		std::string m_comm;
+		std::string m_exe;
+		std::string m_exepath;
+		std::vector<std::string> m_args;
+		std::string m_cwd;
+		std::string m_root;
+		std::string m_container_id;
+	};
+
+	typedef std::function<bool(const thread_view&)> const_view_visitor_t;
+
+	/*!
+	  \brief Enable or disable the concurrent reads. Must be called by the
+	  owner thread while no other thread is reading the table.
+	*/
+	void set_concurrent_reads(bool enable, uint32_t nshards = default_concurrent_shards);
+
+	inline bool concurrent_reads_enabled() const
+	{
+		return m_shards != nullptr;
+	}
+
+	/*!
+	  \brief Marks a thread whose fields may have been changed in place, so
+	  that the next publish() refreshes its copy if they did. Must be called
+	  by the owner thread.
+	*/
+	inline void touch(int64_t tid)
+	{
+		if (m_shards)
+		{
+			m_shards->touch(tid);
+		}
+	}
+
+	/*!
+	  \brief Makes the mutations done so far visible to the concurrent
+	  readers, and frees the shards and views they're done with. Must be
+	  called by the owner thread.
+	*/
+	inline void publish()
+	{
+		if (m_shards)
+		{
+			m_shards->publish(m_threads);
+		}
+	}
+
+	/*!
+	  \brief Calls `callback` with the thread with the given tid, as of the
+	  last publish(). Can be called by any thread, and returns false if the
+	  thread is not found or concurrent reads are disabled.
+	*/
+	inline bool concurrent_visit(int64_t tid, const const_view_visitor_t& callback) const
+	{
+		if (!m_shards)
+		{
+			return false;
+		}
+		return m_shards->visit(tid, callback);
+	}
+
+	/*!
+	  \brief Calls `callback` for all the threads as of the last publish(),
+	  until it returns false. Can be called by any thread, every shard is
+	  consistent on its own but the shards are visited one after the other.
+	*/
+	inline bool concurrent_loop(const const_view_visitor_t& callback) const
+	{
+		if (!m_shards)
+		{
+			return true;
+		}
+		return m_shards->loop(callback);
+	}
+
+	/*!
+	  \brief Returns the number of threads as of the last publish(). Can be
+	  called by any thread.
+	*/
+	inline size_t concurrent_size() const
+	{
+		return m_shards ? m_shards->size() : 0;
+	}
+
 protected:
+	class sharded_snapshot
+	{
+	public:
+		explicit sharded_snapshot(uint32_t nshards);
+		~sharded_snapshot();
+
+		// owner-side
+		inline void touch(int64_t tid)
+		{
+			m_touched.push_back(tid);
+		}
+
+		inline void erase(int64_t tid)
+		{
+			auto& s = shard_of(tid);
+			auto it = s.staged.find(tid);
+			if (it != s.staged.end())
+			{
+				m_unlinked.push_back(it->second);
+				s.staged.erase(it);
+				mark_dirty(s);
+			}
+		}
+
+		void clear();
+		void publish(const std::unordered_map<int64_t, ptr_t>& threads);
+
+		// reader-side
+		inline bool visit(int64_t tid, const const_view_visitor_t& callback) const
+		{
+			auto g = m_reclaimer.enter();
+			const snapshot* snap = shard_of(tid).published.load(std::memory_order_seq_cst);
+			if (snap == nullptr)
+			{
+				return false;
+			}
+			const entry* e = snap->find(tid);
+			if (e == nullptr)
+			{
+				return false;
+			}
+			callback(*e->view.load(std::memory_order_acquire));
+			return true;
+		}
+
+		bool loop(const const_view_visitor_t& callback) const;
+
+		inline size_t size() const
+		{
+			return m_size.load(std::memory_order_relaxed);
+		}
+
+	private:
+		struct entry
+		{
+			int64_t tid;
+			// swapped by the owner when the thread is touched
+			std::atomic<const thread_view*> view;
+		};
+
+		struct snapshot
+		{
+			explicit snapshot(size_t n): entries(std::make_unique<entry[]>(n)), size(n) {}
+
+			inline entry* find(int64_t tid) const
+			{
+				entry* end = entries.get() + size;
+				entry* it = std::lower_bound(entries.get(), end, tid,
+					[](const entry& e, int64_t t) { return e.tid < t; });
+				return (it == end || it->tid != tid) ? nullptr : it;
+			}
+
+			// sorted by tid
+			std::unique_ptr<entry[]> entries;
+			size_t size;
+		};
+
+		struct shard
+		{
+			// the latest view of every thread of the shard, owned here
+			std::unordered_map<int64_t, const thread_view*> staged;
+			std::atomic<const snapshot*> published{nullptr};
+			bool dirty = false;
+		};
+
+		inline shard& shard_of(int64_t tid) const
+		{
+			// multiplicative hashing, tids are often sequential
+			return m_shards[((uint64_t)tid * 0x9E3779B97F4A7C15ULL) >> m_shift];
+		}
+
+		inline void mark_dirty(shard& s)
+		{
+			if (!s.dirty)
+			{
+				s.dirty = true;
+				m_dirty.push_back(&s);
+			}
+		}
+
+		uint32_t m_shift;
+		uint32_t m_nshards;
+		std::unique_ptr<shard[]> m_shards;
+		std::vector<shard*> m_dirty;
+		std::vector<int64_t> m_touched;
+		// views removed from the staged ones, still visible until the next publish
+		std::vector<const thread_view*> m_unlinked;
+		std::atomic<size_t> m_size{0};
+		mutable epoch_reclaimer m_reclaimer;
+	};
+
 	std::unordered_map<int64_t, ptr_t> m_threads;
+	std::unique_ptr<sharded_snapshot> m_shards;
 };
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -850,6 +1254,37 @@ public:
 	void set_m_max_n_proc_lookups(int32_t val) { m_max_n_proc_lookups = val; }
 	void set_m_max_n_proc_socket_lookups(int32_t val) { m_max_n_proc_socket_lookups = val; }
 
+	/*!
+	  \brief When enabled, a thread missing from the table is not looked up
+	  in /proc by the event thread: get_thread_ref() returns an invalid
+	  placeholder right away, and /proc is read by a background thread.
+	  The result is merged when the asyncevent queued for it is parsed: the
+	  /proc fields replace the placeholder ones, but the fds, cwd, user and
+	  group set by the events parsed in the meantime are kept. It is
+	  dropped if the thread exited or was recovered, e.g. by a clone, in the
+	  meantime. Not used when reading capture files, nor before the
+	  inspector is open.
+
+	  \param max_pending how many lookups can be pending at once, the
+	  threads missing beyond that keep the placeholder
+	*/
+	void set_async_proc_lookups(bool enabled, uint32_t max_pending = 1024);
+	bool get_async_proc_lookups() const { return m_async_proc_lookups; }
+	// Number of lookups queued or waiting to be merged
+	size_t get_n_pending_proc_lookups() const { return m_pending_proc_lookups.size(); }
+	// Called when the asyncevent of a lookup is parsed
+	void merge_proc_lookup(int64_t tid);
+	// Blocks until /proc was read for the queued lookups and their
+	// asyncevents are queued
+	void wait_proc_lookups();
+	// Stops the background thread and forgets the pending lookups
+	void stop_proc_lookups();
+	// To hold while using the state of the scap platform (e.g. the device
+	// list) from the event thread, the async lookups use it too. It can be
+	// taken again from the callbacks of the platform.
+	std::unique_lock<std::recursive_mutex> lock_scap_platform() { return std::unique_lock<std::recursive_mutex>(m_scap_platform_mtx); }
+	static constexpr const char* s_proc_lookup_event_name = "proc_lookup";
+
 	// ---- libsinsp::state::table implementation ----
 
 	size_t entries_count() const override
@@ -948,6 +1383,8 @@ public:
 
 private:
 	inline void clear_thread_pointers(sinsp_threadinfo& threadinfo);
+	void queue_proc_lookup(int64_t tid, bool scan_sockets);
+	void remove_stale_proc_lookups();
 	void free_dump_fdinfos(std::vector<scap_fdinfo*>* fdinfos_to_free);
 
 	sinsp* m_inspector;
@@ -966,4 +1403,13 @@ private:
 	int32_t m_n_main_thread_lookups = 0;
 	int32_t m_max_n_proc_lookups = -1;
 	int32_t m_max_n_proc_socket_lookups = -1;
+
+	bool m_async_proc_lookups = false;
+	uint32_t m_max_pending_proc_lookups = 1024;
+	std::unique_ptr<libsinsp::proc_lookup_source> m_proc_lookup_source;
+	std::recursive_mutex m_scap_platform_mtx;
+	// tid -> time the lookup was queued
+	std::unordered_map<int64_t, uint64_t> m_pending_proc_lookups;
+	// results collected from the source whose event is still in the queue
+	std::unordered_map<int64_t, libsinsp::proc_lookup> m_proc_lookup_results;
 };
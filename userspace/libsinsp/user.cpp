@@ -24,6 +24,7 @@ limitations under the License.
 #include <libsinsp/sinsp.h>
 #include <libscap/strl.h>
 #include <sys/types.h>
+#include <cstring>
 
 #ifdef HAVE_PWD_H
 #include <pwd.h>
@@ -116,6 +117,48 @@ static struct group *__getgrgid(uint32_t gid, const std::string &host_root)
 
 using namespace std;
 
+namespace {
+
+const string persisted_users_prefix = "users:";
+const string persisted_groups_prefix = "groups:";
+
+// The tables are stored as a sequence of ids followed by NUL-terminated
+// strings, the scap structs have fixed size path buffers
+void append_id(string &out, uint32_t id)
+{
+	out.append((const char*)&id, sizeof(id));
+}
+
+void append_str(string &out, const char *str)
+{
+	out.append(str, strlen(str) + 1);
+}
+
+bool read_id(const string &in, size_t &pos, uint32_t &id)
+{
+	if(pos + sizeof(id) > in.size())
+	{
+		return false;
+	}
+	memcpy(&id, in.data() + pos, sizeof(id));
+	pos += sizeof(id);
+	return true;
+}
+
+bool read_str(const string &in, size_t &pos, string_view &str)
+{
+	size_t end = in.find('\0', pos);
+	if(end == string::npos)
+	{
+		return false;
+	}
+	str = string_view(in.data() + pos, end - pos);
+	pos = end + 1;
+	return true;
+}
+
+}
+
 // clang-format off
 sinsp_usergroup_manager::sinsp_usergroup_manager(sinsp* inspector)
 	: m_import_users(true)
@@ -200,6 +243,109 @@ void sinsp_usergroup_manager::delete_container_users_groups(const sinsp_containe
 
 	m_userlist.erase(cinfo.m_id);
 	m_grouplist.erase(cinfo.m_id);
+
+	if(m_persistent_cache)
+	{
+		m_persistent_cache->erase(persisted_users_prefix + cinfo.m_id);
+		m_persistent_cache->erase(persisted_groups_prefix + cinfo.m_id);
+	}
+}
+
+void sinsp_usergroup_manager::set_persistent_cache(const std::shared_ptr<libsinsp::persistent_cache>& cache)
+{
+	m_persistent_cache = cache;
+}
+
+void sinsp_usergroup_manager::load_persistent_cache()
+{
+	if(!m_persistent_cache || !m_import_users)
+	{
+		return;
+	}
+
+	vector<string> stale;
+	m_persistent_cache->foreach_entry(persisted_users_prefix, [&](const string &key, const string &value)
+	{
+		string container_id = key.substr(persisted_users_prefix.size());
+		if(!m_inspector->m_container_manager.get_container(container_id))
+		{
+			stale.push_back(key);
+			return true;
+		}
+
+		userinfo_map users;
+		size_t pos = 0;
+		uint32_t uid, gid;
+		string_view name, home, shell;
+		while(read_id(value, pos, uid) && read_id(value, pos, gid) &&
+		      read_str(value, pos, name) && read_str(value, pos, home) && read_str(value, pos, shell))
+		{
+			userinfo_map_insert(users, uid, gid, name, home, shell);
+		}
+		m_userlist[container_id] = std::move(users);
+		return true;
+	});
+
+	m_persistent_cache->foreach_entry(persisted_groups_prefix, [&](const string &key, const string &value)
+	{
+		string container_id = key.substr(persisted_groups_prefix.size());
+		if(!m_inspector->m_container_manager.get_container(container_id))
+		{
+			stale.push_back(key);
+			return true;
+		}
+
+		groupinfo_map groups;
+		size_t pos = 0;
+		uint32_t gid;
+		string_view name;
+		while(read_id(value, pos, gid) && read_str(value, pos, name))
+		{
+			groupinfo_map_insert(groups, gid, name);
+		}
+		m_grouplist[container_id] = std::move(groups);
+		return true;
+	});
+
+	for(const auto &key : stale)
+	{
+		m_persistent_cache->erase(key);
+	}
+}
+
+void sinsp_usergroup_manager::persist_container_users(const std::string &container_id)
+{
+	if(!m_persistent_cache)
+	{
+		return;
+	}
+
+	string value;
+	for(const auto &it : m_userlist[container_id])
+	{
+		append_id(value, it.second.uid);
+		append_id(value, it.second.gid);
+		append_str(value, it.second.name);
+		append_str(value, it.second.homedir);
+		append_str(value, it.second.shell);
+	}
+	m_persistent_cache->put(persisted_users_prefix + container_id, value);
+}
+
+void sinsp_usergroup_manager::persist_container_groups(const std::string &container_id)
+{
+	if(!m_persistent_cache)
+	{
+		return;
+	}
+
+	string value;
+	for(const auto &it : m_grouplist[container_id])
+	{
+		append_id(value, it.second.gid);
+		append_str(value, it.second.name);
+	}
+	m_persistent_cache->put(persisted_groups_prefix + container_id, value);
 }
 
 bool sinsp_usergroup_manager::clear_host_users_groups()
@@ -373,6 +519,7 @@ scap_userinfo *sinsp_usergroup_manager::add_container_user(const std::string &co
 			}
 		}
 		fclose(pwd_file);
+		persist_container_users(container_id);
 	}
 #endif
 
@@ -487,6 +634,7 @@ scap_groupinfo *sinsp_usergroup_manager::add_container_group(const std::string &
 			}
 		}
 		fclose(group_file);
+		persist_container_groups(container_id);
 	}
 #endif
 
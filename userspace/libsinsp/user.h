@@ -23,6 +23,7 @@ limitations under the License.
 #include <string>
 #include <memory>
 #include <libsinsp/container_info.h>
+#include <libsinsp/persistent_cache.h>
 #include <libsinsp/procfs_utils.h>
 #include <libscap/scap.h>
 
@@ -56,6 +57,9 @@ namespace libsinsp { namespace procfs_utils { class ns_helper; }}
  * * Containers users and groups gets bulk deleted once the container is cleaned up and
  *      PPME_{USER,GROUP}_DELETED_E event is sent for each of them.
  *
+ * * With a persistent cache, the users and groups read from a container are saved with
+ *      its metadata, and restored after a restart together with the container.
+ *
  * * Each threadinfo stores internally its user and group informations.
  *      This is needed to avoid that eg: a threadinfo spawns on uid 1000 "foo".
  *      Then, uid 1000 is deleted, and a new uid 1000 is created, named "bar".
@@ -73,6 +77,19 @@ public:
 
 	void dump_users_groups(sinsp_dumper& dumper);
 
+	/*!
+	  \brief Save the users and groups read from the containers in the
+	  given cache, nullptr to stop saving.
+	*/
+	void set_persistent_cache(const std::shared_ptr<libsinsp::persistent_cache>& cache);
+
+	/*!
+	  \brief Restore the users and groups saved in the persistent cache
+	  for the containers known to the container manager, to be called once
+	  the containers are restored.
+	*/
+	void load_persistent_cache();
+
 	/*!
   	  \brief Return the table with all the machine users.
 
@@ -150,6 +167,9 @@ private:
 	void notify_user_changed(const scap_userinfo *user, const std::string &container_id, bool added = true);
 	void notify_group_changed(const scap_groupinfo *group, const std::string &container_id, bool added = true);
 
+	void persist_container_users(const std::string &container_id);
+	void persist_container_groups(const std::string &container_id);
+
 	using userinfo_map = std::unordered_map<uint32_t, scap_userinfo>;
 	using groupinfo_map = std::unordered_map<uint32_t, scap_groupinfo>;
 
@@ -177,6 +197,8 @@ private:
 
 	const std::string &m_host_root;
 	std::unique_ptr<libsinsp::procfs_utils::ns_helper> m_ns_helper;
+
+	std::shared_ptr<libsinsp::persistent_cache> m_persistent_cache;
 };
 
 #endif // KHULNASOFT_LIBS_USER_H
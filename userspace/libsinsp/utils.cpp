@@ -23,6 +23,8 @@ limitations under the License.
 #include <libsinsp/filter.h>
 #include <libsinsp/filter_check_list.h>
 #include <libsinsp/filterchecks.h>
+#include <libsinsp/dns_manager.h>
+#include <libsinsp/sinsp_services_table.h>
 #include <libscap/strl.h>
 
 #if !defined(_WIN32) && !defined(MINIMAL_BUILD) && !defined(__EMSCRIPTEN__)
@@ -462,7 +464,24 @@ const char* sinsp_utils::signal_to_str(uint8_t code)
 	}
 }
 
-bool sinsp_utils::sockinfo_to_str(sinsp_sockinfo* sinfo, scap_fd_type stype, char* targetbuf, uint32_t targetbuf_size, bool resolve)
+//
+// Returns the name of the address if it has been resolved already,
+// `numeric` otherwise. Resolution happens in the background.
+//
+static std::string address_to_string(int af, const void* addr, const char* numeric, bool resolve)
+{
+	if(resolve)
+	{
+		std::string name = sinsp_reverse_dns_manager::get().name_of(af, addr);
+		if(!name.empty())
+		{
+			return name;
+		}
+	}
+	return numeric;
+}
+
+bool sinsp_utils::sockinfo_to_str(const sinsp_sockinfo* sinfo, scap_fd_type stype, char* targetbuf, uint32_t targetbuf_size, bool resolve)
 {
 	if(stype == SCAP_FD_IPV4_SOCK)
 	{
@@ -541,9 +560,9 @@ bool sinsp_utils::sockinfo_to_str(sinsp_sockinfo* sinfo, scap_fd_type stype, cha
 					snprintf(targetbuf,
 								targetbuf_size,
 								"%s:%s->%s:%s",
-								srcstr,
+								address_to_string(AF_INET6, sip6, srcstr, resolve).c_str(),
 								port_to_string(sinfo->m_ipv6info.m_fields.m_sport, sinfo->m_ipv6info.m_fields.m_l4proto, resolve).c_str(),
-								dststr,
+								address_to_string(AF_INET6, dip6, dststr, resolve).c_str(),
 								port_to_string(sinfo->m_ipv6info.m_fields.m_dport, sinfo->m_ipv6info.m_fields.m_l4proto, resolve).c_str());
 					return true;
 				}
@@ -1135,6 +1154,18 @@ std::string port_to_string(uint16_t port, uint8_t l4proto, bool resolve)
 	std::string ret = "";
 	if(resolve)
 	{
+#if !defined(_WIN32) && !defined(__EMSCRIPTEN__)
+		// the services database is loaded once, no NSS lookup here
+		const char* name = libsinsp::sinsp_services_table::get().lookup(port, l4proto);
+		if(name != nullptr)
+		{
+			ret = name;
+		}
+		else
+		{
+			ret = std::to_string(port);
+		}
+#else
 		std::string proto = "";
 		if(l4proto == SCAP_L4_TCP)
 		{
@@ -1156,6 +1187,7 @@ std::string port_to_string(uint16_t port, uint8_t l4proto, bool resolve)
 		{
 			ret = std::to_string(port);
 		}
+#endif
 	}
 	else
 	{
@@ -1173,16 +1205,14 @@ std::string ipv4serveraddr_to_string(ipv4serverinfo* addr, bool resolve)
 	// IP address is in network byte order regardless of host endianness
 	snprintf(buf,
 		sizeof(buf),
-		"%d.%d.%d.%d:%s", ip[0], ip[1], ip[2], ip[3],
-		port_to_string(addr->m_port, addr->m_l4proto, resolve).c_str());
+		"%d.%d.%d.%d", ip[0], ip[1], ip[2], ip[3]);
 
-	return std::string(buf);
+	return address_to_string(AF_INET, &addr->m_ip, buf, resolve) + ':' +
+		port_to_string(addr->m_port, addr->m_l4proto, resolve);
 }
 
 std::string ipv4tuple_to_string(ipv4tuple* tuple, bool resolve)
 {
-	char buf[100];
-
 	ipv4serverinfo info;
 
 	info.m_ip = tuple->m_fields.m_sip;
@@ -1195,26 +1225,20 @@ std::string ipv4tuple_to_string(ipv4tuple* tuple, bool resolve)
 	info.m_l4proto = tuple->m_fields.m_l4proto;
 	std::string dest = ipv4serveraddr_to_string(&info, resolve);
 
-	snprintf(buf, sizeof(buf), "%s->%s", source.c_str(), dest.c_str());
-
-	return std::string(buf);
+	return source + "->" + dest;
 }
 
 std::string ipv6serveraddr_to_string(ipv6serverinfo* addr, bool resolve)
 {
 	char address[100];
-	char buf[200];
 
 	if(NULL == inet_ntop(AF_INET6, addr->m_ip.m_b, address, 100))
 	{
 		return std::string();
 	}
 
-	snprintf(buf,200,"%s:%s",
-		address,
-		port_to_string(addr->m_port, addr->m_l4proto, resolve).c_str());
-
-	return std::string(buf);
+	return address_to_string(AF_INET6, addr->m_ip.m_b, address, resolve) + ':' +
+		port_to_string(addr->m_port, addr->m_l4proto, resolve);
 }
 
 std::string ipv6tuple_to_string(ipv6tuple* tuple, bool resolve)
@@ -1231,14 +1255,10 @@ std::string ipv6tuple_to_string(ipv6tuple* tuple, bool resolve)
 		return std::string();
 	}
 
-	char buf[200];
-	snprintf(buf, sizeof(buf), "%s:%s->%s:%s",
-		source_address,
-		port_to_string(tuple->m_fields.m_sport, tuple->m_fields.m_l4proto, resolve).c_str(),
-		destination_address,
-		port_to_string(tuple->m_fields.m_dport, tuple->m_fields.m_l4proto, resolve).c_str());
-
-	return std::string(buf);
+	return address_to_string(AF_INET6, tuple->m_fields.m_sip.m_b, source_address, resolve) + ':' +
+		port_to_string(tuple->m_fields.m_sport, tuple->m_fields.m_l4proto, resolve) + "->" +
+		address_to_string(AF_INET6, tuple->m_fields.m_dip.m_b, destination_address, resolve) + ':' +
+		port_to_string(tuple->m_fields.m_dport, tuple->m_fields.m_l4proto, resolve);
 }
 
 const char* param_type_to_string(ppm_param_type pt)
@@ -75,7 +75,7 @@ public:
 	//
 	//
 	//
-	static bool sockinfo_to_str(sinsp_sockinfo* sinfo, scap_fd_type stype, char* targetbuf, uint32_t targetbuf_size, bool resolve = false);
+	static bool sockinfo_to_str(const sinsp_sockinfo* sinfo, scap_fd_type stype, char* targetbuf, uint32_t targetbuf_size, bool resolve = false);
 
 	//
 	// Check if string ends with another
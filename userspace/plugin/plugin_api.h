@@ -30,7 +30,7 @@ extern "C" {
 //
 // todo(jasondellaluce): when/if major changes to v4, check and solve all todos
 #define PLUGIN_API_VERSION_MAJOR 3
-#define PLUGIN_API_VERSION_MINOR 4
+#define PLUGIN_API_VERSION_MINOR 6
 #define PLUGIN_API_VERSION_PATCH 0
 
 //
@@ -107,6 +107,13 @@ typedef void ss_plugin_table_iterator_state_t;
 // proceed to the next element, or false in case of break out.
 typedef ss_plugin_bool (*ss_plugin_table_iterator_func_t)(ss_plugin_table_iterator_state_t* s, ss_plugin_table_entry_t* e);
 
+// Iterator function callback used by a plugin for looping through all the
+// entries of a given state table in chunks. The "entries" array contains
+// "nentries" entries and is only valid during the callback invocation.
+// Returns true if the iteration should proceed to the next chunk, or false
+// in case of break out.
+typedef ss_plugin_bool (*ss_plugin_table_iterator_batch_func_t)(ss_plugin_table_iterator_state_t* s, ss_plugin_table_entry_t** entries, uint32_t nentries);
+
 typedef struct
 {
 	// Returns the table's name, or NULL in case of error.
@@ -139,6 +146,21 @@ typedef struct
 	// callback function for each of them. Returns false in case of failure or
 	// iteration break-out, and true otherwise.
 	ss_plugin_bool (*iterate_entries)(ss_plugin_table_t* t, ss_plugin_table_iterator_func_t it, ss_plugin_table_iterator_state_t* s);
+	//
+	// Reads the values of "nfields" fields from each of the "nentries" entries
+	// passed in, all in one call. The values are stored in the "out" array,
+	// which must be large enough to hold nentries * nfields values, in row-major
+	// order: the value of fields[j] for entries[i] is stored in out[i * nfields + j].
+	// Returns SS_PLUGIN_SUCCESS if all the values are read successfully,
+	// and SS_PLUGIN_FAILURE otherwise.
+	// Available since minor version 5.
+	ss_plugin_rc (*read_entries_fields)(ss_plugin_table_t* t, ss_plugin_table_entry_t** entries, uint32_t nentries, const ss_plugin_table_field_t** fields, uint32_t nfields, ss_plugin_state_data* out);
+	//
+	// Iterates through all the entries of a table, invoking the iteration
+	// callback function with chunks of at most "max_batch" entries each.
+	// Returns false in case of failure or iteration break-out, and true otherwise.
+	// Available since minor version 5.
+	ss_plugin_bool (*iterate_entries_batch)(ss_plugin_table_t* t, ss_plugin_table_iterator_batch_func_t it, uint32_t max_batch, ss_plugin_table_iterator_state_t* s);
 } ss_plugin_table_reader_vtable_ext;
 
 // Supported by the API but deprecated. Use the extended version ss_plugin_table_writer_vtable_ext instead.
@@ -958,6 +980,33 @@ typedef struct
 	// or SS_PLUGIN_FAILURE if the config is rejected.
 	// If rejected the plugin should provide context in the string returned by get_last_error().
 	ss_plugin_rc (*set_config)(ss_plugin_t* s, const ss_plugin_set_config_input* i);
+
+	// Return the maximum number of capture sessions that the framework is
+	// allowed to keep open at the same time, each with its own instance
+	// returned by open(). When greater than one, next_batch() can be invoked
+	// concurrently from different threads on distinct instances, and must not
+	// touch state shared with the other instances without synchronization.
+	// open(), close() and get_last_error() are still invoked sequentially.
+	// Required: no. If not implemented, a single session is opened at a time.
+	// Arguments:
+	// - s: the plugin state, returned by init(). Can be NULL.
+	//
+	// Return value: the maximum number of concurrent sessions, 0 and 1
+	// both mean that concurrent sessions are not supported.
+	uint32_t (*get_max_concurrent_instances)(ss_plugin_t* s);
+
+	// Return whether extract_fields() can be asked for several fields in one
+	// call. If so, the framework may pass all the fields of a filter or a
+	// formatter at once: the value of each field must be stored in memory of
+	// its own, left untouched by the extraction of the other fields of the
+	// same call, and every field must be extracted even if a previous one
+	// has no value.
+	// Required: no. If not implemented, one field is extracted per call.
+	// Arguments:
+	// - s: the plugin state, returned by init(). Can be NULL.
+	//
+	// Return value: true if multi-field extraction is supported.
+	ss_plugin_bool (*get_extract_batch_support)(ss_plugin_t* s);
 } plugin_api;
 
 #ifdef __cplusplus
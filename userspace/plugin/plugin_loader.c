@@ -136,6 +136,8 @@ plugin_handle_t* plugin_load(const char* path, char* err)
     SYM_RESOLVE(ret, get_async_events);
     SYM_RESOLVE(ret, set_async_event_handler);
     SYM_RESOLVE(ret, set_config);
+    SYM_RESOLVE(ret, get_max_concurrent_instances);
+    SYM_RESOLVE(ret, get_extract_batch_support);
     return ret;
 }
 